@@ -16,6 +16,7 @@ Item {
     property double scaley
     property bool dropped
     property string fps
+    property int cacheHits: -1
     property bool showMarkers
     property bool showTimecode
     property bool showFps
@@ -130,7 +131,7 @@ Item {
         color: root.dropped ? "red" : "white"
         style: Text.Outline;
         styleColor: "black"
-        text: root.fps + "fps"
+        text: root.fps + "fps" + (root.cacheHits >= 0 ? " (" + root.cacheHits + "% cached)" : "")
         visible: root.showFps
         font.pixelSize: root.displayFontSize
         anchors {
@@ -25,6 +25,7 @@
 #include <QUrl>
 #include <QDebug>
 #include "renderjob.h"
+#include "parallelrenderjob.h"
 
 int main(int argc, char **argv)
 {
@@ -32,10 +33,12 @@ int main(int argc, char **argv)
     QStringList args = app.arguments();
     QStringList preargs;
     QString locale;
+    QString ffmpeg;
     if (args.count() >= 7) {
         int pid = 0;
         int in = -1;
         int out = -1;
+        int segments = 1;
         // Remove program name
         args.removeFirst();
 
@@ -58,6 +61,12 @@ int main(int argc, char **argv)
             locale = args.at(0).section(QLatin1Char(':'), 1);
             args.removeFirst();
         }
+        if (args.at(0).startsWith(QLatin1String("-segments:"))) {
+            segments = args.takeFirst().section(QLatin1Char(':'), 1).toInt();
+        }
+        if (args.at(0).startsWith(QLatin1String("-ffmpeg:"))) {
+            ffmpeg = args.takeFirst().section(QLatin1Char(':'), 1);
+        }
         if (args.at(0).startsWith(QLatin1String("in="))) {
             in = args.takeFirst().section(QLatin1Char('='), -1).toInt();
         }
@@ -120,6 +129,22 @@ int main(int argc, char **argv)
         }
 
         qDebug() << "//STARTING RENDERING: " << erase << ',' << usekuiserver << ',' << render << ',' << profile << ',' << rendermodule << ',' << player << ',' << src << ',' << dest << ',' << preargs << ',' << args << ',' << in << ',' << out;
+        if (ParallelRenderJob::canSegment(rendermodule, dest, in, out, segments)) {
+            QStringList secondPassArgs;
+            if (dualpass) {
+                secondPassArgs = args;
+                if (vprelist.size() > 1) {
+                    secondPassArgs.replaceInStrings(QRegExp(QLatin1String("^vpre=.*")), QStringLiteral("vpre=%1").arg(vprelist.at(1)));
+                }
+                secondPassArgs.replace(secondPassArgs.indexOf(QStringLiteral("pass=1")), QStringLiteral("pass=2"));
+            }
+            if (!locale.isEmpty()) {
+                qputenv("LC_NUMERIC", locale.toUtf8().constData());
+            }
+            ParallelRenderJob job(erase, pid, render, profile, rendermodule, player, src, dest, preargs, args, secondPassArgs, in, out, segments, ffmpeg);
+            job.start();
+            return app.exec();
+        }
         RenderJob *job = new RenderJob(doerase, usekuiserver, pid, render, profile, rendermodule, player, src, dest, preargs, args, in, out);
         if (!locale.isEmpty()) {
             job->setLocale(locale);
@@ -138,10 +163,12 @@ int main(int argc, char **argv)
         delete dualjob;
     } else {
         fprintf(stderr, "Kdenlive video renderer for MLT.\nUsage: "
-                "kdenlive_render [-erase] [-kuiserver] [-locale:LOCALE] [in=pos] [out=pos] [render] [profile] [rendermodule] [player] [src] [dest] [[arg1] [arg2] ...]\n"
+                "kdenlive_render [-erase] [-kuiserver] [-locale:LOCALE] [-segments:COUNT] [-ffmpeg:PATH] [in=pos] [out=pos] [render] [profile] [rendermodule] [player] [src] [dest] [[arg1] [arg2] ...]\n"
                 "  -erase: if that parameter is present, src file will be erased at the end\n"
                 "  -kuiserver: if that parameter is present, use KDE job tracker\n"
                 "  -locale:LOCALE : set a locale for rendering. For example, -locale:fr_FR.UTF-8 will use a french locale (comma as numeric separator)\n"
+                "  -segments:COUNT : render COUNT parts of the zone in parallel and join them, requires in and out\n"
+                "  -ffmpeg:PATH : path to the FFmpeg binary used to join segments\n"
                 "  in=pos: start rendering at frame pos\n"
                 "  out=pos: end rendering at frame pos\n"
                 "  render: path to MLT melt renderer\n"
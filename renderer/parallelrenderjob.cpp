@@ -0,0 +1,285 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team <kdenlive@kde.org>                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#include "parallelrenderjob.h"
+#include "renderjob.h"
+
+#include <QtDBus>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+
+ParallelRenderJob::ParallelRenderJob(bool erase, int pid, const QString &renderer, const QString &profile, const QString &rendermodule, const QString &player, const QString &scenelist, const QString &dest, const QStringList &preargs, const QStringList &args, const QStringList &secondPassArgs, int in, int out, int segments, const QString &ffmpeg) :
+    QObject(),
+    m_erase(erase),
+    m_pid(pid),
+    m_prog(renderer),
+    m_profile(profile),
+    m_rendermodule(rendermodule),
+    m_player(player),
+    m_scenelist(scenelist),
+    m_dest(dest),
+    m_preargs(preargs),
+    m_args(args),
+    m_secondPassArgs(secondPassArgs),
+    m_ffmpeg(ffmpeg.isEmpty() ? QStringLiteral("ffmpeg") : ffmpeg),
+    m_finishedSegments(0),
+    m_progress(0),
+    m_aborted(false),
+    m_concatProcess(nullptr),
+    m_kdenliveinterface(nullptr)
+{
+    createSegments(in, out, segments);
+}
+
+ParallelRenderJob::~ParallelRenderJob()
+{
+    for (const QPointer<RenderJob> &job : m_jobs) {
+        delete job.data();
+    }
+    delete m_concatProcess;
+}
+
+bool ParallelRenderJob::canSegment(const QString &rendermodule, const QString &dest, int in, int out, int segments)
+{
+    // Image sequences and non avformat consumers cannot be joined by stream copy
+    if (segments < 2 || rendermodule != QLatin1String("avformat") || dest.contains(QLatin1Char('%'))) {
+        return false;
+    }
+    return in >= 0 && out - in + 1 >= 2 * MinSegmentFrames;
+}
+
+void ParallelRenderJob::createSegments(int in, int out, int count)
+{
+    int frames = out - in + 1;
+    count = qMax(1, qMin(count, frames / MinSegmentFrames));
+    int length = (frames + count - 1) / count;
+    // Keep the GOP cadence of a single render so that segment boundaries fall on keyframes anyway
+    int gop = 0;
+    for (const QString &arg : m_args) {
+        if (arg.startsWith(QLatin1String("g="))) {
+            gop = arg.section(QLatin1Char('='), 1).toInt();
+        }
+    }
+    if (gop > 1) {
+        length = (length + gop - 1) / gop * gop;
+    }
+    QFileInfo info(m_dest);
+    QString suffix = info.suffix().isEmpty() ? QString() : QLatin1Char('.') + info.suffix();
+    int pos = in;
+    while (pos <= out) {
+        Segment segment;
+        segment.in = pos;
+        segment.out = qMin(out, pos + length - 1);
+        segment.dest = info.absolutePath() + QLatin1Char('/') + info.completeBaseName() + QStringLiteral(".segment%1").arg(m_segments.count()) + suffix;
+        segment.progress = 0;
+        m_segments << segment;
+        pos = segment.out + 1;
+    }
+}
+
+void ParallelRenderJob::start()
+{
+    initKdenliveDbusInterface();
+    m_progressChannel.open(m_pid, m_dest, m_segments.last().out - m_segments.first().in + 1);
+    bool dualpass = !m_secondPassArgs.isEmpty();
+    for (int i = 0; i < m_segments.count(); ++i) {
+        const Segment &segment = m_segments.at(i);
+        QStringList args = m_args;
+        QStringList secondArgs = m_secondPassArgs;
+        if (dualpass) {
+            // Each segment needs its own statistics file
+            QString logFile = QStringLiteral("passlogfile=%1").arg(segment.dest + QStringLiteral(".log"));
+            args = args.filter(QRegExp(QStringLiteral("^(?!passlogfile=)"))) << logFile;
+            secondArgs = secondArgs.filter(QRegExp(QStringLiteral("^(?!passlogfile=)"))) << logFile;
+        }
+        RenderJob *job = new RenderJob(false, false, m_pid, m_prog, m_profile, m_rendermodule, m_player, m_scenelist, segment.dest, m_preargs, args, segment.in, segment.out);
+        job->setSegmentMode(true);
+        job->setProperty("segment", i);
+        connect(job, &RenderJob::renderingProgress, this, &ParallelRenderJob::slotSegmentProgress);
+        connect(job, &RenderJob::renderingFailed, this, &ParallelRenderJob::slotSegmentFailed);
+        m_jobs << job;
+        RenderJob *lastJob = job;
+        if (dualpass) {
+            lastJob = new RenderJob(false, false, m_pid, m_prog, m_profile, m_rendermodule, m_player, m_scenelist, segment.dest, m_preargs, secondArgs, segment.in, segment.out);
+            lastJob->setSegmentMode(true);
+            lastJob->setProperty("segment", i);
+            connect(lastJob, &RenderJob::renderingProgress, this, &ParallelRenderJob::slotSegmentProgress);
+            connect(lastJob, &RenderJob::renderingFailed, this, &ParallelRenderJob::slotSegmentFailed);
+            connect(job, &RenderJob::renderingFinished, lastJob, &RenderJob::start);
+            m_jobs << lastJob;
+        }
+        connect(lastJob, &RenderJob::renderingFinished, this, &ParallelRenderJob::slotSegmentFinished);
+        job->start();
+    }
+    qDebug() << "Rendering" << m_dest << "in" << m_segments.count() << "segments";
+}
+
+void ParallelRenderJob::initKdenliveDbusInterface()
+{
+    QString kdenliveId = RenderJob::kdenliveService(m_pid);
+    m_dbusargs.clear();
+    if (kdenliveId.isEmpty()) {
+        return;
+    }
+    m_kdenliveinterface = new QDBusInterface(kdenliveId,
+            QStringLiteral("/kdenlive/MainWindow_1"),
+            QStringLiteral("org.kde.kdenlive.rendering"),
+            QDBusConnection::sessionBus(),
+            this);
+    m_dbusargs.append(m_dest);
+    m_dbusargs.append((int) 0);
+    m_kdenliveinterface->callWithArgumentList(QDBus::NoBlock, QStringLiteral("setRenderingProgress"), m_dbusargs);
+    connect(m_kdenliveinterface, SIGNAL(abortRenderJob(QString)), this, SLOT(slotAbort(QString)));
+}
+
+void ParallelRenderJob::slotSegmentProgress(int progress)
+{
+    int index = sender()->property("segment").toInt();
+    m_segments[index].progress = progress;
+    qint64 done = 0;
+    qint64 total = 0;
+    for (const Segment &segment : m_segments) {
+        int frames = segment.out - segment.in + 1;
+        done += (qint64) segment.progress * frames;
+        total += frames;
+    }
+    m_progressChannel.update((int) (done / 100));
+    // Keep the last percent for joining the segments
+    int pro = (int) (done * 99 / (total * 100));
+    if (pro <= m_progress) {
+        return;
+    }
+    m_progress = pro;
+    if (!m_progressChannel.isOpen() && m_kdenliveinterface && m_kdenliveinterface->isValid()) {
+        m_dbusargs[1] = m_progress;
+        m_kdenliveinterface->callWithArgumentList(QDBus::NoBlock, QStringLiteral("setRenderingProgress"), m_dbusargs);
+    }
+}
+
+void ParallelRenderJob::slotSegmentFinished()
+{
+    m_finishedSegments++;
+    if (m_finishedSegments < m_segments.count() || m_aborted) {
+        return;
+    }
+    // Join segments with ffmpeg's concat demuxer, without reencoding
+    QFile list(m_dest + QStringLiteral(".segments"));
+    if (!list.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        finish(-2, tr("Cannot write to %1, check permissions.").arg(list.fileName()));
+        return;
+    }
+    QTextStream stream(&list);
+    for (const Segment &segment : m_segments) {
+        QString path = segment.dest;
+        stream << "file '" << path.replace(QLatin1Char('\''), QLatin1String("'\\''")) << "'\n";
+    }
+    list.close();
+    m_concatProcess = new QProcess;
+    m_concatProcess->setProcessChannelMode(QProcess::MergedChannels);
+    connect(m_concatProcess, SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(slotConcatFinished(int, QProcess::ExitStatus)));
+    QStringList args;
+    args << QStringLiteral("-y") << QStringLiteral("-v") << QStringLiteral("error") << QStringLiteral("-f") << QStringLiteral("concat") << QStringLiteral("-safe") << QStringLiteral("0");
+    args << QStringLiteral("-i") << list.fileName() << QStringLiteral("-map") << QStringLiteral("0") << QStringLiteral("-c") << QStringLiteral("copy") << m_dest;
+    m_concatProcess->start(m_ffmpeg, args);
+}
+
+void ParallelRenderJob::slotConcatFinished(int exitCode, QProcess::ExitStatus status)
+{
+    if (status == QProcess::CrashExit || exitCode != 0) {
+        QString error = QString::fromLocal8Bit(m_concatProcess->readAll()).simplified();
+        QFile(m_dest).remove();
+        finish(-2, error.isEmpty() ? tr("Cannot join rendered segments with %1.").arg(m_ffmpeg) : error);
+        return;
+    }
+    finish(-1);
+}
+
+void ParallelRenderJob::slotSegmentFailed(const QString &error)
+{
+    if (m_aborted) {
+        return;
+    }
+    abortSegments();
+    finish(-2, error);
+}
+
+void ParallelRenderJob::slotAbort(const QString &url)
+{
+    if (m_dest != url) {
+        return;
+    }
+    qWarning() << "Job aborted by user...";
+    abortSegments();
+    if (m_concatProcess) {
+        m_concatProcess->disconnect(this);
+        m_concatProcess->kill();
+        m_concatProcess->waitForFinished();
+    }
+    QFile(m_dest).remove();
+    finish(-3);
+}
+
+void ParallelRenderJob::abortSegments()
+{
+    m_aborted = true;
+    for (const QPointer<RenderJob> &job : m_jobs) {
+        if (job) {
+            job->abortSegment();
+        }
+    }
+}
+
+void ParallelRenderJob::removeSegmentFiles()
+{
+    for (const Segment &segment : m_segments) {
+        QFileInfo info(segment.dest);
+        // Also remove dual pass statistics files
+        const QStringList files = info.dir().entryList(QStringList() << info.fileName() + QStringLiteral(".log*"), QDir::Files);
+        for (const QString &file : files) {
+            info.dir().remove(file);
+        }
+        QFile(segment.dest).remove();
+    }
+    QFile(m_dest + QStringLiteral(".segments")).remove();
+}
+
+void ParallelRenderJob::finish(int status, const QString &error)
+{
+    removeSegmentFiles();
+    if (m_erase) {
+        QFile(m_scenelist).remove();
+    }
+    if (m_kdenliveinterface) {
+        m_dbusargs[1] = status;
+        m_dbusargs.append(error);
+        m_kdenliveinterface->callWithArgumentList(QDBus::NoBlock, QStringLiteral("setRenderingFinished"), m_dbusargs);
+    }
+    if (status == -2) {
+        QStringList args;
+        args << QStringLiteral("--error") << tr("Rendering of %1 aborted, resulting video will probably be corrupted.").arg(m_dest);
+        QProcess::startDetached(QStringLiteral("kdialog"), args);
+    } else if (status == -1) {
+        RenderJob::startPlayer(m_player);
+    }
+    qApp->quit();
+}
@@ -0,0 +1,102 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team <kdenlive@kde.org>                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef PARALLELRENDERJOB_H
+#define PARALLELRENDERJOB_H
+
+#include <QObject>
+#include <QPointer>
+#include <QProcess>
+#include <QStringList>
+#include <QVector>
+
+#include "progresschannel.h"
+
+class RenderJob;
+class QDBusInterface;
+
+/**
+ * @class ParallelRenderJob
+ * @brief Renders a zone as several segments in parallel melt processes, then joins them with a stream copy.
+ *
+ * Every segment uses the same encoder settings, including both passes of a dual pass render.
+ * Progress is reported to Kdenlive through D-Bus as for a single RenderJob.
+ */
+
+class ParallelRenderJob : public QObject
+{
+    Q_OBJECT
+
+public:
+    /** @brief Minimum number of frames in a segment, shorter renders are not split. */
+    static const int MinSegmentFrames = 250;
+
+    ParallelRenderJob(bool erase, int pid, const QString &renderer, const QString &profile, const QString &rendermodule, const QString &player, const QString &scenelist, const QString &dest, const QStringList &preargs, const QStringList &args, const QStringList &secondPassArgs, int in, int out, int segments, const QString &ffmpeg);
+    ~ParallelRenderJob();
+    /** @brief Returns true if a render with these parameters can be split in segments. */
+    static bool canSegment(const QString &rendermodule, const QString &dest, int in, int out, int segments);
+
+public slots:
+    void start();
+
+private slots:
+    void slotSegmentProgress(int progress);
+    void slotSegmentFinished();
+    void slotSegmentFailed(const QString &error);
+    void slotConcatFinished(int exitCode, QProcess::ExitStatus status);
+    void slotAbort(const QString &url);
+
+private:
+    struct Segment {
+        int in;
+        int out;
+        QString dest;
+        int progress;
+    };
+    bool m_erase;
+    int m_pid;
+    QString m_prog;
+    QString m_profile;
+    QString m_rendermodule;
+    QString m_player;
+    QString m_scenelist;
+    QString m_dest;
+    QStringList m_preargs;
+    QStringList m_args;
+    QStringList m_secondPassArgs;
+    QString m_ffmpeg;
+    QVector<Segment> m_segments;
+    /** @brief All render jobs, first pass jobs delete themselves when done. */
+    QList<QPointer<RenderJob> > m_jobs;
+    int m_finishedSegments;
+    int m_progress;
+    bool m_aborted;
+    QProcess *m_concatProcess;
+    QDBusInterface *m_kdenliveinterface;
+    ProgressChannel m_progressChannel;
+    QList<QVariant> m_dbusargs;
+    /** @brief Split the in / out zone, aligning segments on the encoder's GOP size. */
+    void createSegments(int in, int out, int count);
+    void initKdenliveDbusInterface();
+    void abortSegments();
+    void removeSegmentFiles();
+    void finish(int status, const QString &error = QString());
+};
+
+#endif
@@ -0,0 +1,76 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team <kdenlive@kde.org>                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#include "progresschannel.h"
+
+#include <QFileInfo>
+
+ProgressChannel::ProgressChannel() :
+    m_frames(0),
+    m_pass(1),
+    m_passes(1),
+    m_lastFrame(0),
+    m_lastTime(0)
+{
+}
+
+bool ProgressChannel::open(int pid, const QString &dest, int frames, int pass, int passes)
+{
+    if (pid <= 0 || frames <= 0) {
+        return false;
+    }
+    m_socket.connectToServer(QStringLiteral("kdenlive-render-%1").arg(pid), QIODevice::WriteOnly);
+    if (!m_socket.waitForConnected(500)) {
+        return false;
+    }
+    m_dest = dest;
+    m_frames = frames;
+    m_pass = pass;
+    m_passes = passes;
+    m_socket.write(QStringLiteral("job=%1\n").arg(dest).toUtf8());
+    m_socket.flush();
+    m_timer.start();
+    return true;
+}
+
+bool ProgressChannel::isOpen() const
+{
+    return m_socket.state() == QLocalSocket::ConnectedState;
+}
+
+void ProgressChannel::update(int frame, bool force)
+{
+    if (!isOpen()) {
+        return;
+    }
+    qint64 now = m_timer.elapsed();
+    if (!force && now - m_lastTime < UpdateInterval) {
+        return;
+    }
+    double fps = now > m_lastTime ? (frame - m_lastFrame) * 1000.0 / (now - m_lastTime) : 0;
+    // Dual pass renders process all frames twice
+    qint64 remaining = m_frames - frame + (qint64) (m_passes - m_pass) * m_frames;
+    double average = now > 0 ? frame * 1000.0 / now : 0;
+    int eta = average > 0 ? (int) (remaining / average) : -1;
+    m_lastFrame = frame;
+    m_lastTime = now;
+    QString line = QStringLiteral("frame=%1 total=%2 pass=%3 passes=%4 fps=%5 bytes=%6 eta=%7\n").arg(frame).arg(m_frames).arg(m_pass).arg(m_passes).arg(fps, 0, 'f', 2).arg(QFileInfo(m_dest).size()).arg(eta);
+    m_socket.write(line.toUtf8());
+    m_socket.flush();
+}
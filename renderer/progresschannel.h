@@ -0,0 +1,63 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team <kdenlive@kde.org>                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef PROGRESSCHANNEL_H
+#define PROGRESSCHANNEL_H
+
+#include <QLocalSocket>
+#include <QElapsedTimer>
+#include <QString>
+
+/**
+ * @class ProgressChannel
+ * @brief Sends render statistics to the Kdenlive instance through a local socket.
+ *
+ * The socket is named kdenlive-render-PID after the Kdenlive process id. The job first
+ * sends a "job=DEST" line, then one line per update with space separated key=value pairs:
+ * frame (frames done in this pass), total (frames to render), pass, passes, fps, bytes (output file size) and
+ * eta (remaining seconds). Receivers ignore unknown keys.
+ */
+
+class ProgressChannel
+{
+public:
+    /** @brief Minimum delay between two updates, in milliseconds. */
+    static const int UpdateInterval = 250;
+
+    ProgressChannel();
+    /** @brief Connect to the Kdenlive instance, returns false if it does not listen for progress.
+     * @param pass the pass rendered by this job, out of passes */
+    bool open(int pid, const QString &dest, int frames, int pass = 1, int passes = 1);
+    bool isOpen() const;
+    /** @brief Report the number of frames done, throttled unless force is set. */
+    void update(int frame, bool force = false);
+
+private:
+    QLocalSocket m_socket;
+    QElapsedTimer m_timer;
+    QString m_dest;
+    int m_frames;
+    int m_pass;
+    int m_passes;
+    /** @brief Frames done and time of the previous update, used for the instant speed. */
+    int m_lastFrame;
+    qint64 m_lastTime;
+};
+
+#endif
@@ -50,7 +50,9 @@ RenderJob::RenderJob(bool erase, bool usekuiserver, int pid, const QString &rend
     m_seconds(0),
     m_frame(0),
     m_pid(pid),
-    m_dualpass(false)
+    m_dualpass(false),
+    m_segment(false),
+    m_frames(in >= 0 && out >= in ? out - in + 1 : 0)
 {
     m_renderProcess = new QProcess;
     m_renderProcess->setReadChannel(QProcess::StandardError);
@@ -96,6 +98,23 @@ void RenderJob::setLocale(const QString &locale)
     qputenv("LC_NUMERIC", locale.toUtf8().constData());
 }
 
+void RenderJob::setSegmentMode(bool segment)
+{
+    m_segment = segment;
+}
+
+void RenderJob::abortSegment()
+{
+    m_segment = true;
+    disconnect(m_renderProcess, &QProcess::stateChanged, this, &RenderJob::slotCheckProcess);
+    m_renderProcess->kill();
+    m_renderProcess->waitForFinished();
+    QFile(m_dest).remove();
+    m_logstream << "Job aborted by user" << endl;
+    m_logstream.flush();
+    m_logfile.close();
+}
+
 void RenderJob::slotAbort(const QString &url)
 {
     if (m_dest == url) {
@@ -133,7 +152,11 @@ void RenderJob::receivedStderr()
         m_errorMessage.append(result + QStringLiteral("<br>"));
     } else {
         m_logstream << "melt: " << result << endl;
-        int pro = result.section(QLatin1Char(' '), -1).toInt();
+        // Several progress lines may have been read at once, use the last one
+        const QString last = result.section(QStringLiteral("Current Frame:"), -1);
+        int frame = last.section(QLatin1Char(','), 0, 0).simplified().toInt();
+        m_progressChannel.update(frame);
+        int pro = last.section(QLatin1Char(' '), -1).toInt();
         if (pro <= m_progress || pro <= 0 || pro > 100) {
             return;
         }
@@ -143,8 +166,12 @@ void RenderJob::receivedStderr()
         } else if (m_args.contains(QStringLiteral("pass=2"))) {
             m_progress = 50 + m_progress / 2.0;
         }
-        int frame = result.section(QLatin1Char(','), 1).section(QLatin1Char(' '), -1).toInt();
-        if (m_kdenliveinterface && m_kdenliveinterface->isValid()) {
+        if (m_segment) {
+            emit renderingProgress(m_progress);
+            return;
+        }
+        // When Kdenlive receives our statistics, only use D-Bus for start and end of the job
+        if (!m_progressChannel.isOpen() && m_kdenliveinterface && m_kdenliveinterface->isValid()) {
             m_dbusargs[1] = m_progress;
             m_kdenliveinterface->callWithArgumentList(QDBus::NoBlock, QStringLiteral("setRenderingProgress"), m_dbusargs);
         }
@@ -169,7 +196,7 @@ void RenderJob::receivedStderr()
 void RenderJob::start()
 {
     QDBusConnectionInterface *interface = QDBusConnection::sessionBus().interface();
-    if (interface && m_usekuiserver) {
+    if (interface && m_usekuiserver && !m_segment) {
         if (!interface->isServiceRegistered(QStringLiteral("org.kde.JobViewServer"))) {
             qWarning() << "No org.kde.JobViewServer registered, trying to start kuiserver";
             if (QProcess::startDetached(QStringLiteral("kuiserver"))) {
@@ -203,7 +230,11 @@ void RenderJob::start()
             }
         }
     }
-    initKdenliveDbusInterface();
+    if (!m_segment) {
+        initKdenliveDbusInterface();
+        bool secondPass = m_args.contains(QStringLiteral("pass=2"));
+        m_progressChannel.open(m_pid, m_dest, m_frames, secondPass ? 2 : 1, secondPass || m_dualpass ? 2 : 1);
+    }
 
     // Make sure the destination directory is writable
     QFileInfo checkDestination(QFileInfo(m_dest).absolutePath());
@@ -217,12 +248,10 @@ void RenderJob::start()
     m_logstream << "Started render process: " << m_prog << ' ' << m_args.join(QLatin1Char(' ')) << endl;
 }
 
-void RenderJob::initKdenliveDbusInterface()
+QString RenderJob::kdenliveService(int pid)
 {
-    QString kdenliveId;
-    QDBusConnection connection = QDBusConnection::sessionBus();
-    QDBusConnectionInterface *ibus = connection.interface();
-    kdenliveId = QStringLiteral("org.kde.kdenlive-%1").arg(m_pid);
+    QDBusConnectionInterface *ibus = QDBusConnection::sessionBus().interface();
+    QString kdenliveId = QStringLiteral("org.kde.kdenlive-%1").arg(pid);
     if (!ibus->isServiceRegistered(kdenliveId)) {
         kdenliveId.clear();
         const QStringList services = ibus->registeredServiceNames();
@@ -234,6 +263,25 @@ void RenderJob::initKdenliveDbusInterface()
             break;
         }
     }
+    return kdenliveId;
+}
+
+void RenderJob::startPlayer(const QString &player)
+{
+    if (player.length() > 3 && player.contains(QLatin1Char(' '))) {
+        QStringList args = player.split(QLatin1Char(' '));
+        QString exec = args.takeFirst();
+        // Decode url
+        QString url = QUrl::fromEncoded(args.takeLast().toUtf8()).toLocalFile();
+        args << url;
+        QProcess::startDetached(exec, args);
+    }
+}
+
+void RenderJob::initKdenliveDbusInterface()
+{
+    QDBusConnection connection = QDBusConnection::sessionBus();
+    QString kdenliveId = kdenliveService(m_pid);
     m_dbusargs.clear();
     if (kdenliveId.isEmpty()) {
         return;
@@ -271,6 +319,11 @@ void RenderJob::slotIsOver(QProcess::ExitStatus status, bool isWritable)
     }
     if (!isWritable) {
         QString error = tr("Cannot write to %1, check permissions.").arg(m_dest);
+        if (m_segment) {
+            m_logstream << error << endl;
+            emit renderingFailed(error);
+            return;
+        }
         if (m_kdenliveinterface) {
             m_dbusargs[1] = (int) - 2;
             m_dbusargs.append(error);
@@ -285,6 +338,12 @@ void RenderJob::slotIsOver(QProcess::ExitStatus status, bool isWritable)
     }
     if (status == QProcess::CrashExit || m_renderProcess->error() != QProcess::UnknownError || m_renderProcess->exitCode() != 0) {
         // rendering crashed
+        if (m_segment) {
+            m_logstream << "Rendering of " << m_dest << " failed" << endl;
+            m_logstream.flush();
+            emit renderingFailed(m_errorMessage);
+            return;
+        }
         if (m_kdenliveinterface) {
             m_dbusargs[1] = (int) - 2;
             m_dbusargs.append(m_errorMessage);
@@ -303,18 +362,16 @@ void RenderJob::slotIsOver(QProcess::ExitStatus status, bool isWritable)
             m_kdenliveinterface->callWithArgumentList(QDBus::NoBlock, QStringLiteral("setRenderingFinished"), m_dbusargs);
         }
         m_logstream << "Rendering of " << m_dest << " finished" << endl;
-        if (!m_dualpass && m_player.length() > 3 && m_player.contains(QLatin1Char(' '))) {
-            QStringList args = m_player.split(QLatin1Char(' '));
-            QString exec = args.takeFirst();
-            // Decode url
-            QString url = QUrl::fromEncoded(args.takeLast().toUtf8()).toLocalFile();
-            args << url;
-            QProcess::startDetached(exec, args);
+        if (!m_dualpass && !m_segment) {
+            startPlayer(m_player);
         }
         m_logstream.flush();
         if (m_dualpass) {
             emit renderingFinished();
             deleteLater();
+        } else if (m_segment) {
+            m_logfile.remove();
+            emit renderingFinished();
         } else  {
             m_logfile.remove();
             qApp->quit();
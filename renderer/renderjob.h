@@ -28,6 +28,8 @@
 #include <QTemporaryFile>
 #include <QTextStream>
 
+#include "progresschannel.h"
+
 class RenderJob : public QObject
 {
     Q_OBJECT
@@ -36,6 +38,14 @@ public:
     RenderJob(bool erase, bool usekuiserver, int pid, const QString &renderer, const QString &profile, const QString &rendermodule, const QString &player, const QString &scenelist, const QString &dest, const QStringList &preargs, const QStringList &args, int in = -1, int out = -1);
     ~RenderJob();
     void setLocale(const QString &locale);
+    /** @brief Render a segment of a parallel render: progress and result are reported with signals instead of D-Bus. */
+    void setSegmentMode(bool segment);
+    /** @brief Kill a segment render process and remove its output. */
+    void abortSegment();
+    /** @brief Returns the D-Bus service name of the Kdenlive instance with process id pid, or any running instance. */
+    static QString kdenliveService(int pid);
+    /** @brief Start the player command line passed to kdenlive_render on the rendered file. */
+    static void startPlayer(const QString &player);
 
 public slots:
     void start();
@@ -64,6 +74,10 @@ private:
     /** @brief The process id of the Kdenlive instance, used to get the dbus service. */
     int m_pid;
     bool m_dualpass;
+    bool m_segment;
+    /** @brief Number of frames to render, 0 if unknown. */
+    int m_frames;
+    ProgressChannel m_progressChannel;
     QProcess *m_renderProcess;
     QString m_errorMessage;
     QList<QVariant> m_dbusargs;
@@ -75,6 +89,10 @@ private:
 
 signals:
     void renderingFinished();
+    /** @brief Emitted in segment mode when the render process fails. */
+    void renderingFailed(const QString &error);
+    /** @brief Emitted in segment mode with the job's progress in percent. */
+    void renderingProgress(int progress);
 };
 
 #endif
@@ -222,7 +222,7 @@ QVariant AbstractProjectItem::data(DataType type) const
 
 int AbstractProjectItem::supportedDataCount() const
 {
-    return 3;
+    return 4;
 }
 
 QString AbstractProjectItem::name() const
@@ -150,7 +150,11 @@ public:
         // error message if job crashes (not fully implemented)
         JobMessage,
         // Item status (ready or not, missing, waiting, ...)
-        ClipStatus
+        ClipStatus,
+        // Source decode speed relative to the project frame rate
+        DataDecodeSpeed,
+        // Same as DataDecodeSpeed, as a number for sorting
+        DecodeSpeedValue
     };
 
     enum CLIPSTATUS {
@@ -174,7 +178,7 @@ public:
     /**
      * @brief Returns the amount of different types of data this item supports.
      *
-     * This base class supports only DataName and DataDescription, so the return value is always 2.
+     * This base class supports DataName, DataDate, DataDescription and DataDecodeSpeed, so the return value is always 4.
      * This function is necessary for interaction with ProjectItemModel.
      */
     virtual int supportedDataCount() const;
@@ -0,0 +1,396 @@
+/*
+Copyright (C) 2018  Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "analysisstore.h"
+#include "bin.h"
+#include "core.h"
+#include "kdenlive_debug.h"
+#include "doc/kdenlivedoc.h"
+#include "project/projectmanager.h"
+
+#include <klocalizedstring.h>
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+namespace {
+const QString referencePrefix = QStringLiteral("analysis:");
+const quint32 storeMagic = 0x4b44414e;
+const quint16 storeVersion = 1;
+// Data shorter than this stays in the project file
+const int inlineLimit = 4096;
+// Parsed tracks kept in memory, cost is in kB
+const int memoryLimit = 64 * 1024;
+
+QChar geometrySeparator(int component)
+{
+    // MLT geometry layout: x/y:wxh:opacity
+    switch (component) {
+    case 1:
+        return QLatin1Char('/');
+    case 3:
+        return QLatin1Char('x');
+    default:
+        return QLatin1Char(':');
+    }
+}
+}
+
+AnalysisStore::AnalysisStore()
+    : m_tracks(memoryLimit)
+{
+}
+
+//static
+bool AnalysisStore::isReference(const QString &value)
+{
+    return value.startsWith(referencePrefix);
+}
+
+QString AnalysisStore::store(const QString &data)
+{
+    if (data.size() < inlineLimit || isReference(data)) {
+        return data;
+    }
+    bool ok = false;
+    QDir dir = folder(&ok);
+    if (!ok) {
+        // The project has no folder yet, keep the data in the project file
+        return data;
+    }
+    Track *parsed = new Track;
+    if (!parse(data, parsed)) {
+        // Keep unknown formats as compressed text
+        parsed->type = RawData;
+        parsed->frames.clear();
+        parsed->interpolation.clear();
+        parsed->values.clear();
+        parsed->raw = data;
+    }
+    const QString id = QString::fromLatin1(QCryptographicHash::hash(data.toUtf8(), QCryptographicHash::Md5).toHex());
+    if (!dir.exists(fileName(id)) && (!dir.mkpath(QStringLiteral(".")) || !write(dir.absoluteFilePath(fileName(id)), *parsed))) {
+        qCDebug(KDENLIVE_LOG) << "Cannot write analysis data to" << dir.absolutePath();
+        delete parsed;
+        return data;
+    }
+    m_tracks.insert(id, parsed, cost(*parsed));
+    return referencePrefix + id;
+}
+
+QString AnalysisStore::text(const QString &value)
+{
+    if (!isReference(value)) {
+        return value;
+    }
+    Track *data = track(value);
+    return data ? serialise(*data) : QString();
+}
+
+int AnalysisStore::keyframeCount(const QString &value)
+{
+    Track *data = track(value);
+    return data ? data->frames.count() : 0;
+}
+
+AnalysisStore::Track *AnalysisStore::track(const QString &value)
+{
+    const QString key = isReference(value) ? value.mid(referencePrefix.size()) : value;
+    Track *data = m_tracks.object(key);
+    if (data) {
+        return data;
+    }
+    if (isReference(value)) {
+        const QString path = filePath(value);
+        data = path.isEmpty() ? nullptr : read(path);
+        if (!data) {
+            if (!m_missing.contains(key)) {
+                m_missing.insert(key);
+                pCore->bin()->emitMessage(i18n("Cannot load clip analysis data %1", fileName(key)), 100, ErrorMessage);
+            }
+            return nullptr;
+        }
+        bool ok = false;
+        QDir dir = folder(&ok);
+        if (ok && QFileInfo(path).absolutePath() != dir.absolutePath()) {
+            // Move side-car files left in the cache by earlier versions next to the project
+            copyFiles(QStringList() << value, dir);
+        }
+    } else {
+        // Inline data, only parsed once
+        data = new Track;
+        if (!parse(value, data)) {
+            data->type = RawData;
+            data->raw = value;
+        }
+    }
+    m_tracks.insert(key, data, cost(*data));
+    return data;
+}
+
+//static
+QString AnalysisStore::folderName()
+{
+    return QStringLiteral("kdenlive-analysis");
+}
+
+//static
+QDir AnalysisStore::folder(bool *ok)
+{
+    // Analysis results cannot be regenerated automatically, so they do not belong to the cache folder
+    *ok = false;
+    KdenliveDoc *doc = pCore->projectManager()->current();
+    if (doc == nullptr || !doc->url().isValid()) {
+        return QDir();
+    }
+    *ok = true;
+    return QDir(QFileInfo(doc->url().toLocalFile()).absolutePath() + QLatin1Char('/') + folderName());
+}
+
+//static
+QString AnalysisStore::filePath(const QString &value)
+{
+    if (!isReference(value)) {
+        return QString();
+    }
+    const QString name = fileName(value.mid(referencePrefix.size()));
+    bool ok = false;
+    QDir dir = folder(&ok);
+    if (ok && dir.exists(name)) {
+        return dir.absoluteFilePath(name);
+    }
+    // Earlier versions stored side-car files in the project cache folder
+    dir = pCore->bin()->getCacheDir(CacheAnalysis, &ok);
+    if (ok && dir.exists(name)) {
+        return dir.absoluteFilePath(name);
+    }
+    return QString();
+}
+
+//static
+void AnalysisStore::copyFiles(const QStringList &values, const QDir &dest)
+{
+    for (const QString &value : values) {
+        const QString source = filePath(value);
+        if (source.isEmpty()) {
+            continue;
+        }
+        const QString target = dest.absoluteFilePath(QFileInfo(source).fileName());
+        if (source == target || QFile::exists(target)) {
+            continue;
+        }
+        if (!dest.mkpath(QStringLiteral(".")) || !QFile::copy(source, target)) {
+            qCDebug(KDENLIVE_LOG) << "Cannot copy analysis data to" << dest.absolutePath();
+        }
+    }
+}
+
+//static
+QString AnalysisStore::fileName(const QString &id)
+{
+    return id + QStringLiteral(".kda");
+}
+
+//static
+bool AnalysisStore::parse(const QString &data, Track *track)
+{
+    track->type = RawData;
+    track->geometryStyle = false;
+    track->terminated = data.endsWith(QLatin1Char(';'));
+    track->frames.clear();
+    track->interpolation.clear();
+    track->values.clear();
+    track->raw.clear();
+    const QVector<QStringRef> entries = data.splitRef(QLatin1Char(';'), QString::SkipEmptyParts);
+    if (entries.isEmpty()) {
+        return false;
+    }
+    int components = 0;
+    track->frames.reserve(entries.count());
+    track->interpolation.reserve(entries.count());
+    for (const QStringRef &entry : entries) {
+        const int equal = entry.indexOf(QLatin1Char('='));
+        if (equal <= 0) {
+            return false;
+        }
+        QStringRef key = entry.left(equal);
+        char interpolation = 0;
+        if (key.endsWith(QLatin1Char('~')) || key.endsWith(QLatin1Char('|'))) {
+            interpolation = key.at(key.size() - 1).toLatin1();
+            key = key.left(key.size() - 1);
+        }
+        bool ok;
+        const int frame = key.toInt(&ok);
+        if (!ok) {
+            return false;
+        }
+        // Values are separated by spaces (mlt_rect) or by MLT geometry separators
+        const QStringRef value = entry.mid(equal + 1);
+        float numbers[RectOpacityTrack];
+        int count = 0;
+        int start = 0;
+        bool geometry = false;
+        for (int i = 0; i <= value.size(); ++i) {
+            if (i < value.size()) {
+                const QChar c = value.at(i);
+                if (c != QLatin1Char(' ') && c != QLatin1Char('/') && c != QLatin1Char(':') && c != QLatin1Char('x')) {
+                    continue;
+                }
+                geometry = geometry || c != QLatin1Char(' ');
+            }
+            if (count == RectOpacityTrack) {
+                return false;
+            }
+            numbers[count++] = value.mid(start, i - start).toFloat(&ok);
+            if (!ok) {
+                return false;
+            }
+            start = i + 1;
+        }
+        if (components == 0) {
+            if (count == 3) {
+                return false;
+            }
+            components = count;
+            track->geometryStyle = geometry;
+        } else if (count != components || (count > 1 && geometry != track->geometryStyle)) {
+            return false;
+        }
+        track->frames.append(frame);
+        track->interpolation.append(interpolation);
+        for (int i = 0; i < count; ++i) {
+            track->values.append(numbers[i]);
+        }
+    }
+    track->type = (TrackType) components;
+    // Only keep the binary form if it gives back exactly the same text
+    if (serialise(*track) != data) {
+        track->type = RawData;
+        return false;
+    }
+    return true;
+}
+
+//static
+QString AnalysisStore::serialise(const Track &track)
+{
+    if (track.type == RawData) {
+        return track.raw;
+    }
+    const int components = track.type;
+    QString result;
+    result.reserve(track.values.count() * 6);
+    for (int i = 0; i < track.frames.count(); ++i) {
+        if (i > 0) {
+            result.append(QLatin1Char(';'));
+        }
+        result.append(QString::number(track.frames.at(i)));
+        if (track.interpolation.at(i) != 0) {
+            result.append(QLatin1Char(track.interpolation.at(i)));
+        }
+        result.append(QLatin1Char('='));
+        const float *v = track.values.constData() + i * components;
+        for (int c = 0; c < components; ++c) {
+            if (c > 0) {
+                result.append(track.geometryStyle ? geometrySeparator(c) : QLatin1Char(' '));
+            }
+            result.append(QString::number(v[c], 'g', 7));
+        }
+    }
+    if (track.terminated) {
+        result.append(QLatin1Char(';'));
+    }
+    return result;
+}
+
+//static
+bool AnalysisStore::write(const QString &path, const Track &track)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    QByteArray payload;
+    QDataStream data(&payload, QIODevice::WriteOnly);
+    data.setVersion(QDataStream::Qt_5_6);
+    data.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    if (track.type == RawData) {
+        data << track.raw;
+    } else {
+        data << track.frames << track.interpolation << track.values;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_6);
+    out << storeMagic << storeVersion << (qint8) track.type << track.geometryStyle << track.terminated << qCompress(payload);
+    return out.status() == QDataStream::Ok && file.commit();
+}
+
+//static
+AnalysisStore::Track *AnalysisStore::read(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return nullptr;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_6);
+    quint32 magic;
+    quint16 version;
+    qint8 type;
+    bool geometryStyle;
+    bool terminated;
+    QByteArray compressed;
+    in >> magic >> version;
+    if (magic != storeMagic || version > storeVersion) {
+        return nullptr;
+    }
+    in >> type >> geometryStyle >> terminated >> compressed;
+    if (in.status() != QDataStream::Ok || (type != RawData && type != ScalarTrack && type != PointTrack && type != RectTrack && type != RectOpacityTrack)) {
+        return nullptr;
+    }
+    Track *track = new Track;
+    track->type = (TrackType) type;
+    track->geometryStyle = geometryStyle;
+    track->terminated = terminated;
+    const QByteArray payload = qUncompress(compressed);
+    QDataStream data(payload);
+    data.setVersion(QDataStream::Qt_5_6);
+    data.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    if (track->type == RawData) {
+        data >> track->raw;
+    } else {
+        data >> track->frames >> track->interpolation >> track->values;
+    }
+    if (data.status() != QDataStream::Ok || track->interpolation.size() != track->frames.size() || track->values.size() != track->frames.size() * track->type) {
+        delete track;
+        return nullptr;
+    }
+    return track;
+}
+
+//static
+int AnalysisStore::cost(const Track &track)
+{
+    const qint64 bytes = track.frames.size() * sizeof(qint32) + track.interpolation.size() + track.values.size() * sizeof(float) + track.raw.size() * 2;
+    return qMin<qint64>(memoryLimit, bytes / 1024 + 1);
+}
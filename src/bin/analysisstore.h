@@ -0,0 +1,98 @@
+/*
+Copyright (C) 2018  Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ANALYSISSTORE_H
+#define ANALYSISSTORE_H
+
+#include <QCache>
+#include <QDir>
+#include <QSet>
+#include <QVector>
+
+/**
+ * @class AnalysisStore
+ * @brief Keeps clip analysis data (motion tracking, shot lists, ...) in binary side-car files.
+ *
+ * Large analysis results are written to a folder next to the project file, named after the hash of their
+ * content. The kdenlive:clipanalysis.* clip property then only holds a reference to the file, which is
+ * loaded the first time the data is used. Small results, data that cannot be converted without loss and
+ * data of projects that were not saved yet stay inline in the property, so both forms can be passed to
+ * the accessors below.
+ */
+class AnalysisStore
+{
+public:
+    /** @brief Kind of data held, the value is the number of components per keyframe. */
+    enum TrackType {
+        RawData = 0,
+        ScalarTrack = 1,
+        PointTrack = 2,
+        RectTrack = 4,
+        RectOpacityTrack = 5
+    };
+
+    AnalysisStore();
+
+    /** @brief Returns true if a clip property value refers to a side-car file. */
+    static bool isReference(const QString &value);
+    /** @brief Name of the side-car folder, next to the project file. */
+    static QString folderName();
+    /** @brief Returns the side-car file of a reference, or an empty string if it cannot be found. */
+    static QString filePath(const QString &value);
+    /** @brief Copy the side-car files of references to @param dest, for example when the project is saved elsewhere. */
+    static void copyFiles(const QStringList &values, const QDir &dest);
+    /** @brief Stores analysis data, returns the value to set on the clip property: a reference, or the data itself if small. */
+    QString store(const QString &data);
+    /** @brief Returns the analysis data as text, as produced by the analysis filter. */
+    QString text(const QString &value);
+    /** @brief Returns the number of keyframes, 0 for raw data. */
+    int keyframeCount(const QString &value);
+
+private:
+    struct Track {
+        TrackType type;
+        /** @brief True for MLT geometry separators (x/y:wxh:opacity), false for space separated values */
+        bool geometryStyle;
+        /** @brief True if the text ends with a separator */
+        bool terminated;
+        QVector<qint32> frames;
+        /** @brief Interpolation marker of each keyframe (~ or |), 0 for the default */
+        QByteArray interpolation;
+        /** @brief Keyframe values, type components per keyframe */
+        QVector<float> values;
+        QString raw;
+    };
+    QCache<QString, Track> m_tracks;
+    /** @brief References whose side-car file could not be loaded, only reported once. */
+    QSet<QString> m_missing;
+    /** @brief Returns the parsed data of a clip property value, or nullptr if it cannot be loaded. */
+    Track *track(const QString &value);
+    /** @brief Returns the side-car folder of the current project, ok is false if the project was not saved yet. */
+    static QDir folder(bool *ok);
+    static QString fileName(const QString &id);
+    static bool parse(const QString &data, Track *track);
+    static QString serialise(const Track &track);
+    static bool write(const QString &path, const Track &track);
+    static Track *read(const QString &path);
+    static int cost(const Track &track);
+};
+
+#endif
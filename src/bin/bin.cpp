@@ -28,6 +28,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "projectsubclip.h"
 #include "projectfolder.h"
 #include "projectfolderup.h"
+#include "clipresourcemanager.h"
+#include "decodeprobe.h"
+#include "analysisstore.h"
 #include "kdenlivesettings.h"
 #include "project/projectmanager.h"
 #include "project/clipmanager.h"
@@ -520,6 +523,9 @@ Bin::Bin(QWidget *parent) :
     , m_rootFolder(nullptr)
     , m_folderUp(nullptr)
     , m_jobManager(nullptr)
+    , m_resourceManager(new ClipResourceManager(this))
+    , m_decodeProbe(new DecodeProbe(this))
+    , m_analysisStore(new AnalysisStore)
     , m_doc(nullptr)
     , m_extractAudioAction(nullptr)
     , m_transcodeAction(nullptr)
@@ -562,8 +568,6 @@ Bin::Bin(QWidget *parent) :
 
     // Connect models
     m_proxyModel->setSourceModel(m_itemModel);
-    connect(m_itemModel, SIGNAL(dataChanged(QModelIndex, QModelIndex)), m_proxyModel, SLOT(slotDataChanged(const QModelIndex &, const
-            QModelIndex &)));
     connect(m_itemModel, &QAbstractItemModel::rowsInserted, this, &Bin::rowsInserted);
     connect(m_itemModel, &QAbstractItemModel::rowsRemoved, this, &Bin::rowsRemoved);
     connect(m_proxyModel, &ProjectSortProxyModel::selectModel, this, &Bin::selectProxyModel);
@@ -639,8 +643,13 @@ Bin::Bin(QWidget *parent) :
     m_showDesc = new QAction(i18n("Show description"), this);
     m_showDesc->setCheckable(true);
     connect(m_showDesc, &QAction::triggered, this, &Bin::slotShowDescColumn);
+    m_showDecode = new QAction(i18n("Show decode speed"), this);
+    m_showDecode->setCheckable(true);
+    connect(m_showDecode, &QAction::triggered, this, &Bin::slotShowDecodeColumn);
+    connect(m_decodeProbe, &DecodeProbe::probeFinished, this, &Bin::slotDecodeProbeFinished);
     settingsMenu->addAction(m_showDate);
     settingsMenu->addAction(m_showDesc);
+    settingsMenu->addAction(m_showDecode);
     settingsMenu->addAction(disableEffects);
     QToolButton *button = new QToolButton;
     button->setIcon(KoIconUtils::themedIcon(QStringLiteral("kdenlive-menu")));
@@ -701,6 +710,17 @@ Bin::~Bin()
     abortOperations();
     delete m_infoMessage;
     delete m_propertiesPanel;
+    delete m_analysisStore;
+}
+
+ClipResourceManager *Bin::resourceManager()
+{
+    return m_resourceManager;
+}
+
+AnalysisStore *Bin::analysisStore()
+{
+    return m_analysisStore;
 }
 
 QDockWidget *Bin::clipPropertiesDock()
@@ -730,6 +750,21 @@ void Bin::requestAudioThumbs(const QString &id, long duration)
     }
 }
 
+void Bin::prioritizeAudioThumbs(const QStringList &ids)
+{
+    QMutexLocker aMutex(&m_audioThumbMutex);
+    QStringList priority;
+    for (int i = 0; i < m_audioThumbsList.count(); ++i) {
+        if (ids.contains(m_audioThumbsList.at(i))) {
+            priority << m_audioThumbsList.takeAt(i);
+            --i;
+        }
+    }
+    if (!priority.isEmpty()) {
+        m_audioThumbsList = priority + m_audioThumbsList;
+    }
+}
+
 void Bin::doUpdateThumbsProgress(long ms)
 {
     int progress = (m_processedAudio + ms) * 100 / m_audioDuration;
@@ -748,6 +783,7 @@ void Bin::abortOperations()
 {
     blockSignals(true);
     abortAudioThumbs();
+    m_decodeProbe->abort();
     if (m_propertiesPanel) {
         foreach (QWidget *w, m_propertiesPanel->findChildren<ClipPropertiesController *>()) {
             delete w;
@@ -1383,6 +1419,8 @@ QString Bin::slotAddFolder(const QString &folderName)
 
 QModelIndex Bin::getIndexForId(const QString &id, bool folderWanted) const
 {
+    // Make sure recently added items are known to the model
+    m_itemModel->flushPendingChanges();
     QModelIndexList items = m_itemModel->match(m_itemModel->index(0, 0), AbstractProjectItem::DataId, QVariant::fromValue(id), 2, Qt::MatchRecursive);
     for (int i = 0; i < items.count(); i++) {
         AbstractProjectItem *currentItem = static_cast<AbstractProjectItem *>(items.at(i).internalPointer());
@@ -1565,18 +1603,8 @@ void Bin::emitAboutToAddItem(AbstractProjectItem *item)
 
 void Bin::emitItemAdded(AbstractProjectItem *item)
 {
+    // Rows are notified to the views in batches, selection is handled in rowsInserted
     m_itemModel->onItemAdded(item);
-    if (!m_proxyModel->selectionModel()->hasSelection()) {
-        QModelIndex ix = getIndexForId(item->clipId(), item->itemType() == AbstractProjectItem::FolderItem);
-        int row = ix.row();
-        if (row < 0) {
-            row = item->index();
-        }
-        const QModelIndex id = m_itemModel->index(row, 0, ix.parent());
-        const QModelIndex id2 = m_itemModel->index(row, m_rootFolder->supportedDataCount() - 1, ix.parent());
-        m_proxyModel->selectionModel()->select(QItemSelection(m_proxyModel->mapFromSource(id), m_proxyModel->mapFromSource(id2)), QItemSelectionModel::Select);
-        selectProxyModel(m_proxyModel->mapFromSource(id));
-    }
 }
 
 void Bin::emitAboutToRemoveItem(AbstractProjectItem *item)
@@ -1605,10 +1633,14 @@ void Bin::emitItemRemoved(AbstractProjectItem *item)
 
 void Bin::rowsInserted(const QModelIndex &parent, int start, int end)
 {
-    Q_UNUSED(parent)
-    Q_UNUSED(start)
     Q_UNUSED(end)
-    //Moved selection stuff to emitItemAdded otherwise selection is messaed up by sorting
+    if (!m_proxyModel->selectionModel()->hasSelection()) {
+        // Select first inserted item
+        const QModelIndex id = m_itemModel->index(start, 0, parent);
+        const QModelIndex id2 = m_itemModel->index(start, m_rootFolder->supportedDataCount() - 1, parent);
+        m_proxyModel->selectionModel()->select(QItemSelection(m_proxyModel->mapFromSource(id), m_proxyModel->mapFromSource(id2)), QItemSelectionModel::Select);
+        selectProxyModel(m_proxyModel->mapFromSource(id));
+    }
 }
 
 void Bin::rowsRemoved(const QModelIndex &parent, int start, int end)
@@ -1724,6 +1756,7 @@ void Bin::slotInitView(QAction *action)
             m_headerInfo = view->header()->saveState();
             m_showDate->setEnabled(true);
             m_showDesc->setEnabled(true);
+            m_showDecode->setEnabled(true);
         } else {
             // remove the current folderUp item if any
             if (m_folderUp) {
@@ -1746,11 +1779,13 @@ void Bin::slotInitView(QAction *action)
         m_folderUp = new ProjectFolderUp(nullptr);
         m_showDate->setEnabled(false);
         m_showDesc->setEnabled(false);
+        m_showDecode->setEnabled(false);
         break;
     default:
         m_itemView = new MyTreeView(this);
         m_showDate->setEnabled(true);
         m_showDesc->setEnabled(true);
+        m_showDecode->setEnabled(true);
         break;
     }
     m_itemView->setMouseTracking(true);
@@ -1772,16 +1807,16 @@ void Bin::slotInitView(QAction *action)
         view->setWordWrap(true);
         connect(m_proxyModel, &QAbstractItemModel::layoutAboutToBeChanged, this, &Bin::slotSetSorting);
         m_proxyModel->setDynamicSortFilter(true);
-        if (!m_headerInfo.isEmpty()) {
-            view->header()->restoreState(m_headerInfo);
-        } else {
+        if (m_headerInfo.isEmpty() || !view->header()->restoreState(m_headerInfo)) {
             view->header()->resizeSections(QHeaderView::ResizeToContents);
             view->resizeColumnToContents(0);
             view->setColumnHidden(1, true);
             view->setColumnHidden(2, true);
+            view->setColumnHidden(3, true);
         }
         m_showDate->setChecked(!view->isColumnHidden(1));
         m_showDesc->setChecked(!view->isColumnHidden(2));
+        m_showDecode->setChecked(!view->isColumnHidden(3));
         connect(view->header(), &QHeaderView::sectionResized, this, &Bin::slotSaveHeaders);
         connect(view->header(), &QHeaderView::sectionClicked, this, &Bin::slotSaveHeaders);
         connect(view, &MyTreeView::focusView, this, &Bin::slotGotFocus);
@@ -2165,8 +2200,13 @@ void Bin::slotProducerReady(const requestClipInfo &info, ClipController *control
             if (t == AV || t == Audio || t == Image || t == Video || t == Playlist) {
                 m_doc->watchFile(clip->url());
             }
+            if (KdenliveSettings::proxydecodeprobe() && (t == AV || t == Video) && clip->decodeSpeed() <= 0) {
+                m_decodeProbe->probe(info.clipId, clip->url(), clip->hash());
+            }
             if (m_doc->useProxy()) {
-                if (t == AV || t == Video) {
+                if ((t == AV || t == Video) && KdenliveSettings::proxydecodeprobe()) {
+                    // Proxy creation is decided once the decode speed is known
+                } else if (t == AV || t == Video) {
                     int width = clip->getProducerIntProperty(QStringLiteral("meta.media.width"));
                     if (m_doc->autoGenerateProxy(width)) {
                         // Start proxy
@@ -2183,6 +2223,7 @@ void Bin::slotProducerReady(const requestClipInfo &info, ClipController *control
         } else {
             emit producerReady(info.clipId);
         }
+        clip->storeAnalysisData();
         QString currentClip = m_monitor->activeClipId();
         if (currentClip.isEmpty()) {
             //No clip displayed in monitor, check if item is selected
@@ -2727,13 +2768,22 @@ void Bin::addEffect(const QString &id, QDomElement &effect)
     m_monitor->refreshMonitorIfActive();
 }
 
-void Bin::updateEffect(const QString &id, QDomElement &effect, int ix, bool refreshStackWidget, bool updateClip)
+QDomElement Bin::currentEffect(const QString &id, int ix)
+{
+    ProjectClip *currentItem = m_rootFolder->clip(id);
+    if (!currentItem || !currentItem->controller()) {
+        return QDomElement();
+    }
+    return currentItem->controller()->effectList().itemFromIndex(ix).cloneNode().toElement();
+}
+
+void Bin::updateEffect(const QString &id, QDomElement &effect, int ix, bool refreshStackWidget, bool updateClip, const QDomElement &previous)
 {
     ProjectClip *currentItem = m_rootFolder->clip(id);
     if (!currentItem) {
         return;
     }
-    currentItem->updateEffect(m_monitor->profileInfo(), effect, ix, refreshStackWidget, updateClip);
+    currentItem->updateEffect(m_monitor->profileInfo(), effect, ix, refreshStackWidget, updateClip, previous);
     if (updateClip) {
         m_monitor->refreshMonitorIfActive();
     }
@@ -3676,6 +3726,32 @@ void Bin::slotShowDescColumn(bool show)
     }
 }
 
+void Bin::slotShowDecodeColumn(bool show)
+{
+    QTreeView *view = qobject_cast<QTreeView *>(m_itemView);
+    if (view) {
+        view->setColumnHidden(3, !show);
+    }
+}
+
+void Bin::slotDecodeProbeFinished(const QString &id, double speed)
+{
+    ProjectClip *clip = m_rootFolder ? m_rootFolder->clip(id) : nullptr;
+    if (!clip || !m_doc) {
+        return;
+    }
+    clip->setDecodeSpeed(speed / m_doc->fps());
+    // Only proxy clips that have no proxy and where the user did not disable it ("-")
+    if (!m_doc->useProxy() || !clip->getProducerProperty(QStringLiteral("kdenlive:proxy")).isEmpty()) {
+        return;
+    }
+    int proxyWidth = 0;
+    if (m_doc->autoGenerateProxy(speed, &proxyWidth)) {
+        clip->setProducerProperty(QStringLiteral("kdenlive:proxywidth"), proxyWidth > 0 ? QString::number(proxyWidth) : QString());
+        m_doc->slotProxyCurrentItem(true, QList<ProjectClip *>() << clip);
+    }
+}
+
 void Bin::slotQueryRemoval(const QString &id, const QString &url, const QString &errorMessage)
 {
     if (m_invalidClipDialog) {
@@ -3720,7 +3796,12 @@ void Bin::slotAddClipExtraData(const QString &id, const QString &key, const QStr
     QMap<QString, QString> oldProps;
     oldProps.insert(key, oldValue);
     QMap<QString, QString> newProps;
-    newProps.insert(key, data);
+    if (key.startsWith(QLatin1String("kdenlive:clipanalysis."))) {
+        // Large analysis data goes to a side-car file, the project only keeps a reference
+        newProps.insert(key, m_analysisStore->store(data));
+    } else {
+        newProps.insert(key, data);
+    }
     EditClipCommand *command = new EditClipCommand(this, id, oldProps, newProps, true, groupCommand);
     if (!groupCommand) {
         m_doc->commandStack()->push(command);
@@ -3827,6 +3908,14 @@ void Bin::refreshProxySettings()
             if (t == Playlist) {
                 toProxy << clp;
                 continue;
+            } else if ((t == AV || t == Video) && KdenliveSettings::proxydecodeprobe()) {
+                // Use the measured decode speed, clips still being probed are handled when the result comes
+                int proxyWidth = 0;
+                if (m_doc->autoGenerateProxy(m_decodeProbe->decodeSpeed(clp->hash()), &proxyWidth)) {
+                    clp->setProducerProperty(QStringLiteral("kdenlive:proxywidth"), proxyWidth > 0 ? QString::number(proxyWidth) : QString());
+                    toProxy << clp;
+                }
+                continue;
             } else if ((t == AV || t == Video)
                        && m_doc->autoGenerateProxy(clp->getProducerIntProperty(QStringLiteral("meta.media.width")))) {
                 // Start proxy
@@ -3862,12 +3951,34 @@ QStringList Bin::getProxyHashList()
     return list;
 }
 
+QStringList Bin::getAnalysisReferences()
+{
+    QStringList list;
+    QList<ProjectClip *> clipList = m_rootFolder->childClips();
+    foreach (ProjectClip *clp, clipList) {
+        if (clp->controller() == nullptr) {
+            continue;
+        }
+        const QMap<QString, QString> data = clp->controller()->getPropertiesFromPrefix(QStringLiteral("kdenlive:clipanalysis."));
+        for (const QString &value : data) {
+            if (AnalysisStore::isReference(value)) {
+                list << value;
+            }
+        }
+    }
+    return list;
+}
+
 void Bin::slotSendAudioThumb(const QString &id)
 {
     ProjectClip *clip = m_rootFolder->clip(id);
     if (clip && clip->audioThumbCreated()) {
         m_monitor->prepareAudioThumb(clip->audioChannels(), clip->audioFrameCache);
     } else {
+        if (clip && clip->audioCacheReleased()) {
+            // Audio data was released to save memory, reload it from the thumbnail cache
+            clip->createAudioThumbs();
+        }
         QVariantList list;
         m_monitor->prepareAudioThumb(0, list);
     }
@@ -58,6 +58,9 @@ class AbstractProjectItem;
 class Monitor;
 class ProjectSortProxyModel;
 class JobManager;
+class ClipResourceManager;
+class DecodeProbe;
+class AnalysisStore;
 class ProjectFolderUp;
 class InvalidDialog;
 class BinItemDelegate;
@@ -186,6 +189,12 @@ public:
     /** @brief Returns the root folder, which is the parent for all items in the view */
     ProjectFolder *rootFolder();
 
+    /** @brief Returns the manager keeping clip thumbnail producers and audio thumbnails within memory limits */
+    ClipResourceManager *resourceManager();
+
+    /** @brief Returns the store holding clip analysis data */
+    AnalysisStore *analysisStore();
+
     /** @brief Create a clip item from its xml description  */
     void createClip(const QDomElement &xml);
 
@@ -302,8 +311,10 @@ public:
     void moveEffect(const QString &id, const QList<int> &oldPos, const QList<int> &newPos);
     /** @brief Add an effect to a bin clip. */
     void addEffect(const QString &id, QDomElement &effect);
-    /** @brief Update a bin clip effect. */
-    void updateEffect(const QString &id, QDomElement &effect, int ix, bool refreshStackWidget, bool updateClip);
+    /** @brief Returns a copy of the bin clip effect with index @param ix (kdenlive_ix) as currently applied. */
+    QDomElement currentEffect(const QString &id, int ix);
+    /** @brief Update a bin clip effect. If @param previous is the currently applied effect, only the changed properties are passed to MLT. */
+    void updateEffect(const QString &id, QDomElement &effect, int ix, bool refreshStackWidget, bool updateClip, const QDomElement &previous = QDomElement());
     void changeEffectState(const QString &id, const QList<int> &indexes, bool disable, bool refreshStack);
     /** @brief Edit an effect settings to a bin clip. */
     void editMasterEffect(ClipController *ctl);
@@ -317,6 +328,8 @@ public:
     void setBinEffectsDisabledStatus(bool disabled);
 
     void requestAudioThumbs(const QString &id, long duration);
+    /** @brief Create the audio thumbnails of clips @param ids before the other pending ones. */
+    void prioritizeAudioThumbs(const QStringList &ids);
     /** @brief Proxy status for the project changed, update. */
     void refreshProxySettings();
     /** @brief A clip is ready, update its info panel if displayed. */
@@ -343,6 +356,8 @@ public:
     void rebuildProxies();
     /** @brief Return a list of all clips hashes used in this project */
     QStringList getProxyHashList();
+    /** @brief Return the clip analysis properties referring to side-car files */
+    QStringList getAnalysisReferences();
     /** @brief Get info (id, name) of a folder (or the currently selected one)  */
     const QStringList getFolderInfo(const QModelIndex &selectedIx = QModelIndex());
     /** @brief Save a clip zone as MLT playlist */
@@ -356,6 +371,9 @@ private slots:
     /** @brief Show/hide date column */
     void slotShowDateColumn(bool show);
     void slotShowDescColumn(bool show);
+    void slotShowDecodeColumn(bool show);
+    /** @brief The decode speed of a clip's source was measured, decide if it needs a proxy. */
+    void slotDecodeProbeFinished(const QString &id, double speed);
 
     /** @brief Setup the bin view type (icon view, tree view, ...).
     * @param action The action whose data defines the view type or nullptr to keep default view */
@@ -489,6 +507,10 @@ private:
     BinItemDelegate *m_binTreeViewDelegate;
     ProjectSortProxyModel *m_proxyModel;
     JobManager *m_jobManager;
+    ClipResourceManager *m_resourceManager;
+    /** @brief Measures clip decode speeds to decide proxy creation */
+    DecodeProbe *m_decodeProbe;
+    AnalysisStore *m_analysisStore;
     QToolBar *m_toolbar;
     KdenliveDoc *m_doc;
     QLineEdit *m_searchLine;
@@ -499,6 +521,7 @@ private:
     QAction *m_inTimelineAction;
     QAction *m_showDate;
     QAction *m_showDesc;
+    QAction *m_showDecode;
     /** @brief Holds an available unique id for a clip to be created */
     int m_clipCounter;
     /** @brief Holds an available unique id for a folder to be created */
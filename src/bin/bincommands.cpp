@@ -158,8 +158,7 @@ UpdateBinEffectCommand::UpdateBinEffectCommand(Bin *bin, const QString &clipId,
     QUndoCommand(parent),
     m_bin(bin),
     m_clipId(clipId),
-    m_oldEffect(oldEffect),
-    m_newEffect(newEffect),
+    m_delta(oldEffect, newEffect),
     m_ix(ix),
     m_refreshStack(refreshStack),
     m_updateClip(updateClip)
@@ -167,14 +166,37 @@ UpdateBinEffectCommand::UpdateBinEffectCommand(Bin *bin, const QString &clipId,
     setText(i18n("Edit Bin Effect"));
 }
 // virtual
+int UpdateBinEffectCommand::id() const
+{
+    // Shares the undo stack with the timeline commands, keep the id unique
+    return 3;
+}
+// virtual
+bool UpdateBinEffectCommand::mergeWith(const QUndoCommand *other)
+{
+    if (other->id() != id()) {
+        return false;
+    }
+    const UpdateBinEffectCommand *command = static_cast<const UpdateBinEffectCommand *>(other);
+    if (m_clipId != command->m_clipId || m_ix != command->m_ix) {
+        return false;
+    }
+    m_delta.merge(command->m_delta);
+    return true;
+}
+// virtual
 void UpdateBinEffectCommand::undo()
 {
-    m_bin->updateEffect(m_clipId, m_oldEffect, m_ix, m_refreshStack, m_updateClip);
+    const QDomElement current = m_bin->currentEffect(m_clipId, m_ix);
+    QDomElement effect = m_delta.oldEffect(current);
+    m_bin->updateEffect(m_clipId, effect, m_ix, m_refreshStack, m_updateClip, current);
 }
 // virtual
 void UpdateBinEffectCommand::redo()
 {
-    m_bin->updateEffect(m_clipId, m_newEffect, m_ix, m_refreshStack, m_updateClip);
+    const QDomElement current = m_bin->currentEffect(m_clipId, m_ix);
+    QDomElement effect = m_delta.newEffect(current);
+    m_bin->updateEffect(m_clipId, effect, m_ix, m_refreshStack, m_updateClip, current);
     m_refreshStack = true;
 }
 
@@ -24,6 +24,8 @@
 #include <QDomElement>
 #include <QMap>
 
+#include "effectslist/effectdelta.h"
+
 class Bin;
 
 class AddBinFolderCommand : public QUndoCommand
@@ -107,13 +109,15 @@ class UpdateBinEffectCommand : public QUndoCommand
 {
 public:
     explicit UpdateBinEffectCommand(Bin *bin, const QString &clipId, QDomElement &oldEffect, QDomElement &newEffect, int ix, bool refreshStack, bool updateClip, QUndoCommand *parent = nullptr);
+    int id() const Q_DECL_OVERRIDE;
+    bool mergeWith(const QUndoCommand *other) Q_DECL_OVERRIDE;
     void undo() Q_DECL_OVERRIDE;
     void redo() Q_DECL_OVERRIDE;
 private:
     Bin *m_bin;
     QString m_clipId;
-    QDomElement m_oldEffect;
-    QDomElement m_newEffect;
+    /** @brief Only the changed attributes are kept, successive edits of the effect are merged in it */
+    EffectDelta m_delta;
     int m_ix;
     bool m_refreshStack;
     bool m_updateClip;
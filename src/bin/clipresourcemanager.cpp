@@ -0,0 +1,113 @@
+/*
+Copyright (C) 2018  Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "clipresourcemanager.h"
+#include "projectclip.h"
+#include "kdenlivesettings.h"
+#include "kdenlive_debug.h"
+
+#include <QMutexLocker>
+
+ClipResourceManager::ClipResourceManager(QObject *parent) : QObject(parent)
+    , m_audioCacheBytes(0)
+    , m_evictions(0)
+    , m_enforcePending(false)
+{
+}
+
+void ClipResourceManager::touch(ProjectClip *clip, ResourceType type, qint64 size)
+{
+    QMutexLocker lock(&m_mutex);
+    m_lru[type].removeOne(clip);
+    m_lru[type].append(clip);
+    if (type == AudioCache) {
+        m_audioCacheBytes += size - m_audioSizes.value(clip);
+        m_audioSizes.insert(clip, size);
+    }
+    if (!m_enforcePending && overBudget()) {
+        // Resources are released in the main thread, where clip jobs are started
+        m_enforcePending = true;
+        QMetaObject::invokeMethod(this, "enforceBudget", Qt::QueuedConnection);
+    }
+}
+
+void ClipResourceManager::remove(ProjectClip *clip, ResourceType type)
+{
+    QMutexLocker lock(&m_mutex);
+    m_lru[type].removeOne(clip);
+    if (type == AudioCache) {
+        m_audioCacheBytes -= m_audioSizes.take(clip);
+    }
+}
+
+void ClipResourceManager::removeClip(ProjectClip *clip)
+{
+    for (int i = 0; i < ResourceTypeCount; i++) {
+        remove(clip, (ResourceType) i);
+    }
+}
+
+bool ClipResourceManager::overBudget() const
+{
+    return m_lru[ThumbProducer].count() > KdenliveSettings::maxthumbproducers() || m_audioCacheBytes > (qint64) KdenliveSettings::audiocachebudget() * 1048576;
+}
+
+void ClipResourceManager::enforceBudget()
+{
+    m_mutex.lock();
+    m_enforcePending = false;
+    const QList<ProjectClip *> producers = m_lru[ThumbProducer];
+    const QList<ProjectClip *> audioCaches = m_lru[AudioCache];
+    m_mutex.unlock();
+    // Clips release their resources outside of our lock since they call remove()
+    int excess = producers.count() - KdenliveSettings::maxthumbproducers();
+    for (int i = 0; i < producers.count() && excess > 0; i++) {
+        if (producers.at(i)->releaseThumbProducer()) {
+            excess--;
+            m_evictions++;
+        }
+    }
+    qint64 budget = (qint64) KdenliveSettings::audiocachebudget() * 1048576;
+    for (int i = 0; i < audioCaches.count(); i++) {
+        m_mutex.lock();
+        bool over = m_audioCacheBytes > budget;
+        m_mutex.unlock();
+        if (!over) {
+            break;
+        }
+        if (audioCaches.at(i)->releaseAudioCache()) {
+            m_evictions++;
+        }
+    }
+    Stats current = stats();
+    qCDebug(KDENLIVE_LOG) << "Clip resources: " << current.thumbProducers << " thumbnail producers, " << current.audioCaches << " audio caches (" << current.audioCacheBytes / 1024 << "kB), " << current.evictions << " evictions";
+}
+
+ClipResourceManager::Stats ClipResourceManager::stats() const
+{
+    QMutexLocker lock(&m_mutex);
+    Stats result;
+    result.thumbProducers = m_lru[ThumbProducer].count();
+    result.audioCaches = m_lru[AudioCache].count();
+    result.audioCacheBytes = m_audioCacheBytes;
+    result.evictions = m_evictions;
+    return result;
+}
@@ -0,0 +1,90 @@
+/*
+Copyright (C) 2018  Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CLIPRESOURCEMANAGER_H
+#define CLIPRESOURCEMANAGER_H
+
+#include <QObject>
+#include <QMutex>
+#include <QList>
+#include <QHash>
+
+class ProjectClip;
+
+/**
+ * @class ClipResourceManager
+ * @brief Keeps the memory used by bin clips for thumbnail producers and audio thumbnails within a budget.
+ *
+ * Clips report each use of their thumbnail producer or audio cache. When the number
+ * of thumbnail producers or the audio cache size goes over the configured limit, the
+ * least recently used resources are released. Clips used in timeline keep their
+ * audio cache since timeline clips draw it directly, busy clips are skipped.
+ */
+
+class ClipResourceManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum ResourceType {
+        ThumbProducer = 0,
+        AudioCache,
+        ResourceTypeCount
+    };
+
+    struct Stats {
+        /** @brief Number of resident thumbnail producers */
+        int thumbProducers;
+        /** @brief Number of resident audio caches and their approximate size in bytes */
+        int audioCaches;
+        qint64 audioCacheBytes;
+        /** @brief Number of resources released since startup */
+        int evictions;
+    };
+
+    explicit ClipResourceManager(QObject *parent = nullptr);
+
+    /** @brief Mark a clip resource as recently used. Thread safe.
+     * @param size approximate memory used by the resource, only used for audio caches */
+    void touch(ProjectClip *clip, ResourceType type, qint64 size = 0);
+    /** @brief The clip released the resource itself. Thread safe. */
+    void remove(ProjectClip *clip, ResourceType type);
+    /** @brief The clip is deleted, forget all its resources. */
+    void removeClip(ProjectClip *clip);
+    /** @brief Returns a summary of resident resources. */
+    Stats stats() const;
+
+public slots:
+    /** @brief Release least recently used resources until usage is within limits. */
+    void enforceBudget();
+
+private:
+    mutable QMutex m_mutex;
+    /** @brief Clips using each resource type, least recently used first */
+    QList<ProjectClip *> m_lru[ResourceTypeCount];
+    QHash<ProjectClip *, qint64> m_audioSizes;
+    qint64 m_audioCacheBytes;
+    int m_evictions;
+    bool m_enforcePending;
+    bool overBudget() const;
+};
+
+#endif
@@ -0,0 +1,185 @@
+/*
+Copyright (C) 2018  Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "decodeprobe.h"
+#include "core.h"
+#include "mltcontroller/bincontroller.h"
+#include "kdenlivesettings.h"
+#include "kdenlive_debug.h"
+
+#include <KConfigGroup>
+#include <KSharedConfig>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QStandardPaths>
+#include <QtConcurrent>
+#include <mlt++/Mlt.h>
+
+#include <cmath>
+
+namespace {
+KSharedConfigPtr speedConfig()
+{
+    QDir dir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+    dir.mkpath(QStringLiteral("."));
+    return KSharedConfig::openConfig(dir.absoluteFilePath(QStringLiteral("decodespeed.rc")), KConfig::SimpleConfig);
+}
+}
+
+DecodeProbe::DecodeProbe(QObject *parent) : QObject(parent)
+    , m_workerActive(false)
+    , m_abort(0)
+{
+    KConfigGroup group(speedConfig(), "speed");
+    const QStringList hashes = group.keyList();
+    for (const QString &hash : hashes) {
+        m_speeds.insert(hash, group.readEntry(hash, 0.0));
+    }
+}
+
+DecodeProbe::~DecodeProbe()
+{
+    abort();
+}
+
+void DecodeProbe::abort()
+{
+    m_mutex.lock();
+    m_queue.clear();
+    m_abort.store(1);
+    m_mutex.unlock();
+    m_future.waitForFinished();
+    m_abort.store(0);
+}
+
+void DecodeProbe::probe(const QString &clipId, const QString &url, const QString &fileHash)
+{
+    if (fileHash.isEmpty()) {
+        return;
+    }
+    QMutexLocker lock(&m_mutex);
+    for (const ProbeRequest &request : m_queue) {
+        if (request.clipId == clipId) {
+            return;
+        }
+    }
+    m_queue.append({clipId, url, fileHash});
+    if (!m_workerActive) {
+        m_workerActive = true;
+        m_future = QtConcurrent::run(this, &DecodeProbe::processQueue);
+    }
+}
+
+double DecodeProbe::decodeSpeed(const QString &fileHash) const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_speeds.value(fileHash);
+}
+
+void DecodeProbe::processQueue()
+{
+    while (true) {
+        m_mutex.lock();
+        if (m_queue.isEmpty() || m_abort.load()) {
+            m_workerActive = false;
+            m_mutex.unlock();
+            break;
+        }
+        ProbeRequest request = m_queue.takeFirst();
+        double speed = m_speeds.value(request.hash);
+        m_mutex.unlock();
+        if (speed <= 0) {
+            speed = measure(request.url);
+            if (speed <= 0 || m_abort.load()) {
+                continue;
+            }
+            QMutexLocker lock(&m_mutex);
+            m_speeds.insert(request.hash, speed);
+            KSharedConfigPtr config = speedConfig();
+            KConfigGroup group(config, "speed");
+            group.writeEntry(request.hash, speed);
+            config->sync();
+        }
+        emit probeFinished(request.clipId, speed);
+    }
+}
+
+double DecodeProbe::measure(const QString &url) const
+{
+    Mlt::Profile *profile = pCore->binController()->profile();
+    Mlt::Producer prod(*profile, nullptr, url.toUtf8().constData());
+    if (!prod.is_valid() || prod.get_length() < 2) {
+        return 0;
+    }
+    // Only video decoding matters for playback fluidity here
+    prod.set("audio_index", -1);
+    // Skip intros and fades, which are often cheaper to decode
+    int start = prod.get_length() / 3;
+    int count = qMin(KdenliveSettings::decodeprobeframes(), prod.get_length() - start - 1);
+    prod.seek(start);
+    mlt_image_format format = mlt_image_yuv422;
+    int width = profile->width();
+    int height = profile->height();
+    // The first frame includes seeking and codec setup
+    Mlt::Frame *frame = prod.get_frame();
+    if (frame == nullptr) {
+        return 0;
+    }
+    frame->get_image(format, width, height);
+    delete frame;
+
+    QElapsedTimer timer;
+    timer.start();
+    int decoded = 0;
+    while (decoded < count && !m_abort.load()) {
+        frame = prod.get_frame();
+        if (frame == nullptr || !frame->is_valid()) {
+            delete frame;
+            break;
+        }
+        format = mlt_image_yuv422;
+        width = profile->width();
+        height = profile->height();
+        frame->get_image(format, width, height);
+        delete frame;
+        decoded++;
+    }
+    qint64 elapsed = timer.nsecsElapsed();
+    if (decoded < 2 || elapsed <= 0) {
+        qCDebug(KDENLIVE_LOG) << "Cannot measure decode speed for" << url;
+        return 0;
+    }
+    return decoded * 1e9 / elapsed;
+}
+
+//static
+int DecodeProbe::proxyWidth(double decodeSpeed, double fps, int proxyWidth)
+{
+    const double margin = KdenliveSettings::proxydecodemargin();
+    const double ratio = decodeSpeed / fps;
+    if (ratio >= margin) {
+        return 0;
+    }
+    // Decoding cost grows with the pixel count, so very slow sources get a smaller proxy to keep scrubbing fluid
+    double factor = qBound(0.5, std::sqrt(ratio / margin), 1.0);
+    return qMax(2, (int) (proxyWidth * factor / 2) * 2);
+}
@@ -0,0 +1,82 @@
+/*
+Copyright (C) 2018  Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DECODEPROBE_H
+#define DECODEPROBE_H
+
+#include <QObject>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QFuture>
+#include <QHash>
+#include <QList>
+
+/**
+ * @class DecodeProbe
+ * @brief Measures how fast the source of a clip can be decoded, to decide if it needs a proxy.
+ *
+ * A short sequence of frames is decoded at project resolution in a worker thread.
+ * The resulting speed, in frames per second, is cached per file hash so that a
+ * clip is only benchmarked once, even across projects.
+ */
+
+class DecodeProbe : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DecodeProbe(QObject *parent = nullptr);
+    ~DecodeProbe();
+
+    /** @brief Queue a decode benchmark for a clip, probeFinished is emitted when done. */
+    void probe(const QString &clipId, const QString &url, const QString &fileHash);
+    /** @brief Returns the cached decode speed for a file in frames per second, or 0 if it was not probed yet. */
+    double decodeSpeed(const QString &fileHash) const;
+    /** @brief Stop pending benchmarks. */
+    void abort();
+    /** @brief Returns the proxy width to use for a clip, or 0 if its source decodes fast enough to play without proxy.
+     *  @param decodeSpeed the measured decode speed in frames per second
+     *  @param fps the project frame rate
+     *  @param proxyWidth the width requested by the proxy encoding profile, used for sources that are just too slow */
+    static int proxyWidth(double decodeSpeed, double fps, int proxyWidth);
+
+private:
+    struct ProbeRequest {
+        QString clipId;
+        QString url;
+        QString hash;
+    };
+    mutable QMutex m_mutex;
+    QList<ProbeRequest> m_queue;
+    QHash<QString, double> m_speeds;
+    QFuture<void> m_future;
+    /** @brief True while the worker thread processes m_queue, protected by m_mutex. */
+    bool m_workerActive;
+    QAtomicInt m_abort;
+    void processQueue();
+    /** @brief Decode a few frames of @param url, returns the decode speed in frames per second or 0 on failure. */
+    double measure(const QString &url) const;
+
+signals:
+    void probeFinished(const QString &clipId, double speed);
+};
+
+#endif
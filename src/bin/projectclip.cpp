@@ -38,6 +38,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QFile>
 #include <QDir>
 #include "kdenlive_debug.h"
+#include "clipresourcemanager.h"
+#include "analysisstore.h"
 #include <QCryptographicHash>
 #include <QtConcurrent>
 #include <KLocalizedString>
@@ -48,6 +50,8 @@ ProjectClip::ProjectClip(const QString &id, const QIcon &thumb, ClipController *
     , m_abortAudioThumb(false)
     , m_controller(controller)
     , m_thumbsProducer(nullptr)
+    , m_audioCacheReleased(false)
+    , m_decodeSpeed(0)
 {
     m_clipStatus = StatusReady;
     m_name = m_controller->clipName();
@@ -75,6 +79,8 @@ ProjectClip::ProjectClip(const QDomElement &description, const QIcon &thumb, Pro
     , m_controller(nullptr)
     , m_type(Unknown)
     , m_thumbsProducer(nullptr)
+    , m_audioCacheReleased(false)
+    , m_decodeSpeed(0)
 {
     Q_ASSERT(description.hasAttribute(QStringLiteral("id")));
     m_clipStatus = StatusWaiting;
@@ -111,6 +117,8 @@ ProjectClip::~ProjectClip()
     m_requestedThumbs.clear();
     m_thumbMutex.unlock();
     m_thumbThread.waitForFinished();
+    m_intraThread.waitForFinished();
+    bin()->resourceManager()->removeClip(this);
     delete m_thumbsProducer;
     audioFrameCache.clear();
 }
@@ -143,6 +151,8 @@ void ProjectClip::updateAudioThumbnail(const QVariantList &audioLevels)
 {
     audioFrameCache = audioLevels;
     m_controller->audioThumbCreated = true;
+    m_audioCacheReleased = false;
+    bin()->resourceManager()->touch(this, ClipResourceManager::AudioCache, audioLevels.count() * (qint64) (sizeof(QVariant) + sizeof(void *)));
     bin()->emitRefreshAudioThumbs(m_id);
     emit gotAudioData();
 }
@@ -418,6 +428,7 @@ Mlt::Producer *ProjectClip::originalProducer()
 Mlt::Producer *ProjectClip::thumbProducer()
 {
     if (m_thumbsProducer) {
+        bin()->resourceManager()->touch(this, ClipResourceManager::ThumbProducer);
         return m_thumbsProducer;
     }
     if (!m_controller || m_controller->clipType() == Unknown) {
@@ -438,9 +449,51 @@ Mlt::Producer *ProjectClip::thumbProducer()
     } else {
         m_thumbsProducer = clip.clone();
     }
+    bin()->resourceManager()->touch(this, ClipResourceManager::ThumbProducer);
     return m_thumbsProducer;
 }
 
+bool ProjectClip::releaseThumbProducer()
+{
+    // Extraction threads are started from the main thread, so they cannot start while we release
+    if (m_thumbThread.isRunning() || m_intraThread.isRunning()) {
+        return false;
+    }
+    delete m_thumbsProducer;
+    m_thumbsProducer = nullptr;
+    bin()->resourceManager()->remove(this, ClipResourceManager::ThumbProducer);
+    return true;
+}
+
+bool ProjectClip::releaseAudioCache()
+{
+    // Timeline clips paint directly from our audio cache
+    if (!m_controller || refCount() > 0 || !m_controller->audioThumbCreated) {
+        return false;
+    }
+    audioFrameCache.clear();
+    m_controller->audioThumbCreated = false;
+    m_audioCacheReleased = true;
+    bin()->resourceManager()->remove(this, ClipResourceManager::AudioCache);
+    return true;
+}
+
+bool ProjectClip::audioCacheReleased() const
+{
+    return m_audioCacheReleased;
+}
+
+void ProjectClip::setDecodeSpeed(double speed)
+{
+    m_decodeSpeed = speed;
+    bin()->emitItemUpdated(this);
+}
+
+double ProjectClip::decodeSpeed() const
+{
+    return m_decodeSpeed;
+}
+
 ClipController *ProjectClip::controller()
 {
     return m_controller;
@@ -686,6 +739,10 @@ void ProjectClip::setProperties(const QMap<QString, QString> &properties, bool r
     }
     if (properties.contains(QStringLiteral("xmldata")) || !passProperties.isEmpty()) {
         reload = true;
+        if (properties.contains(QStringLiteral("xmldata")) && !getProducerProperty(QStringLiteral("_titleraster")).isEmpty()) {
+            // The producer plays a raster of the previous title content, rebuild it
+            refreshOnly = false;
+        }
     }
     if (refreshAnalysis) {
         emit refreshAnalysisPanel();
@@ -862,9 +919,9 @@ void ProjectClip::addEffect(const ProfileInfo &pInfo, QDomElement &effect)
     bin()->emitItemUpdated(this);
 }
 
-void ProjectClip::updateEffect(const ProfileInfo &pInfo, QDomElement &effect, int ix, bool refreshStack, bool updateClip)
+void ProjectClip::updateEffect(const ProfileInfo &pInfo, QDomElement &effect, int ix, bool refreshStack, bool updateClip, const QDomElement &previous)
 {
-    m_controller->updateEffect(pInfo, effect, ix, updateClip);
+    m_controller->updateEffect(pInfo, effect, ix, updateClip, previous);
     if (refreshStack) {
         bin()->updateMasterEffect(m_controller);
     }
@@ -884,6 +941,12 @@ QVariant ProjectClip::data(DataType type) const
     case AbstractProjectItem::IconOverlay:
         return m_controller != nullptr ? (m_controller->hasEffects() ? QVariant("kdenlive-track_has_effect") : QVariant()) : QVariant();
         break;
+    case AbstractProjectItem::DataDecodeSpeed:
+        return m_decodeSpeed > 0 ? QVariant(QString::number(m_decodeSpeed, 'f', 1) + QChar(0x00D7)) : QVariant();
+        break;
+    case AbstractProjectItem::DecodeSpeedValue:
+        return m_decodeSpeed;
+        break;
     default:
         break;
     }
@@ -926,6 +989,11 @@ void ProjectClip::doExtractIntra()
             // Cache already contains image
             continue;
         }
+        img = KThumb::getTitleFrame(prod, pos, fullWidth, 150);
+        if (!img.isNull()) {
+            emit thumbReady(pos, img);
+            continue;
+        }
         prod->seek(pos);
         Mlt::Frame *frame = prod->get_frame();
         frame->set("deinterlace_method", "onefield");
@@ -980,6 +1048,12 @@ void ProjectClip::doExtractImage()
             emit thumbReady(pos, img);
             continue;
         }
+        img = KThumb::getTitleFrame(prod, pos, frameWidth, 150);
+        if (!img.isNull()) {
+            // Title rasters are already cached on disk
+            emit thumbReady(pos, img);
+            continue;
+        }
         prod->seek(pos);
         Mlt::Frame *frame = prod->get_frame();
         frame->set("deinterlace_method", "onefield");
@@ -1012,6 +1086,7 @@ void ProjectClip::discardAudioThumb()
         QFile::remove(audioThumbPath);
     }
     audioFrameCache.clear();
+    bin()->resourceManager()->remove(this, ClipResourceManager::AudioCache);
     qCDebug(KDENLIVE_LOG) << "////////////////////  DISCARD AUIIO THUMBNS";
     m_controller->audioThumbCreated = false;
     m_abortAudioThumb = false;
@@ -1347,7 +1422,7 @@ QStringList ProjectClip::updatedAnalysisData(const QString &name, const QString
         return QStringList() << QString("kdenlive:clipanalysis." + name) << QString();
         //m_controller->resetProperty("kdenlive:clipanalysis." + name);
     } else {
-        QString current = m_controller->property("kdenlive:clipanalysis." + name);
+        QString current = bin()->analysisStore()->text(m_controller->property("kdenlive:clipanalysis." + name));
         if (!current.isEmpty()) {
             if (KMessageBox::questionYesNo(QApplication::activeWindow(), i18n("Clip already contains analysis data %1", name), QString(), KGuiItem(i18n("Merge")), KGuiItem(i18n("Add"))) == KMessageBox::Yes) {
                 // Merge data
@@ -1384,7 +1459,33 @@ QStringList ProjectClip::updatedAnalysisData(const QString &name, const QString
 
 QMap<QString, QString> ProjectClip::analysisData(bool withPrefix)
 {
-    return m_controller->getPropertiesFromPrefix(QStringLiteral("kdenlive:clipanalysis."), withPrefix);
+    QMap<QString, QString> data = m_controller->getPropertiesFromPrefix(QStringLiteral("kdenlive:clipanalysis."), withPrefix);
+    AnalysisStore *store = bin()->analysisStore();
+    QMutableMapIterator<QString, QString> i(data);
+    while (i.hasNext()) {
+        i.next();
+        if (AnalysisStore::isReference(i.value())) {
+            i.setValue(store->text(i.value()));
+        }
+    }
+    return data;
+}
+
+void ProjectClip::storeAnalysisData()
+{
+    if (!m_controller) {
+        return;
+    }
+    const QMap<QString, QString> data = m_controller->getPropertiesFromPrefix(QStringLiteral("kdenlive:clipanalysis."), true);
+    AnalysisStore *store = bin()->analysisStore();
+    QMapIterator<QString, QString> i(data);
+    while (i.hasNext()) {
+        i.next();
+        const QString value = store->store(i.value());
+        if (value != i.value()) {
+            setProducerProperty(i.key(), value);
+        }
+    }
 }
 
 const QString ProjectClip::geometryWithOffset(const QString &data, int offset)
@@ -136,6 +136,16 @@ public:
     /** @brief Returns this clip's producer. */
     Mlt::Producer *originalProducer();
     Mlt::Producer *thumbProducer();
+    /** @brief Delete the thumbnail producer to save memory, returns false if it is in use. */
+    bool releaseThumbProducer();
+    /** @brief Unload the audio thumbnail data to save memory, returns false if it is in use. */
+    bool releaseAudioCache();
+    /** @brief Returns true if the audio thumbnail data was unloaded by releaseAudioCache(). */
+    bool audioCacheReleased() const;
+    /** @brief Set the measured decode speed of the source, relative to the project frame rate. */
+    void setDecodeSpeed(double speed);
+    /** @brief Returns the decode speed relative to the project frame rate, 0 if it was not measured. */
+    double decodeSpeed() const;
 
     ClipController *controller();
 
@@ -193,7 +203,7 @@ public:
     void addMarkers(QList<CommentedTime> &markers);
     /** @brief Add an effect to bin clip. */
     void addEffect(const ProfileInfo &pInfo, QDomElement &effect);
-    void updateEffect(const ProfileInfo &pInfo, QDomElement &effect, int ix, bool refreshStack, bool updateClip);
+    void updateEffect(const ProfileInfo &pInfo, QDomElement &effect, int ix, bool refreshStack, bool updateClip, const QDomElement &previous = QDomElement());
     void removeEffect(int ix);
     /** @brief Create audio thumbnail for this clip. */
     void createAudioThumbs();
@@ -201,7 +211,10 @@ public:
     int audioChannels() const;
     /** @brief get data analysis value. */
     QStringList updatedAnalysisData(const QString &name, const QString &data, int offset);
+    /** @brief Returns the analysis data of this clip, loading side-car data if needed. */
     QMap<QString, QString> analysisData(bool withPrefix = false);
+    /** @brief Move large analysis data saved inline by older versions to the side-car store. */
+    void storeAnalysisData();
     /** @brief Abort running audio thumb process if any. */
     void abortAudioThumbs();
     /** @brief Returns the list of this clip's subclip's ids. */
@@ -238,6 +251,8 @@ private:
     QString m_temporaryUrl;
     ClipType m_type;
     Mlt::Producer *m_thumbsProducer;
+    bool m_audioCacheReleased;
+    double m_decodeSpeed;
     QMutex m_producerMutex;
     QMutex m_thumbMutex;
     QMutex m_intraThumbMutex;
@@ -32,11 +32,16 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QIcon>
 #include <QMimeData>
 
+#include <algorithm>
+
 ProjectItemModel::ProjectItemModel(Bin *bin) :
     QAbstractItemModel(bin)
     , m_bin(bin)
 {
     connect(m_bin, &Bin::itemUpdated, this, &ProjectItemModel::onItemUpdated);
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(0);
+    connect(&m_flushTimer, &QTimer::timeout, this, &ProjectItemModel::flushPendingChanges);
 }
 
 ProjectItemModel::~ProjectItemModel()
@@ -55,6 +60,9 @@ int ProjectItemModel::mapToColumn(int column) const
     case 2:
         return AbstractProjectItem::DataDescription;
         break;
+    case 3:
+        return AbstractProjectItem::DataDecodeSpeed;
+        break;
     default:
         return AbstractProjectItem::DataName;
     }
@@ -173,6 +181,9 @@ QVariant ProjectItemModel::headerData(int section, Qt::Orientation orientation,
         case 2:
             columnName = i18n("Description");
             break;
+        case 3:
+            columnName = i18n("Decode speed");
+            break;
         default:
             columnName = i18n("Unknown");
             break;
@@ -228,7 +239,11 @@ int ProjectItemModel::rowCount(const QModelIndex &parent) const
     } else {
         parentItem = m_bin->rootFolder();
     }
-
+    // Do not expose rows that were not yet notified to the views
+    QHash<AbstractProjectItem *, int>::const_iterator committed = m_committedRows.constFind(parentItem);
+    if (committed != m_committedRows.constEnd()) {
+        return committed.value();
+    }
     return parentItem->count();
 }
 
@@ -292,17 +307,68 @@ void ProjectItemModel::onAboutToAddItem(AbstractProjectItem *item)
     if (parentItem == nullptr) {
         return;
     }
-    QModelIndex parentIndex;
-    if (parentItem != m_bin->rootFolder()) {
-        parentIndex = createIndex(parentItem->index(), 0, parentItem);
+    // Items are always appended, remember how many rows the views know about
+    if (!m_committedRows.contains(parentItem)) {
+        m_committedRows.insert(parentItem, parentItem->count());
     }
-    beginInsertRows(parentIndex, parentItem->count(), parentItem->count());
 }
 
 void ProjectItemModel::onItemAdded(AbstractProjectItem *item)
 {
     Q_UNUSED(item)
-    endInsertRows();
+    m_flushTimer.start();
+}
+
+void ProjectItemModel::flushPendingChanges()
+{
+    m_flushTimer.stop();
+    if (!m_committedRows.isEmpty()) {
+        // Process parent folders before their children so that parent indexes are valid
+        QList<QPair<int, AbstractProjectItem *> > folders;
+        for (QHash<AbstractProjectItem *, int>::const_iterator i = m_committedRows.constBegin(); i != m_committedRows.constEnd(); ++i) {
+            int depth = 0;
+            for (AbstractProjectItem *p = i.key()->parent(); p; p = p->parent()) {
+                depth++;
+            }
+            folders << qMakePair(depth, i.key());
+        }
+        std::sort(folders.begin(), folders.end());
+        for (int i = 0; i < folders.count(); i++) {
+            AbstractProjectItem *parentItem = folders.at(i).second;
+            int first = m_committedRows.value(parentItem);
+            int last = parentItem->count() - 1;
+            QModelIndex parentIndex;
+            if (parentItem != m_bin->rootFolder()) {
+                parentIndex = createIndex(parentItem->index(), 0, parentItem);
+            }
+            if (last >= first) {
+                beginInsertRows(parentIndex, first, last);
+                m_committedRows.remove(parentItem);
+                endInsertRows();
+            } else {
+                m_committedRows.remove(parentItem);
+            }
+        }
+    }
+    if (!m_pendingUpdates.isEmpty()) {
+        const QSet<AbstractProjectItem *> updates = m_pendingUpdates;
+        m_pendingUpdates.clear();
+        foreach (AbstractProjectItem *item, updates) {
+            if (item->clipStatus() == AbstractProjectItem::StatusDeleting) {
+                continue;
+            }
+            AbstractProjectItem *parentItem = item->parent();
+            if (parentItem == nullptr) {
+                continue;
+            }
+            QModelIndex parentIndex;
+            if (parentItem != m_bin->rootFolder()) {
+                parentIndex = createIndex(parentItem->index(), 0, parentItem);
+            }
+            int row = item->index();
+            emit dataChanged(index(row, 0, parentIndex), index(row, columnCount(parentIndex) - 1, parentIndex));
+        }
+    }
 }
 
 void ProjectItemModel::onAboutToRemoveItem(AbstractProjectItem *item)
@@ -311,6 +377,8 @@ void ProjectItemModel::onAboutToRemoveItem(AbstractProjectItem *item)
     if (parentItem == nullptr) {
         return;
     }
+    // Views must know about all rows before one is removed
+    flushPendingChanges();
     QModelIndex parentIndex;
     if (parentItem != m_bin->rootFolder()) {
         parentIndex = createIndex(parentItem->index(), 0, parentItem);
@@ -330,13 +398,10 @@ void ProjectItemModel::onItemUpdated(AbstractProjectItem *item)
     if (!item || item->clipStatus() == AbstractProjectItem::StatusDeleting) {
         return;
     }
-    AbstractProjectItem *parentItem = item->parent();
-    if (parentItem == nullptr) {
+    if (item->parent() == nullptr) {
         return;
     }
-    QModelIndex parentIndex;
-    if (parentItem != m_bin->rootFolder()) {
-        parentIndex = createIndex(parentItem->index(), 0, parentItem);
-    }
-    emit dataChanged(parentIndex, parentIndex);
+    // Thumbnail, status and job updates are merged and notified once per event loop iteration
+    m_pendingUpdates.insert(item);
+    m_flushTimer.start();
 }
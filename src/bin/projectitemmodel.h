@@ -24,7 +24,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define PROJECTITEMMODEL_H
 
 #include <QAbstractItemModel>
+#include <QHash>
+#include <QSet>
 #include <QSize>
+#include <QTimer>
 
 class AbstractProjectItem;
 class Bin;
@@ -78,10 +81,18 @@ public:
 public slots:
     /** @brief An item in the list was modified, notify */
     void onItemUpdated(AbstractProjectItem *item);
+    /** @brief Notify views of the rows added and items modified since last event loop iteration */
+    void flushPendingChanges();
 
 private:
     /** @brief Reference to the project bin */
     Bin *m_bin;
+    /** @brief Row count known by the views for folders with pending row insertions
+     *  Items added to a folder are notified in one range on next event loop iteration */
+    QHash<AbstractProjectItem *, int> m_committedRows;
+    /** @brief Items modified since last notification */
+    QSet<AbstractProjectItem *> m_pendingUpdates;
+    QTimer m_flushTimer;
     /** @brief Return reference to column specific data */
     int mapToColumn(int column) const;
 
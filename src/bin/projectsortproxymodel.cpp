@@ -21,71 +21,261 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "projectsortproxymodel.h"
 #include "abstractprojectitem.h"
+#include "projectclip.h"
 
 #include <QItemSelectionModel>
+#include <QtConcurrent>
+
+// Above this number of bin items, searches run in a separate thread
+static const int s_threadedSearchThreshold = 5000;
 
 ProjectSortProxyModel::ProjectSortProxyModel(QObject *parent)
     : QSortFilterProxyModel(parent)
+    , m_indexValid(false)
 {
     m_collator.setNumericMode(true);
     m_selection = new QItemSelectionModel(this);
     connect(m_selection, &QItemSelectionModel::selectionChanged, this, &ProjectSortProxyModel::onCurrentRowChanged);
     setDynamicSortFilter(true);
+    m_refreshTimer.setSingleShot(true);
+    m_refreshTimer.setInterval(200);
+    connect(&m_refreshTimer, &QTimer::timeout, this, &ProjectSortProxyModel::slotUpdateSearch);
+    connect(&m_searchWatcher, &QFutureWatcherBase::finished, this, &ProjectSortProxyModel::slotSearchFinished);
+}
+
+void ProjectSortProxyModel::setSourceModel(QAbstractItemModel *model)
+{
+    if (sourceModel()) {
+        disconnect(sourceModel(), nullptr, this, nullptr);
+    }
+    QSortFilterProxyModel::setSourceModel(model);
+    slotInvalidateIndex();
+    if (model) {
+        connect(model, &QAbstractItemModel::modelReset, this, &ProjectSortProxyModel::slotInvalidateIndex);
+        connect(model, &QAbstractItemModel::dataChanged, this, &ProjectSortProxyModel::slotSourceDataChanged);
+        connect(model, &QAbstractItemModel::rowsInserted, this, &ProjectSortProxyModel::slotSourceRowsInserted);
+        connect(model, &QAbstractItemModel::rowsAboutToBeRemoved, this, &ProjectSortProxyModel::slotSourceRowsAboutToBeRemoved);
+    }
 }
 
 // Responsible for item sorting!
 bool ProjectSortProxyModel::filterAcceptsRow(int sourceRow,
         const QModelIndex &sourceParent) const
 {
-    if (filterAcceptsRowItself(sourceRow, sourceParent)) {
+    if (m_searchString.isEmpty()) {
         return true;
     }
-    //accept if any of the children is accepted on it's own merits
-    if (hasAcceptedChildren(sourceRow, sourceParent)) {
-        return true;
+    // Items matching the search and folders containing a match were collected by applyMatches
+    QModelIndex index0 = sourceModel()->index(sourceRow, 0, sourceParent);
+    if (!index0.isValid()) {
+        return false;
     }
-    return false;
+    return m_visible.contains(static_cast<AbstractProjectItem *>(index0.internalPointer()));
 }
 
-bool ProjectSortProxyModel::filterAcceptsRowItself(int sourceRow,
-        const QModelIndex &sourceParent) const
+//static
+QString ProjectSortProxyModel::normalizeSearchText(const QString &text)
 {
-    int cols = sourceModel()->columnCount();
-    for (int i = 0; i < cols; i++) {
-        QModelIndex index0 = sourceModel()->index(sourceRow, i, sourceParent);
-        if (!index0.isValid()) {
-            return false;
+    // Decompose accented characters so that searching "e" also finds "é"
+    const QString decomposed = text.normalized(QString::NormalizationForm_KD);
+    QString result;
+    result.reserve(decomposed.size());
+    for (const QChar &c : decomposed) {
+        if (!c.isMark()) {
+            result.append(c.toCaseFolded());
         }
-        if (sourceModel()->data(index0).toString().contains(m_searchString, Qt::CaseInsensitive)) {
-            return true;
+    }
+    return result;
+}
+
+//static
+QString ProjectSortProxyModel::itemSearchText(AbstractProjectItem *item)
+{
+    QStringList text;
+    text << item->name() << item->data(AbstractProjectItem::DataDate).toString() << item->description();
+    if (item->itemType() == AbstractProjectItem::ClipItem) {
+        const QList<CommentedTime> markers = static_cast<ProjectClip *>(item)->commentedSnapMarkers();
+        for (const CommentedTime &marker : markers) {
+            text << marker.comment();
         }
     }
-    return false;
+    return normalizeSearchText(text.join(QLatin1Char('\n')));
 }
 
-bool ProjectSortProxyModel::hasAcceptedChildren(int sourceRow, const QModelIndex &source_parent) const
+void ProjectSortProxyModel::buildIndex()
 {
-    QModelIndex item = sourceModel()->index(sourceRow, 0, source_parent);
-    if (!item.isValid()) {
-        return false;
+    m_searchIndex.clear();
+    QAbstractItemModel *model = sourceModel();
+    if (model) {
+        int max = model->rowCount();
+        for (int i = 0; i < max; i++) {
+            QModelIndex ix = model->index(i, 0);
+            if (ix.isValid()) {
+                indexItem(static_cast<AbstractProjectItem *>(ix.internalPointer()));
+            }
+        }
     }
+    m_indexValid = true;
+}
 
-    //check if there are children
-    int childCount = item.model()->rowCount(item);
-    if (childCount == 0) {
-        return false;
+void ProjectSortProxyModel::indexItem(AbstractProjectItem *item)
+{
+    m_searchIndex.insert(item, itemSearchText(item));
+    for (int i = 0; i < item->count(); i++) {
+        indexItem(item->at(i));
+    }
+}
+
+void ProjectSortProxyModel::unindexItem(AbstractProjectItem *item)
+{
+    m_searchIndex.remove(item);
+    m_matches.remove(item);
+    m_visible.remove(item);
+    for (int i = 0; i < item->count(); i++) {
+        unindexItem(item->at(i));
+    }
+}
+
+void ProjectSortProxyModel::slotInvalidateIndex()
+{
+    m_indexValid = false;
+    m_searchIndex.clear();
+    m_matches.clear();
+    m_visible.clear();
+    m_matchedString.clear();
+    if (!m_searchString.isEmpty()) {
+        m_refreshTimer.start();
+    }
+}
+
+void ProjectSortProxyModel::slotSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    if (!m_indexValid) {
+        return;
+    }
+    bool changed = false;
+    for (int i = topLeft.row(); i <= bottomRight.row(); i++) {
+        QModelIndex ix = sourceModel()->index(i, 0, topLeft.parent());
+        if (!ix.isValid()) {
+            continue;
+        }
+        AbstractProjectItem *item = static_cast<AbstractProjectItem *>(ix.internalPointer());
+        // Thumbnail and job progress updates do not change the searchable text
+        const QString text = itemSearchText(item);
+        if (m_searchIndex.value(item) != text) {
+            m_searchIndex.insert(item, text);
+            changed = true;
+        }
+    }
+    if (changed) {
+        m_matchedString.clear();
+        if (!m_searchString.isEmpty()) {
+            m_refreshTimer.start();
+        }
+    }
+}
+
+void ProjectSortProxyModel::slotSourceRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    if (!m_indexValid) {
+        return;
+    }
+    for (int i = first; i <= last; i++) {
+        QModelIndex ix = sourceModel()->index(i, 0, parent);
+        if (ix.isValid()) {
+            indexItem(static_cast<AbstractProjectItem *>(ix.internalPointer()));
+        }
+    }
+    m_matchedString.clear();
+    if (!m_searchString.isEmpty()) {
+        m_refreshTimer.start();
     }
+}
 
-    for (int i = 0; i < childCount; ++i) {
-        if (filterAcceptsRowItself(i, item)) {
-            return true;
+void ProjectSortProxyModel::slotSourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+    for (int i = first; i <= last; i++) {
+        QModelIndex ix = sourceModel()->index(i, 0, parent);
+        if (ix.isValid()) {
+            unindexItem(static_cast<AbstractProjectItem *>(ix.internalPointer()));
         }
-        //recursive call -> NOTICE that this is depth-first searching, you're probably better off with breadth first search...
-        if (hasAcceptedChildren(i, item)) {
-            return true;
+    }
+}
+
+//static
+QSet<AbstractProjectItem *> ProjectSortProxyModel::matchItems(const SearchIndex &index, const QString &searchString)
+{
+    QSet<AbstractProjectItem *> result;
+    for (SearchIndex::const_iterator i = index.constBegin(); i != index.constEnd(); ++i) {
+        if (i.value().contains(searchString)) {
+            result.insert(i.key());
         }
     }
-    return false;
+    return result;
+}
+
+void ProjectSortProxyModel::slotUpdateSearch()
+{
+    m_refreshTimer.stop();
+    if (m_searchString.isEmpty() || m_searchWatcher.isRunning()) {
+        // A running search will restart when finished if the query changed
+        return;
+    }
+    if (!m_indexValid) {
+        buildIndex();
+    }
+    SearchIndex candidates;
+    if (!m_matchedString.isEmpty() && m_searchString.contains(m_matchedString)) {
+        // User typed more characters, only previous matches can still match
+        for (AbstractProjectItem *item : m_matches) {
+            candidates.insert(item, m_searchIndex.value(item));
+        }
+    } else {
+        candidates = m_searchIndex;
+    }
+    if (candidates.count() < s_threadedSearchThreshold) {
+        applyMatches(matchItems(candidates, m_searchString), m_searchString);
+        return;
+    }
+    m_pendingString = m_searchString;
+    m_searchWatcher.setFuture(QtConcurrent::run(&ProjectSortProxyModel::matchItems, candidates, m_pendingString));
+}
+
+void ProjectSortProxyModel::slotSearchFinished()
+{
+    if (!m_searchString.isEmpty() && m_searchString.contains(m_pendingString)) {
+        // Result is still valid, or can be narrowed to the current query
+        QSet<AbstractProjectItem *> matches = m_searchWatcher.result();
+        // Drop items deleted while searching
+        QSet<AbstractProjectItem *>::iterator i = matches.begin();
+        while (i != matches.end()) {
+            if (m_searchIndex.contains(*i)) {
+                ++i;
+            } else {
+                i = matches.erase(i);
+            }
+        }
+        applyMatches(matches, m_pendingString);
+    }
+    if (m_searchString != m_pendingString) {
+        slotUpdateSearch();
+    }
+}
+
+void ProjectSortProxyModel::applyMatches(const QSet<AbstractProjectItem *> &matches, const QString &searchString)
+{
+    m_matches = matches;
+    m_matchedString = searchString;
+    // Folders containing a match must be displayed too
+    m_visible = matches;
+    for (AbstractProjectItem *item : matches) {
+        AbstractProjectItem *parent = item->parent();
+        while (parent && !m_visible.contains(parent)) {
+            m_visible.insert(parent);
+            parent = parent->parent();
+        }
+    }
+    invalidateFilter();
 }
 
 bool ProjectSortProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
@@ -101,6 +291,9 @@ bool ProjectSortProxyModel::lessThan(const QModelIndex &left, const QModelIndex
             // Subclips, sort by start position
             leftData = sourceModel()->data(left, AbstractProjectItem::DataDuration);
             rightData = sourceModel()->data(right, AbstractProjectItem::DataDuration);
+        } else if (left.column() == 3) {
+            // Decode speed, compare the values instead of their text
+            return sourceModel()->data(left, AbstractProjectItem::DecodeSpeedValue).toDouble() < sourceModel()->data(right, AbstractProjectItem::DecodeSpeedValue).toDouble();
         } else {
             leftData = sourceModel()->data(left, Qt::DisplayRole);
             rightData = sourceModel()->data(right, Qt::DisplayRole);
@@ -123,8 +316,18 @@ QItemSelectionModel *ProjectSortProxyModel::selectionModel()
 
 void ProjectSortProxyModel::slotSetSearchString(const QString &str)
 {
-    m_searchString = str;
-    invalidateFilter();
+    m_searchString = normalizeSearchText(str);
+    if (m_searchString.isEmpty()) {
+        // Markers are not monitored, make sure the next search starts from fresh data
+        m_indexValid = false;
+        m_searchIndex.clear();
+        m_matches.clear();
+        m_visible.clear();
+        m_matchedString.clear();
+        invalidateFilter();
+        return;
+    }
+    slotUpdateSearch();
 }
 
 void ProjectSortProxyModel::onCurrentRowChanged(const QItemSelection &current, const QItemSelection &previous)
@@ -143,8 +346,3 @@ void ProjectSortProxyModel::onCurrentRowChanged(const QItemSelection &current, c
     }
 }
 
-void ProjectSortProxyModel::slotDataChanged(const QModelIndex &ix1, const QModelIndex &ix2)
-{
-    emit dataChanged(ix1, ix2);
-}
-
@@ -24,8 +24,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QSortFilterProxyModel>
 #include <QCollator>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
 
 class QItemSelectionModel;
+class AbstractProjectItem;
 
 /**
  * @class ProjectSortProxyModel
@@ -39,12 +44,13 @@ class ProjectSortProxyModel : public QSortFilterProxyModel
 public:
     explicit ProjectSortProxyModel(QObject *parent = nullptr);
     QItemSelectionModel *selectionModel();
+    void setSourceModel(QAbstractItemModel *sourceModel) Q_DECL_OVERRIDE;
+    /** @brief Returns the searchable form of a string (case folded, without accents) */
+    static QString normalizeSearchText(const QString &text);
 
 public slots:
     /** @brief Set search string that will filter the view */
     void slotSetSearchString(const QString &str);
-    /** @brief Relay datachanged signal from view's model  */
-    void slotDataChanged(const QModelIndex &ix1, const QModelIndex &ix2);
 
 private slots:
     /** @brief Called when a row change is detected by selection model */
@@ -56,13 +62,43 @@ protected:
     bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const Q_DECL_OVERRIDE;
     /** @brief Reimplemented to show folders first  */
     bool lessThan(const QModelIndex &left, const QModelIndex &right) const Q_DECL_OVERRIDE;
-    bool filterAcceptsRowItself(int source_row, const QModelIndex &source_parent) const;
-    bool hasAcceptedChildren(int source_row, const QModelIndex &source_parent) const;
+
+private slots:
+    /** @brief Source model was reset, drop the search index */
+    void slotInvalidateIndex();
+    /** @brief Keep the search index in sync with source model changes */
+    void slotSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+    void slotSourceRowsInserted(const QModelIndex &parent, int first, int last);
+    void slotSourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    /** @brief Run the search for m_searchString, in a thread if the bin is large */
+    void slotUpdateSearch();
+    void slotSearchFinished();
 
 private:
+    typedef QHash<AbstractProjectItem *, QString> SearchIndex;
     QItemSelectionModel *m_selection;
+    /** @brief The normalized search string */
     QString m_searchString;
     QCollator m_collator;
+    /** @brief Normalized searchable text (name, date, description, markers) of each bin item */
+    SearchIndex m_searchIndex;
+    bool m_indexValid;
+    /** @brief Items matching current search, used to narrow the next search when user types more */
+    QSet<AbstractProjectItem *> m_matches;
+    /** @brief Matching items and their parent folders, which the filter accepts */
+    QSet<AbstractProjectItem *> m_visible;
+    /** @brief Query that produced m_matches */
+    QString m_matchedString;
+    QFutureWatcher<QSet<AbstractProjectItem *> > m_searchWatcher;
+    /** @brief Query being processed by the search thread */
+    QString m_pendingString;
+    QTimer m_refreshTimer;
+    void buildIndex();
+    void indexItem(AbstractProjectItem *item);
+    void unindexItem(AbstractProjectItem *item);
+    static QString itemSearchText(AbstractProjectItem *item);
+    void applyMatches(const QSet<AbstractProjectItem *> &matches, const QString &searchString);
+    static QSet<AbstractProjectItem *> matchItems(const SearchIndex &index, const QString &searchString);
 
 signals:
     /** @brief Emitted when the row changes, used to prepare action for selected item  */
@@ -41,12 +41,12 @@ static void consumer_gl_frame_show(mlt_consumer, MltDeviceCapture *self, mlt_fra
 MltDeviceCapture::MltDeviceCapture(QString profile, /*VideoSurface *surface, */QWidget *parent) :
     AbstractRender(Kdenlive::RecordMonitor, parent),
     doCapture(0),
-    processingImage(false),
     m_mltConsumer(nullptr),
     m_mltProducer(nullptr),
     m_mltProfile(nullptr),
     m_showFrameEvent(nullptr),
     m_droppedFrames(0),
+    m_reportedPreviewDropped(0),
     m_livePreview(KdenliveSettings::enable_recording_preview())
 {
     analyseAudio = KdenliveSettings::monitor_audio();
@@ -54,7 +54,6 @@ MltDeviceCapture::MltDeviceCapture(QString profile, /*VideoSurface *surface, */Q
         profile = KdenliveSettings::current_profile();
     }
     buildConsumer(profile);
-    connect(this, &MltDeviceCapture::unblockPreview, this, &MltDeviceCapture::slotPreparePreview);
     m_droppedFramesTimer.setSingleShot(false);
     m_droppedFramesTimer.setInterval(1000);
     connect(&m_droppedFramesTimer, &QTimer::timeout, this, &MltDeviceCapture::slotCheckDroppedFrames);
@@ -94,7 +93,8 @@ bool MltDeviceCapture::buildConsumer(const QString &profileName)
     // OpenGL monitor
     m_mltConsumer = new Mlt::Consumer(*m_mltProfile, KdenliveSettings::audiobackend().toUtf8().constData());
     m_mltConsumer->set("preview_off", 1);
-    m_mltConsumer->set("preview_format", mlt_image_rgb24);
+    // Conversion to rgb is done by us, see convertFrame()
+    m_mltConsumer->set("preview_format", mlt_image_yuv422);
     m_showFrameEvent = m_mltConsumer->listen("consumer-frame-show", this, (mlt_listener) consumer_gl_frame_show);
     //m_mltConsumer->set("resize", 1);
     //m_mltConsumer->set("terminate_on_pause", 1);
@@ -192,42 +192,44 @@ void MltDeviceCapture::stop()
     m_mltConsumer = nullptr;
 }
 
-void MltDeviceCapture::emitFrameUpdated(Mlt::Frame &frame)
+QImage *MltDeviceCapture::convertFrame(Mlt::Frame &frame)
 {
-    /*
-    //TEST: is it better to convert the frame in a thread outside of MLT??
-    if (processingImage) return;
-    mlt_image_format format = (mlt_image_format) frame.get_int("format"); //mlt_image_rgb24;
-    int width = frame.get_int("width");
-    int height = frame.get_int("height");
-    unsigned char *buffer = (unsigned char *) frame.get_data("image");
-    if (format == mlt_image_yuv422) {
-        QtConcurrent::run(this, &MltDeviceCapture::uyvy2rgb, (unsigned char *) buffer, width, height);
-    }
-    */
-
-    mlt_image_format format = mlt_image_rgb24;
+    mlt_image_format format = mlt_image_yuv422;
     int width = 0;
     int height = 0;
     const uchar *image = frame.get_image(format, width, height);
-    QImage qimage(width, height, QImage::Format_RGB888);
-    //QImage qimage(width, height, QImage::Format_ARGB32_Premultiplied);
-    memcpy(qimage.bits(), image, width * height * 3);
-    emit frameUpdated(qimage);
+    if (!image || format != mlt_image_yuv422 || width <= 0 || height <= 0) {
+        return nullptr;
+    }
+    QImage *buffer = m_previewPool.acquire(width, height);
+    if (!buffer) {
+        // All buffers are still queued for the monitor or scopes, skip this frame rather than piling up copies
+        m_previewDropped.fetchAndAddRelaxed(1);
+        return nullptr;
+    }
+    YuvConvert::toRgb32(image, width * 2, buffer->bits(), buffer->bytesPerLine(), width, height, YuvConvert::YUYV);
+    return buffer;
+}
+
+void MltDeviceCapture::emitFrameUpdated(Mlt::Frame &frame)
+{
+    QImage *image = convertFrame(frame);
+    if (image) {
+        emit frameUpdated(*image);
+    }
 }
 
 void MltDeviceCapture::showFrame(Mlt::Frame &frame)
 {
-    mlt_image_format format = mlt_image_rgb24;
-    int width = 0;
-    int height = 0;
-    const uchar *image = frame.get_image(format, width, height);
-    QImage qimage(width, height, QImage::Format_RGB888);
-    memcpy(qimage.scanLine(0), image, static_cast<size_t>(width * height * 3));
-    emit showImageSignal(qimage);
+    QImage *image = convertFrame(frame);
+    if (!image) {
+        return;
+    }
+    emit showImageSignal(*image);
 
     if (sendFrameForAnalysis && frame.get_frame()->convert_image) {
-        emit frameUpdated(qimage.rgbSwapped());
+        // RGB32 already has the QRgb layout expected by the scopes, no swapped copy needed
+        emit frameUpdated(*image);
     }
 }
 
@@ -298,6 +300,11 @@ void MltDeviceCapture::slotCheckDroppedFrames()
             emit droppedFrames(m_droppedFrames);
         }
     }
+    int previewDropped = m_previewDropped.load();
+    if (previewDropped > m_reportedPreviewDropped) {
+        qCDebug(KDENLIVE_LOG) << "Capture preview is behind, dropped" << previewDropped - m_reportedPreviewDropped << "frames";
+        m_reportedPreviewDropped = previewDropped;
+    }
 }
 
 void MltDeviceCapture::saveFrame(Mlt::Frame &frame)
@@ -316,6 +323,7 @@ void MltDeviceCapture::saveFrame(Mlt::Frame &frame)
     trackProducer.set("hide", 0);
 
     qimage.save(m_capturePath);
+    emit frameCaptured(m_capturePath, qimage);
     emit frameSaved(m_capturePath);
     m_capturePath.clear();
 }
@@ -345,6 +353,8 @@ bool MltDeviceCapture::slotStartCapture(const QString &params, const QString &pa
     m_livePreview = livePreview;
     m_frameCount = 0;
     m_droppedFrames = 0;
+    m_previewDropped.store(0);
+    m_reportedPreviewDropped = 0;
     delete m_mltProfile;
     char *tmp = qstrdup(m_activeProfile.toUtf8().constData());
     m_mltProfile = new Mlt::Profile(tmp);
@@ -398,7 +408,7 @@ bool MltDeviceCapture::slotStartCapture(const QString &params, const QString &pa
         // OpenGL monitor
         previewProps->set("mlt_service", KdenliveSettings::audiobackend().toUtf8().constData());
         previewProps->set("preview_off", 1);
-        previewProps->set("preview_format", mlt_image_rgb24);
+        previewProps->set("preview_format", mlt_image_yuv422);
         previewProps->set("terminate_on_pause", 0);
         m_showFrameEvent = m_mltConsumer->listen("consumer-frame-show", this, (mlt_listener) consumer_gl_frame_show);
         //m_mltConsumer->set("resize", 1);
@@ -595,96 +605,3 @@ void MltDeviceCapture::mirror(bool activate)
     }
     mlt_service_unlock(service.get_service());
 }
-
-void MltDeviceCapture::uyvy2rgb(unsigned char *yuv_buffer, int width, int height)
-{
-    processingImage = true;
-    QImage image(width, height, QImage::Format_RGB888);
-    unsigned char *rgb_buffer = image.bits();
-
-    int rgb_ptr = 0, y_ptr = 0;
-    int len = width * height / 2;
-
-    for (int t = 0; t < len; ++t) {
-        int Y = yuv_buffer[y_ptr];
-        int U = yuv_buffer[y_ptr + 1];
-        int Y2 = yuv_buffer[y_ptr + 2];
-        int V = yuv_buffer[y_ptr + 3];
-        y_ptr += 4;
-
-        int r = ((298 * (Y - 16)               + 409 * (V - 128) + 128) >> 8);
-
-        int g = ((298 * (Y - 16) - 100 * (U - 128) - 208 * (V - 128) + 128) >> 8);
-
-        int b = ((298 * (Y - 16) + 516 * (U - 128)               + 128) >> 8);
-
-        if (r > 255) {
-            r = 255;
-        }
-        if (g > 255) {
-            g = 255;
-        }
-        if (b > 255) {
-            b = 255;
-        }
-
-        if (r < 0) {
-            r = 0;
-        }
-        if (g < 0) {
-            g = 0;
-        }
-        if (b < 0) {
-            b = 0;
-        }
-
-        rgb_buffer[rgb_ptr] = static_cast<uchar>(r);
-        rgb_buffer[rgb_ptr + 1] = static_cast<uchar>(g);
-        rgb_buffer[rgb_ptr + 2] = static_cast<uchar>(b);
-        rgb_ptr += 3;
-
-        r = ((298 * (Y2 - 16)               + 409 * (V - 128) + 128) >> 8);
-        g = ((298 * (Y2 - 16) - 100 * (U - 128) - 208 * (V - 128) + 128) >> 8);
-        b = ((298 * (Y2 - 16) + 516 * (U - 128)               + 128) >> 8);
-
-        if (r > 255) {
-            r = 255;
-        }
-        if (g > 255) {
-            g = 255;
-        }
-        if (b > 255) {
-            b = 255;
-        }
-
-        if (r < 0) {
-            r = 0;
-        }
-        if (g < 0) {
-            g = 0;
-        }
-        if (b < 0) {
-            b = 0;
-        }
-
-        rgb_buffer[rgb_ptr] = static_cast<uchar>(r);
-        rgb_buffer[rgb_ptr + 1] = static_cast<uchar>(g);
-        rgb_buffer[rgb_ptr + 2] = static_cast<uchar>(b);
-        rgb_ptr += 3;
-    }
-    //emit imageReady(image);
-    //m_captureDisplayWidget->setImage(image);
-    emit unblockPreview();
-    //processingImage = false;
-}
-
-void MltDeviceCapture::slotPreparePreview()
-{
-    QTimer::singleShot(1000, this, &MltDeviceCapture::slotAllowPreview);
-}
-
-void MltDeviceCapture::slotAllowPreview()
-{
-    processingImage = false;
-}
-
@@ -29,9 +29,11 @@
 #include "gentime.h"
 #include "definitions.h"
 #include "monitor/abstractmonitor.h"
+#include "utils/yuvconvert.h"
 
 #include <QTimer>
 #include <QMutex>
+#include <QAtomicInt>
 
 // include after QTimer to have C++ phtreads defined
 #include <mlt/framework/mlt_types.h>
@@ -91,9 +93,6 @@ Q_OBJECT public:
     /** @brief This will add a horizontal flip effect, easier to work when filming yourself. */
     void mirror(bool activate);
 
-    /** @brief True if we are processing an image (yuv > rgb) when recording. */
-    bool processingImage;
-
     void pause();
 
 private:
@@ -108,7 +107,13 @@ private:
     /** @brief Count captured frames, used to display only one in ten images while capturing. */
     int m_frameCount;
 
-    void uyvy2rgb(unsigned char *yuv_buffer, int width, int height);
+    /** @brief Reused preview images, a full pool means the monitor is behind and new frames are dropped. */
+    ImagePool m_previewPool;
+    /** @brief Number of preview frames dropped since the capture started. */
+    QAtomicInt m_previewDropped;
+    int m_reportedPreviewDropped;
+    /** @brief Convert the frame's yuv422 image into a pooled RGB32 image, returns nullptr if the frame has to be dropped. */
+    QImage *convertFrame(Mlt::Frame &frame);
 
     QString m_capturePath;
 
@@ -122,8 +127,6 @@ private:
     bool buildConsumer(const QString &profileName = QString());
 
 private slots:
-    void slotPreparePreview();
-    void slotAllowPreview();
     /** @brief When capturing, check every second for dropped frames. */
     void slotCheckDroppedFrames();
 
@@ -135,10 +138,10 @@ signals:
 
     void frameSaved(const QString &);
 
-    void droppedFrames(int);
+    /** @brief A frame was captured and saved to @param path, @param image holds its content. */
+    void frameCaptured(const QString &path, const QImage &image);
 
-    void unblockPreview();
-    void imageReady(const QImage &);
+    void droppedFrames(int);
 
 public slots:
     /** @brief Stops the consumer. */
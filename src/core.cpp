@@ -13,6 +13,7 @@ the Free Software Foundation, either version 3 of the License, or
 #include "kdenlivesettings.h"
 #include "project/projectmanager.h"
 #include "monitor/monitormanager.h"
+#include "monitor/scopes/audioanalysis.h"
 #include "mltconnection.h"
 #include "profiles/profilerepository.hpp"
 #include "mltcontroller/bincontroller.h"
@@ -63,6 +64,7 @@ void Core::build(const QString &MltPath, const QUrl &Url, const QString &clipsTo
     m_self->initLocale();
 
     qRegisterMetaType<audioShortVector> ("audioShortVector");
+    qRegisterMetaType<AudioAnalysisResult> ("AudioAnalysisResult");
     qRegisterMetaType< QVector<double> > ("QVector<double>");
     qRegisterMetaType<MessageType> ("MessageType");
     qRegisterMetaType<stringMap> ("stringMap");
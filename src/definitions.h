@@ -29,6 +29,8 @@
 #include <QHash>
 
 const int MAXCLIPDURATION = 15000;
+/** @brief Version of the project document written by Kdenlive. */
+const double DOCUMENTVERSION = 0.96;
 
 namespace Kdenlive
 {
@@ -174,7 +176,9 @@ enum CacheType {
     CachePreview = 2,
     CacheProxy = 3,
     CacheAudio = 4,
-    CacheThumbs = 5
+    CacheThumbs = 5,
+    CacheTitles = 6,
+    CacheAnalysis = 7
 };
 
 enum TrimMode {
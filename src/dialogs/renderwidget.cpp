@@ -33,6 +33,7 @@
 #include <KNotification>
 #include <KMimeTypeTrader>
 #include <KIO/DesktopExecParser>
+#include <KIO/Global>
 #include <knotifications_version.h>
 #include <kio_version.h>
 
@@ -53,6 +54,8 @@
 #include <QDir>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QLocalServer>
+#include <QLocalSocket>
 
 
 #ifdef KF5_USE_PURPOSE
@@ -60,6 +63,7 @@
 #include <PurposeWidgets/Menu>
 #endif
 
+#include <algorithm>
 #include <locale>
 #ifdef Q_OS_MAC
 #include <xlocale.h>
@@ -81,11 +85,8 @@ enum {GroupRole = Qt::UserRole,
       ErrorRole
      };
 
-// Render job roles
-const int ParametersRole = Qt::UserRole + 1;
-const int TimeRole = Qt::UserRole + 2;
-const int ProgressRole = Qt::UserRole + 3;
-const int ExtraInfoRole = Qt::UserRole + 5;
+// Number of speed samples kept for the throughput graph
+const int ThroughputSamples = 120;
 
 const int DirectRenderType = QTreeWidgetItem::Type;
 const int ScriptRenderType = QTreeWidgetItem::UserType;
@@ -114,6 +115,17 @@ static QStringList acodecsList;
 static QStringList vcodecsList;
 static QStringList supportedFormats;
 
+// Split consumer arguments like "vcodec=libx264 pix_fmt=yuv420p" into name / value pairs
+static QMap<QString, QString> consumerParameters(const QString &args)
+{
+    QMap<QString, QString> params;
+    const QStringList list = args.simplified().split(QLatin1Char(' '), QString::SkipEmptyParts);
+    for (const QString &param : list) {
+        params.insert(param.section(QLatin1Char('='), 0, 0), param.section(QLatin1Char('='), 1));
+    }
+    return params;
+}
+
 RenderJobItem::RenderJobItem(QTreeWidget *parent, const QStringList &strings, int type)
     : QTreeWidgetItem(parent, strings, type),
       m_status(-1)
@@ -171,7 +183,9 @@ RenderWidget::RenderWidget(const QString &projectfolder, bool enableProxy, const
     QDialog(parent),
     m_projectFolder(projectfolder),
     m_profile(profile),
-    m_blockProcessing(false)
+    m_blockProcessing(false),
+    m_progressServer(nullptr),
+    m_renderProgress(100)
 {
     m_view.setupUi(this);
     int size = style()->pixelMetric(QStyle::PM_SmallIconSize);
@@ -228,6 +242,17 @@ RenderWidget::RenderWidget(const QString &projectfolder, bool enableProxy, const
     m_view.checkTwoPass->setEnabled(false);
     m_view.proxy_render->setHidden(!enableProxy);
     connect(m_view.proxy_render, &QCheckBox::toggled, this, &RenderWidget::slotProxyWarn);
+    // Render jobs send their statistics through this socket
+    m_progressServer = new QLocalServer(this);
+    const QString serverName = QStringLiteral("kdenlive-render-%1").arg(QCoreApplication::applicationPid());
+    QLocalServer::removeServer(serverName);
+    if (m_progressServer->listen(serverName)) {
+        connect(m_progressServer, &QLocalServer::newConnection, this, &RenderWidget::slotNewProgressConnection);
+    } else {
+        qCDebug(KDENLIVE_LOG) << "Cannot listen for render progress: " << m_progressServer->errorString();
+    }
+    m_view.use_preview->setChecked(KdenliveSettings::renderusepreview());
+    connect(m_view.use_preview, &QCheckBox::toggled, this, &RenderWidget::slotUpdatePreviewReuse);
     KColorScheme scheme(palette().currentColorGroup(), KColorScheme::Window, KSharedConfig::openConfig(KdenliveSettings::colortheme()));
     QColor bg = scheme.background(KColorScheme::NegativeBackground).color();
     m_view.errorBox->setStyleSheet(QStringLiteral("QGroupBox { background-color: rgb(%1, %2, %3); border-radius: 5px;}; ").arg(bg.red()).arg(bg.green()).arg(bg.blue()));
@@ -248,6 +273,12 @@ RenderWidget::RenderWidget(const QString &projectfolder, bool enableProxy, const
     m_view.encoder_threads->setMaximum(QThread::idealThreadCount());
     m_view.encoder_threads->setValue(KdenliveSettings::encodethreads());
     connect(m_view.encoder_threads, SIGNAL(valueChanged(int)), this, SLOT(slotUpdateEncodeThreads(int)));
+    m_view.render_segments->setMaximum(QThread::idealThreadCount());
+    m_view.render_segments->setValue(KdenliveSettings::rendersegments());
+    connect(m_view.render_segments, SIGNAL(valueChanged(int)), this, SLOT(slotUpdateRenderSegments(int)));
+    m_view.render_jobs->setMaximum(QThread::idealThreadCount());
+    m_view.render_jobs->setValue(KdenliveSettings::maxrenderjobs());
+    connect(m_view.render_jobs, SIGNAL(valueChanged(int)), this, SLOT(slotUpdateRenderJobs(int)));
 
     m_view.rescale_keep->setChecked(KdenliveSettings::rescalekeepratio());
     connect(m_view.rescale_width, SIGNAL(valueChanged(int)), this, SLOT(slotUpdateRescaleWidth(int)));
@@ -1156,6 +1187,12 @@ void RenderWidget::slotExport(bool scriptExport, int zoneIn, int zoneOut,
 #endif
             render_process_args << QStringLiteral("-locale:%1").arg(currentLocale);
         }
+        if (KdenliveSettings::rendersegments() > 1) {
+            render_process_args << QStringLiteral("-segments:%1").arg(KdenliveSettings::rendersegments());
+            if (!KdenliveSettings::ffmpegpath().isEmpty()) {
+                render_process_args << QStringLiteral("-ffmpeg:%1").arg(KdenliveSettings::ffmpegpath());
+            }
+        }
 
         QString renderArgs = m_view.advanced_params->toPlainText().simplified();
         QString std = renderArgs;
@@ -1286,7 +1323,8 @@ void RenderWidget::slotExport(bool scriptExport, int zoneIn, int zoneOut,
         }
 
         // Set the thread counts
-        if (!renderArgs.contains(QStringLiteral("threads="))) {
+        bool balanceThreads = !renderArgs.contains(QStringLiteral("threads="));
+        if (balanceThreads) {
             renderArgs.append(QStringLiteral(" threads=%1").arg(KdenliveSettings::encodethreads()));
         }
         renderArgs.append(QStringLiteral(" real_time=-%1").arg(KdenliveSettings::mltthreads()));
@@ -1464,6 +1502,12 @@ void RenderWidget::slotExport(bool scriptExport, int zoneIn, int zoneOut,
         }*/
 
         renderItem->setData(1, ParametersRole, render_process_args);
+        renderItem->setData(1, SceneRole, playlistPaths.at(stemIdx));
+        renderItem->setData(1, ThreadsRole, balanceThreads);
+        // Rough estimate of the frames buffered by melt and the encoder, for all segments of the job
+        qint64 frameSize = (qint64) width * height * 4;
+        int memory = 64 + (int) (frameSize * (25 + 2 * KdenliveSettings::mltthreads()) / 1048576);
+        renderItem->setData(1, MemoryRole, memory * qMax(1, KdenliveSettings::rendersegments()));
         if (exportAudio == false) {
             renderItem->setData(1, ExtraInfoRole, i18n("Video without audio track"));
         } else {
@@ -1486,37 +1530,80 @@ void RenderWidget::checkRenderStatus()
 
     RenderJobItem *item = static_cast<RenderJobItem *>(m_view.running_jobs->topLevelItem(0));
 
-    // Make sure no other rendering is running
+    // Count the running jobs and the resources they use
+    int runningJobs = 0;
+    int usedMemory = 0;
+    QStringList activeScenes;
+    QList<RenderJobItem *> waitingJobs;
     while (item) {
-        if (item->status() == RUNNINGJOB) {
-            return;
+        if (item->status() == RUNNINGJOB || item->status() == STARTINGJOB) {
+            runningJobs++;
+            usedMemory += item->data(1, MemoryRole).toInt();
+            activeScenes << item->data(1, SceneRole).toString();
+        } else if (item->status() == WAITINGJOB) {
+            waitingJobs << item;
         }
         item = static_cast<RenderJobItem *>(m_view.running_jobs->itemBelow(item));
     }
-    item = static_cast<RenderJobItem *>(m_view.running_jobs->topLevelItem(0));
-    bool waitingJob = false;
+    if (runningJobs == 0 && waitingJobs.isEmpty() && m_view.shutdown->isChecked()) {
+        emit shutdown();
+        return;
+    }
 
-    // Find first waiting job
-    while (item) {
-        if (item->status() == WAITINGJOB) {
-            item->setData(1, TimeRole, QDateTime::currentDateTime());
-            waitingJob = true;
-            startRendering(item);
-            item->setStatus(STARTINGJOB);
+    // Fan out jobs rendering a scene that is already in use before starting new scenes
+    std::stable_partition(waitingJobs.begin(), waitingJobs.end(), [&activeScenes](RenderJobItem *job) {
+        const QString scene = job->data(1, SceneRole).toString();
+        return !scene.isEmpty() && activeScenes.contains(scene);
+    });
+    int maxJobs = qMax(1, KdenliveSettings::maxrenderjobs());
+    int memoryBudget = KdenliveSettings::rendermemorybudget();
+    int concurrentJobs = qMin(maxJobs, runningJobs + waitingJobs.count());
+    for (RenderJobItem *job : waitingJobs) {
+        if (runningJobs >= maxJobs) {
             break;
         }
-        item = static_cast<RenderJobItem *>(m_view.running_jobs->itemBelow(item));
-    }
-    if (waitingJob == false && m_view.shutdown->isChecked()) {
-        emit shutdown();
+        int memory = job->data(1, MemoryRole).toInt();
+        // A single job is always allowed, even if it does not fit in the budget
+        if (memoryBudget > 0 && runningJobs > 0 && usedMemory + memory > memoryBudget) {
+            break;
+        }
+        job->setData(1, TimeRole, QDateTime::currentDateTime());
+        startRendering(job, concurrentJobs);
+        if (job->status() == FAILEDJOB) {
+            continue;
+        }
+        job->setStatus(STARTINGJOB);
+        runningJobs++;
+        usedMemory += memory;
     }
 }
 
-void RenderWidget::startRendering(RenderJobItem *item)
+void RenderWidget::startRendering(RenderJobItem *item, int concurrentJobs)
 {
     if (item->type() == DirectRenderType) {
+        QStringList args = item->data(1, ParametersRole).toStringList();
+        if (concurrentJobs > 1 && item->data(1, ThreadsRole).toBool()) {
+            // Share the cores between the jobs running at the same time
+            int threads = qMax(1, qMin(KdenliveSettings::encodethreads(), QThread::idealThreadCount() / concurrentJobs));
+            args.replaceInStrings(QRegExp(QStringLiteral("^threads=\\d+$")), QStringLiteral("threads=%1").arg(threads));
+        }
+        const QString scene = item->data(1, SceneRole).toString();
+        if (!scene.isEmpty() && args.contains(QStringLiteral("-erase"))) {
+            // Another job still needs this scene file, erase it ourselves when all are done
+            RenderJobItem *other = static_cast<RenderJobItem *>(m_view.running_jobs->topLevelItem(0));
+            while (other) {
+                if (other != item && other->data(1, SceneRole).toString() == scene && other->status() <= RUNNINGJOB) {
+                    args.removeAll(QStringLiteral("-erase"));
+                    if (!m_sharedScenes.contains(scene)) {
+                        m_sharedScenes << scene;
+                    }
+                    break;
+                }
+                other = static_cast<RenderJobItem *>(m_view.running_jobs->itemBelow(other));
+            }
+        }
         // Normal render process
-        if (QProcess::startDetached(m_renderer, item->data(1, ParametersRole).toStringList()) == false) {
+        if (QProcess::startDetached(m_renderer, args) == false) {
             item->setStatus(FAILEDJOB);
         } else {
             KNotification::event(QStringLiteral("RenderStarted"), i18n("Rendering <i>%1</i> started", item->text(1)), QPixmap(), this);
@@ -2211,6 +2298,7 @@ void RenderWidget::setRenderJob(const QString &dest, int progress)
     if (progress == 0) {
         item->setIcon(0, KoIconUtils::themedIcon(QStringLiteral("media-record")));
         item->setData(1, TimeRole, QDateTime::currentDateTime());
+        item->setData(1, ThroughputRole, QVariant());
         slotCheckJob();
     } else {
         QDateTime startTime = item->data(1, TimeRole).toDateTime();
@@ -2225,6 +2313,95 @@ void RenderWidget::setRenderJob(const QString &dest, int progress)
         QString t = i18n("Remaining time %1", est);
         item->setData(1, Qt::UserRole, t);
     }
+    updateRenderProgress();
+}
+
+void RenderWidget::updateRenderProgress()
+{
+    // Several jobs may run at once, report their average progress
+    int running = 0;
+    int progress = 0;
+    for (int i = 0; i < m_view.running_jobs->topLevelItemCount(); ++i) {
+        RenderJobItem *item = static_cast<RenderJobItem *>(m_view.running_jobs->topLevelItem(i));
+        if (item->status() == RUNNINGJOB) {
+            progress += item->data(1, ProgressRole).toInt();
+            running++;
+        }
+    }
+    progress = running > 0 ? progress / running : 100;
+    if (progress != m_renderProgress) {
+        m_renderProgress = progress;
+        emit renderProgress(progress);
+    }
+}
+
+void RenderWidget::slotNewProgressConnection()
+{
+    while (m_progressServer->hasPendingConnections()) {
+        QLocalSocket *socket = m_progressServer->nextPendingConnection();
+        connect(socket, &QLocalSocket::readyRead, this, &RenderWidget::slotReadRenderProgress);
+        connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+    }
+}
+
+void RenderWidget::slotReadRenderProgress()
+{
+    QLocalSocket *socket = qobject_cast<QLocalSocket *>(sender());
+    if (!socket) {
+        return;
+    }
+    while (socket->canReadLine()) {
+        const QString line = QString::fromUtf8(socket->readLine()).trimmed();
+        if (line.startsWith(QLatin1String("job="))) {
+            socket->setProperty("job", line.mid(4));
+            continue;
+        }
+        QMap<QString, QString> values;
+        const QStringList pairs = line.split(QLatin1Char(' '), QString::SkipEmptyParts);
+        for (const QString &pair : pairs) {
+            values.insert(pair.section(QLatin1Char('='), 0, 0), pair.section(QLatin1Char('='), 1));
+        }
+        setRenderStats(socket->property("job").toString(), values);
+    }
+}
+
+void RenderWidget::setRenderStats(const QString &dest, const QMap<QString, QString> &values)
+{
+    QList<QTreeWidgetItem *> existing = m_view.running_jobs->findItems(dest, Qt::MatchExactly, 1);
+    if (existing.isEmpty()) {
+        return;
+    }
+    RenderJobItem *item = static_cast<RenderJobItem *>(existing.at(0));
+    int total = values.value(QStringLiteral("total")).toInt();
+    if (total <= 0 || item->status() > RUNNINGJOB) {
+        return;
+    }
+    int frame = values.value(QStringLiteral("frame")).toInt();
+    int pass = qMax(1, values.value(QStringLiteral("pass")).toInt());
+    int passes = qMax(pass, values.value(QStringLiteral("passes")).toInt());
+    double fps = values.value(QStringLiteral("fps")).toDouble();
+    int progress = (int) (((qint64) (pass - 1) * total + frame) * 100 / ((qint64) passes * total));
+    item->setStatus(RUNNINGJOB);
+    if (progress != item->data(1, ProgressRole).toInt()) {
+        item->setData(1, ProgressRole, progress);
+        updateRenderProgress();
+    }
+    QVariantList samples = item->data(1, ThroughputRole).toList();
+    samples << fps;
+    while (samples.count() > ThroughputSamples) {
+        samples.removeFirst();
+    }
+    item->setData(1, ThroughputRole, samples);
+    QString text;
+    int eta = values.value(QStringLiteral("eta")).toInt();
+    if (eta >= 0) {
+        QTime when = QTime(0, 0, 0, 0).addSecs(eta % 86400);
+        QString est = (eta >= 86400) ? i18np("%1 day ", "%1 days ", eta / 86400) : QString();
+        est.append(when.toString(QStringLiteral("hh:mm:ss")));
+        text = i18n("Remaining time %1", est) + QStringLiteral(", ");
+    }
+    text.append(i18n("%1 fps, %2", QString::number(fps, 'f', 1), KIO::convertSize(values.value(QStringLiteral("bytes")).toULongLong())));
+    item->setData(1, Qt::UserRole, text);
 }
 
 void RenderWidget::setRenderStatus(const QString &dest, int status, const QString &error)
@@ -2239,6 +2416,7 @@ void RenderWidget::setRenderStatus(const QString &dest, int status, const QStrin
     if (!item) {
         return;
     }
+    const QString scene = item->data(1, SceneRole).toString();
     if (status == -1) {
         // Job finished successfully
         item->setStatus(FINISHEDJOB);
@@ -2287,8 +2465,26 @@ void RenderWidget::setRenderStatus(const QString &dest, int status, const QStrin
     } else {
         delete item;
     }
+    releaseScene(scene);
     slotCheckJob();
     checkRenderStatus();
+    updateRenderProgress();
+}
+
+void RenderWidget::releaseScene(const QString &scene)
+{
+    if (!m_sharedScenes.contains(scene)) {
+        return;
+    }
+    RenderJobItem *item = static_cast<RenderJobItem *>(m_view.running_jobs->topLevelItem(0));
+    while (item) {
+        if (item->data(1, SceneRole).toString() == scene && item->status() <= RUNNINGJOB) {
+            return;
+        }
+        item = static_cast<RenderJobItem *>(m_view.running_jobs->itemBelow(item));
+    }
+    m_sharedScenes.removeAll(scene);
+    QFile::remove(scene);
 }
 
 void RenderWidget::slotAbortCurrentJob()
@@ -2298,7 +2494,9 @@ void RenderWidget::slotAbortCurrentJob()
         if (current->status() == RUNNINGJOB) {
             emit abortProcess(current->text(1));
         } else {
+            const QString scene = current->data(1, SceneRole).toString();
             delete current;
+            releaseScene(scene);
             slotCheckJob();
             checkRenderStatus();
         }
@@ -2686,6 +2884,22 @@ void RenderWidget::slotUpdateEncodeThreads(int val)
     KdenliveSettings::setEncodethreads(val);
 }
 
+void RenderWidget::slotUpdateRenderSegments(int val)
+{
+    KdenliveSettings::setRendersegments(val);
+}
+
+void RenderWidget::slotUpdatePreviewReuse(bool reuse)
+{
+    KdenliveSettings::setRenderusepreview(reuse);
+}
+
+void RenderWidget::slotUpdateRenderJobs(int val)
+{
+    KdenliveSettings::setMaxrenderjobs(val);
+    checkRenderStatus();
+}
+
 void RenderWidget::slotUpdateRescaleWidth(int val)
 {
     KdenliveSettings::setDefaultrescalewidth(val);
@@ -2750,6 +2964,41 @@ bool RenderWidget::proxyRendering()
     return m_view.proxy_render->isChecked();
 }
 
+bool RenderWidget::reusePreviewChunks(const QString &previewParams, bool previewUsesProxy) const
+{
+    // Preview chunks are rendered at the project frame size, do not reuse them for a rescaled output
+    if (!m_view.use_preview->isChecked() || (m_view.rescale->isChecked() && m_view.rescale->isEnabled())) {
+        return false;
+    }
+    // Chunks rendered from proxy clips can only be used in a proxy render
+    if (previewUsesProxy && !m_view.proxy_render->isChecked()) {
+        return false;
+    }
+    const QString renderArgs = m_view.advanced_params->toPlainText();
+    if (renderArgs.contains(QLatin1String("%dv_standard"))) {
+        // DV output forces its own frame size and rate
+        return false;
+    }
+    const QMap<QString, QString> output = consumerParameters(renderArgs);
+    const QMap<QString, QString> preview = consumerParameters(previewParams);
+    // The preview is rendered with the project profile, the output must not force another one
+    std::unique_ptr<ProfileModel> &profile = ProfileRepository::get()->getProfile(m_profile);
+    if (output.contains(QStringLiteral("mlt_profile"))) {
+        std::unique_ptr<ProfileModel> &forced = ProfileRepository::get()->getProfile(output.value(QStringLiteral("mlt_profile")));
+        if (forced->width() != profile->width() || forced->height() != profile->height() || qAbs(forced->fps() - profile->fps()) > 0.01) {
+            return false;
+        }
+    }
+    if (output.contains(QStringLiteral("r")) && qAbs(output.value(QStringLiteral("r")).toDouble() - profile->fps()) > 0.01) {
+        return false;
+    }
+    if (output.contains(QStringLiteral("s")) && output.value(QStringLiteral("s")) != QStringLiteral("%1x%2").arg(profile->width()).arg(profile->height())) {
+        return false;
+    }
+    // Mixing chunks of another codec or pixel format would change the picture in the reused zones
+    return output.value(QStringLiteral("vcodec")) == preview.value(QStringLiteral("vcodec")) && output.value(QStringLiteral("pix_fmt")) == preview.value(QStringLiteral("pix_fmt"));
+}
+
 bool RenderWidget::isStemAudioExportEnabled() const
 {
     return (m_view.stemAudioExport->isChecked()
@@ -35,6 +35,17 @@ namespace Purpose { class Menu; }
 
 class QDomElement;
 class QKeyEvent;
+class QLocalServer;
+
+// Render job roles
+const int ParametersRole = Qt::UserRole + 1;
+const int TimeRole = Qt::UserRole + 2;
+const int ProgressRole = Qt::UserRole + 3;
+const int ExtraInfoRole = Qt::UserRole + 5;
+const int SceneRole = Qt::UserRole + 6;
+const int MemoryRole = Qt::UserRole + 7;
+const int ThreadsRole = Qt::UserRole + 8;
+const int ThroughputRole = Qt::UserRole + 9;
 
 // RenderViewDelegate is used to draw the progress bars.
 class RenderViewDelegate : public QStyledItemDelegate
@@ -66,7 +77,7 @@ public:
             font.setBold(false);
             painter->setFont(font);
             painter->drawText(r1, Qt::AlignLeft | Qt::AlignTop, index.data(Qt::UserRole).toString());
-            int progress = index.data(Qt::UserRole + 3).toInt();
+            int progress = index.data(ProgressRole).toInt();
             if (progress > 0 && progress < 100) {
                 // draw progress bar
                 QColor color = option.palette.alternateBase().color();
@@ -83,10 +94,29 @@ public:
                 painter->setPen(Qt::NoPen);
                 bgrect.setWidth((width - 2) * progress / 100);
                 painter->drawRect(bgrect);
+                // draw encoding speed graph
+                const QVariantList samples = index.data(ThroughputRole).toList();
+                int graphWidth = r1.right() - (r1.left() + width + 12);
+                if (samples.count() > 1 && graphWidth > 20) {
+                    double maxFps = 0;
+                    for (const QVariant &sample : samples) {
+                        maxFps = qMax(maxFps, sample.toDouble());
+                    }
+                    if (maxFps > 0) {
+                        QRect graph(r1.left() + width + 10, option.rect.bottom() - 16 - textMargin, qMin(graphWidth, 120), 16);
+                        QPolygonF line;
+                        for (int i = 0; i < samples.count(); ++i) {
+                            line << QPointF(graph.left() + (double) i * graph.width() / (samples.count() - 1), graph.bottom() - samples.at(i).toDouble() / maxFps * graph.height());
+                        }
+                        painter->setPen(QPen(fgColor));
+                        painter->setBrush(Qt::NoBrush);
+                        painter->drawPolyline(line);
+                    }
+                }
             } else {
                 r1.setBottom(opt.rect.bottom());
                 r1.setTop(r1.bottom() - mid);
-                painter->drawText(r1, Qt::AlignLeft | Qt::AlignBottom, index.data(Qt::UserRole + 5).toString());
+                painter->drawText(r1, Qt::AlignLeft | Qt::AlignBottom, index.data(ExtraInfoRole).toString());
             }
             painter->restore();
         } else {
@@ -122,6 +152,8 @@ public:
     void setProfile(const QString &profile);
     void setRenderJob(const QString &dest, int progress = 0);
     void setRenderStatus(const QString &dest, int status, const QString &error);
+    /** @brief Update a job with the statistics received from its render process. */
+    void setRenderStats(const QString &dest, const QMap<QString, QString> &values);
     void setDocumentPath(const QString &path);
     void reloadProfiles();
     void setRenderProfile(const QMap<QString, QString> &props);
@@ -136,6 +168,10 @@ public:
     void updateProxyConfig(bool enable);
     /** @brief Should we render using proxy clips. */
     bool proxyRendering();
+    /** @brief Returns true if timeline preview chunks can replace the rendering of their zone.
+     *  @param previewParams the encoding parameters of the timeline preview
+     *  @param previewUsesProxy true if the preview was rendered from proxy clips */
+    bool reusePreviewChunks(const QString &previewParams, bool previewUsesProxy) const;
     /** @brief Returns true if the stem audio export checkbox is set. */
     bool isStemAudioExportEnabled() const;
     enum RenderError {
@@ -187,6 +223,11 @@ private slots:
     void slotStartCurrentJob();
     void slotCopyToFavorites();
     void slotUpdateEncodeThreads(int);
+    void slotUpdateRenderSegments(int);
+    void slotUpdateRenderJobs(int);
+    void slotUpdatePreviewReuse(bool reuse);
+    void slotNewProgressConnection();
+    void slotReadRenderProgress();
     void slotUpdateRescaleHeight(int);
     void slotUpdateRescaleWidth(int);
     void slotSwitchAspectRatio();
@@ -212,6 +253,12 @@ private:
     RenderViewDelegate *m_scriptsDelegate;
     RenderViewDelegate *m_jobsDelegate;
     bool m_blockProcessing;
+    /** @brief Local server receiving render statistics from kdenlive_render. */
+    QLocalServer *m_progressServer;
+    /** @brief Last progress sent through renderProgress. */
+    int m_renderProgress;
+    /** @brief Scene files used by several jobs, erased when the last of them is done. */
+    QStringList m_sharedScenes;
     QString m_renderer;
     KMessageWidget *m_infoMessage;
     KMessageWidget *m_jobInfoMessage;
@@ -227,7 +274,12 @@ private:
     QUrl filenameWithExtension(QUrl url, const QString &extension);
     /** @brief Check if a job needs to be started. */
     void checkRenderStatus();
-    void startRendering(RenderJobItem *item);
+    /** @brief Start a job, sharing the encoding threads between concurrentJobs jobs. */
+    void startRendering(RenderJobItem *item, int concurrentJobs = 1);
+    /** @brief Erase a scene file shared by several jobs once none of them needs it anymore. */
+    void releaseScene(const QString &scene);
+    /** @brief Send the combined progress of the running jobs. */
+    void updateRenderProgress();
     bool saveProfile(QDomElement newprofile);
     /** @brief Create a rendering profile from MLT preset. */
     QTreeWidgetItem *loadFromMltPreset(const QString &groupName, const QString &path, const QString &profileName);
@@ -241,6 +293,8 @@ signals:
     void selectedRenderProfile(const QMap<QString, QString> &renderProps);
     void prepareRenderingData(bool scriptExport, bool zoneOnly, const QString &chapterFile, const QString scriptPath);
     void shutdown();
+    /** @brief Average progress of the running jobs, 100 when none is running. */
+    void renderProgress(int progress);
 };
 
 #endif
@@ -25,6 +25,7 @@
 #include "mainwindow.h"
 #include "core.h"
 #include "mltcontroller/bincontroller.h"
+#include "utils/tracer.h"
 
 #include "kdenlive_debug.h"
 #include <KMessageBox>
@@ -34,6 +35,9 @@
 #include <QColor>
 #include <QString>
 #include <QDir>
+#include <QHash>
+#include <QSet>
+#include <QVector>
 
 #include <mlt++/Mlt.h>
 
@@ -44,13 +48,42 @@
 
 #include <QStandardPaths>
 
+namespace {
+/** @brief Walk the document once and group its elements by tag name, in document order. */
+QHash<QString, QVector<QDomElement> > indexElements(const QDomDocument &doc)
+{
+    QHash<QString, QVector<QDomElement> > index;
+    QDomElement elem = doc.documentElement();
+    while (!elem.isNull()) {
+        index[elem.tagName()].append(elem);
+        QDomElement next = elem.firstChildElement();
+        QDomNode node = elem;
+        while (next.isNull() && !node.isNull()) {
+            next = node.nextSiblingElement();
+            node = node.parentNode();
+        }
+        elem = next;
+    }
+    return index;
+}
+}
+
 DocumentValidator::DocumentValidator(const QDomDocument &doc, const QUrl &documentUrl):
     m_doc(doc),
     m_url(documentUrl),
-    m_modified(false)
+    m_modified(false),
+    m_version(-1),
+    m_currentVersion(-1),
+    m_convertTitles(false),
+    m_collectMessages(false)
 {}
 
 bool DocumentValidator::validate(const double currentVersion)
+{
+    return prepare(currentVersion) && upgradeDocument(false);
+}
+
+bool DocumentValidator::prepare(const double currentVersion)
 {
     QDomElement mlt = m_doc.firstChildElement(QStringLiteral("mlt"));
     // At least the root element must be there
@@ -214,8 +247,20 @@ bool DocumentValidator::validate(const double currentVersion)
             }
         }
     }
+    m_version = version;
+    m_currentVersion = currentVersion;
+    if (version > 0.7 && version <= 0.83 && hasPointSizeTitles()) {
+        m_convertTitles = KMessageBox::warningYesNo(QApplication::activeWindow(), i18n("Some of your text clips were saved with size in points, which means different sizes on different displays. Do you want to convert them to pixel size, making them portable? It is recommended you do this on the computer they were first created on, or you could have to adjust their size."), i18n("Update Text Clips")) == KMessageBox::Yes;
+    }
+    return true;
+}
+
+bool DocumentValidator::upgradeDocument(bool collectMessages)
+{
+    m_collectMessages = collectMessages;
+    m_messages.clear();
     // Upgrade the document to the latest version
-    if (!upgrade(version, currentVersion)) {
+    if (!upgrade(m_version, m_currentVersion)) {
         return false;
     }
 
@@ -338,6 +383,43 @@ bool DocumentValidator::validate(const double currentVersion)
     */
 }
 
+QStringList DocumentValidator::messages() const
+{
+    return m_messages;
+}
+
+void DocumentValidator::showError(const QString &message, const QString &caption)
+{
+    if (m_collectMessages) {
+        m_messages << message;
+    } else {
+        KMessageBox::sorry(QApplication::activeWindow(), message, caption);
+    }
+}
+
+bool DocumentValidator::hasPointSizeTitles() const
+{
+    const QDomNodeList kproducerNodes = m_doc.elementsByTagName(QStringLiteral("kdenlive_producer"));
+    for (int i = 0; i < kproducerNodes.count(); ++i) {
+        QDomElement kproducer = kproducerNodes.at(i).toElement();
+        if (kproducer.attribute(QStringLiteral("type")).toInt() != Text || !kproducer.attribute(QStringLiteral("xmldata")).contains(QStringLiteral("font-size"))) {
+            continue;
+        }
+        QDomDocument data;
+        data.setContent(kproducer.attribute(QStringLiteral("xmldata")));
+        QDomNodeList items = data.firstChild().childNodes();
+        for (int j = 0; j < items.count(); ++j) {
+            if (items.at(j).attributes().namedItem(QStringLiteral("type")).nodeValue() == QLatin1String("QGraphicsTextItem")) {
+                QDomNamedNodeMap textProperties = items.at(j).namedItem(QStringLiteral("content")).attributes();
+                if (textProperties.namedItem(QStringLiteral("font-pixel-size")).isNull() && !textProperties.namedItem(QStringLiteral("font-size")).isNull()) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
 bool DocumentValidator::upgrade(double version, const double currentVersion)
 {
     qCDebug(KDENLIVE_LOG) << "Opening a document with version " << version << " / " << currentVersion;
@@ -346,28 +428,32 @@ bool DocumentValidator::upgrade(double version, const double currentVersion)
     if (qAbs(version - currentVersion) < 0.001) {
         return true;
     }
+    KDENLIVE_TRACE("load", "upgrade project");
 
     // The document is too new
     if (version > currentVersion) {
         //qCDebug(KDENLIVE_LOG) << "Unable to open document with version " << version;
-        KMessageBox::sorry(QApplication::activeWindow(), i18n("This project type is unsupported (version %1) and can't be loaded.\nPlease consider upgrading your Kdenlive version.", version), i18n("Unable to open project"));
+        showError(i18n("This project type is unsupported (version %1) and can't be loaded.\nPlease consider upgrading your Kdenlive version.", version), i18n("Unable to open project"));
         return false;
     }
 
     // Unsupported document versions
     if (version <= 0.7) {
         //qCDebug(KDENLIVE_LOG) << "Unable to open document with version " << version;
-        KMessageBox::sorry(QApplication::activeWindow(), i18n("This project type is unsupported (version %1) and can't be loaded.", version), i18n("Unable to open project"));
+        showError(i18n("This project type is unsupported (version %1) and can't be loaded.", version), i18n("Unable to open project"));
         return false;
     }
 
+    // Upgrade steps work on elements collected in one pass over the document. Live QDomNodeLists
+    // are rebuilt after each structural change, which made large legacy projects quadratic.
+    // The index is refreshed after the steps that move or remove elements.
+    QHash<QString, QVector<QDomElement> > elements = indexElements(m_doc);
+
     // <kdenlivedoc />
-    QDomNode infoXmlNode;
     QDomElement infoXml;
-    QDomNodeList docs = m_doc.elementsByTagName(QStringLiteral("kdenlivedoc"));
+    const QVector<QDomElement> docs = elements.value(QStringLiteral("kdenlivedoc"));
     if (!docs.isEmpty()) {
-        infoXmlNode = m_doc.elementsByTagName(QStringLiteral("kdenlivedoc")).at(0);
-        infoXml = infoXmlNode.toElement();
+        infoXml = docs.first();
         infoXml.setAttribute(QStringLiteral("upgraded"), QStringLiteral("1"));
     }
     m_doc.documentElement().setAttribute(QStringLiteral("upgraded"), QStringLiteral("1"));
@@ -376,9 +462,8 @@ bool DocumentValidator::upgrade(double version, const double currentVersion)
         // Add the tracks information
         QString tracksOrder = infoXml.attribute(QStringLiteral("tracks"));
         if (tracksOrder.isEmpty()) {
-            QDomNodeList tracks = m_doc.elementsByTagName(QStringLiteral("track"));
-            for (int i = 0; i < tracks.count(); ++i) {
-                QDomElement track = tracks.at(i).toElement();
+            const QVector<QDomElement> tracks = elements.value(QStringLiteral("track"));
+            for (const QDomElement &track : tracks) {
                 if (track.attribute(QStringLiteral("producer")) != QLatin1String("black_track")) {
                     if (track.attribute(QStringLiteral("hide")) == QLatin1String("video")) {
                         tracksOrder.append(QLatin1Char('a'));
@@ -406,46 +491,36 @@ bool DocumentValidator::upgrade(double version, const double currentVersion)
 
     if (version <= 0.82) {
         // Convert <westley />s in <mlt />s (MLT extreme makeover)
-        QDomNodeList westleyNodes = m_doc.elementsByTagName(QStringLiteral("westley"));
-        for (int i = 0; i < westleyNodes.count(); ++i) {
-            QDomElement westley = westleyNodes.at(i).toElement();
+        const QVector<QDomElement> westleyNodes = elements.value(QStringLiteral("westley"));
+        for (QDomElement westley : westleyNodes) {
             westley.setTagName(QStringLiteral("mlt"));
         }
     }
 
     if (version <= 0.83) {
-        // Replace point size with pixel size in text titles
-        if (m_doc.toString().contains(QStringLiteral("font-size"))) {
-            KMessageBox::ButtonCode convert = KMessageBox::Continue;
-            QDomNodeList kproducerNodes = m_doc.elementsByTagName(QStringLiteral("kdenlive_producer"));
-            for (int i = 0; i < kproducerNodes.count() && convert != KMessageBox::No; ++i) {
-                QDomElement kproducer = kproducerNodes.at(i).toElement();
-                if (kproducer.attribute(QStringLiteral("type")).toInt() == Text) {
-                    QDomDocument data;
-                    data.setContent(kproducer.attribute(QStringLiteral("xmldata")));
-                    QDomNodeList items = data.firstChild().childNodes();
-                    for (int j = 0; j < items.count() && convert != KMessageBox::No; ++j) {
-                        if (items.at(j).attributes().namedItem(QStringLiteral("type")).nodeValue() == QLatin1String("QGraphicsTextItem")) {
-                            QDomNamedNodeMap textProperties = items.at(j).namedItem(QStringLiteral("content")).attributes();
-                            if (textProperties.namedItem(QStringLiteral("font-pixel-size")).isNull() && !textProperties.namedItem(QStringLiteral("font-size")).isNull()) {
-                                // Ask the user if he wants to convert
-                                if (convert != KMessageBox::Yes && convert != KMessageBox::No) {
-                                    convert = (KMessageBox::ButtonCode)KMessageBox::warningYesNo(QApplication::activeWindow(), i18n("Some of your text clips were saved with size in points, which means different sizes on different displays. Do you want to convert them to pixel size, making them portable? It is recommended you do this on the computer they were first created on, or you could have to adjust their size."), i18n("Update Text Clips"));
-                                }
-                                if (convert == KMessageBox::Yes) {
-                                    QFont font;
-                                    font.setPointSize(textProperties.namedItem(QStringLiteral("font-size")).nodeValue().toInt());
-                                    QDomElement content = items.at(j).namedItem(QStringLiteral("content")).toElement();
-                                    content.setAttribute(QStringLiteral("font-pixel-size"), QFontInfo(font).pixelSize());
-                                    content.removeAttribute(QStringLiteral("font-size"));
-                                    kproducer.setAttribute(QStringLiteral("xmldata"), data.toString());
-                                    /*
-                                     * You may be tempted to delete the preview file
-                                     * to force its recreation: bad idea (see
-                                     * http://www.kdenlive.org/mantis/view.php?id=749)
-                                     */
-                                }
-                            }
+        // Replace point size with pixel size in text titles, if the user agreed in prepare()
+        const QVector<QDomElement> kproducerNodes = m_convertTitles ? elements.value(QStringLiteral("kdenlive_producer")) : QVector<QDomElement>();
+        for (int i = 0; i < kproducerNodes.count(); ++i) {
+            QDomElement kproducer = kproducerNodes.at(i);
+            if (kproducer.attribute(QStringLiteral("type")).toInt() == Text && kproducer.attribute(QStringLiteral("xmldata")).contains(QStringLiteral("font-size"))) {
+                QDomDocument data;
+                data.setContent(kproducer.attribute(QStringLiteral("xmldata")));
+                QDomNodeList items = data.firstChild().childNodes();
+                for (int j = 0; j < items.count(); ++j) {
+                    if (items.at(j).attributes().namedItem(QStringLiteral("type")).nodeValue() == QLatin1String("QGraphicsTextItem")) {
+                        QDomNamedNodeMap textProperties = items.at(j).namedItem(QStringLiteral("content")).attributes();
+                        if (textProperties.namedItem(QStringLiteral("font-pixel-size")).isNull() && !textProperties.namedItem(QStringLiteral("font-size")).isNull()) {
+                            QFont font;
+                            font.setPointSize(textProperties.namedItem(QStringLiteral("font-size")).nodeValue().toInt());
+                            QDomElement content = items.at(j).namedItem(QStringLiteral("content")).toElement();
+                            content.setAttribute(QStringLiteral("font-pixel-size"), QFontInfo(font).pixelSize());
+                            content.removeAttribute(QStringLiteral("font-size"));
+                            kproducer.setAttribute(QStringLiteral("xmldata"), data.toString());
+                            /*
+                             * You may be tempted to delete the preview file
+                             * to force its recreation: bad idea (see
+                             * http://www.kdenlive.org/mantis/view.php?id=749)
+                             */
                         }
                     }
                 }
@@ -466,9 +541,16 @@ bool DocumentValidator::upgrade(double version, const double currentVersion)
 
     if (version <= 0.84) {
         // update the title clips to use the new MLT kdenlivetitle producer
-        QDomNodeList kproducerNodes = m_doc.elementsByTagName(QStringLiteral("kdenlive_producer"));
-        for (int i = 0; i < kproducerNodes.count(); ++i) {
-            QDomElement kproducer = kproducerNodes.at(i).toElement();
+        QHash<QString, QDomElement> mltProducers;
+        const QVector<QDomElement> producers = elements.value(QStringLiteral("producer"));
+        for (const QDomElement &prod : producers) {
+            const QString id = prod.attribute(QStringLiteral("id"));
+            if (!mltProducers.contains(id)) {
+                mltProducers.insert(id, prod);
+            }
+        }
+        const QVector<QDomElement> kproducerNodes = elements.value(QStringLiteral("kdenlive_producer"));
+        for (QDomElement kproducer : kproducerNodes) {
             if (kproducer.attribute(QStringLiteral("type")).toInt() == Text) {
                 QString data = kproducer.attribute(QStringLiteral("xmldata"));
                 QString datafile = kproducer.attribute(QStringLiteral("resource"));
@@ -476,49 +558,44 @@ bool DocumentValidator::upgrade(double version, const double currentVersion)
                     datafile = QString();
                     kproducer.setAttribute(QStringLiteral("resource"), QString());
                 }
-                QString id = kproducer.attribute(QStringLiteral("id"));
-                QDomNodeList mltproducers = m_doc.elementsByTagName(QStringLiteral("producer"));
+                QDomElement wproducer = mltProducers.value(kproducer.attribute(QStringLiteral("id")));
                 bool foundData = false;
                 bool foundResource = false;
                 bool foundService = false;
-                for (int j = 0; j < mltproducers.count(); ++j) {
-                    QDomElement wproducer = mltproducers.at(j).toElement();
-                    if (wproducer.attribute(QStringLiteral("id")) == id) {
-                        QDomNodeList props = wproducer.childNodes();
-                        for (int k = 0; k < props.count(); ++k) {
-                            if (props.at(k).toElement().attribute(QStringLiteral("name")) == QLatin1String("xmldata")) {
-                                props.at(k).firstChild().setNodeValue(data);
-                                foundData = true;
-                            } else if (props.at(k).toElement().attribute(QStringLiteral("name")) == QLatin1String("mlt_service")) {
-                                props.at(k).firstChild().setNodeValue(QStringLiteral("kdenlivetitle"));
-                                foundService = true;
-                            } else if (props.at(k).toElement().attribute(QStringLiteral("name")) == QLatin1String("resource")) {
-                                props.at(k).firstChild().setNodeValue(datafile);
-                                foundResource = true;
-                            }
-                        }
-                        if (!foundData) {
-                            QDomElement e = m_doc.createElement(QStringLiteral("property"));
-                            e.setAttribute(QStringLiteral("name"), QStringLiteral("xmldata"));
-                            QDomText value = m_doc.createTextNode(data);
-                            e.appendChild(value);
-                            wproducer.appendChild(e);
-                        }
-                        if (!foundService) {
-                            QDomElement e = m_doc.createElement(QStringLiteral("property"));
-                            e.setAttribute(QStringLiteral("name"), QStringLiteral("mlt_service"));
-                            QDomText value = m_doc.createTextNode(QStringLiteral("kdenlivetitle"));
-                            e.appendChild(value);
-                            wproducer.appendChild(e);
+                if (!wproducer.isNull()) {
+                    QDomNodeList props = wproducer.childNodes();
+                    for (int k = 0; k < props.count(); ++k) {
+                        if (props.at(k).toElement().attribute(QStringLiteral("name")) == QLatin1String("xmldata")) {
+                            props.at(k).firstChild().setNodeValue(data);
+                            foundData = true;
+                        } else if (props.at(k).toElement().attribute(QStringLiteral("name")) == QLatin1String("mlt_service")) {
+                            props.at(k).firstChild().setNodeValue(QStringLiteral("kdenlivetitle"));
+                            foundService = true;
+                        } else if (props.at(k).toElement().attribute(QStringLiteral("name")) == QLatin1String("resource")) {
+                            props.at(k).firstChild().setNodeValue(datafile);
+                            foundResource = true;
                         }
-                        if (!foundResource) {
-                            QDomElement e = m_doc.createElement(QStringLiteral("property"));
-                            e.setAttribute(QStringLiteral("name"), QStringLiteral("resource"));
-                            QDomText value = m_doc.createTextNode(datafile);
-                            e.appendChild(value);
-                            wproducer.appendChild(e);
-                        }
-                        break;
+                    }
+                    if (!foundData) {
+                        QDomElement e = m_doc.createElement(QStringLiteral("property"));
+                        e.setAttribute(QStringLiteral("name"), QStringLiteral("xmldata"));
+                        QDomText value = m_doc.createTextNode(data);
+                        e.appendChild(value);
+                        wproducer.appendChild(e);
+                    }
+                    if (!foundService) {
+                        QDomElement e = m_doc.createElement(QStringLiteral("property"));
+                        e.setAttribute(QStringLiteral("name"), QStringLiteral("mlt_service"));
+                        QDomText value = m_doc.createTextNode(QStringLiteral("kdenlivetitle"));
+                        e.appendChild(value);
+                        wproducer.appendChild(e);
+                    }
+                    if (!foundResource) {
+                        QDomElement e = m_doc.createElement(QStringLiteral("property"));
+                        e.setAttribute(QStringLiteral("name"), QStringLiteral("resource"));
+                        QDomText value = m_doc.createTextNode(datafile);
+                        e.appendChild(value);
+                        wproducer.appendChild(e);
                     }
                 }
             }
@@ -526,9 +603,8 @@ bool DocumentValidator::upgrade(double version, const double currentVersion)
     }
     if (version <= 0.85) {
         // update the LADSPA effects to use the new ladspa.id format instead of external xml file
-        QDomNodeList effectNodes = m_doc.elementsByTagName(QStringLiteral("filter"));
-        for (int i = 0; i < effectNodes.count(); ++i) {
-            QDomElement effect = effectNodes.at(i).toElement();
+        const QVector<QDomElement> effectNodes = elements.value(QStringLiteral("filter"));
+        for (const QDomElement &effect : effectNodes) {
             if (EffectsList::property(effect, QStringLiteral("mlt_service")) == QLatin1String("ladspa")) {
                 // Needs to be converted
                 QStringList info = getInfoFromEffectName(EffectsList::property(effect, QStringLiteral("kdenlive_id")));
@@ -553,10 +629,8 @@ bool DocumentValidator::upgrade(double version, const double currentVersion)
 
     if (version <= 0.86) {
         // Make sure we don't have avformat-novalidate producers, since it caused crashes
-        QDomNodeList producers = m_doc.elementsByTagName(QStringLiteral("producer"));
-        int max = producers.count();
-        for (int i = 0; i < max; ++i) {
-            QDomElement prod = producers.at(i).toElement();
+        const QVector<QDomElement> producers = elements.value(QStringLiteral("producer"));
+        for (const QDomElement &prod : producers) {
             if (EffectsList::property(prod, QStringLiteral("mlt_service")) == QLatin1String("avformat-novalidate")) {
                 EffectsList::setProperty(prod, QStringLiteral("mlt_service"), QStringLiteral("avformat"));
             }
@@ -587,10 +661,8 @@ bool DocumentValidator::upgrade(double version, const double currentVersion)
             profileWidth = profile.attribute(QStringLiteral("width")).toInt();
             profileHeight = profile.attribute(QStringLiteral("height")).toInt();
         }
-        QDomNodeList transitions = m_doc.elementsByTagName(QStringLiteral("transition"));
-        max = transitions.count();
-        for (int i = 0; i < max; ++i) {
-            QDomElement trans = transitions.at(i).toElement();
+        const QVector<QDomElement> transitions = elements.value(QStringLiteral("transition"));
+        for (const QDomElement &trans : transitions) {
             int out = trans.attribute(QStringLiteral("out")).toInt() - trans.attribute(QStringLiteral("in")).toInt();
             QString geom = EffectsList::property(trans, QStringLiteral("geometry"));
             Mlt::Geometry *g = new Mlt::Geometry(geom.toUtf8().data(), out, profileWidth, profileHeight);
@@ -616,7 +688,7 @@ bool DocumentValidator::upgrade(double version, const double currentVersion)
 
     if (version <= 0.88) {
         // convert to new MLT-only format
-        QDomNodeList producers = m_doc.elementsByTagName(QStringLiteral("producer"));
+        const QVector<QDomElement> producers = elements.value(QStringLiteral("producer"));
         QDomDocumentFragment frag = m_doc.createDocumentFragment();
 
         // Create Bin Playlist
@@ -628,9 +700,8 @@ bool DocumentValidator::upgrade(double version, const double currentVersion)
         main_playlist.appendChild(prop);
 
         // Move markers
-        QDomNodeList markers = m_doc.elementsByTagName(QStringLiteral("marker"));
-        for (int i = 0; i < markers.count(); ++i) {
-            QDomElement marker = markers.at(i).toElement();
+        const QVector<QDomElement> markers = elements.value(QStringLiteral("marker"));
+        for (const QDomElement &marker : markers) {
             QDomElement property = m_doc.createElement(QStringLiteral("property"));
             property.setAttribute(QStringLiteral("name"), QStringLiteral("kdenlive:marker.") + marker.attribute(QStringLiteral("id")) + QLatin1Char(':') + marker.attribute(QStringLiteral("time")));
             QDomText val_node = m_doc.createTextNode(marker.attribute(QStringLiteral("type")) + QLatin1Char(':') + marker.attribute(QStringLiteral("comment")));
@@ -639,9 +710,8 @@ bool DocumentValidator::upgrade(double version, const double currentVersion)
         }
 
         // Move guides
-        QDomNodeList guides = m_doc.elementsByTagName(QStringLiteral("guide"));
-        for (int i = 0; i < guides.count(); ++i) {
-            QDomElement guide = guides.at(i).toElement();
+        const QVector<QDomElement> guides = elements.value(QStringLiteral("guide"));
+        for (const QDomElement &guide : guides) {
             QDomElement property = m_doc.createElement(QStringLiteral("property"));
             property.setAttribute(QStringLiteral("name"), QStringLiteral("kdenlive:guide.") + guide.attribute(QStringLiteral("time")));
             QDomText val_node = m_doc.createTextNode(guide.attribute(QStringLiteral("comment")));
@@ -650,9 +720,8 @@ bool DocumentValidator::upgrade(double version, const double currentVersion)
         }
 
         // Move folders
-        QDomNodeList folders = m_doc.elementsByTagName(QStringLiteral("folder"));
-        for (int i = 0; i < folders.count(); ++i) {
-            QDomElement folder = folders.at(i).toElement();
+        const QVector<QDomElement> folders = elements.value(QStringLiteral("folder"));
+        for (const QDomElement &folder : folders) {
             QDomElement property = m_doc.createElement(QStringLiteral("property"));
             property.setAttribute(QStringLiteral("name"), QStringLiteral("kdenlive:folder.-1.") + folder.attribute(QStringLiteral("id")));
             QDomText val_node = m_doc.createTextNode(folder.attribute(QStringLiteral("name")));
@@ -661,21 +730,20 @@ bool DocumentValidator::upgrade(double version, const double currentVersion)
         }
 
         QDomNode mlt = m_doc.firstChildElement(QStringLiteral("mlt"));
-        main_playlist.setAttribute(QStringLiteral("id"), pCore->binController()->binPlaylistId());
-        mlt.toElement().setAttribute(QStringLiteral("producer"), pCore->binController()->binPlaylistId());
-        QStringList ids;
+        main_playlist.setAttribute(QStringLiteral("id"), BinController::binPlaylistId());
+        mlt.toElement().setAttribute(QStringLiteral("producer"), BinController::binPlaylistId());
+        QSet<QString> ids;
         QStringList slowmotionIds;
         QDomNode firstProd = m_doc.firstChildElement(QStringLiteral("producer"));
 
-        QDomNodeList kdenlive_producers = m_doc.elementsByTagName(QStringLiteral("kdenlive_producer"));
+        const QVector<QDomElement> kdenlive_producers = elements.value(QStringLiteral("kdenlive_producer"));
 
         // Rename all track producers to correct name: "id_playlistName" instead of "id_trackNumber"
         QMap<QString, QString> trackRenaming;
         // Create a list of which producers / track on which the producer is
         QMap<QString, QString> playlistForId;
-        QDomNodeList entries = m_doc.elementsByTagName(QStringLiteral("entry"));
-        for (int i = 0; i < entries.count(); i++) {
-            QDomElement entry = entries.at(i).toElement();
+        const QVector<QDomElement> entries = elements.value(QStringLiteral("entry"));
+        for (QDomElement entry : entries) {
             QString entryId = entry.attribute(QStringLiteral("producer"));
             if (entryId == QLatin1String("black")) {
                 continue;
@@ -722,8 +790,7 @@ bool DocumentValidator::upgrade(double version, const double currentVersion)
             entry.setAttribute(QStringLiteral("producer"), newId);
         }
         if (!trackRenaming.isEmpty()) {
-            for (int i = 0; i < producers.count(); ++i) {
-                QDomElement prod = producers.at(i).toElement();
+            for (QDomElement prod : producers) {
                 QString id = prod.attribute(QStringLiteral("id"));
                 if (trackRenaming.contains(id)) {
                     prod.setAttribute(QStringLiteral("id"), trackRenaming.value(id));
@@ -733,14 +800,18 @@ bool DocumentValidator::upgrade(double version, const double currentVersion)
 
         // Create easily searchable index of original producers
         QMap<QString, QDomElement> m_source_producers;
-        for (int j = 0; j < kdenlive_producers.count(); j++) {
-            QDomElement prod = kdenlive_producers.at(j).toElement();
+        for (const QDomElement &prod : kdenlive_producers) {
             QString id = prod.attribute(QStringLiteral("id"));
             m_source_producers.insert(id, prod);
         }
 
-        for (int i = 0; i < producers.count(); ++i) {
-            QDomElement prod = producers.at(i).toElement();
+        // Timeline entries by producer id, used to rename the entries of duplicated track producers
+        QHash<QString, QVector<QDomElement> > entriesForId;
+        for (const QDomElement &entry : entries) {
+            entriesForId[entry.attribute(QStringLiteral("producer"))].append(entry);
+        }
+
+        for (QDomElement prod : producers) {
             QString id = prod.attribute(QStringLiteral("id"));
             if (id == QLatin1String("black")) {
                 continue;
@@ -764,17 +835,14 @@ bool DocumentValidator::upgrade(double version, const double currentVersion)
                         // This should be a track producer, rename
                         QString newId = id + QLatin1Char('_') + playlistForId.value(id);
                         prod.setAttribute(QStringLiteral("id"), newId);
-                        for (int j = 0; j < entries.count(); j++) {
-                            QDomElement entry = entries.at(j).toElement();
-                            QString entryId = entry.attribute(QStringLiteral("producer"));
-                            if (entryId == id) {
-                                entry.setAttribute(QStringLiteral("producer"), newId);
-                            }
+                        const QVector<QDomElement> renamed = entriesForId.take(id);
+                        for (QDomElement entry : renamed) {
+                            entry.setAttribute(QStringLiteral("producer"), newId);
                         }
+                        entriesForId[newId] += renamed;
                     } else {
                         // This is a duplicate, remove
                         mlt.removeChild(prod);
-                        i--;
                     }
                 }
                 // Already processed, continue
@@ -796,8 +864,6 @@ bool DocumentValidator::upgrade(double version, const double currentVersion)
                     entry.setAttribute(QStringLiteral("out"), QString::number(source.attribute(QStringLiteral("duration")).toInt() - 1));
                 }
                 frag.appendChild(prod);
-                // Changing prod parent removes it from list, so rewind index
-                i--;
             } else {
                 QDomElement originalProd = prod.cloneNode().toElement();
                 originalProd.setAttribute(QStringLiteral("id"), prodId);
@@ -817,12 +883,11 @@ bool DocumentValidator::upgrade(double version, const double currentVersion)
                 entry.setAttribute(QStringLiteral("producer"), prodId);
                 main_playlist.appendChild(entry);
             }
-            ids.append(prodId);
+            ids.insert(prodId);
         }
 
         // Make sure to include producers that were not in timeline
-        for (int j = 0; j < kdenlive_producers.count(); j++) {
-            QDomElement prod = kdenlive_producers.at(j).toElement();
+        for (const QDomElement &prod : kdenlive_producers) {
             QString id = prod.attribute(QStringLiteral("id"));
             if (!ids.contains(id)) {
                 // Clip was not in timeline, create it
@@ -874,32 +939,28 @@ bool DocumentValidator::upgrade(double version, const double currentVersion)
                     fixTitleProducerLocale(originalProd);
                 }
                 frag.appendChild(originalProd);
-                ids << id;
+                ids.insert(id);
             }
         }
 
         // Set clip folders
-        for (int j = 0; j < kdenlive_producers.count(); j++) {
-            QDomElement prod = kdenlive_producers.at(j).toElement();
-            QString id = prod.attribute(QStringLiteral("id"));
+        QHash<QString, QDomElement> binProducers;
+        for (QDomElement mltprod = frag.firstChildElement(QStringLiteral("producer")); !mltprod.isNull(); mltprod = mltprod.nextSiblingElement(QStringLiteral("producer"))) {
+            const QString id = mltprod.attribute(QStringLiteral("id"));
+            if (!binProducers.contains(id)) {
+                binProducers.insert(id, mltprod);
+            }
+        }
+        for (const QDomElement &prod : kdenlive_producers) {
             QString folder = prod.attribute(QStringLiteral("groupid"));
-            QDomNodeList mlt_producers = frag.childNodes();
-            for (int k = 0; k < mlt_producers.count(); k++) {
-                QDomElement mltprod = mlt_producers.at(k).toElement();
-                if (mltprod.tagName() != QLatin1String("producer")) {
-                    continue;
-                }
-                if (mltprod.attribute(QStringLiteral("id")) == id) {
-                    if (!folder.isEmpty()) {
-                        // We have found our producer, set folder info
-                        QDomElement property = m_doc.createElement(QStringLiteral("property"));
-                        property.setAttribute(QStringLiteral("name"), QStringLiteral("kdenlive:folderid"));
-                        QDomText val_node = m_doc.createTextNode(folder);
-                        property.appendChild(val_node);
-                        mltprod.appendChild(property);
-                    }
-                    break;
-                }
+            QDomElement mltprod = binProducers.value(prod.attribute(QStringLiteral("id")));
+            if (!mltprod.isNull() && !folder.isEmpty()) {
+                // We have found our producer, set folder info
+                QDomElement property = m_doc.createElement(QStringLiteral("property"));
+                property.setAttribute(QStringLiteral("name"), QStringLiteral("kdenlive:folderid"));
+                QDomText val_node = m_doc.createTextNode(folder);
+                property.appendChild(val_node);
+                mltprod.appendChild(property);
             }
         }
 
@@ -908,8 +969,7 @@ bool DocumentValidator::upgrade(double version, const double currentVersion)
             QString slo = slowmotionIds.at(i);
             if (!ids.contains(slo)) {
                 // rebuild producer from Kdenlive's old xml format
-                for (int j = 0; j < kdenlive_producers.count(); j++) {
-                    QDomElement prod = kdenlive_producers.at(j).toElement();
+                for (const QDomElement &prod : kdenlive_producers) {
                     QString id = prod.attribute(QStringLiteral("id"));
                     if (id == slo) {
                         // We found the kdenlive_producer, build MLT producer
@@ -938,7 +998,7 @@ bool DocumentValidator::upgrade(double version, const double currentVersion)
                         entry.setAttribute(QStringLiteral("producer"), id);
                         main_playlist.appendChild(entry);
                         frag.appendChild(original);
-                        ids << slo;
+                        ids.insert(slo);
                         break;
                     }
                 }
@@ -946,26 +1006,28 @@ bool DocumentValidator::upgrade(double version, const double currentVersion)
         }
         frag.appendChild(main_playlist);
         mlt.insertBefore(frag, firstProd);
+        elements = indexElements(m_doc);
     }
 
     if (version < 0.91) {
         // Migrate track properties
         QDomNode mlt = m_doc.firstChildElement(QStringLiteral("mlt"));
-        QDomNodeList old_tracks = m_doc.elementsByTagName(QStringLiteral("trackinfo"));
-        QDomNodeList tracks = m_doc.elementsByTagName(QStringLiteral("track"));
-        QDomNodeList playlists = m_doc.elementsByTagName(QStringLiteral("playlist"));
+        const QVector<QDomElement> old_tracks = elements.value(QStringLiteral("trackinfo"));
+        const QVector<QDomElement> tracks = elements.value(QStringLiteral("track"));
+        QHash<QString, QDomElement> playlists;
+        const QVector<QDomElement> playlistNodes = elements.value(QStringLiteral("playlist"));
+        for (const QDomElement &playlist : playlistNodes) {
+            const QString id = playlist.attribute(QStringLiteral("id"));
+            if (!playlists.contains(id)) {
+                playlists.insert(id, playlist);
+            }
+        }
         for (int i = 0; i < old_tracks.count(); i++) {
-            QString playlistName = tracks.at(i + 1).toElement().attribute(QStringLiteral("producer"));
+            QString playlistName = tracks.value(i + 1).attribute(QStringLiteral("producer"));
             // find playlist for track
-            QDomElement trackPlaylist;
-            for (int j = 0; j < playlists.count(); j++) {
-                if (playlists.at(j).toElement().attribute(QStringLiteral("id")) == playlistName) {
-                    trackPlaylist = playlists.at(j).toElement();
-                    break;
-                }
-            }
+            QDomElement trackPlaylist = playlists.value(playlistName);
             if (!trackPlaylist.isNull()) {
-                QDomElement kdenliveTrack = old_tracks.at(i).toElement();
+                const QDomElement &kdenliveTrack = old_tracks.at(i);
                 if (kdenliveTrack.attribute(QStringLiteral("type")) == QLatin1String("audio")) {
                     EffectsList::setProperty(trackPlaylist, QStringLiteral("kdenlive:audio_track"), QStringLiteral("1"));
                 }
@@ -976,33 +1038,26 @@ bool DocumentValidator::upgrade(double version, const double currentVersion)
             }
         }
         // Find bin playlist
-        playlists = m_doc.elementsByTagName(QStringLiteral("playlist"));
-        QDomElement playlist;
-        for (int i = 0; i < playlists.count(); i++) {
-            if (playlists.at(i).toElement().attribute(QStringLiteral("id")) == pCore->binController()->binPlaylistId()) {
-                playlist = playlists.at(i).toElement();
-                break;
-            }
-        }
+        QDomElement playlist = playlists.value(BinController::binPlaylistId());
         // Migrate document notes
-        QDomNodeList notesList = m_doc.elementsByTagName(QStringLiteral("documentnotes"));
+        const QVector<QDomElement> notesList = elements.value(QStringLiteral("documentnotes"));
         if (!notesList.isEmpty()) {
-            QDomElement notes_elem = notesList.at(0).toElement();
+            const QDomElement &notes_elem = notesList.first();
             QString notes = notes_elem.firstChild().nodeValue();
             EffectsList::setProperty(playlist, QStringLiteral("kdenlive:documentnotes"), notes);
         }
         // Migrate clip groups
-        QDomNodeList groupElement = m_doc.elementsByTagName(QStringLiteral("groups"));
+        const QVector<QDomElement> groupElement = elements.value(QStringLiteral("groups"));
         if (!groupElement.isEmpty()) {
-            QDomElement groups = groupElement.at(0).toElement();
+            const QDomElement &groups = groupElement.first();
             QDomDocument d2;
             d2.importNode(groups, true);
             EffectsList::setProperty(playlist, QStringLiteral("kdenlive:clipgroups"), d2.toString());
         }
         // Migrate custom effects
-        QDomNodeList effectsElement = m_doc.elementsByTagName(QStringLiteral("customeffects"));
+        const QVector<QDomElement> effectsElement = elements.value(QStringLiteral("customeffects"));
         if (!effectsElement.isEmpty()) {
-            QDomElement effects = effectsElement.at(0).toElement();
+            const QDomElement &effects = effectsElement.first();
             QDomDocument d2;
             d2.importNode(effects, true);
             EffectsList::setProperty(playlist, QStringLiteral("kdenlive:customeffects"), d2.toString());
@@ -1017,14 +1072,13 @@ bool DocumentValidator::upgrade(double version, const double currentVersion)
         if (!docXml.isNull()) {
             mlt.removeChild(docXml);
         }
+        elements = indexElements(m_doc);
     }
 
     if (version < 0.92) {
         // Luma transition used for wipe is deprecated, we now use a composite, convert
-        QDomNodeList transitionList = m_doc.elementsByTagName(QStringLiteral("transition"));
-        QDomElement trans;
-        for (int i = 0; i < transitionList.count(); i++) {
-            trans = transitionList.at(i).toElement();
+        const QVector<QDomElement> transitionList = elements.value(QStringLiteral("transition"));
+        for (const QDomElement &trans : transitionList) {
             QString id = EffectsList::property(trans, QStringLiteral("kdenlive_id"));
             if (id == QLatin1String("luma")) {
                 EffectsList::setProperty(trans, QStringLiteral("kdenlive_id"), QStringLiteral("wipe"));
@@ -1054,9 +1108,8 @@ bool DocumentValidator::upgrade(double version, const double currentVersion)
         keyframeFilterToConvert.insert(QStringLiteral("volume"), QStringList() << QStringLiteral("gain") << QStringLiteral("end") << QStringLiteral("level"));
         keyframeFilterToConvert.insert(QStringLiteral("brightness"), QStringList() << QStringLiteral("start") << QStringLiteral("end") << QStringLiteral("level"));
 
-        QDomNodeList entries = m_doc.elementsByTagName(QStringLiteral("entry"));
-        for (int i = 0; i < entries.count(); i++) {
-            QDomNode entry = entries.at(i);
+        const QVector<QDomElement> entries = elements.value(QStringLiteral("entry"));
+        for (QDomElement entry : entries) {
             QDomNodeList effects = entry.toElement().elementsByTagName(QStringLiteral("filter"));
             QStringList parsedIds;
             for (int j = 0; j < effects.count(); j++) {
@@ -1112,11 +1165,9 @@ bool DocumentValidator::upgrade(double version, const double currentVersion)
 
     if (version < 0.94) {
         // convert slowmotion effects/producers
-        QDomNodeList producers = m_doc.elementsByTagName(QStringLiteral("producer"));
-        int max = producers.count();
-        QStringList slowmoIds;
-        for (int i = 0; i < max; ++i) {
-            QDomElement prod = producers.at(i).toElement();
+        const QVector<QDomElement> producers = elements.value(QStringLiteral("producer"));
+        QSet<QString> slowmoIds;
+        for (QDomElement prod : producers) {
             QString id = prod.attribute(QStringLiteral("id"));
             if (id.startsWith(QLatin1String("slowmotion"))) {
                 QString service = EffectsList::property(prod, QStringLiteral("mlt_service"));
@@ -1134,13 +1185,11 @@ bool DocumentValidator::upgrade(double version, const double currentVersion)
             }
         }
         if (!slowmoIds.isEmpty()) {
-            producers = m_doc.elementsByTagName(QStringLiteral("entry"));
-            max = producers.count();
-            for (int i = 0; i < max; ++i) {
-                QDomElement prod = producers.at(i).toElement();
-                QString entryId = prod.attribute(QStringLiteral("producer"));
+            const QVector<QDomElement> entries = elements.value(QStringLiteral("entry"));
+            for (QDomElement entry : entries) {
+                QString entryId = entry.attribute(QStringLiteral("producer"));
                 if (slowmoIds.contains(entryId)) {
-                    prod.setAttribute(QStringLiteral("producer"), entryId + QStringLiteral(":1"));
+                    entry.setAttribute(QStringLiteral("producer"), entryId + QStringLiteral(":1"));
                 }
             }
         }
@@ -1148,13 +1197,8 @@ bool DocumentValidator::upgrade(double version, const double currentVersion)
     }
     if (version < 0.95) {
         // convert slowmotion effects/producers
-        QDomNodeList producers = m_doc.elementsByTagName(QStringLiteral("producer"));
-        int max = producers.count();
-        for (int i = 0; i < max; ++i) {
-            QDomElement prod = producers.at(i).toElement();
-            if (prod.isNull()) {
-                continue;
-            }
+        const QVector<QDomElement> producers = elements.value(QStringLiteral("producer"));
+        for (const QDomElement &prod : producers) {
             QString id = prod.attribute(QStringLiteral("id")).section(QLatin1Char('_'), 0, 0);
             if (id == QLatin1String("black")) {
                 EffectsList::setProperty(prod, QStringLiteral("set.test_audio"), QStringLiteral("0"));
@@ -1164,11 +1208,8 @@ bool DocumentValidator::upgrade(double version, const double currentVersion)
     }
     if (version < 0.96) {
         // Check image sequences with buggy begin frame number
-        QDomNodeList producers = m_doc.elementsByTagName(QStringLiteral("producer"));
-        int max = producers.count();
-        for (int i = 0; i < max; ++i) {
-            QDomElement prod = producers.at(i).toElement();
-            if (prod.isNull()) continue;
+        const QVector<QDomElement> producers = elements.value(QStringLiteral("producer"));
+        for (const QDomElement &prod : producers) {
             const QString service = EffectsList::property(prod, QStringLiteral("mlt_service"));
             if (service == QLatin1String("pixbuf") || service == QLatin1String("qimage")) {
                 QString resource = EffectsList::property(prod, QStringLiteral("resource"));
@@ -1179,11 +1220,8 @@ bool DocumentValidator::upgrade(double version, const double currentVersion)
             }
         }
         if (TransitionHandler::sumAudioMixAvailable()) {
-            QDomNodeList transitions = m_doc.elementsByTagName(QStringLiteral("transition"));
-            max = transitions.count();
-            for (int i = 0; i < max; ++i) {
-                QDomElement trans = transitions.at(i).toElement();
-                if (trans.isNull()) continue;
+            const QVector<QDomElement> transitions = elements.value(QStringLiteral("transition"));
+            for (const QDomElement &trans : transitions) {
                 const QString service = EffectsList::property(trans, QStringLiteral("mlt_service"));
                 if (service == QLatin1String("mix")) {
                     EffectsList::renameProperty(trans, QStringLiteral("combine"), QStringLiteral("sum"));
@@ -1463,7 +1501,7 @@ void DocumentValidator::checkOrphanedProducers()
     QDomElement mlt = m_doc.firstChildElement(QStringLiteral("mlt"));
     QDomElement main = mlt.firstChildElement(QStringLiteral("playlist"));
     QDomNodeList bin_producers = main.childNodes();
-    QStringList binProducers;
+    QSet<QString> binProducers;
     for (int k = 0; k < bin_producers.count(); k++) {
         QDomElement mltprod = bin_producers.at(k).toElement();
         if (mltprod.tagName() != QLatin1String("entry")) {
@@ -1474,7 +1512,7 @@ void DocumentValidator::checkOrphanedProducers()
 
     QDomNodeList producers = m_doc.elementsByTagName(QStringLiteral("producer"));
     int max = producers.count();
-    QStringList allProducers;
+    QSet<QString> allProducers;
     for (int i = 0; i < max; ++i) {
         QDomElement prod = producers.at(i).toElement();
         if (prod.isNull()) {
@@ -1485,6 +1523,7 @@ void DocumentValidator::checkOrphanedProducers()
 
     QDomDocumentFragment frag = m_doc.createDocumentFragment();
     QDomDocumentFragment trackProds = m_doc.createDocumentFragment();
+    QVector<QDomElement> entries;
     for (int i = 0; i < max; ++i) {
         QDomElement prod = producers.at(i).toElement();
         if (prod.isNull()) {
@@ -1524,9 +1563,10 @@ void DocumentValidator::checkOrphanedProducers()
                     // Found probable source producer, replace
                     frag.appendChild(prod);
                     i--;
-                    QDomNodeList entries = m_doc.elementsByTagName(QStringLiteral("entry"));
-                    for (int k = 0; k < entries.count(); k++) {
-                        QDomElement entry = entries.at(k).toElement();
+                    if (entries.isEmpty()) {
+                        entries = indexElements(m_doc).value(QStringLiteral("entry"));
+                    }
+                    for (QDomElement entry : entries) {
                         if (entry.attribute(QStringLiteral("producer")) == id) {
                             QString entryId = binId;
                             if (service.contains(QStringLiteral("avformat")) || service == QLatin1String("xml") || service == QLatin1String("consumer")) {
@@ -25,6 +25,7 @@
 
 #include <QUrl>
 #include <QMap>
+#include <QStringList>
 
 class DocumentValidator
 {
@@ -32,7 +33,15 @@ class DocumentValidator
 public:
     DocumentValidator(const QDomDocument &doc, const QUrl &documentUrl);
     bool isProject() const;
+    /** @brief Check the document and upgrade it to @param currentVersion, same as prepare followed by upgradeDocument. */
     bool validate(const double currentVersion);
+    /** @brief Check the document locale and version, and ask the questions of the upgrade. Runs in the GUI thread. */
+    bool prepare(const double currentVersion);
+    /** @brief Upgrade the document after prepare. It does not use the GUI, so it can run in a worker thread
+     *  if @param collectMessages is set: error messages are then kept in messages() instead of being shown. */
+    bool upgradeDocument(bool collectMessages);
+    /** @brief Error messages collected by upgradeDocument. */
+    QStringList messages() const;
     bool isModified() const;
     /** @brief Check if the project contains references to Movit stuff (GLSL), and try to convert if wanted. */
     bool checkMovit();
@@ -41,6 +50,16 @@ private:
     QDomDocument m_doc;
     QUrl m_url;
     bool m_modified;
+    double m_version;
+    double m_currentVersion;
+    /** @brief The user agreed to convert the text clips with a size in points. */
+    bool m_convertTitles;
+    bool m_collectMessages;
+    QStringList m_messages;
+    /** @brief Show an error message, or keep it in m_messages when the upgrade runs in a worker thread. */
+    void showError(const QString &message, const QString &caption);
+    /** @brief Returns true if a legacy text clip has a font size in points. */
+    bool hasPointSizeTitles() const;
     /** @brief Upgrade from a previous Kdenlive document version. */
     bool upgrade(double version, const double currentVersion);
     /** @brief Pass producer properties from previous Kdenlive versions. */
@@ -32,12 +32,16 @@
 #include "effectslist/initeffects.h"
 #include "dialogs/profilesdialog.h"
 #include "titler/titlewidget.h"
+#include "titler/titlerastercache.h"
 #include "project/notesplugin.h"
 #include "project/dialogs/noteswidget.h"
 #include "core.h"
 #include "bin/bin.h"
 #include "bin/projectclip.h"
+#include "bin/projectfolder.h"
+#include "bin/decodeprobe.h"
 #include "utils/KoIconUtils.h"
+#include "utils/tracer.h"
 #include "mltcontroller/bincontroller.h"
 #include "mltcontroller/effectscontroller.h"
 #include "timeline/transitionhandler.h"
@@ -56,6 +60,7 @@
 #include <QDomImplementation>
 #include <QUndoGroup>
 #include <QTimer>
+#include <QRegularExpression>
 #include <QUndoStack>
 
 #include <mlt++/Mlt.h>
@@ -80,9 +85,7 @@ void DocUndoStack::push(QUndoCommand *cmd)
     QUndoStack::push(cmd);
 }
 
-const double DOCUMENTVERSION = 0.96;
-
-KdenliveDoc::KdenliveDoc(const QUrl &url, const QString &projectFolder, QUndoGroup *undoGroup, const QString &profileName, const QMap<QString, QString> &properties, const QMap<QString, QString> &metadata, const QPoint &tracks, Render *render, NotesPlugin *notes, bool *openBackup, MainWindow *parent) :
+KdenliveDoc::KdenliveDoc(const QUrl &url, const QString &projectFolder, QUndoGroup *undoGroup, const QString &profileName, const QMap<QString, QString> &properties, const QMap<QString, QString> &metadata, const QPoint &tracks, Render *render, NotesPlugin *notes, bool *openBackup, MainWindow *parent, const ProjectFile *projectFile) :
     QObject(parent),
     m_autosave(nullptr),
     m_url(url),
@@ -159,8 +162,9 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, const QString &projectFolder, QUndoGro
     }
     *openBackup = false;
     if (url.isValid()) {
+        const ProjectFile loaded = projectFile ? *projectFile : readProjectFile(url.toLocalFile(), KdenliveSettings::cacheupgradedprojects());
         QFile file(url.toLocalFile());
-        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        if (!loaded.opened) {
             // The file cannot be opened
             if (KMessageBox::warningContinueCancel(parent, i18n("Cannot open the project file,\nDo you want to open a backup file?"), i18n("Error opening file"), KGuiItem(i18n("Open Backup"))) == KMessageBox::Continue) {
                 *openBackup = true;
@@ -168,12 +172,13 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, const QString &projectFolder, QUndoGro
             //KMessageBox::error(parent, KIO::NetAccess::lastErrorString());
         } else {
             qCDebug(KDENLIVE_LOG) << " // / processing file open";
-            QString errorMsg;
-            int line;
-            int col;
-            QDomImplementation::setInvalidDataPolicy(QDomImplementation::DropInvalidChars);
-            success = m_document.setContent(&file, false, &errorMsg, &line, &col);
-            file.close();
+            QString errorMsg = loaded.errorMsg;
+            int line = loaded.line;
+            int col = loaded.col;
+            const QString &sourceHash = loaded.sourceHash;
+            const bool fromUpgradeCache = loaded.fromUpgradeCache;
+            m_document = loaded.document;
+            success = loaded.parsed;
 
             if (!success) {
                 // It is corrupted
@@ -230,7 +235,27 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, const QString &projectFolder, QUndoGro
                      * and recover it if needed). It is NOT a passive operation
                      */
                     // TODO: backup the document or alert the user?
-                    success = validator.validate(DOCUMENTVERSION);
+                    if (loaded.validated) {
+                        // Already upgraded in a worker thread
+                        for (const QString &message : loaded.messages) {
+                            KMessageBox::sorry(parent, message);
+                        }
+                        success = loaded.valid;
+                    } else {
+                        success = validator.validate(DOCUMENTVERSION);
+                    }
+                    if (success && !fromUpgradeCache && KdenliveSettings::cacheupgradedprojects() && m_document.documentElement().hasAttribute(QStringLiteral("upgraded"))) {
+                        // Only hash the project once we know it needed an upgrade
+                        QString cacheKey = sourceHash;
+                        QFile source(url.toLocalFile());
+                        if (cacheKey.isEmpty() && source.open(QIODevice::ReadOnly | QIODevice::Text)) {
+                            cacheKey = upgradeCacheKey(&source);
+                            source.close();
+                        }
+                        if (!cacheKey.isEmpty()) {
+                            saveUpgradeCache(url.toLocalFile(), cacheKey);
+                        }
+                    }
                     if (success && !KdenliveSettings::gpu_accel()) {
                         success = validator.checkMovit();
                     }
@@ -245,7 +270,7 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, const QString &projectFolder, QUndoGro
                             if (m_document.documentElement().attribute(QStringLiteral("modified")) == QLatin1String("1")) {
                                 setModified(true);
                             }
-                            if (validator.isModified()) {
+                            if (validator.isModified() || loaded.upgradeModified || fromUpgradeCache) {
                                 setModified(true);
                             }
                         }
@@ -555,6 +580,31 @@ bool KdenliveDoc::autoGenerateProxy(int width) const
     return m_documentProperties.value(QStringLiteral("generateproxy")).toInt() && width > m_documentProperties.value(QStringLiteral("proxyminsize")).toInt();
 }
 
+bool KdenliveDoc::autoGenerateProxy(double decodeSpeed, int *proxyWidth) const
+{
+    *proxyWidth = 0;
+    if (!m_documentProperties.value(QStringLiteral("generateproxy")).toInt() || decodeSpeed <= 0) {
+        return false;
+    }
+    // Width requested by the proxy encoding profile
+    const QString params = m_documentProperties.value(QStringLiteral("proxyparams"));
+    int profileWidth = 0;
+    QRegularExpressionMatch match = QRegularExpression(QStringLiteral("scale=(\\d+):")).match(params);
+    if (match.hasMatch()) {
+        profileWidth = match.captured(1).toInt();
+    } else if (params.contains(QStringLiteral("-s "))) {
+        profileWidth = params.section(QStringLiteral("-s "), 1).section(QLatin1Char('x'), 0, 0).toInt();
+    }
+    int width = DecodeProbe::proxyWidth(decodeSpeed, fps(), qMax(profileWidth, 2));
+    if (width == 0) {
+        return false;
+    }
+    if (profileWidth > 0 && width < profileWidth) {
+        *proxyWidth = width;
+    }
+    return true;
+}
+
 bool KdenliveDoc::autoGenerateImageProxy(int width) const
 {
     return m_documentProperties.value(QStringLiteral("generateimageproxy")).toInt() && width > m_documentProperties.value(QStringLiteral("proxyimageminsize")).toInt();
@@ -710,6 +760,9 @@ bool KdenliveDoc::saveSceneList(const QString &path, const QString &scene)
     }
     file.close();
     cleanupBackupFiles();
+    // The saved project is up to date, drop the upgraded copy of its legacy version
+    QFile::remove(upgradeCachePath(path));
+    pruneTitleRasters();
     QFileInfo info(file);
     QString fileName = QUrl::fromLocalFile(path).fileName().section(QLatin1Char('.'), 0, -2);
     fileName.append(QLatin1Char('-') + m_documentProperties.value(QStringLiteral("documentid")));
@@ -720,6 +773,106 @@ bool KdenliveDoc::saveSceneList(const QString &path, const QString &scene)
     return true;
 }
 
+void KdenliveDoc::pruneTitleRasters()
+{
+    bool ok = false;
+    QDir titleFolder = getCacheDir(CacheTitles, &ok);
+    if (!ok || pCore->bin()->rootFolder() == nullptr) {
+        return;
+    }
+    QStringList titles;
+    const QList<ProjectClip *> clips = pCore->bin()->rootFolder()->childClips();
+    for (ProjectClip *clip : clips) {
+        if (clip->clipType() == Text) {
+            titles << clip->getProducerProperty(QStringLiteral("xmldata"));
+        }
+    }
+    TitleRasterCache::prune(titleFolder, titles);
+}
+
+//static
+KdenliveDoc::ProjectFile KdenliveDoc::readProjectFile(const QString &path, bool useUpgradeCache)
+{
+    KDENLIVE_TRACE("load", "read project");
+    ProjectFile result;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return result;
+    }
+    result.opened = true;
+    QDomImplementation::setInvalidDataPolicy(QDomImplementation::DropInvalidChars);
+    // Reuse the upgraded copy of a legacy project if the project file did not change since
+    if (useUpgradeCache && QFile::exists(upgradeCachePath(path))) {
+        result.sourceHash = upgradeCacheKey(&file);
+        file.seek(0);
+        result.fromUpgradeCache = loadUpgradeCache(path, result.sourceHash, result.document);
+    }
+    result.parsed = result.fromUpgradeCache || result.document.setContent(&file, false, &result.errorMsg, &result.line, &result.col);
+    file.close();
+    return result;
+}
+
+//static
+QString KdenliveDoc::upgradeCachePath(const QString &projectFile)
+{
+    QFileInfo info(projectFile);
+    if (QFileInfo(info.absolutePath()).isWritable()) {
+        return info.absolutePath() + QStringLiteral("/.") + info.fileName() + QStringLiteral(".upgraded");
+    }
+    // Read only archive, keep the copy in the user cache
+    QDir folder(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/upgraded"));
+    folder.mkpath(QStringLiteral("."));
+    const QByteArray pathHash = QCryptographicHash::hash(info.absoluteFilePath().toUtf8(), QCryptographicHash::Md5).toHex();
+    return folder.absoluteFilePath(QString::fromLatin1(pathHash) + QStringLiteral(".kdenlive"));
+}
+
+//static
+QString KdenliveDoc::upgradeCacheKey(QIODevice *project)
+{
+    // A copy upgraded by another Kdenlive version may differ, so the version is part of the key
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(project);
+    hash.addData(QByteArray(KDENLIVE_VERSION));
+    hash.addData(QByteArray::number(DOCUMENTVERSION));
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+//static
+bool KdenliveDoc::loadUpgradeCache(const QString &projectFile, const QString &sourceHash, QDomDocument &document)
+{
+    QFile cache(upgradeCachePath(projectFile));
+    if (!cache.exists()) {
+        return false;
+    }
+    bool valid = QFileInfo(cache).lastModified() >= QFileInfo(projectFile).lastModified() && cache.open(QIODevice::ReadOnly | QIODevice::Text) && document.setContent(&cache, false);
+    cache.close();
+    QDomElement mlt = document.documentElement();
+    if (valid && mlt.attribute(QStringLiteral("kdenlive:upgradesource")) == sourceHash) {
+        mlt.removeAttribute(QStringLiteral("kdenlive:upgradesource"));
+        return true;
+    }
+    // The project was modified since it was upgraded
+    cache.remove();
+    document.clear();
+    return false;
+}
+
+void KdenliveDoc::saveUpgradeCache(const QString &projectFile, const QString &sourceHash) const
+{
+    QDomDocument upgraded = m_document.cloneNode(true).toDocument();
+    QDomElement mlt = upgraded.documentElement();
+    mlt.setAttribute(QStringLiteral("kdenlive:upgradesource"), sourceHash);
+    // Recent upgrade steps do not update the version property, make sure the copy is not upgraded again
+    EffectsList::setProperty(mlt.firstChildElement(QStringLiteral("playlist")), QStringLiteral("kdenlive:docproperties.version"), QString::number(DOCUMENTVERSION));
+    QFile cache(upgradeCachePath(projectFile));
+    if (!cache.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qCDebug(KDENLIVE_LOG) << "Cannot write upgraded project copy" << cache.fileName();
+        return;
+    }
+    cache.write(upgraded.toString().toUtf8());
+    cache.close();
+}
+
 ClipManager *KdenliveDoc::clipManager()
 {
     return m_clipManager;
@@ -1364,7 +1517,13 @@ void KdenliveDoc::slotProxyCurrentItem(bool doProxy, QList<ProjectClip *> clipLi
 
             if (doProxy) {
                 newProps.clear();
-                QString path = dir.absoluteFilePath(item->hash() + (t == Image ? QStringLiteral(".png") : extension));
+                QString proxyName = item->hash();
+                int proxyWidth = item->getProducerIntProperty(QStringLiteral("kdenlive:proxywidth"));
+                if (proxyWidth > 0 && t != Image) {
+                    // Resolution was adapted to the clip's decode speed
+                    proxyName.append(QLatin1Char('-') + QString::number(proxyWidth));
+                }
+                QString path = dir.absoluteFilePath(proxyName + (t == Image ? QStringLiteral(".png") : extension));
                 // insert required duration for proxy
                 newProps.insert(QStringLiteral("proxy_out"), item->getProducerProperty(QStringLiteral("out")));
                 newProps.insert(QStringLiteral("kdenlive:proxy"), path);
@@ -1655,6 +1814,12 @@ void KdenliveDoc::forceProcessing(const QString &id)
     pCore->producerQueue()->forceProcessing(id);
 }
 
+void KdenliveDoc::prioritizeClips(const QStringList &ids)
+{
+    pCore->producerQueue()->prioritize(ids);
+    pCore->bin()->prioritizeAudioThumbs(ids);
+}
+
 void KdenliveDoc::getFileProperties(const QDomElement &xml, const QString &clipId, int imageHeight, bool replaceProducer)
 {
     pCore->producerQueue()->getFileProperties(xml, clipId, imageHeight, replaceProducer);
@@ -1774,6 +1939,7 @@ void KdenliveDoc::initCacheDirs()
     dir.mkdir(QStringLiteral("preview"));
     dir.mkdir(QStringLiteral("audiothumbs"));
     dir.mkdir(QStringLiteral("videothumbs"));
+    dir.mkdir(QStringLiteral("titles"));
     QDir cacheDir(kdenliveCacheDir);
     cacheDir.mkdir(QStringLiteral("proxy"));
 }
@@ -1814,6 +1980,12 @@ QDir KdenliveDoc::getCacheDir(CacheType type, bool *ok) const
     case CacheThumbs:
         basePath.append(QStringLiteral("/videothumbs"));
         break;
+    case CacheTitles:
+        basePath.append(QStringLiteral("/titles"));
+        break;
+    case CacheAnalysis:
+        basePath.append(QStringLiteral("/analysis"));
+        break;
     default:
         break;
     }
@@ -51,6 +51,8 @@ class NotesPlugin;
 class ProjectClip;
 class ClipController;
 
+class QFile;
+class QIODevice;
 class QTextEdit;
 class QUndoGroup;
 class QTimer;
@@ -76,8 +78,35 @@ class KdenliveDoc: public QObject
     Q_OBJECT
 public:
 
-    KdenliveDoc(const QUrl &url, const QString &projectFolder, QUndoGroup *undoGroup, const QString &profileName, const QMap<QString, QString> &properties, const QMap<QString, QString> &metadata, const QPoint &tracks, Render *render, NotesPlugin *notes, bool *openBackup, MainWindow *parent = nullptr);
+    /** @brief Content of a project file, as read by readProjectFile. */
+    struct ProjectFile {
+        QDomDocument document;
+        /** @brief False if the file could not be opened. */
+        bool opened = false;
+        /** @brief False if the file is not valid xml, see errorMsg, line and col. */
+        bool parsed = false;
+        /** @brief True if the document is the cached upgrade of a legacy project. */
+        bool fromUpgradeCache = false;
+        QString sourceHash;
+        QString errorMsg;
+        int line = 0;
+        int col = 0;
+        /** @brief True if the document was already upgraded with DocumentValidator::upgradeDocument, see valid. */
+        bool validated = false;
+        bool valid = false;
+        /** @brief True if the upgrade modified the document. */
+        bool upgradeModified = false;
+        /** @brief Errors collected during the upgrade, shown when the document is opened. */
+        QStringList messages;
+    };
+
+    /** @brief Open or create a project.
+     *  @param projectFile the content of @param url if it was already read with readProjectFile, otherwise it is read here */
+    KdenliveDoc(const QUrl &url, const QString &projectFolder, QUndoGroup *undoGroup, const QString &profileName, const QMap<QString, QString> &properties, const QMap<QString, QString> &metadata, const QPoint &tracks, Render *render, NotesPlugin *notes, bool *openBackup, MainWindow *parent = nullptr, const ProjectFile *projectFile = nullptr);
     ~KdenliveDoc();
+    /** @brief Read and parse the project file @param path, reusing its upgrade cache if @param useUpgradeCache is set.
+     *  This does not touch any document and can run in a worker thread. */
+    static ProjectFile readProjectFile(const QString &path, bool useUpgradeCache);
     QDomNodeList producersList();
     double fps() const;
     int width() const;
@@ -149,6 +178,9 @@ public:
     QMap<QString, QString> documentProperties();
     bool useProxy() const;
     bool autoGenerateProxy(int width) const;
+    /** @brief Returns true if a clip decoding at @param decodeSpeed frames per second needs a proxy.
+     *  @param proxyWidth is set to the proxy width suited to the clip, or 0 to keep the encoding profile's size */
+    bool autoGenerateProxy(double decodeSpeed, int *proxyWidth) const;
     bool autoGenerateImageProxy(int width) const;
     QString documentNotes() const;
     /** @brief Saves effects embedded in project file. */
@@ -156,6 +188,8 @@ public:
     void resetProfile();
     /** @brief Force processing of clip id in producer queue. */
     void forceProcessing(const QString &id);
+    /** @brief Load the producers and thumbnails of clips @param ids before the other pending clips. */
+    void prioritizeClips(const QStringList &ids);
     void getFileProperties(const QDomElement &xml, const QString &clipId, int imageHeight, bool replaceProducer = true);
     /** @brief Returns true if the profile file has changed. */
     bool profileChanged(const QString &profile) const;
@@ -218,6 +252,17 @@ private:
     void cleanupBackupFiles();
     /** @brief Load document properties from the xml file */
     void loadDocumentProperties();
+    /** @brief Delete the cached rasters of titles that are not used by the project anymore. */
+    void pruneTitleRasters();
+    /** @brief Returns the file where the upgraded copy of a legacy project is cached.
+     *  The copy is stored next to the project, or in the user cache if the project folder is read only. */
+    static QString upgradeCachePath(const QString &projectFile);
+    /** @brief Key of the upgrade cache for the content of @param project and the running Kdenlive version. */
+    static QString upgradeCacheKey(QIODevice *project);
+    /** @brief Load in @param document the upgraded copy of a legacy project if it was made with the cache key @param sourceHash. */
+    static bool loadUpgradeCache(const QString &projectFile, const QString &sourceHash, QDomDocument &document);
+    /** @brief Store the upgraded document so that the next opening of @param projectFile can skip the upgrade. */
+    void saveUpgradeCache(const QString &projectFile, const QString &sourceHash) const;
     /** @brief update document properties to reflect a change in the current profile */
     void updateProjectProfile(bool reloadProducers = false);
 
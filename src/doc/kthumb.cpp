@@ -21,6 +21,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "kthumb.h"
 #include "kdenlivesettings.h"
+#include "core.h"
+#include "bin/bin.h"
+#include "titler/titlerastercache.h"
 
 #include <mlt++/Mlt.h>
 
@@ -77,6 +80,10 @@ QImage KThumb::getFrame(Mlt::Producer *producer, int framepos, int displayWidth,
         return p;
     }
 
+    QImage title = getTitleFrame(producer, framepos, displayWidth, height);
+    if (!title.isNull()) {
+        return title;
+    }
     producer->seek(framepos);
     Mlt::Frame *frame = producer->get_frame();
     const QImage p = getFrame(frame, displayWidth, height);
@@ -117,6 +124,31 @@ QImage KThumb::getFrame(Mlt::Frame *frame, int width, int height, bool forceResc
     return p;
 }
 
+//static
+QImage KThumb::getTitleFrame(Mlt::Producer *producer, int framepos, int width, int height)
+{
+    if (producer == nullptr || !producer->is_valid()) {
+        return QImage();
+    }
+    Mlt::Producer parent = producer->parent();
+    if (qstrcmp(parent.get("mlt_service"), "kdenlivetitle") != 0) {
+        return QImage();
+    }
+    const QString xmlData = QString::fromUtf8(parent.get("xmldata"));
+    if (xmlData.isEmpty() || pCore->bin() == nullptr) {
+        return QImage();
+    }
+    // Rasters are stored at profile size so that all thumbnail sizes share them
+    bool ok = false;
+    QDir titleFolder = pCore->bin()->getCacheDir(CacheTitles, &ok);
+    Mlt::Profile *profile = producer->profile();
+    QImage img = TitleRasterCache::image(titleFolder, xmlData, QSize(profile->width(), profile->height()), framepos, parent.get_length());
+    if (img.isNull()) {
+        return img;
+    }
+    return img.scaled(width, height, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+}
+
 //static
 uint KThumb::imageVariance(const QImage &image)
 {
@@ -39,6 +39,10 @@ QPixmap getImage(const QUrl &url, int width, int height = -1);
 QPixmap getImage(const QUrl &url, int frame, int width, int height = -1);
 QImage getFrame(Mlt::Producer *producer, int framepos, int displayWidth, int height);
 QImage getFrame(Mlt::Frame *frame, int width, int height, bool forceRescale = false);
+/** @brief Returns a title clip frame from the title raster cache.
+ *  @return a null image if the producer is not a title or the title cannot be cached, the frame should then be requested from the producer
+ * */
+QImage getTitleFrame(Mlt::Producer *producer, int framepos, int width, int height);
 /** @brief Calculates image variance, useful to know if a thumbnail is interesting.
  *  @return an integer between 0 and 100. 0 means no variance, eg. black image while bigger values mean contrasted image
  * */
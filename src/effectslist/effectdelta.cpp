@@ -0,0 +1,184 @@
+/*
+Copyright (C) 2018  Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "effectdelta.h"
+
+namespace {
+void collectElements(const QDomElement &element, QVector<QDomElement> &elements)
+{
+    elements.append(element);
+    for (QDomElement child = element.firstChildElement(); !child.isNull(); child = child.nextSiblingElement()) {
+        collectElements(child, elements);
+    }
+}
+
+/** @brief Returns true if both nodes only differ by their attributes. */
+bool sameStructure(const QDomNode &a, const QDomNode &b)
+{
+    if (a.nodeType() != b.nodeType()) {
+        return false;
+    }
+    if (a.isElement()) {
+        if (a.toElement().tagName() != b.toElement().tagName()) {
+            return false;
+        }
+    } else if (a.nodeValue() != b.nodeValue()) {
+        return false;
+    }
+    QDomNode childA = a.firstChild();
+    QDomNode childB = b.firstChild();
+    while (!childA.isNull() && !childB.isNull()) {
+        if (!sameStructure(childA, childB)) {
+            return false;
+        }
+        childA = childA.nextSibling();
+        childB = childB.nextSibling();
+    }
+    return childA.isNull() && childB.isNull();
+}
+}
+
+EffectDelta::EffectDelta()
+{
+}
+
+EffectDelta::EffectDelta(const QDomElement &oldEffect, const QDomElement &newEffect)
+{
+    if (!sameStructure(oldEffect, newEffect)) {
+        m_oldEffect = oldEffect.cloneNode().toElement();
+        m_newEffect = newEffect.cloneNode().toElement();
+        return;
+    }
+    QVector<QDomElement> before;
+    QVector<QDomElement> after;
+    collectElements(oldEffect, before);
+    collectElements(newEffect, after);
+    for (int i = 0; i < before.count(); ++i) {
+        const QDomElement &previous = before.at(i);
+        const QDomElement &current = after.at(i);
+        QDomNamedNodeMap attributes = previous.attributes();
+        for (int j = 0; j < attributes.count(); ++j) {
+            QDomAttr attribute = attributes.item(j).toAttr();
+            const bool exists = current.hasAttribute(attribute.name());
+            if (!exists || current.attribute(attribute.name()) != attribute.value()) {
+                AttributeChange change = {i, attribute.name(), attribute.value(), current.attribute(attribute.name()), true, exists};
+                m_changes.append(change);
+            }
+        }
+        attributes = current.attributes();
+        for (int j = 0; j < attributes.count(); ++j) {
+            QDomAttr attribute = attributes.item(j).toAttr();
+            if (!previous.hasAttribute(attribute.name())) {
+                AttributeChange change = {i, attribute.name(), QString(), attribute.value(), false, true};
+                m_changes.append(change);
+            }
+        }
+    }
+}
+
+bool EffectDelta::isEmpty() const
+{
+    return m_oldEffect.isNull() && m_changes.isEmpty();
+}
+
+QDomElement EffectDelta::newEffect(const QDomElement &current) const
+{
+    if (!m_newEffect.isNull()) {
+        return m_newEffect.cloneNode().toElement();
+    }
+    return apply(current, false);
+}
+
+QDomElement EffectDelta::oldEffect(const QDomElement &current) const
+{
+    if (!m_oldEffect.isNull()) {
+        return m_oldEffect.cloneNode().toElement();
+    }
+    return apply(current, true);
+}
+
+QDomElement EffectDelta::apply(const QDomElement &effect, bool previous) const
+{
+    if (effect.isNull()) {
+        return QDomElement();
+    }
+    QDomElement result = effect.cloneNode().toElement();
+    if (m_changes.isEmpty()) {
+        return result;
+    }
+    QVector<QDomElement> elements;
+    collectElements(result, elements);
+    for (const AttributeChange &change : m_changes) {
+        if (change.element >= elements.count()) {
+            continue;
+        }
+        QDomElement element = elements.at(change.element);
+        if (previous ? change.existed : change.exists) {
+            element.setAttribute(change.name, previous ? change.oldValue : change.newValue);
+        } else {
+            element.removeAttribute(change.name);
+        }
+    }
+    return result;
+}
+
+void EffectDelta::merge(const EffectDelta &next)
+{
+    if (!next.m_newEffect.isNull()) {
+        // Structure changed, element indexes are not valid anymore. The effect before the next edit is our new effect
+        if (m_newEffect.isNull()) {
+            m_oldEffect = apply(next.m_oldEffect, true);
+            m_changes.clear();
+        }
+        m_newEffect = next.m_newEffect;
+        return;
+    }
+    if (!m_newEffect.isNull()) {
+        m_newEffect = next.apply(m_newEffect, false);
+        return;
+    }
+    for (const AttributeChange &change : next.m_changes) {
+        bool known = false;
+        for (AttributeChange &existing : m_changes) {
+            if (existing.element == change.element && existing.name == change.name) {
+                existing.newValue = change.newValue;
+                existing.exists = change.exists;
+                known = true;
+                break;
+            }
+        }
+        if (!known) {
+            m_changes.append(change);
+        }
+    }
+    dropUnchanged();
+}
+
+void EffectDelta::dropUnchanged()
+{
+    for (int i = m_changes.count() - 1; i >= 0; --i) {
+        const AttributeChange &change = m_changes.at(i);
+        bool unchanged = change.existed == change.exists && (!change.exists || change.oldValue == change.newValue);
+        if (unchanged) {
+            m_changes.remove(i);
+        }
+    }
+}
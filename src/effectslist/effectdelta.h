@@ -0,0 +1,73 @@
+/*
+Copyright (C) 2018  Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef EFFECTDELTA_H
+#define EFFECTDELTA_H
+
+#include <QDomElement>
+#include <QVector>
+
+/**
+ * @class EffectDelta
+ * @brief Compact record of an effect edit, used by the undo commands.
+ *
+ * Only the attributes that changed (parameter values, keyframes, disable state...) are kept, with their
+ * value before and after the edit. The effect to apply is rebuilt from the effect currently set on the
+ * clip. Edits that change the effect structure keep a copy of the effect before and after the edit instead.
+ */
+class EffectDelta
+{
+public:
+    EffectDelta();
+    EffectDelta(const QDomElement &oldEffect, const QDomElement &newEffect);
+    /** @brief Returns true if the edit did not change anything. */
+    bool isEmpty() const;
+    /** @brief Returns the effect after the edit, built from @param current, the effect as it is now. */
+    QDomElement newEffect(const QDomElement &current) const;
+    /** @brief Returns the effect before the edit, built from @param current, the effect as it is now. */
+    QDomElement oldEffect(const QDomElement &current) const;
+    /** @brief Appends the edit @param next, which must start from our new effect.
+     *  Our previous values are kept and the new values of @param next are used. */
+    void merge(const EffectDelta &next);
+
+private:
+    struct AttributeChange {
+        /** @brief Index of the element in document order, 0 being the effect itself. */
+        int element;
+        QString name;
+        QString oldValue;
+        QString newValue;
+        /** @brief False if the attribute did not exist before the edit. */
+        bool existed;
+        /** @brief False if the edit removed the attribute. */
+        bool exists;
+    };
+    /** @brief Copies of the effect before and after the edit, only used when the edit changed the effect structure. */
+    QDomElement m_oldEffect;
+    QDomElement m_newEffect;
+    QVector<AttributeChange> m_changes;
+    /** @brief Returns a copy of @param effect with the old or new value of each changed attribute. */
+    QDomElement apply(const QDomElement &effect, bool previous) const;
+    /** @brief Removes the changes that were reverted by a later edit. */
+    void dropUnchanged();
+};
+
+#endif
@@ -17,39 +17,42 @@
 
 #include "gentime.h"
 
-double GenTime::s_delta = 0.00001;
-
 GenTime::GenTime()
 {
-    m_time = 0.0;
+    m_ticks = 0;
 }
 
 GenTime::GenTime(double seconds)
 {
-    m_time = seconds;
+    m_ticks = qRound64(seconds * TicksPerSecond);
 }
 
 GenTime::GenTime(int frames, double framesPerSecond)
 {
-    m_time = (double) frames / framesPerSecond;
+    m_ticks = qRound64(frames * (TicksPerSecond / framesPerSecond));
 }
 
 double GenTime::seconds() const
 {
-    return m_time;
+    return (double) m_ticks / TicksPerSecond;
 }
 
 double GenTime::ms() const
 {
-    return m_time * 1000;
+    return (double) m_ticks * 1000 / TicksPerSecond;
 }
 
 double GenTime::frames(double framesPerSecond) const
 {
-    return floor(m_time * framesPerSecond + 0.5);
+    return floor((double) m_ticks * framesPerSecond / TicksPerSecond + 0.5);
+}
+
+qint64 GenTime::ticks() const
+{
+    return m_ticks;
 }
 
 QString GenTime::toString() const
 {
-    return QStringLiteral("%1 s").arg(m_time, 0, 'f', 2);
+    return QStringLiteral("%1 s").arg(seconds(), 0, 'f', 2);
 }
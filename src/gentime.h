@@ -19,6 +19,7 @@
 #define GENTIME_H
 
 #include <QString>
+#include <QtGlobal>
 #include <cmath>
 
 /**
@@ -27,9 +28,20 @@
  * @author Jason Wood
  */
 
+/** @class GenTime
+ *  @brief A timeline position or duration.
+ *
+ *  Time is stored as an integer count of ticks, with TicksPerSecond chosen so
+ *  that one frame is a whole number of ticks for all usual frame rates,
+ *  including the NTSC ones (23.976, 29.97, 59.94). Frame conversions are thus
+ *  exact and comparisons are plain integer operations.
+ */
 class GenTime
 {
 public:
+    /** @brief Number of ticks in one second. */
+    static const qint64 TicksPerSecond = 705600000;
+
     /** @brief Creates a GenTime object, with a time of 0 seconds. */
     GenTime();
 
@@ -49,6 +61,9 @@ public:
     * @param framesPerSecond Number of frames per second */
     double frames(double framesPerSecond) const;
 
+    /** @brief Gets the time in ticks, see TicksPerSecond. */
+    qint64 ticks() const;
+
     QString toString() const;
 
     /*
@@ -58,83 +73,90 @@ public:
     /// Unary minus
     GenTime operator -()
     {
-        return GenTime(-m_time);
+        return fromTicks(-m_ticks);
     }
 
     /// Addition
     GenTime &operator+=(GenTime op)
     {
-        m_time += op.m_time;
+        m_ticks += op.m_ticks;
         return *this;
     }
 
     /// Subtraction
     GenTime &operator-=(GenTime op)
     {
-        m_time -= op.m_time;
+        m_ticks -= op.m_ticks;
         return *this;
     }
 
     /** @brief Adds two GenTimes. */
     GenTime operator+(GenTime op) const
     {
-        return GenTime(m_time + op.m_time);
+        return fromTicks(m_ticks + op.m_ticks);
     }
 
     /** @brief Subtracts one genTime from another. */
     GenTime operator-(GenTime op) const
     {
-        return GenTime(m_time - op.m_time);
+        return fromTicks(m_ticks - op.m_ticks);
     }
 
     /** @brief Multiplies one GenTime by a double value, returning a GenTime. */
     GenTime operator*(double op) const
     {
-        return GenTime(m_time * op);
+        return fromTicks(qRound64((double) m_ticks * op));
     }
 
     /** @brief Divides one GenTime by a double value, returning a GenTime. */
     GenTime operator/(double op) const
     {
-        return GenTime(m_time / op);
+        return fromTicks(qRound64((double) m_ticks / op));
     }
 
     bool operator<(GenTime op) const
     {
-        return m_time + s_delta < op.m_time;
+        return m_ticks + s_delta < op.m_ticks;
     }
 
     bool operator>(GenTime op) const
     {
-        return m_time > op.m_time + s_delta;
+        return m_ticks > op.m_ticks + s_delta;
     }
 
     bool operator>=(GenTime op) const
     {
-        return m_time + s_delta >= op.m_time;
+        return m_ticks + s_delta >= op.m_ticks;
     }
 
     bool operator<=(GenTime op) const
     {
-        return m_time <= op.m_time + s_delta;
+        return m_ticks <= op.m_ticks + s_delta;
     }
 
     bool operator==(GenTime op) const
     {
-        return fabs(m_time - op.m_time) < s_delta;
+        return qAbs(m_ticks - op.m_ticks) < s_delta;
     }
 
     bool operator!=(GenTime op) const
     {
-        return fabs(m_time - op.m_time) >= s_delta;
+        return qAbs(m_ticks - op.m_ticks) >= s_delta;
     }
 
 private:
-    /** Holds the time in seconds for this object. */
-    double m_time;
+    /** Holds the time in ticks for this object. */
+    qint64 m_ticks;
 
-    /** A delta value that is used to get around floating point rounding issues. */
-    static double s_delta;
+    /** A delta value (10 microseconds) that absorbs rounding of times given in seconds. */
+    static const qint64 s_delta = TicksPerSecond / 100000;
+
+    static GenTime fromTicks(qint64 ticks)
+    {
+        GenTime t;
+        t.m_ticks = ticks;
+        return t;
+    }
 };
 
 #endif
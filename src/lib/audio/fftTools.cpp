@@ -31,7 +31,7 @@ FFTTools::FFTTools() :
 }
 FFTTools::~FFTTools()
 {
-    QHash<QString, kiss_fftr_cfg>::iterator i;
+    QHash<uint, kiss_fftr_cfg>::iterator i;
     for (i = m_fftCfgs.begin(); i != m_fftCfgs.end(); ++i) {
         free(*i);
     }
@@ -45,6 +45,11 @@ const QString FFTTools::cfgSignature(const int size)
 {
     return QStringLiteral("s%1").arg(size);
 }
+quint64 FFTTools::windowKey(const WindowType windowType, const uint size, const float param)
+{
+    // Cheaper than windowSignature() for the cache lookup done with every FFT
+    return ((quint64) size << 32) | ((quint64) windowType << 24) | ((quint64) qRound(param * 1000) & 0xffffff);
+}
 
 // http://cplusplus.syntaxerrors.info/index.php?title=Cannot_declare_member_function_%E2%80%98static_int_Foo::bar%28%29%E2%80%99_to_have_static_linkage
 const QVector<float> FFTTools::window(const WindowType windowType, const int size, const float param)
@@ -113,19 +118,23 @@ const QVector<float> FFTTools::window(const WindowType windowType, const int siz
 
 void FFTTools::fftNormalized(const audioShortVector &audioFrame, const uint channel, const uint numChannels, float *freqSpectrum,
                              const WindowType windowType, const uint windowSize, const float param)
+{
+    fftNormalized(audioFrame.constData(), audioFrame.size() / numChannels, channel, numChannels, freqSpectrum, windowType, windowSize, param);
+}
+
+void FFTTools::fftNormalized(const qint16 *audio, const uint numSamples, const uint channel, const uint numChannels, float *freqSpectrum,
+                             const WindowType windowType, const uint windowSize, const float param)
 {
 #ifdef DEBUG_FFTTOOLS
     QTime start = QTime::currentTime();
 #endif
 
-    const uint numSamples = audioFrame.size() / numChannels;
-
     if (windowSize & 1 || windowSize < 2) {
         return;
     }
 
-    const QString cfgSig = cfgSignature(windowSize);
-    const QString winSig = windowSignature(windowType, windowSize, param);
+    const uint cfgSig = windowSize;
+    const quint64 winSig = windowKey(windowType, windowSize, param);
 
     // Get the kiss_fft configuration from the config cache
     // or build a new configuration if the requested one is not available.
@@ -179,9 +188,9 @@ void FFTTools::fftNormalized(const audioShortVector &audioFrame, const uint chan
         // does not do noticeable worse than keeping it outside (perhaps the branch predictor
         // is good enough), so it remains in there for better readability.
         if (windowType != FFTTools::Window_Rect) {
-            data[i] = (float) audioFrame.data()[i * numChannels + channel] / 32767.0f * window[i];
+            data[i] = (float) audio[i * numChannels + channel] / 32767.0f * window[i];
         } else {
-            data[i] = (float) audioFrame.data()[i * numChannels + channel] / 32767.0f;
+            data[i] = (float) audio[i * numChannels + channel] / 32767.0f;
         }
     }
 
@@ -226,19 +235,24 @@ void FFTTools::fftNormalized(const audioShortVector &audioFrame, const uint chan
 }
 
 const QVector<float> FFTTools::interpolatePeakPreserving(const QVector<float> &in, const uint targetSize, uint left, uint right, float fill)
+{
+    QVector<float> out(targetSize);
+    interpolatePeakPreserving(in.constData(), in.size(), out.data(), targetSize, left, right, fill);
+    return out;
+}
+
+void FFTTools::interpolatePeakPreserving(const float *in, const uint inSize, float *out, const uint targetSize, uint left, uint right, float fill)
 {
 #ifdef DEBUG_FFTTOOLS
     QTime start = QTime::currentTime();
 #endif
 
     if (right == 0) {
-        right = in.size() - 1;
+        right = inSize - 1;
     }
     Q_ASSERT(targetSize > 0);
     Q_ASSERT(left < right);
 
-    QVector<float> out(targetSize);
-
     float x;
     uint xi;
     uint i;
@@ -254,14 +268,14 @@ const QVector<float> FFTTools::interpolatePeakPreserving(const QVector<float> &i
             x = ((float) i) / (targetSize - 1) * (right - left) + left;
             xi = (int) floor(x);
 
-            if (x > in.size() - 1) {
-                // This may happen if right > in.size()-1; Fill the rest of the vector
+            if (x > inSize - 1) {
+                // This may happen if right > inSize-1; Fill the rest of the vector
                 // with the default value now.
                 break;
             }
 
             // Use linear interpolation in order to get smoother display
-            if (xi == 0 || xi == (uint) in.size() - 1) {
+            if (xi == 0 || xi == inSize - 1) {
                 // ... except if we are at the left or right border of the input sigal.
                 // Special case here since we consider previous and future values as well for
                 // the actual interpolation (not possible here).
@@ -297,7 +311,7 @@ const QVector<float> FFTTools::interpolatePeakPreserving(const QVector<float> &i
 
             out[i] = fill;
 
-            for (; src < xi && src < (uint) in.size(); ++src) {
+            for (; src < xi && src < inSize; ++src) {
                 if (out[i] < in[src]) {
                     out[i] = in[src];
                 }
@@ -313,10 +327,8 @@ const QVector<float> FFTTools::interpolatePeakPreserving(const QVector<float> &i
     }
 
 #ifdef DEBUG_FFTTOOLS
-    qCDebug(KDENLIVE_LOG) << "Interpolated " << targetSize << " nodes from " << in.size() << " input points in " << start.elapsed() << " ms";
+    qCDebug(KDENLIVE_LOG) << "Interpolated " << targetSize << " nodes from " << inSize << " input points in " << start.elapsed() << " ms";
 #endif
-
-    return out;
 }
 
 #ifdef DEBUG_FFTTOOLS
@@ -56,6 +56,9 @@ public:
     */
     void fftNormalized(const audioShortVector &audioFrame, const uint channel, const uint numChannels, float *freqSpectrum,
                        const WindowType windowType, const uint windowSize, const float param = 0);
+    /** Same as above for @p numSamples interleaved samples in a plain buffer, e.g. the tail of a longer history. */
+    void fftNormalized(const qint16 *audio, const uint numSamples, const uint channel, const uint numChannels, float *freqSpectrum,
+                       const WindowType windowType, const uint windowSize, const float param = 0);
 
     /** This is linear interpolation with the special property that it preserves peaks, which is required
         for e.g. showing correct Decibel values (where the peak values are of interest because of clipping which
@@ -72,10 +75,14 @@ public:
                             will be used for filling the missing information.
         */
     static const QVector<float> interpolatePeakPreserving(const QVector<float> &in, const uint targetSize, uint left = 0, uint right = 0, float fill = 0.0);
+    /** Same as above, but reads @p inSize values from @p in and writes @p targetSize values to @p out
+        without allocating, for callers keeping their data in preallocated buffers. */
+    static void interpolatePeakPreserving(const float *in, const uint inSize, float *out, const uint targetSize, uint left = 0, uint right = 0, float fill = 0.0);
 
 private:
-    QHash<QString, kiss_fftr_cfg> m_fftCfgs; // FFT cfg cache
-    QHash<QString, QVector<float> > m_windowFunctions; // Window function cache
+    QHash<uint, kiss_fftr_cfg> m_fftCfgs; // FFT cfg cache, by window size
+    QHash<quint64, QVector<float> > m_windowFunctions; // Window function cache, see windowKey()
+    static quint64 windowKey(const WindowType windowType, const uint size, const float param);
 
 };
 
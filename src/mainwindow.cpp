@@ -63,6 +63,7 @@
 #include <config-kdenlive.h>
 #include "utils/thememanager.h"
 #include "utils/progressbutton.h"
+#include "utils/tracer.h"
 #include "effectslist/effectslistwidget.h"
 #include "profiles/profilerepository.hpp"
 
@@ -797,6 +798,10 @@ MainWindow::~MainWindow()
 //virtual
 bool MainWindow::queryClose()
 {
+    if (pCore->projectManager()->isLoading()) {
+        // Wait until the project is set up
+        return false;
+    }
     if (m_renderWidget) {
         int waitingJobs = m_renderWidget->waitingJobsCount();
         if (waitingJobs > 0) {
@@ -1258,6 +1263,11 @@ void MainWindow::setupActions()
     KNS3::standardAction(i18n("Download New Title Templates..."),  this, SLOT(slotGetNewTitleStuff()),      actionCollection(), "get_new_titles");
 
     addAction(QStringLiteral("run_wizard"), i18n("Run Config Wizard"), this, SLOT(slotRunWizard()), KoIconUtils::themedIcon(QStringLiteral("tools-wizard")));
+    QAction *traceAction = new QAction(i18n("Record Performance Trace"), this);
+    traceAction->setCheckable(true);
+    addAction(QStringLiteral("record_trace"), traceAction);
+    connect(traceAction, &QAction::toggled, this, &MainWindow::setTracing);
+    addAction(QStringLiteral("save_trace"), i18n("Save Performance Trace..."), this, SLOT(slotSaveTrace()));
     addAction(QStringLiteral("project_settings"), i18n("Project Settings"), this, SLOT(slotEditProjectSettings()), KoIconUtils::themedIcon(QStringLiteral("configure")));
 
     addAction(QStringLiteral("project_render"), i18n("Render"), this, SLOT(slotRenderProject()), KoIconUtils::themedIcon(QStringLiteral("media-record")), Qt::CTRL + Qt::Key_Return);
@@ -1673,6 +1683,32 @@ void MainWindow::slotRunWizard()
     delete w;
 }
 
+void MainWindow::setTracing(bool enable)
+{
+    Tracer::setEnabled(enable);
+    QAction *traceAction = actionCollection()->action(QStringLiteral("record_trace"));
+    if (traceAction && traceAction->isChecked() != enable) {
+        QSignalBlocker blocker(traceAction);
+        traceAction->setChecked(enable);
+    }
+}
+
+bool MainWindow::saveTrace(const QString &path)
+{
+    if (pCore->projectManager()->isLoading()) {
+        return false;
+    }
+    return Tracer::exportTrace(path);
+}
+
+void MainWindow::slotSaveTrace()
+{
+    const QString path = QFileDialog::getSaveFileName(this, i18n("Save Performance Trace"), QDir::homePath(), i18n("Chrome Trace (*.json)"));
+    if (!path.isEmpty() && !saveTrace(path)) {
+        KMessageBox::sorry(this, i18n("Cannot write to file %1", path));
+    }
+}
+
 void MainWindow::slotRefreshProfiles()
 {
     KdenliveSettingsDialog *d = static_cast <KdenliveSettingsDialog *>(KConfigDialog::exists(QStringLiteral("settings")));
@@ -1816,6 +1852,7 @@ void MainWindow::slotRenderProject()
             connect(m_renderWidget, &RenderWidget::prepareRenderingData, this, &MainWindow::slotPrepareRendering);
             connect(m_renderWidget, &RenderWidget::abortProcess, this, &MainWindow::abortRenderJob);
             connect(m_renderWidget, &RenderWidget::openDvdWizard, this, &MainWindow::slotDvdWizard);
+            connect(m_renderWidget, &RenderWidget::renderProgress, this, &MainWindow::setRenderProgress);
             m_renderWidget->setProfile(project->mltProfile().path);
             m_renderWidget->setGuides(pCore->projectManager()->currentTimeline()->projectView()->guidesData(), project->projectDuration());
             m_renderWidget->setDocumentPath(project->projectDataFolder());
@@ -1845,23 +1882,26 @@ void MainWindow::slotCheckRenderStatus()
 
 void MainWindow::setRenderingProgress(const QString &url, int progress)
 {
-    emit setRenderProgress(progress);
     if (m_renderWidget) {
+        // The render widget combines the progress of all running jobs
         m_renderWidget->setRenderJob(url, progress);
+    } else {
+        emit setRenderProgress(progress);
     }
 }
 
 void MainWindow::setRenderingFinished(const QString &url, int status, const QString &error)
 {
-    emit setRenderProgress(100);
     if (m_renderWidget) {
         m_renderWidget->setRenderStatus(url, status, error);
+    } else {
+        emit setRenderProgress(100);
     }
 }
 
 void MainWindow::addProjectClip(const QString &url)
 {
-    if (pCore->projectManager()->current()) {
+    if (pCore->projectManager()->current() && !pCore->projectManager()->isLoading()) {
         QStringList ids = pCore->binController()->getBinIdsByResource(QFileInfo(url));
         if (!ids.isEmpty()) {
             // Clip is already in project bin, abort
@@ -1873,7 +1913,7 @@ void MainWindow::addProjectClip(const QString &url)
 
 void MainWindow::addTimelineClip(const QString &url)
 {
-    if (pCore->projectManager()->current()) {
+    if (pCore->projectManager()->current() && !pCore->projectManager()->isLoading()) {
         QStringList ids = pCore->binController()->getBinIdsByResource(QFileInfo(url));
         if (!ids.isEmpty()) {
             pCore->bin()->selectClipById(ids.constFirst());
@@ -1884,6 +1924,9 @@ void MainWindow::addTimelineClip(const QString &url)
 
 void MainWindow::addEffect(const QString &effectName)
 {
+    if (pCore->projectManager()->isLoading()) {
+        return;
+    }
     QStringList effectInfo;
     effectInfo << effectName << effectName;
     const QDomElement effect = EffectsListWidget::itemEffect(5, effectInfo);
@@ -1897,6 +1940,9 @@ void MainWindow::addEffect(const QString &effectName)
 
 void MainWindow::scriptRender(const QString &url)
 {
+    if (pCore->projectManager()->isLoading()) {
+        return;
+    }
     slotRenderProject();
     m_renderWidget->slotPrepareExport(true, url);
 }
@@ -3236,17 +3282,10 @@ void MainWindow::buildDynamicActions()
             break;
         }
     }
-    filter.reset(new Mlt::Filter(profile, "motion_est"));
-    if (filter) {
-        if (filter->is_valid()) {
-            QAction *action = new QAction(i18n("Automatic scene split"), m_extraFactory->actionCollection());
-            QStringList stabJob;
-            stabJob << QString::number((int) AbstractClipJob::FILTERCLIPJOB) << QStringLiteral("motion_est");
-            action->setData(stabJob);
-            ts->addAction(action->text(), action);
-            connect(action, &QAction::triggered, pCore->bin(), &Bin::slotStartClipJob);
-        }
-    }
+    QAction *splitAction = new QAction(i18n("Automatic scene split"), m_extraFactory->actionCollection());
+    splitAction->setData(QStringList() << QString::number((int) AbstractClipJob::FILTERCLIPJOB) << QStringLiteral("scenesplit"));
+    ts->addAction(splitAction->text(), splitAction);
+    connect(splitAction, &QAction::triggered, pCore->bin(), &Bin::slotStartClipJob);
     if (KdenliveSettings::producerslist().contains(QStringLiteral("timewarp"))) {
         QAction *action = new QAction(i18n("Duplicate clip with speed change"), m_extraFactory->actionCollection());
         QStringList stabJob;
@@ -3562,6 +3601,12 @@ void MainWindow::slotPrepareRendering(bool scriptExport, bool zoneOnly, const QS
         }
     }
 
+    // Reuse up to date timeline preview chunks if they were encoded like the output
+    if (!stemExport && m_renderWidget->reusePreviewChunks(project->getDocumentProperty(QStringLiteral("previewparameters")), project->useProxy())) {
+        int chunks = pCore->projectManager()->currentTimeline()->addPreviewChunks(doc);
+        qCDebug(KDENLIVE_LOG) << "Render reuses " << chunks << " timeline preview chunks";
+    }
+
     QList<QDomDocument> docList;
 
     // check which audio tracks have to be exported
@@ -253,6 +253,10 @@ public slots:
     Q_SCRIPTABLE void addTimelineClip(const QString &url);
     Q_SCRIPTABLE void addEffect(const QString &effectName);
     Q_SCRIPTABLE void scriptRender(const QString &url);
+    /** @brief Start or stop recording the performance trace points. */
+    Q_SCRIPTABLE void setTracing(bool enable);
+    /** @brief Save the recorded trace points to @param path in the Chrome trace format, fails while a project is loading. */
+    Q_SCRIPTABLE bool saveTrace(const QString &path);
     Q_NOREPLY void exitApp();
 
     void slotSwitchVideoThumbs();
@@ -383,6 +387,7 @@ private slots:
     void slotGetNewRenderStuff();
     void slotAutoTransition();
     void slotRunWizard();
+    void slotSaveTrace();
     void slotZoneMoved(int start, int end);
     void slotDvdWizard(const QString &url = QString());
     void slotGroupClips();
@@ -784,7 +784,7 @@ void ClipController::changeEffectState(const QList<int> &indexes, bool disable)
     m_binController->updateTrackProducer(clipId());
 }
 
-void ClipController::updateEffect(const ProfileInfo &pInfo, const QDomElement &e, int ix, bool updateClip)
+void ClipController::updateEffect(const ProfileInfo &pInfo, const QDomElement &e, int ix, bool updateClip, const QDomElement &previous)
 {
     QString tag = e.attribute(QStringLiteral("id"));
     if (tag == QLatin1String("autotrack_rectangle") || tag.startsWith(QLatin1String("ladspa")) || tag == QLatin1String("sox")) {
@@ -795,6 +795,9 @@ void ClipController::updateEffect(const ProfileInfo &pInfo, const QDomElement &e
         return;
     }
     EffectsParameterList params = EffectsController::getEffectArgs(pInfo, e);
+    if (!previous.isNull()) {
+        params = params.changedParams(EffectsController::getEffectArgs(pInfo, previous));
+    }
     Mlt::Service service = m_masterProducer->parent();
     for (int i = 0; i < service.filter_count(); ++i) {
         QScopedPointer<Mlt::Filter> effect(service.filter(i));
@@ -174,7 +174,8 @@ public:
     EffectsList effectList();
     /** @brief Enable/disable an effect. */
     void changeEffectState(const QList<int> &indexes, bool disable);
-    void updateEffect(const ProfileInfo &pInfo, const QDomElement &e, int ix, bool updateClip);
+    /** @brief Update an effect's filter. If @param previous is the currently applied effect, only the changed properties are set. */
+    void updateEffect(const ProfileInfo &pInfo, const QDomElement &e, int ix, bool updateClip, const QDomElement &previous = QDomElement());
     /** @brief Returns true if the bin clip has effects */
     bool hasEffects() const;
     /** @brief Returns info about clip audio */
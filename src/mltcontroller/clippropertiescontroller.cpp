@@ -28,6 +28,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "effectstack/widgets/choosecolorwidget.h"
 #include "dialogs/profilesdialog.h"
 #include "utils/KoIconUtils.h"
+#include "core.h"
+#include "bin/bin.h"
+#include "bin/analysisstore.h"
 
 #include <KLocalizedString>
 
@@ -1082,8 +1085,21 @@ void ClipPropertiesController::slotFillAnalysisData()
     Mlt::Properties subProperties;
     subProperties.pass_values(m_properties, "kdenlive:clipanalysis.");
     if (subProperties.count() > 0) {
+        AnalysisStore *store = pCore->bin()->analysisStore();
         for (int i = 0; i < subProperties.count(); i++) {
-            new QTreeWidgetItem(m_analysisTree, QStringList() << subProperties.get_name(i) << subProperties.get(i));
+            const QString value = QString::fromUtf8(subProperties.get(i));
+            QString display = value;
+            if (AnalysisStore::isReference(value)) {
+                // Side-car data can be huge, only show a summary
+                if (AnalysisStore::filePath(value).isEmpty()) {
+                    display = i18n("Missing analysis file");
+                } else {
+                    int count = store->keyframeCount(value);
+                    display = count > 0 ? i18np("%1 keyframe", "%1 keyframes", count) : i18n("Analysis data");
+                }
+            }
+            QTreeWidgetItem *item = new QTreeWidgetItem(m_analysisTree, QStringList() << subProperties.get_name(i) << display);
+            item->setData(1, Qt::UserRole, value);
         }
     }
     m_analysisTree->resizeColumnToContents(0);
@@ -1107,7 +1123,7 @@ void ClipPropertiesController::slotSaveAnalysis()
     KSharedConfigPtr config = KSharedConfig::openConfig(url, KConfig::SimpleConfig);
     KConfigGroup analysisConfig(config, "Analysis");
     QTreeWidgetItem *current = m_analysisTree->currentItem();
-    analysisConfig.writeEntry(current->text(0), current->text(1));
+    analysisConfig.writeEntry(current->text(0), pCore->bin()->analysisStore()->text(current->data(1, Qt::UserRole).toString()));
 }
 
 void ClipPropertiesController::slotLoadAnalysis()
@@ -117,6 +117,18 @@ void EffectsParameterList::removeParam(const QString &name)
         }
 }
 
+EffectsParameterList EffectsParameterList::changedParams(const EffectsParameterList &previous) const
+{
+    EffectsParameterList changed;
+    for (int i = 0; i < size(); ++i) {
+        const EffectParameter &param = at(i);
+        if (!previous.hasParam(param.name()) || previous.paramValue(param.name()) != param.value()) {
+            changed.append(param);
+        }
+    }
+    return changed;
+}
+
 EffectsParameterList EffectsController::getEffectArgs(const ProfileInfo &info, const QDomElement &effect)
 {
     EffectsParameterList parameters;
@@ -79,6 +79,8 @@ public:
     QString paramValue(const QString &name, const QString &defaultValue = QString()) const;
     void addParam(const QString &name, const QString &value);
     void removeParam(const QString &name);
+    /** @brief Returns the parameters that are missing or have a different value in @param previous. */
+    EffectsParameterList changedParams(const EffectsParameterList &previous) const;
 };
 
 /**
@@ -28,6 +28,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "dialogs/profilesdialog.h"
 #include "project/dialogs/slideshowclip.h"
 #include "timeline/clip.h"
+#include "utils/tracer.h"
+#include "titler/titlerastercache.h"
+#include "core.h"
+#include "bin/bin.h"
 
 #include <QtConcurrent>
 
@@ -109,6 +113,21 @@ void ProducerQueue::forceProcessing(const QString &id)
     }
 }
 
+void ProducerQueue::prioritize(const QStringList &ids)
+{
+    QMutexLocker lock(&m_infoMutex);
+    QList<requestClipInfo> priority;
+    for (int i = 0; i < m_requestList.count(); ++i) {
+        if (ids.contains(m_requestList.at(i).clipId)) {
+            priority << m_requestList.takeAt(i);
+            --i;
+        }
+    }
+    if (!priority.isEmpty()) {
+        m_requestList = priority + m_requestList;
+    }
+}
+
 void ProducerQueue::slotProcessingDone(const QString &id)
 {
     QMutexLocker lock(&m_infoMutex);
@@ -136,6 +155,7 @@ void ProducerQueue::processFileProperties()
     locale.setNumberOptions(QLocale::OmitGroupSeparator);
     bool forceThumbScale = m_binController->profile()->sar() != 1;
     while (!m_requestList.isEmpty()) {
+        KDENLIVE_TRACE("producerqueue", "Load clip");
         m_infoMutex.lock();
         info = m_requestList.takeFirst();
         if (info.xml.hasAttribute(QStringLiteral("thumbnailOnly")) || info.xml.hasAttribute(QStringLiteral("refreshOnly"))) {
@@ -145,6 +165,18 @@ void ProducerQueue::processFileProperties()
             if (!prod || !prod->is_valid()) {
                 continue;
             }
+            int fullWidth = info.imageHeight * m_binController->profile()->dar() + 0.5;
+            int frameNumber = ProjectClip::getXmlProperty(info.xml, QStringLiteral("kdenlive:thumbnailFrame"), QStringLiteral("-1")).toInt();
+            QImage titleImg = KThumb::getTitleFrame(prod, qMax(0, frameNumber), fullWidth, info.imageHeight);
+            if (!titleImg.isNull()) {
+                emit replyGetImage(info.clipId, titleImg);
+                delete prod;
+                if (info.xml.hasAttribute(QStringLiteral("refreshOnly"))) {
+                    // inform timeline about change
+                    emit refreshTimelineProducer(info.clipId);
+                }
+                continue;
+            }
             // Check if we are using GPU accel, then we need to use alternate producer
             if (KdenliveSettings::gpu_accel()) {
                 QString service = prod->get("mlt_service");
@@ -156,13 +188,11 @@ void ProducerQueue::processFileProperties()
                 prod->attach(scaler);
                 prod->attach(converter);
             }
-            int frameNumber = ProjectClip::getXmlProperty(info.xml, QStringLiteral("kdenlive:thumbnailFrame"), QStringLiteral("-1")).toInt();
             if (frameNumber > 0) {
                 prod->seek(frameNumber);
             }
             Mlt::Frame *frame = prod->get_frame();
             if (frame && frame->is_valid()) {
-                int fullWidth = info.imageHeight * m_binController->profile()->dar() + 0.5;
                 QImage img = KThumb::getFrame(frame, fullWidth, info.imageHeight, forceThumbScale);
                 emit replyGetImage(info.clipId, img);
             }
@@ -219,8 +249,25 @@ void ProducerQueue::processFileProperties()
             path.prepend(QStringLiteral("color:"));
             producer = new Mlt::Producer(*m_binController->profile(), nullptr, path.toUtf8().constData());
         } else if (type == Text || type == TextTemplate) {
-            path.prepend(QStringLiteral("kdenlivetitle:"));
-            producer = new Mlt::Producer(*m_binController->profile(), nullptr, path.toUtf8().constData());
+            // Static titles play their cached raster instead of rendering the title scene on every frame
+            const QString raster = type == Text ? titleRaster(info.xml) : QString();
+            if (!raster.isEmpty()) {
+                producer = new Mlt::Producer(*m_binController->profile(), "qimage", raster.toUtf8().constData());
+                if (!producer->is_valid()) {
+                    delete producer;
+                    producer = nullptr;
+                }
+            }
+            if (producer) {
+                // Keep the title identity so that the project still saves and edits a title clip
+                producer->set("mlt_service", "kdenlivetitle");
+                producer->set("resource", path.toUtf8().constData());
+                producer->set("force_aspect_ratio", m_binController->profile()->sar());
+                producer->set("_titleraster", raster.toUtf8().constData());
+            } else {
+                path.prepend(QStringLiteral("kdenlivetitle:"));
+                producer = new Mlt::Producer(*m_binController->profile(), nullptr, path.toUtf8().constData());
+            }
         } else if (type == QText) {
             path.prepend(QStringLiteral("qtext:"));
             producer = new Mlt::Producer(*m_binController->profile(), nullptr, path.toUtf8().constData());
@@ -673,20 +720,22 @@ void ProducerQueue::processFileProperties()
         if (frame && frame->is_valid()) {
             if (!mltService.contains(QStringLiteral("avformat"))) {
                 // Fetch thumbnail
-                QImage img;
-                if (KdenliveSettings::gpu_accel()) {
-                    delete frame;
-                    Clip clp(*producer);
-                    Mlt::Producer *glProd = clp.softClone(ClipController::getPassPropertiesList());
-                    Mlt::Filter scaler(*m_binController->profile(), "swscale");
-                    Mlt::Filter converter(*m_binController->profile(), "avcolor_space");
-                    glProd->attach(scaler);
-                    glProd->attach(converter);
-                    frame = glProd->get_frame();
-                    img = KThumb::getFrame(frame, fullWidth, info.imageHeight);
-                    delete glProd;
-                } else {
-                    img = KThumb::getFrame(frame, fullWidth, info.imageHeight, forceThumbScale);
+                QImage img = KThumb::getTitleFrame(producer, 0, fullWidth, info.imageHeight);
+                if (img.isNull()) {
+                    if (KdenliveSettings::gpu_accel()) {
+                        delete frame;
+                        Clip clp(*producer);
+                        Mlt::Producer *glProd = clp.softClone(ClipController::getPassPropertiesList());
+                        Mlt::Filter scaler(*m_binController->profile(), "swscale");
+                        Mlt::Filter converter(*m_binController->profile(), "avcolor_space");
+                        glProd->attach(scaler);
+                        glProd->attach(converter);
+                        frame = glProd->get_frame();
+                        img = KThumb::getFrame(frame, fullWidth, info.imageHeight);
+                        delete glProd;
+                    } else {
+                        img = KThumb::getFrame(frame, fullWidth, info.imageHeight, forceThumbScale);
+                    }
                 }
                 emit replyGetImage(info.clipId, img);
             } else {
@@ -854,6 +903,21 @@ void ProducerQueue::abortOperations()
     m_infoThread.waitForFinished();
 }
 
+QString ProducerQueue::titleRaster(const QDomElement &xml) const
+{
+    const QString xmlData = ProjectClip::getXmlProperty(xml, QStringLiteral("xmldata"));
+    if (xmlData.isEmpty() || pCore->bin() == nullptr) {
+        return QString();
+    }
+    bool ok = false;
+    QDir titleFolder = pCore->bin()->getCacheDir(CacheTitles, &ok);
+    if (!ok) {
+        return QString();
+    }
+    Mlt::Profile *profile = m_binController->profile();
+    return TitleRasterCache::rasterFile(titleFolder, xmlData, QSize(profile->width(), profile->height()));
+}
+
 ClipType ProducerQueue::getTypeForService(const QString &id, const QString &path) const
 {
     if (id.isEmpty()) {
@@ -54,6 +54,8 @@ public:
     void forceProcessing(const QString &id);
     /** @brief Are we currently processing clip with selected id. */
     bool isProcessing(const QString &id);
+    /** @brief Move the pending requests for clips @param ids to the front of the queue. */
+    void prioritize(const QStringList &ids);
     /** @brief Make sure to close running threads before closing document */
     void abortOperations();
 
@@ -65,6 +67,8 @@ private:
     QFuture <void> m_infoThread;
     BinController *m_binController;
     ClipType getTypeForService(const QString &id, const QString &path) const;
+    /** @brief Returns the cached png of a static title clip, or an empty string if it needs the title producer */
+    QString titleRaster(const QDomElement &xml) const;
     /** @brief Pass xml values to an MLT producer at build time */
     void processProducerProperties(Mlt::Producer *prod, const QDomElement &xml);
 
@@ -0,0 +1,378 @@
+/*
+Copyright (C) 2018  Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "framecache.h"
+#include "effectslist/effectslist.h"
+#include "kdenlivesettings.h"
+#include "utils/tracer.h"
+#include "kdenlive_debug.h"
+
+#include <mlt++/Mlt.h>
+#include <QDomDocument>
+#include <QMutexLocker>
+#include <QtConcurrent>
+
+namespace {
+/** @brief Returns the producer xml without the effects added by the user. */
+QString removeUserEffects(const QString &xml)
+{
+    QDomDocument doc;
+    if (!doc.setContent(xml)) {
+        return xml;
+    }
+    QDomNodeList filters = doc.elementsByTagName(QStringLiteral("filter"));
+    for (int i = filters.count() - 1; i >= 0; --i) {
+        QDomElement filter = filters.item(i).toElement();
+        if (!EffectsList::property(filter, QStringLiteral("kdenlive_id")).isEmpty()) {
+            filter.parentNode().removeChild(filter);
+        }
+    }
+    return doc.toString();
+}
+}
+
+FrameCache::FrameCache(QObject *parent) : QObject(parent)
+    , m_size(0)
+    , m_maxSize((qint64) KdenliveSettings::monitor_framecache_size() * 1024 * 1024)
+    , m_hits(0)
+    , m_misses(0)
+    , m_playhead(0)
+    , m_direction(1)
+    , m_length(0)
+    , m_generation(0)
+    , m_abort(false)
+    , m_workerActive(false)
+    , m_profile(nullptr)
+    , m_producer(nullptr)
+    , m_previewProducer(nullptr)
+    , m_producerGeneration(-1)
+    , m_previewPosition(-1)
+{
+}
+
+FrameCache::~FrameCache()
+{
+    abort();
+    delete m_producer;
+    delete m_previewProducer;
+}
+
+bool FrameCache::hasSource() const
+{
+    QMutexLocker lock(&m_mutex);
+    return !m_xml.isEmpty();
+}
+
+void FrameCache::setSource(Mlt::Profile *profile, const QString &xml, int length)
+{
+    QMutexLocker lock(&m_mutex);
+    m_profile = profile;
+    m_xml = xml;
+    m_length = length;
+    // Frames of the previous source must not be shown for the new one
+    m_frames.clear();
+    m_size = 0;
+    m_generation++;
+}
+
+void FrameCache::invalidate()
+{
+    QMutexLocker lock(&m_mutex);
+    if (m_hits + m_misses > 0) {
+        qCDebug(KDENLIVE_LOG) << "Monitor frame cache, hits:" << m_hits << "misses:" << m_misses;
+    }
+    m_frames.clear();
+    m_size = 0;
+    m_hits = 0;
+    m_misses = 0;
+    m_xml.clear();
+    m_previewPosition = -1;
+    m_generation++;
+}
+
+void FrameCache::abort()
+{
+    m_mutex.lock();
+    m_abort = true;
+    m_mutex.unlock();
+    m_prefetchThread.waitForFinished();
+    m_mutex.lock();
+    m_abort = false;
+    m_mutex.unlock();
+}
+
+void FrameCache::insert(const SharedFrame &frame)
+{
+    if (!frame.is_valid() || frame.get_int("kdenlive:preview") || frame.get_image_format() != mlt_image_yuv420p || !frame.get_image()) {
+        return;
+    }
+    QMutexLocker lock(&m_mutex);
+    insertFrame(frame.get_position(), frame);
+}
+
+bool FrameCache::frame(int position, SharedFrame &frame)
+{
+    QMutexLocker lock(&m_mutex);
+    QMap<int, SharedFrame>::const_iterator it = m_frames.constFind(position);
+    if (it == m_frames.constEnd()) {
+        m_misses++;
+        return false;
+    }
+    m_hits++;
+    frame = it.value();
+    return true;
+}
+
+bool FrameCache::nearestFrame(int position, int maxDistance, SharedFrame &frame) const
+{
+    QMutexLocker lock(&m_mutex);
+    if (m_frames.isEmpty()) {
+        return false;
+    }
+    QMap<int, SharedFrame>::const_iterator it = m_frames.lowerBound(position);
+    if (it == m_frames.constEnd() || (it != m_frames.constBegin() && position - (it - 1).key() < it.key() - position)) {
+        --it;
+    }
+    if (qAbs(it.key() - position) > maxDistance) {
+        return false;
+    }
+    frame = it.value();
+    return true;
+}
+
+void FrameCache::requestPreview(int position)
+{
+    QMutexLocker lock(&m_mutex);
+    m_previewPosition = position;
+    startThread();
+}
+
+void FrameCache::prefetch(int position, int direction)
+{
+    QMutexLocker lock(&m_mutex);
+    m_playhead = position;
+    m_direction = direction < 0 ? -1 : 1;
+    if (nextMissingFrame() >= 0) {
+        startThread();
+    }
+}
+
+void FrameCache::startThread()
+{
+    if (!m_xml.isEmpty() && !m_abort && !m_workerActive) {
+        m_workerActive = true;
+        m_prefetchThread = QtConcurrent::run(this, &FrameCache::processPrefetch);
+    }
+}
+
+int FrameCache::hits() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_hits;
+}
+
+int FrameCache::misses() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_misses;
+}
+
+int FrameCache::prefetchWindow(int frameSize) const
+{
+    // Keep the window well below the cache size so that prefetched frames never evict each other
+    int maxFrames = frameSize > 0 ? (int)(m_maxSize / frameSize / 2) : 0;
+    return qMin(KdenliveSettings::monitor_framecache_prefetch(), maxFrames);
+}
+
+int FrameCache::nextMissingFrame() const
+{
+    if (!m_profile) {
+        return -1;
+    }
+    int window = prefetchWindow(m_profile->width() * m_profile->height() * 3 / 2);
+    if (window <= 0) {
+        return -1;
+    }
+    int last = m_length - 1;
+    if (m_direction > 0) {
+        for (int i = m_playhead; i <= qMin(last, m_playhead + window); ++i) {
+            if (!m_frames.contains(i)) {
+                return i;
+            }
+        }
+    } else {
+        // Decode forward from the start of the window, sources cannot be decoded efficiently backwards
+        for (int i = qMax(0, m_playhead - window); i <= qMin(last, m_playhead); ++i) {
+            if (!m_frames.contains(i)) {
+                return i;
+            }
+        }
+    }
+    // Then a smaller window in the other direction
+    window /= 4;
+    if (m_direction > 0) {
+        for (int i = qMax(0, m_playhead - window); i < m_playhead; ++i) {
+            if (!m_frames.contains(i)) {
+                return i;
+            }
+        }
+    } else {
+        for (int i = m_playhead + 1; i <= qMin(last, m_playhead + window); ++i) {
+            if (!m_frames.contains(i)) {
+                return i;
+            }
+        }
+    }
+    return -1;
+}
+
+void FrameCache::insertFrame(int position, const SharedFrame &frame)
+{
+    QMap<int, SharedFrame>::iterator it = m_frames.find(position);
+    if (it != m_frames.end()) {
+        m_size -= it.value().get_image_width() * it.value().get_image_height() * 3 / 2;
+        m_frames.erase(it);
+    }
+    m_frames.insert(position, frame);
+    m_size += frame.get_image_width() * frame.get_image_height() * 3 / 2;
+    // Drop the frames farthest from the playhead
+    while (m_size > m_maxSize && m_frames.count() > 1) {
+        it = qAbs(m_frames.firstKey() - m_playhead) > qAbs(m_frames.lastKey() - m_playhead) ? m_frames.begin() : m_frames.end() - 1;
+        m_size -= it.value().get_image_width() * it.value().get_image_height() * 3 / 2;
+        m_frames.erase(it);
+    }
+}
+
+bool FrameCache::loadProducers(Mlt::Profile *profile, const QString &xml)
+{
+    delete m_producer;
+    delete m_previewProducer;
+    m_previewProducer = nullptr;
+    m_producer = new Mlt::Producer(*profile, "xml-string", xml.toUtf8().constData());
+    if (!m_producer->is_valid()) {
+        qCDebug(KDENLIVE_LOG) << "Cannot create producer for monitor frame cache";
+        delete m_producer;
+        m_producer = nullptr;
+        return false;
+    }
+    m_previewProducer = new Mlt::Producer(*profile, "xml-string", removeUserEffects(xml).toUtf8().constData());
+    if (!m_previewProducer->is_valid()) {
+        delete m_previewProducer;
+        m_previewProducer = nullptr;
+    }
+    return true;
+}
+
+SharedFrame FrameCache::decodeFrame(Mlt::Producer *producer, Mlt::Profile *profile, int position, int scale)
+{
+    KDENLIVE_TRACE("monitor", "Decode cached frame");
+    producer->seek(position);
+    QScopedPointer<Mlt::Frame> frame(producer->get_frame());
+    if (!frame || !frame->is_valid()) {
+        return SharedFrame();
+    }
+    // Match the monitor consumer's processing
+    frame->set("consumer_deinterlace", profile->progressive());
+    frame->set("deinterlace_method", KdenliveSettings::mltdeinterlacer().toUtf8().constData());
+    frame->set("rescale.interp", scale > 1 ? "nearest" : KdenliveSettings::mltinterpolation().toUtf8().constData());
+    mlt_image_format format = mlt_image_yuv420p;
+    // yuv420p needs even dimensions
+    int width = qMax(2, profile->width() / scale) & ~1;
+    int height = qMax(2, profile->height() / scale) & ~1;
+    if (!frame->get_image(format, width, height)) {
+        return SharedFrame();
+    }
+    if (scale > 1) {
+        frame->set("kdenlive:preview", 1);
+    }
+    return SharedFrame(*frame);
+}
+
+void FrameCache::processPrefetch()
+{
+    while (true) {
+        int position;
+        int previewPosition;
+        int generation;
+        QString xml;
+        Mlt::Profile *profile;
+        {
+            QMutexLocker lock(&m_mutex);
+            if (m_abort) {
+                m_workerActive = false;
+                return;
+            }
+            previewPosition = m_previewPosition;
+            m_previewPosition = -1;
+            position = previewPosition >= 0 ? previewPosition : nextMissingFrame();
+            if (position < 0) {
+                m_workerActive = false;
+                return;
+            }
+            generation = m_generation;
+            profile = m_profile;
+            if (m_producerGeneration != generation) {
+                if (m_xml.isEmpty()) {
+                    // Invalidated, the loaded producers do not match the timeline anymore
+                    m_workerActive = false;
+                    return;
+                }
+                xml = m_xml;
+            }
+        }
+        if (!xml.isEmpty()) {
+            m_producerGeneration = generation;
+            if (!loadProducers(profile, xml)) {
+                QMutexLocker lock(&m_mutex);
+                if (m_generation == generation) {
+                    m_xml.clear();
+                }
+                m_workerActive = false;
+                return;
+            }
+        }
+        if (!m_producer) {
+            break;
+        }
+        if (previewPosition >= 0) {
+            // Placeholder while scrubbing: reduced size and no user effects to keep up with the mouse
+            SharedFrame frame = decodeFrame(m_previewProducer ? m_previewProducer : m_producer, profile, previewPosition, qMax(1, KdenliveSettings::monitor_scrubscale()));
+            if (frame.is_valid()) {
+                QMutexLocker lock(&m_mutex);
+                if (generation == m_generation) {
+                    lock.unlock();
+                    emit previewReady(frame);
+                }
+            }
+            continue;
+        }
+        SharedFrame frame = decodeFrame(m_producer, profile, position, 1);
+        if (!frame.is_valid()) {
+            break;
+        }
+        QMutexLocker lock(&m_mutex);
+        if (generation == m_generation) {
+            insertFrame(position, frame);
+        }
+    }
+    QMutexLocker lock(&m_mutex);
+    m_workerActive = false;
+}
@@ -0,0 +1,124 @@
+/*
+Copyright (C) 2018  Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FRAMECACHE_H
+#define FRAMECACHE_H
+
+#include "scopes/sharedframe.h"
+
+#include <QObject>
+#include <QMap>
+#include <QMutex>
+#include <QFuture>
+
+namespace Mlt
+{
+class Producer;
+class Profile;
+}
+
+/**
+ * @class FrameCache
+ * @brief A size bounded cache of decoded monitor frames around the playhead.
+ *
+ * Frames displayed by the monitor are kept, and frames around the playhead are decoded in the
+ * background from a copy of the monitor producer, so that scrubbing and reverse playback can be
+ * served without asking MLT to decode long-GOP sources backwards. When the cache is full, the frames
+ * farthest from the playhead are dropped first.
+ *
+ * While scrubbing, placeholder frames can be requested: they are decoded at reduced resolution
+ * without the user effects and are never stored in the cache.
+ */
+class FrameCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FrameCache(QObject *parent = nullptr);
+    ~FrameCache();
+    /** @brief Returns true if a producer description was set for background decoding. */
+    bool hasSource() const;
+    /** @brief Set the xml description of the monitor producer, used to decode frames in the background. */
+    void setSource(Mlt::Profile *profile, const QString &xml, int length);
+    /** @brief Drop all frames, to be called whenever the monitor content changes. */
+    void invalidate();
+    /** @brief Stop background decoding and wait for it to finish. */
+    void abort();
+    /** @brief Store a frame displayed by the monitor. Only frames in system memory (yuv420p) are kept. */
+    void insert(const SharedFrame &frame);
+    /** @brief Get the frame at @param position, returns false if it is not cached. */
+    bool frame(int position, SharedFrame &frame);
+    /** @brief Get the cached frame closest to @param position, at most @param maxDistance frames away. */
+    bool nearestFrame(int position, int maxDistance, SharedFrame &frame) const;
+    /** @brief Decode a reduced resolution frame without effects at @param position, sent with previewReady. */
+    void requestPreview(int position);
+    /** @brief Decode frames around @param position in the background, favoring the playback @param direction (-1 for reverse). */
+    void prefetch(int position, int direction);
+    /** @brief Number of frames served from the cache. */
+    int hits() const;
+    /** @brief Number of requested frames that were not in the cache. */
+    int misses() const;
+
+signals:
+    /** @brief A placeholder frame requested with requestPreview is ready. */
+    void previewReady(const SharedFrame &frame);
+
+private:
+    mutable QMutex m_mutex;
+    QMap<int, SharedFrame> m_frames;
+    /** @brief Size of the cached images in bytes. */
+    qint64 m_size;
+    qint64 m_maxSize;
+    int m_hits;
+    int m_misses;
+    int m_playhead;
+    int m_direction;
+    int m_length;
+    /** @brief Incremented each time the content changes, frames decoded for an older generation are discarded. */
+    int m_generation;
+    bool m_abort;
+    /** @brief True while the prefetch thread processes requests, protected by m_mutex. */
+    bool m_workerActive;
+    Mlt::Profile *m_profile;
+    QString m_xml;
+    /** @brief Copy of the monitor producer, only used from the prefetch thread. */
+    Mlt::Producer *m_producer;
+    /** @brief Same as m_producer without the user effects, used for placeholder frames. */
+    Mlt::Producer *m_previewProducer;
+    int m_producerGeneration;
+    /** @brief Position of the requested placeholder frame, -1 if none. */
+    int m_previewPosition;
+    QFuture<void> m_prefetchThread;
+    /** @brief Returns the size of the prefetch window in frames. */
+    int prefetchWindow(int frameSize) const;
+    /** @brief Returns the next frame to decode, or -1 if the window around the playhead is filled. */
+    int nextMissingFrame() const;
+    void insertFrame(int position, const SharedFrame &frame);
+    /** @brief Create the prefetch producers from the monitor producer's xml. */
+    bool loadProducers(Mlt::Profile *profile, const QString &xml);
+    /** @brief Decode the frame at @param position, at the profile size divided by @param scale. */
+    SharedFrame decodeFrame(Mlt::Producer *producer, Mlt::Profile *profile, int position, int scale);
+    /** @brief Start the prefetch thread if it is not active, m_mutex must be locked. */
+    void startThread();
+    void processPrefetch();
+};
+
+#endif
@@ -31,6 +31,7 @@
 #include "qml/qmlaudiothumb.h"
 #include "kdenlivesettings.h"
 #include "mltcontroller/bincontroller.h"
+#include "utils/tracer.h"
 
 #ifndef GL_UNPACK_ROW_LENGTH
 # ifdef GL_UNPACK_ROW_LENGTH_EXT
@@ -319,6 +320,7 @@ void GLWidget::createShader()
 
 static void uploadTextures(QOpenGLContext *context, const SharedFrame &frame, GLuint texture[])
 {
+    KDENLIVE_TRACE("monitor", "Upload textures");
     int width = frame.get_image_width();
     int height = frame.get_image_height();
     const uint8_t *image = frame.get_image();
@@ -1241,6 +1243,24 @@ void GLWidget::updateTexture(GLuint yName, GLuint uName, GLuint vName)
 }
 
 // MLT consumer-frame-show event handler
+bool GLWidget::canCacheFrames() const
+{
+    return m_glslManager == nullptr;
+}
+
+bool GLWidget::showCachedFrame(const SharedFrame &frame, bool preview)
+{
+    if (m_glslManager || !m_frameRenderer || !m_frameRenderer->semaphore()->tryAcquire(1)) {
+        return false;
+    }
+    Mlt::Frame copy = frame.clone(false, true);
+    if (preview) {
+        copy.set("kdenlive:preview", 1);
+    }
+    QMetaObject::invokeMethod(m_frameRenderer, "showFrame", Qt::QueuedConnection, Q_ARG(Mlt::Frame, copy));
+    return true;
+}
+
 void GLWidget::on_frame_show(mlt_consumer, void *self, mlt_frame frame_ptr)
 {
     Mlt::Frame frame(frame_ptr);
@@ -113,6 +113,11 @@ public:
     void setAudioThumb(int channels = 0, const QVariantList &audioCache = QList<QVariant>());
     int droppedFrames() const;
     void resetDrops();
+    /** @brief Returns true if displayed frames are decoded in system memory and can be cached (no GPU effects). */
+    bool canCacheFrames() const;
+    /** @brief Display a frame that did not come from the consumer, returns false if the renderer is busy.
+     *  @param preview if true, the frame is only a placeholder while seeking and does not update the monitor position */
+    bool showCachedFrame(const SharedFrame &frame, bool preview = false);
 
 protected:
     void mouseReleaseEvent(QMouseEvent *event) Q_DECL_OVERRIDE;
@@ -335,14 +335,9 @@ Monitor::Monitor(Kdenlive::MonitorId id, MonitorManager *manager, QWidget *paren
     int tm = 0;
     int bm = 0;
     m_toolbar->getContentsMargins(nullptr, &tm, nullptr, &bm);
-    m_audioMeterWidget = new MonitorAudioLevel(m_glMonitor->profile(), m_toolbar->height() - tm - bm, this);
+    m_audioMeterWidget = new MonitorAudioLevel(m_toolbar->height() - tm - bm, this);
     m_toolbar->addWidget(m_audioMeterWidget);
-    if (!m_audioMeterWidget->isValid) {
-        KdenliveSettings::setMonitoraudio(0x01);
-        m_audioMeterWidget->setVisibility(false);
-    } else {
-        m_audioMeterWidget->setVisibility((KdenliveSettings::monitoraudio() & m_id) != 0);
-    }
+    m_audioMeterWidget->setVisibility((KdenliveSettings::monitoraudio() & m_id) != 0);
 
     connect(m_timePos, SIGNAL(timeCodeEditingFinished()), this, SLOT(slotSeek()));
     layout->addWidget(m_toolbar);
@@ -1734,7 +1729,12 @@ void Monitor::updateAudioForAnalysis()
 
 void Monitor::onFrameDisplayed(const SharedFrame &frame)
 {
+    if (frame.get_int("kdenlive:preview")) {
+        // Placeholder shown while seeking, the requested frame will follow
+        return;
+    }
     m_monitorManager->frameDisplayed(frame);
+    render->cacheFrame(frame);
     int position = frame.get_position();
     seekCursor(position);
     if (!render->checkFrameNumber(position)) {
@@ -2146,16 +2146,14 @@ void Monitor::prepareAudioThumb(int channels, QVariantList &audioCache)
 void Monitor::slotUpdateQmlTimecode(const QString &tc)
 {
     checkDrops(m_glMonitor->droppedFrames());
+    if (m_glMonitor->rootObject()->property("showFps").toBool()) {
+        m_glMonitor->rootObject()->setProperty("cacheHits", render->frameCacheHitRate());
+    }
     m_glMonitor->rootObject()->setProperty("timecode", tc);
 }
 
 void Monitor::slotSwitchAudioMonitor()
 {
-    if (!m_audioMeterWidget->isValid) {
-        KdenliveSettings::setMonitoraudio(0x01);
-        m_audioMeterWidget->setVisibility(false);
-        return;
-    }
     int currentOverlay = KdenliveSettings::monitoraudio();
     currentOverlay ^= m_id;
     KdenliveSettings::setMonitoraudio(currentOverlay);
@@ -2170,9 +2168,11 @@ void Monitor::displayAudioMonitor(bool isActive)
 {
     bool enable = isActive && (KdenliveSettings::monitoraudio() & m_id);
     if (enable) {
-        connect(m_monitorManager, &MonitorManager::frameDisplayed, m_audioMeterWidget, &ScopeWidget::onNewFrame, Qt::UniqueConnection);
+        m_monitorManager->audioAnalysis()->subscribe(m_audioMeterWidget);
+        connect(m_monitorManager->audioAnalysis(), &AudioAnalysis::analysisReady, m_audioMeterWidget, &MonitorAudioLevel::setAudioAnalysis, Qt::UniqueConnection);
     } else {
-        disconnect(m_monitorManager, &MonitorManager::frameDisplayed, m_audioMeterWidget, &ScopeWidget::onNewFrame);
+        m_monitorManager->audioAnalysis()->unsubscribe(m_audioMeterWidget);
+        disconnect(m_monitorManager->audioAnalysis(), &AudioAnalysis::analysisReady, m_audioMeterWidget, &MonitorAudioLevel::setAudioAnalysis);
     }
     m_audioMeterWidget->setVisibility((KdenliveSettings::monitoraudio() & m_id) != 0);
 }
@@ -25,6 +25,7 @@
 #include "doc/kdenlivedoc.h"
 #include "utils/KoIconUtils.h"
 #include "mltcontroller/bincontroller.h"
+#include "scopes/audioanalysis.h"
 
 #include <mlt++/Mlt.h>
 
@@ -42,6 +43,8 @@ MonitorManager::MonitorManager(QObject *parent) :
     m_activeMonitor(nullptr)
 {
     setupActions();
+    m_audioAnalysis = new AudioAnalysis(this);
+    connect(this, &MonitorManager::frameDisplayed, m_audioAnalysis, &AudioAnalysis::onNewFrame);
 }
 
 Timecode MonitorManager::timecode() const
@@ -319,6 +322,11 @@ void MonitorManager::updateScopeSource()
     emit checkColorScopes();
 }
 
+AudioAnalysis *MonitorManager::audioAnalysis()
+{
+    return m_audioAnalysis;
+}
+
 AbstractRender *MonitorManager::activeRenderer()
 {
     if (m_activeMonitor) {
@@ -28,6 +28,7 @@
 
 class KdenliveDoc;
 class BinController;
+class AudioAnalysis;
 class KDualAction;
 
 namespace Mlt
@@ -71,6 +72,8 @@ public:
     void refreshIcons();
     void resetDisplay();
     QDir getCacheFolder(CacheType type);
+    /** @brief The audio analysis stage shared by all audio scopes and meters, fed with the displayed frames. */
+    AudioAnalysis *audioAnalysis();
 
 public slots:
 
@@ -129,6 +132,7 @@ private:
     AbstractMonitor *m_activeMonitor;
     QList<AbstractMonitor *>m_monitorsList;
     KDualAction *m_muteAction;
+    AudioAnalysis *m_audioAnalysis;
 
 signals:
     /** @brief When the monitor changed, update the visible color scopes */
@@ -0,0 +1,243 @@
+/*
+Copyright (C) 2018  Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "audioanalysis.h"
+
+#include <QtConcurrent>
+#include <QMutexLocker>
+
+#include <math.h>
+
+AudioAnalysisData::AudioAnalysisData() :
+    frequency(0),
+    channels(0),
+    samples(0)
+{
+}
+
+QVector<float> AudioAnalysisData::spectrum(int windowSize, FFTTools::WindowType windowType) const
+{
+    return spectra.value(AudioAnalysis::spectrumKey(windowSize, windowType));
+}
+
+AudioAnalysis::AudioAnalysis(QObject *parent) :
+    QObject(parent),
+    m_queue(3, DataQueue<AudioBlock>::OverflowModeDiscardOldest),
+    m_future(),
+    m_mutex(QMutex::NonRecursive),
+    m_historyFilled(0),
+    m_historyFrequency(0)
+{
+}
+
+AudioAnalysis::~AudioAnalysis()
+{
+    m_mutex.lock();
+    m_clients.clear();
+    m_mutex.unlock();
+    m_future.waitForFinished();
+}
+
+quint32 AudioAnalysis::spectrumKey(int windowSize, FFTTools::WindowType windowType)
+{
+    return ((quint32) windowSize << 8) | (quint32) windowType;
+}
+
+void AudioAnalysis::subscribe(QObject *client)
+{
+    QMutexLocker lock(&m_mutex);
+    if (!m_clients.contains(client)) {
+        m_clients.insert(client, QSet<quint32>());
+        connect(client, &QObject::destroyed, this, &AudioAnalysis::slotClientDestroyed);
+    }
+}
+
+void AudioAnalysis::unsubscribe(QObject *client)
+{
+    QMutexLocker lock(&m_mutex);
+    if (m_clients.remove(client) > 0) {
+        disconnect(client, &QObject::destroyed, this, &AudioAnalysis::slotClientDestroyed);
+    }
+}
+
+void AudioAnalysis::slotClientDestroyed(QObject *client)
+{
+    QMutexLocker lock(&m_mutex);
+    m_clients.remove(client);
+}
+
+void AudioAnalysis::requestSpectrum(QObject *client, int windowSize, FFTTools::WindowType windowType)
+{
+    if (windowSize < 2 || (windowSize & 1) == 1) {
+        return;
+    }
+    subscribe(client);
+    QMutexLocker lock(&m_mutex);
+    QSet<quint32> &spectra = m_clients[client];
+    const quint32 key = spectrumKey(windowSize, windowType);
+    if (!spectra.contains(key)) {
+        // Scopes show one spectrum at a time, forget the previous settings
+        spectra.clear();
+        spectra.insert(key);
+    }
+}
+
+bool AudioAnalysis::isActive() const
+{
+    QMutexLocker lock(&m_mutex);
+    return !m_clients.isEmpty();
+}
+
+void AudioAnalysis::onNewFrame(const SharedFrame &frame)
+{
+    if (!isActive() || !frame.is_valid() || frame.get_audio_samples() <= 0) {
+        return;
+    }
+    AudioBlock block;
+    block.frame = frame;
+    block.frequency = block.channels = block.samples = 0;
+    m_queue.push(block);
+    if (m_future.isFinished()) {
+        m_future = QtConcurrent::run(this, &AudioAnalysis::processQueue);
+    }
+}
+
+void AudioAnalysis::addSamples(const audioShortVector &audio, int frequency, int channels, int samples)
+{
+    if (!isActive() || channels <= 0 || samples <= 0) {
+        return;
+    }
+    AudioBlock block;
+    block.audio = audio;
+    block.frequency = frequency;
+    block.channels = channels;
+    block.samples = samples;
+    m_queue.push(block);
+    if (m_future.isFinished()) {
+        m_future = QtConcurrent::run(this, &AudioAnalysis::processQueue);
+    }
+}
+
+void AudioAnalysis::processQueue()
+{
+    while (m_queue.count() > 0) {
+        AudioBlock block = m_queue.pop();
+        m_mutex.lock();
+        QSet<quint32> spectra;
+        for (QHash<QObject *, QSet<quint32> >::const_iterator it = m_clients.constBegin(); it != m_clients.constEnd(); ++it) {
+            spectra.unite(it.value());
+        }
+        bool active = !m_clients.isEmpty();
+        m_mutex.unlock();
+        if (!active) {
+            continue;
+        }
+        if (block.frame.is_valid()) {
+            // Convert the frame's audio to interleaved 16 bit samples
+            mlt_audio_format format = mlt_audio_s16;
+            block.channels = block.frame.get_audio_channels();
+            block.frequency = block.frame.get_audio_frequency();
+            block.samples = block.frame.get_audio_samples();
+            Mlt::Frame mFrame = block.frame.clone(true, false, false);
+            const qint16 *data = (const qint16 *) mFrame.get_audio(format, block.frequency, block.channels, block.samples);
+            if (!data || block.samples <= 0 || block.channels <= 0) {
+                continue;
+            }
+            block.audio = audioShortVector(block.samples * block.channels);
+            memcpy(block.audio.data(), data, block.audio.size() * sizeof(qint16));
+            block.frame = SharedFrame();
+        }
+        emit analysisReady(analyse(block, spectra));
+    }
+}
+
+AudioAnalysisResult AudioAnalysis::analyse(const AudioBlock &block, const QSet<quint32> &spectra)
+{
+    AudioAnalysisData *result = new AudioAnalysisData;
+    const int channels = block.channels;
+    const int samples = qMin(block.samples, block.audio.size() / channels);
+    result->frequency = block.frequency;
+    result->channels = channels;
+    result->samples = samples;
+    result->audio = block.audio;
+    result->peak.resize(channels);
+    result->rms.resize(channels);
+
+    const qint16 *audio = block.audio.constData();
+    for (int c = 0; c < channels; ++c) {
+        int peak = 0;
+        double sum = 0;
+        for (int i = 0; i < samples; ++i) {
+            const int value = audio[i * channels + c];
+            peak = qMax(peak, qAbs(value));
+            sum += (double) value * value;
+        }
+        result->peak[c] = peak / 32768.0f;
+        result->rms[c] = samples > 0 ? sqrt(sum / samples) / 32768.0 : 0;
+    }
+
+    if (spectra.isEmpty() || samples == 0) {
+        return AudioAnalysisResult(result);
+    }
+
+    // Keep enough of the channel mix for the largest requested window
+    int historySize = 0;
+    for (quint32 key : spectra) {
+        historySize = qMax(historySize, (int)(key >> 8));
+    }
+    if (block.frequency != m_historyFrequency) {
+        m_history.clear();
+        m_historyFilled = 0;
+        m_historyFrequency = block.frequency;
+    }
+    if (m_history.size() != historySize) {
+        QVector<qint16> history(historySize, 0);
+        const int kept = qMin(qMin(m_historyFilled, m_history.size()), historySize);
+        memcpy(history.data() + historySize - kept, m_history.constData() + m_history.size() - kept, kept * sizeof(qint16));
+        m_history = history;
+        m_historyFilled = kept;
+    }
+    const int count = qMin(samples, historySize);
+    qint16 *history = m_history.data();
+    memmove(history, history + count, (historySize - count) * sizeof(qint16));
+    const qint16 *src = audio + (samples - count) * channels;
+    qint16 *dst = history + historySize - count;
+    for (int i = 0; i < count; ++i) {
+        int sum = 0;
+        for (int c = 0; c < channels; ++c) {
+            sum += src[i * channels + c];
+        }
+        dst[i] = sum / channels;
+    }
+    m_historyFilled = qMin(historySize, m_historyFilled + count);
+
+    for (quint32 key : spectra) {
+        // Until the history is filled, use what is available
+        const int windowSize = qMin((int)(key >> 8), m_historyFilled) & ~1;
+        if (windowSize < 2) {
+            continue;
+        }
+        QVector<float> spectrum(windowSize / 2);
+        m_fftTools.fftNormalized(history + historySize - windowSize, windowSize, 0, 1, spectrum.data(), (FFTTools::WindowType)(key & 0xff), windowSize);
+        result->spectra.insert(key, spectrum);
+    }
+    return AudioAnalysisResult(result);
+}
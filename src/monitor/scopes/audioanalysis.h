@@ -0,0 +1,130 @@
+/*
+Copyright (C) 2018  Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef AUDIOANALYSIS_H
+#define AUDIOANALYSIS_H
+
+#include "definitions.h"
+#include "sharedframe.h"
+#include "dataqueue.h"
+#include "lib/audio/fftTools.h"
+
+#include <QObject>
+#include <QFuture>
+#include <QMutex>
+#include <QHash>
+#include <QSet>
+#include <QSharedPointer>
+
+/**
+ * @class AudioAnalysisData
+ * @brief Results of the analysis of one block of audio samples, shared read-only by all subscribers.
+ */
+class AudioAnalysisData
+{
+public:
+    AudioAnalysisData();
+    int frequency;
+    int channels;
+    /** @brief Number of samples per channel in the block. */
+    int samples;
+    /** @brief The block's interleaved samples. */
+    audioShortVector audio;
+    /** @brief Peak and RMS level of each channel, in [0, 1]. */
+    QVector<float> peak;
+    QVector<float> rms;
+    /** @brief Spectra (in dB, see FFTTools::fftNormalized) of the channel mix, by AudioAnalysis::spectrumKey(). */
+    QHash<quint32, QVector<float> > spectra;
+
+    /** @brief Returns the requested spectrum, or an empty vector if it was not computed for this block. */
+    QVector<float> spectrum(int windowSize, FFTTools::WindowType windowType) const;
+};
+
+typedef QSharedPointer<const AudioAnalysisData> AudioAnalysisResult;
+Q_DECLARE_METATYPE(AudioAnalysisResult)
+
+/**
+ * @class AudioAnalysis
+ * @brief Single audio analysis stage for all audio scopes and meters.
+ *
+ * Audio blocks coming from the monitor consumer are analysed once in a worker thread:
+ * per channel peak and RMS levels, and the union of the spectra requested by the
+ * subscribers using cached kiss_fftr plans. The result is published with analysisReady().
+ * Spectra are computed over a history of the channel mix, so windows larger than one
+ * frame of audio are possible.
+ * Nothing is done as long as no client subscribed.
+ */
+class AudioAnalysis : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AudioAnalysis(QObject *parent = nullptr);
+    ~AudioAnalysis();
+
+    /** @brief Register @param client, analysis runs as long as at least one client is registered. */
+    void subscribe(QObject *client);
+    /** @brief Unregister @param client and drop the spectra it requested. */
+    void unsubscribe(QObject *client);
+    /** @brief Subscribe @param client and ask for a spectrum to be computed with each block.
+     *  Spectra requested by several clients are only computed once. Thread safe. */
+    void requestSpectrum(QObject *client, int windowSize, FFTTools::WindowType windowType);
+    bool isActive() const;
+
+    static quint32 spectrumKey(int windowSize, FFTTools::WindowType windowType);
+
+public slots:
+    /** @brief Queue the audio of a displayed frame for analysis. */
+    void onNewFrame(const SharedFrame &frame);
+    /** @brief Queue interleaved samples for analysis, for sources not based on SharedFrame (capture). */
+    void addSamples(const audioShortVector &audio, int frequency, int channels, int samples);
+
+signals:
+    void analysisReady(const AudioAnalysisResult &result);
+
+private:
+    struct AudioBlock {
+        /** Audio is extracted from the frame in the worker thread, if valid */
+        SharedFrame frame;
+        audioShortVector audio;
+        int frequency;
+        int channels;
+        int samples;
+    };
+    DataQueue<AudioBlock> m_queue;
+    QFuture<void> m_future;
+    mutable QMutex m_mutex;
+    /** @brief Requested spectrum keys by client (mutex protected). */
+    QHash<QObject *, QSet<quint32> > m_clients;
+    /** @brief Only used in the worker thread. */
+    FFTTools m_fftTools;
+    QVector<qint16> m_history;
+    int m_historyFilled;
+    int m_historyFrequency;
+
+    void processQueue();
+    AudioAnalysisResult analyse(const AudioBlock &block, const QSet<quint32> &spectra);
+
+private slots:
+    void slotClientDestroyed(QObject *client);
+};
+
+#endif
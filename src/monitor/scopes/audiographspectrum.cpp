@@ -32,8 +32,6 @@
 
 #include <math.h>
 
-#include <mlt++/Mlt.h>
-
 // Code borrowed from Shotcut's audiospectum by Brian Matherly <code@brianmatherly.com> (GPL)
 
 static const int WINDOW_SIZE = 8000; // 6 Hz FFT bins at 48kHz
@@ -265,7 +263,7 @@ void AudioGraphWidget::paintEvent(QPaintEvent *pe)
     }
 }
 
-AudioGraphSpectrum::AudioGraphSpectrum(MonitorManager *manager, QWidget *parent) : ScopeWidget(parent)
+AudioGraphSpectrum::AudioGraphSpectrum(MonitorManager *manager, QWidget *parent) : QWidget(parent)
     , m_manager(manager)
 {
     QVBoxLayout *lay = new QVBoxLayout(this);
@@ -277,26 +275,10 @@ AudioGraphSpectrum::AudioGraphSpectrum(MonitorManager *manager, QWidget *parent)
     lay->setStretchFactor(m_graphWidget, 5);
     lay->setStretchFactor(m_equalizer, 3);*/
 
-    m_filter = new Mlt::Filter(*(m_manager->projectMonitor()->profile()), "fft");
-    if (!m_filter->is_valid()) {
-        KdenliveSettings::setEnableaudiospectrum(false);
-        KMessageWidget *mw = new KMessageWidget(this);
-        mw->setCloseButtonVisible(false);
-        mw->setWordWrap(true);
-        mw->setMessageType(KMessageWidget::Information);
-        mw->setText(i18n("MLT must be compiled with libfftw3 to enable Audio Spectrum"));
-        layout()->addWidget(mw);
-        mw->show();
-        setEnabled(false);
-        return;
-    }
-    m_filter->set("window_size", WINDOW_SIZE);
     QAction *a = new QAction(i18n("Enable Audio Spectrum"), this);
     a->setCheckable(true);
     a->setChecked(KdenliveSettings::enableaudiospectrum());
-    if (KdenliveSettings::enableaudiospectrum()) {
-        connect(m_manager, &MonitorManager::frameDisplayed, this, &ScopeWidget::onNewFrame, Qt::UniqueConnection);
-    }
+    activate(KdenliveSettings::enableaudiospectrum());
     connect(a, &QAction::triggered, this, &AudioGraphSpectrum::activate);
     addAction(a);
     setContextMenuPolicy(Qt::ActionsContextMenu);
@@ -305,15 +287,17 @@ AudioGraphSpectrum::AudioGraphSpectrum(MonitorManager *manager, QWidget *parent)
 AudioGraphSpectrum::~AudioGraphSpectrum()
 {
     delete m_graphWidget;
-    delete m_filter;
 }
 
 void AudioGraphSpectrum::activate(bool enable)
 {
+    AudioAnalysis *analysis = m_manager->audioAnalysis();
     if (enable) {
-        connect(m_manager, &MonitorManager::frameDisplayed, this, &ScopeWidget::onNewFrame, Qt::UniqueConnection);
+        analysis->requestSpectrum(this, WINDOW_SIZE, FFTTools::Window_Hamming);
+        connect(analysis, &AudioAnalysis::analysisReady, this, &AudioGraphSpectrum::processSpectrum, Qt::UniqueConnection);
     } else {
-        disconnect(m_manager, &MonitorManager::frameDisplayed, this, &ScopeWidget::onNewFrame);
+        analysis->unsubscribe(this);
+        disconnect(analysis, &AudioAnalysis::analysisReady, this, &AudioGraphSpectrum::processSpectrum);
     }
     KdenliveSettings::setEnableaudiospectrum(enable);
 }
@@ -325,34 +309,20 @@ void AudioGraphSpectrum::refreshPixmap()
     }
 }
 
-void AudioGraphSpectrum::refreshScope(const QSize & /*size*/, bool /*full*/)
+void AudioGraphSpectrum::processSpectrum(const AudioAnalysisResult &analysis)
 {
-    SharedFrame sFrame;
-    while (m_queue.count() > 0) {
-        sFrame = m_queue.pop();
-        if (sFrame.is_valid() && sFrame.get_audio_samples() > 0) {
-            mlt_audio_format format = mlt_audio_s16;
-            int channels = sFrame.get_audio_channels();
-            int frequency = sFrame.get_audio_frequency();
-            int samples = sFrame.get_audio_samples();
-            Mlt::Frame mFrame = sFrame.clone(true, false, false);
-            m_filter->process(mFrame);
-            mFrame.get_audio(format, frequency, channels, samples);
-            if (samples == 0 || format == 0) {
-                // There was an error processing audio from frame
-                continue;
-            }
-            processSpectrum();
-        }
+    // Spectrum in dB, smaller than requested until enough samples were analysed
+    const QVector<float> spectrum = analysis->spectrum(WINDOW_SIZE, FFTTools::Window_Hamming);
+    if (spectrum.isEmpty() || analysis->frequency <= 0) {
+        return;
     }
-}
-
-void AudioGraphSpectrum::processSpectrum()
-{
     QVector<double> bands(AUDIBLE_BAND_COUNT);
-    float *bins = (float *)m_filter->get_data("bins");
-    int bin_count = m_filter->get_int("bin_count");
-    double bin_width = m_filter->get_double("bin_width");
+    int bin_count = spectrum.size();
+    double bin_width = (double) analysis->frequency / (2 * bin_count);
+    QVector<float> bins(bin_count);
+    for (int bin = 0; bin < bin_count; bin++) {
+        bins[bin] = pow(10.0, spectrum.at(bin) / 20.0);
+    }
 
     int band = 0;
     bool firstBandFound = false;
@@ -393,5 +363,5 @@ void AudioGraphSpectrum::processSpectrum()
     }
 
     // Update the audio signal widget
-    QMetaObject::invokeMethod(m_graphWidget, "showAudio", Qt::QueuedConnection, Q_ARG(const QVector<double> &, bands));
+    m_graphWidget->showAudio(bands);
 }
@@ -28,18 +28,12 @@
 #ifndef AUDIOGRAPHSPECTRUM_H
 #define AUDIOGRAPHSPECTRUM_H
 
-#include "scopewidget.h"
-#include "sharedframe.h"
+#include "audioanalysis.h"
 
 #include <QWidget>
 #include <QVector>
 #include <QPixmap>
 
-namespace Mlt
-{
-class Filter;
-}
-
 class MonitorManager;
 
 /*class EqualizerWidget : public QWidget
@@ -75,7 +69,7 @@ private:
     void drawChanLabels(QPainter &p, const QRect &rect, int barWidth);
 };
 
-class AudioGraphSpectrum : public ScopeWidget
+class AudioGraphSpectrum : public QWidget
 {
     Q_OBJECT
 public:
@@ -84,14 +78,13 @@ public:
 
 private:
     MonitorManager *m_manager;
-    Mlt::Filter *m_filter;
     AudioGraphWidget *m_graphWidget;
     //EqualizerWidget *m_equalizer;
-    void processSpectrum();
-    void refreshScope(const QSize &size, bool full) Q_DECL_OVERRIDE;
 
 public slots:
     void refreshPixmap();
+    /** @brief Group the spectrum computed by the shared audio analysis into bands. */
+    void processSpectrum(const AudioAnalysisResult &analysis);
 
 private slots:
     void activate(bool enable);
@@ -21,8 +21,6 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "monitoraudiolevel.h"
 
-#include "mlt++/Mlt.h"
-
 #include <math.h>
 
 #include <QPainter>
@@ -39,7 +37,7 @@ static inline double levelToDB(double dB)
     return 100 * (1.0 - log10(dB) * log_factor);
 }
 
-MonitorAudioLevel::MonitorAudioLevel(Mlt::Profile *profile, int height, QWidget *parent) : ScopeWidget(parent)
+MonitorAudioLevel::MonitorAudioLevel(int height, QWidget *parent) : QWidget(parent)
     , audioChannels(2)
     , m_height(height)
     , m_channelHeight(height / 2)
@@ -47,56 +45,30 @@ MonitorAudioLevel::MonitorAudioLevel(Mlt::Profile *profile, int height, QWidget
     , m_channelFillHeight(m_channelHeight)
 {
     setSizePolicy(QSizePolicy::MinimumExpanding, QSizePolicy::Preferred);
-    m_filter = new Mlt::Filter(*profile, "audiolevel");
-    if (!m_filter->is_valid()) {
-        isValid = false;
-        return;
-    }
-    m_filter->set("iec_scale", 0);
-    isValid = true;
 }
 
 MonitorAudioLevel::~MonitorAudioLevel()
 {
-    delete m_filter;
 }
 
-void MonitorAudioLevel::refreshScope(const QSize & /*size*/, bool /*full*/)
+void MonitorAudioLevel::setAudioAnalysis(const AudioAnalysisResult &analysis)
 {
-    SharedFrame sFrame;
-    while (m_queue.count() > 0) {
-        sFrame = m_queue.pop();
-        if (sFrame.is_valid() && sFrame.get_audio_samples() > 0) {
-            mlt_audio_format format = mlt_audio_s16;
-            int channels = sFrame.get_audio_channels();
-            int frequency = sFrame.get_audio_frequency();
-            int samples = sFrame.get_audio_samples();
-            Mlt::Frame mFrame = sFrame.clone(true, false, false);
-            m_filter->process(mFrame);
-            mFrame.get_audio(format, frequency, channels, samples);
-            if (samples == 0) {
-                // There was an error processing audio from frame
-                continue;
-            }
-            QVector<int> levels;
-            for (int i = 0; i < audioChannels; i++) {
-                QString s = QStringLiteral("meta.media.audio_level.%1").arg(i);
-                double audioLevel = mFrame.get_double(s.toLatin1().constData());
-                if (audioLevel == 0.0) {
-                    levels << -100;
-                } else {
-                    levels << (int) levelToDB(audioLevel);
-                }
-            }
-            QMetaObject::invokeMethod(this, "setAudioValues", Qt::QueuedConnection, Q_ARG(const QVector<int> &, levels));
+    QVector<int> levels;
+    for (int i = 0; i < audioChannels; i++) {
+        double audioLevel = i < analysis->peak.size() ? analysis->peak.at(i) : 0.0;
+        if (audioLevel == 0.0) {
+            levels << -100;
+        } else {
+            levels << (int) levelToDB(audioLevel);
         }
     }
+    setAudioValues(levels);
 }
 
 void MonitorAudioLevel::resizeEvent(QResizeEvent *event)
 {
     drawBackground(m_peaks.size());
-    ScopeWidget::resizeEvent(event);
+    QWidget::resizeEvent(event);
 }
 
 void MonitorAudioLevel::refreshPixmap()
@@ -22,32 +22,28 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef MONITORAUDIOLEVEL_H
 #define MONITORAUDIOLEVEL_H
 
-#include "scopewidget.h"
+#include "audioanalysis.h"
 #include <QWidget>
 
-namespace Mlt
-{
-class Profile;
-class Filter;
-}
-
-class MonitorAudioLevel : public ScopeWidget
+class MonitorAudioLevel : public QWidget
 {
     Q_OBJECT
 public:
-    explicit MonitorAudioLevel(Mlt::Profile *profile, int height, QWidget *parent = nullptr);
+    explicit MonitorAudioLevel(int height, QWidget *parent = nullptr);
     virtual ~MonitorAudioLevel();
     void refreshPixmap();
     int audioChannels;
-    bool isValid;
     void setVisibility(bool enable);
 
+public slots:
+    /** @brief Display the channel peaks of the shared audio analysis. */
+    void setAudioAnalysis(const AudioAnalysisResult &analysis);
+
 protected:
     void paintEvent(QPaintEvent *) Q_DECL_OVERRIDE;
     void resizeEvent(QResizeEvent *event) Q_DECL_OVERRIDE;
 
 private:
-    Mlt::Filter *m_filter;
     int m_height;
     QPixmap m_pixmap;
     QVector <int> m_peaks;
@@ -56,7 +52,6 @@ private:
     int m_channelDistance;
     int m_channelFillHeight;
     void drawBackground(int channels = 2);
-    void refreshScope(const QSize &size, bool full) Q_DECL_OVERRIDE;
 
 private slots:
     void setAudioValues(const QVector <int> &values);
@@ -21,6 +21,7 @@
 #include "projectsettings.h"
 #include "titler/titlewidget.h"
 #include "mltcontroller/clipcontroller.h"
+#include "bin/analysisstore.h"
 
 #include <klocalizedstring.h>
 #include <KDiskFreeSpaceInfo>
@@ -95,10 +96,17 @@ ArchiveWidget::ArchiveWidget(const QString &projectName, const QDomDocument &doc
     proxies->setData(0, Qt::UserRole, QStringLiteral("proxy"));
     proxies->setExpanded(false);
 
+    // Clip analysis side-car files are copied to the same folder name, references stay valid next to the archived project
+    QTreeWidgetItem *analysis = new QTreeWidgetItem(files_list, QStringList() << i18n("Clip analysis data"));
+    analysis->setIcon(0, QIcon::fromTheme(QStringLiteral("document-properties")));
+    analysis->setData(0, Qt::UserRole, AnalysisStore::folderName());
+    analysis->setExpanded(false);
+
     // process all files
     QStringList allFonts;
     QStringList extraImageUrls;
     QStringList otherUrls;
+    QStringList analysisUrls;
     generateItems(lumas, luma_list);
 
     QMap<QString, QString> slideUrls;
@@ -112,6 +120,14 @@ ArchiveWidget::ArchiveWidget(const QString &projectName, const QDomDocument &doc
         ClipController *clip = list.at(i);
         ClipType t = clip->clipType();
         QString id = clip->clipId();
+        const QMap<QString, QString> analysisData = clip->getPropertiesFromPrefix(QStringLiteral("kdenlive:clipanalysis."));
+        for (const QString &value : analysisData) {
+            if (AnalysisStore::isReference(value)) {
+                // Missing side-cars are listed with their reference and counted as missing
+                const QString path = AnalysisStore::filePath(value);
+                analysisUrls << (path.isEmpty() ? value : path);
+            }
+        }
         if (t == Color) {
             continue;
         }
@@ -156,6 +172,8 @@ ArchiveWidget::ArchiveWidget(const QString &projectName, const QDomDocument &doc
     generateItems(playlists, playlistUrls);
     generateItems(others, otherUrls);
     generateItems(proxies, proxyUrls);
+    analysisUrls.removeDuplicates();
+    generateItems(analysis, analysisUrls);
 
     allFonts.removeDuplicates();
 
@@ -22,6 +22,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "temporarydata.h"
 #include "doc/kdenlivedoc.h"
 #include "utils/KoIconUtils.h"
+#include "core.h"
+#include "bin/bin.h"
+#include "bin/clipresourcemanager.h"
 
 #include <KLocalizedString>
 #include <KMessageBox>
@@ -187,6 +190,13 @@ TemporaryData::TemporaryData(KdenliveDoc *doc, bool currentProjectOnly, QWidget
     del->setEnabled(false);
     m_grid->addWidget(del, 6, 4);
 
+    // Clip resources currently held in memory
+    const ClipResourceManager::Stats stats = pCore->bin()->resourceManager()->stats();
+    preview = new QLabel(i18n("Loaded in memory: %1 thumbnail producers, %2 audio thumbnails (%3), %4 released",
+                              stats.thumbProducers, stats.audioCaches, KIO::convertSize(stats.audioCacheBytes), stats.evictions), this);
+    preview->setWordWrap(true);
+    m_grid->addWidget(preview, 8, 0, 1, 5);
+
     m_currentPage->setLayout(m_grid);
     m_proxies = m_doc->getProxyHashList();
     for (int i = 0; i < m_proxies.count(); i++) {
@@ -415,12 +425,30 @@ void TemporaryData::deleteCurrentCacheData()
     if (dir.dirName() == m_doc->getDocumentProperty(QStringLiteral("documentid"))) {
         emit disablePreview();
         emit disableProxies();
-        dir.removeRecursively();
+        removeCacheFolder(dir);
         m_doc->initCacheDirs();
         updateDataInfo();
     }
 }
 
+//static
+void TemporaryData::removeCacheFolder(QDir dir)
+{
+    // Earlier versions stored clip analysis data in the cache, it is referenced by projects and cannot be regenerated automatically
+    if (!dir.exists(QStringLiteral("analysis"))) {
+        dir.removeRecursively();
+        return;
+    }
+    const QFileInfoList entries = dir.entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot);
+    for (const QFileInfo &entry : entries) {
+        if (entry.isDir() && entry.fileName() != QLatin1String("analysis")) {
+            QDir(entry.absoluteFilePath()).removeRecursively();
+        } else if (!entry.isDir()) {
+            dir.remove(entry.fileName());
+        }
+    }
+}
+
 void TemporaryData::openCacheFolder()
 {
     bool ok = false;
@@ -595,7 +623,7 @@ void TemporaryData::deleteSelected()
             continue;
         }
         QDir toRemove(m_globalDir.absoluteFilePath(folder));
-        toRemove.removeRecursively();
+        removeCacheFolder(toRemove);
         if (folder == QLatin1String("proxy")) {
             // We deleted proxy folder, recreate it
             toRemove.mkpath(QStringLiteral("."));
@@ -120,6 +120,8 @@ private:
     void updateTotal();
     void buildGlobalCacheDialog(int minHeight);
     void processglobalDirectories();
+    /** @brief Delete a project cache folder, except the clip analysis data that older projects still reference. */
+    static void removeCacheFolder(QDir dir);
 
 private slots:
     void gotPreviewSize(KJob *job);
@@ -20,6 +20,7 @@
 
 #include "filterjob.h"
 #include "meltjob.h"
+#include "scenesplitjob.h"
 #include "kdenlivesettings.h"
 #include "doc/kdenlivedoc.h"
 #include "bin/projectclip.h"
@@ -109,7 +110,7 @@ QHash<ProjectClip *, AbstractClipJob *> FilterJob::prepareJob(const QList<Projec
         }
         delete d;
         return jobs;
-    } else if (filterName == QLatin1String("motion_est")) {
+    } else if (filterName == QLatin1String("scenesplit")) {
         // Show config dialog
         QPointer<QDialog> d = new QDialog(QApplication::activeWindow());
         Ui::SceneCutDialog_UI ui;
@@ -120,33 +121,12 @@ QHash<ProjectClip *, AbstractClipJob *> FilterJob::prepareJob(const QList<Projec
             ui.marker_type->setItemData(i, CommentedTime::markerColor(i), Qt::DecorationRole);
         }
         ui.marker_type->setCurrentIndex(KdenliveSettings::default_marker_type());
+        ui.threshold->setValue(KdenliveSettings::scenecut_threshold());
         if (d->exec() != QDialog::Accepted) {
             delete d;
             return jobs;
         }
-        // Autosplit filter
-        QMap<QString, QString> producerParams = QMap<QString, QString> ();
-        QMap<QString, QString> filterParams = QMap<QString, QString> ();
-        QMap<QString, QString> consumerParams = QMap<QString, QString> ();
-
-        // Producer params
-        // None
-
-        // Filter params, use a smaller region of the image to speed up operation
-        // In fact, it's faster to rescale whole image than using part of it (bounding=\"25%x25%:15%x15\")
-        filterParams.insert(QStringLiteral("filter"), filterName);
-        filterParams.insert(QStringLiteral("shot_change_list"), QStringLiteral("0"));
-        filterParams.insert(QStringLiteral("denoise"), QStringLiteral("0"));
-
-        // Consumer
-        consumerParams.insert(QStringLiteral("consumer"), QStringLiteral("null"));
-        consumerParams.insert(QStringLiteral("all"), QStringLiteral("1"));
-        consumerParams.insert(QStringLiteral("terminate_on_pause"), QStringLiteral("1"));
-        consumerParams.insert(QStringLiteral("real_time"), QStringLiteral("-1"));
-        // We just want to find scene change, set all mathods to the fastests
-        consumerParams.insert(QStringLiteral("rescale"), QStringLiteral("nearest"));
-        consumerParams.insert(QStringLiteral("deinterlace_method"), QStringLiteral("onefield"));
-        consumerParams.insert(QStringLiteral("top_field_first"), QStringLiteral("-1"));
+        KdenliveSettings::setScenecut_threshold(ui.threshold->value());
 
         // Extra
         QMap<QString, QString> extraParams;
@@ -154,7 +134,6 @@ QHash<ProjectClip *, AbstractClipJob *> FilterJob::prepareJob(const QList<Projec
         extraParams.insert(QStringLiteral("projecttreefilter"), QStringLiteral("1"));
         QString keyword(QStringLiteral("%count"));
         extraParams.insert(QStringLiteral("resultmessage"), i18n("Found %1 scenes.", keyword));
-        extraParams.insert(QStringLiteral("resize_profile"), QStringLiteral("160"));
         if (ui.store_data->isChecked()) {
             // We want to save result as clip metadata
             extraParams.insert(QStringLiteral("storedata"), QStringLiteral("1"));
@@ -175,26 +154,17 @@ QHash<ProjectClip *, AbstractClipJob *> FilterJob::prepareJob(const QList<Projec
         delete d;
 
         for (int i = 0; i < clips.count(); i++) {
-            // Set clip specific infos
-
             // in and out
             int in = 0;
             int out = -1;
             ProjectClip *clip = clips.at(i);
             if (extraParams.contains(QStringLiteral("zoneonly"))) {
-                // Analyse clip zone only, remove in / out and replace with zone
+                // Analyse clip zone only
                 QPoint zone = clip->zone();
                 in = zone.x();
                 out = zone.y();
             }
-            producerParams.insert(QStringLiteral("in"), QString::number(in));
-            producerParams.insert(QStringLiteral("out"), QString::number(out));
-            producerParams.insert(QStringLiteral("producer"), sources.at(i));
-
-            // Destination
-            // Since this job is only doing analysis, we have a null consumer and no destination
-            MeltJob *job = new MeltJob(clip->clipType(), clip->clipId(), producerParams, filterParams, consumerParams, extraParams);
-            job->description = i18n("Auto split");
+            SceneSplitJob *job = new SceneSplitJob(clip->clipType(), clip->clipId(), sources.at(i), in, out, extraParams);
             jobs.insert(clip, job);
         }
         return jobs;
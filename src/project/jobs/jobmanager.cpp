@@ -30,6 +30,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "meltjob.h"
 #include "filterjob.h"
 #include "bin/bin.h"
+#include "utils/tracer.h"
 #include "mlt++/Mlt.h"
 
 #include "kdenlive_debug.h"
@@ -221,7 +222,10 @@ void JobManager::slotProcessJobs()
         if (job->jobType == AbstractClipJob::MLTJOB || job->jobType == AbstractClipJob::ANALYSECLIPJOB) {
             connect(job, SIGNAL(gotFilterJobResults(QString, int, int, stringMap, stringMap)), this, SIGNAL(gotFilterJobResults(QString, int, int, stringMap, stringMap)));
         }
-        job->startJob();
+        {
+            KDENLIVE_TRACE("jobmanager", "Run job");
+            job->startJob();
+        }
         if (job->status() == JobDone) {
             emit updateJobStatus(job->clipId(), job->jobType, JobDone);
             //TODO: replace with more generic clip replacement framework
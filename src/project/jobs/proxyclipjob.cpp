@@ -25,6 +25,7 @@
 #include "bin/projectclip.h"
 #include "bin/bin.h"
 #include <QProcess>
+#include <QRegularExpression>
 #include <QTemporaryFile>
 
 #include <klocalizedstring.h>
@@ -333,6 +334,16 @@ QHash<ProjectClip *, AbstractClipJob *> ProxyJob::prepareJob(Bin *bin, const QLi
         if (item->getProducerProperty(QStringLiteral("autorotate")) == QStringLiteral("0")) {
             local_params.append(QStringLiteral(" -noautorotate"));
         }
+        int proxyWidth = item->getProducerIntProperty(QStringLiteral("kdenlive:proxywidth"));
+        if (proxyWidth > 0 && (item->clipType() == AV || item->clipType() == Video)) {
+            // Proxy resolution was chosen from the clip's decode speed
+            local_params.replace(QRegularExpression(QStringLiteral("scale=\\d+:")), QStringLiteral("scale=%1:").arg(proxyWidth));
+            QRegularExpressionMatch match = QRegularExpression(QStringLiteral("-s (\\d+)x(\\d+)")).match(local_params);
+            if (match.hasMatch() && match.captured(1).toInt() > 0) {
+                int proxyHeight = match.captured(2).toInt() * proxyWidth / match.captured(1).toInt() / 2 * 2;
+                local_params.replace(match.capturedStart(), match.capturedLength(), QStringLiteral("-s %1x%2").arg(proxyWidth).arg(proxyHeight));
+            }
+        }
         QString path = item->getProducerProperty(QStringLiteral("kdenlive:proxy"));
         if (path.isEmpty() || path.length() < 3) path = item->getProducerProperty(QStringLiteral("_proxy"));
         if (path.isEmpty() || path.length() < 3) {
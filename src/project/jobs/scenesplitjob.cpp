@@ -0,0 +1,314 @@
+/*
+Copyright (C) 2018  Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "scenesplitjob.h"
+#include "kdenlivesettings.h"
+#include "kdenlive_debug.h"
+
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <klocalizedstring.h>
+#include <mlt++/Mlt.h>
+
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+// Height of the decoded frames, enough to see scene changes
+const int analysisHeight = 160;
+// Segments shorter than this are not worth an extra decoder
+const int minSegmentLength = 500;
+const int histogramBins = 64;
+// Number of previous frames a cut must stand out from
+const int motionWindow = 8;
+
+#ifdef __SSE2__
+inline __m128i absDiff(__m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+}
+#endif
+
+quint64 sumAbsDiff(const uchar *a, const uchar *b, int count)
+{
+    quint64 sum = 0;
+    int i = 0;
+#ifdef __SSE2__
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 16 <= count; i += 16) {
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_loadu_si128((const __m128i *)(a + i)), _mm_loadu_si128((const __m128i *)(b + i))));
+    }
+    // Each 64 bit lane holds at most count * 255 / 2, low 32 bits are enough at analysis size
+    sum = (quint32) _mm_cvtsi128_si32(acc) + (quint32) _mm_cvtsi128_si32(_mm_srli_si128(acc, 8));
+#endif
+    for (; i < count; ++i) {
+        sum += qAbs(a[i] - b[i]);
+    }
+    return sum;
+}
+
+/** Sum of the horizontal and vertical gradients of each pixel, saturated to 255 */
+void edgeMap(const uchar *luma, uchar *edges, int width, int height)
+{
+    for (int y = 0; y + 1 < height; ++y) {
+        const uchar *line = luma + y * width;
+        const uchar *next = line + width;
+        uchar *dst = edges + y * width;
+        int x = 0;
+#ifdef __SSE2__
+        for (; x + 17 <= width; x += 16) {
+            const __m128i pixel = _mm_loadu_si128((const __m128i *)(line + x));
+            const __m128i right = _mm_loadu_si128((const __m128i *)(line + x + 1));
+            const __m128i below = _mm_loadu_si128((const __m128i *)(next + x));
+            _mm_storeu_si128((__m128i *)(dst + x), _mm_adds_epu8(absDiff(pixel, right), absDiff(pixel, below)));
+        }
+#endif
+        for (; x + 1 < width; ++x) {
+            dst[x] = qMin(255, qAbs(line[x + 1] - line[x]) + qAbs(next[x] - line[x]));
+        }
+        dst[width - 1] = 0;
+    }
+}
+
+struct FrameSignature {
+    QByteArray luma;
+    QByteArray edges;
+    int histogram[histogramBins];
+
+    void compute(const uchar *data, int width, int height)
+    {
+        const int pixels = width * height;
+        if (luma.size() != pixels) {
+            luma = QByteArray(pixels, 0);
+            edges = QByteArray(pixels, 0);
+        }
+        uchar *dst = reinterpret_cast<uchar *>(luma.data());
+        memcpy(dst, data, pixels);
+        edgeMap(dst, reinterpret_cast<uchar *>(edges.data()), width, height);
+        // Interleaved partial histograms avoid stalls on repeated bins
+        int partial[4][histogramBins];
+        memset(partial, 0, sizeof(partial));
+        int i = 0;
+        for (; i + 4 <= pixels; i += 4) {
+            partial[0][dst[i] >> 2]++;
+            partial[1][dst[i + 1] >> 2]++;
+            partial[2][dst[i + 2] >> 2]++;
+            partial[3][dst[i + 3] >> 2]++;
+        }
+        for (; i < pixels; ++i) {
+            partial[0][dst[i] >> 2]++;
+        }
+        for (int bin = 0; bin < histogramBins; ++bin) {
+            histogram[bin] = partial[0][bin] + partial[1][bin] + partial[2][bin] + partial[3][bin];
+        }
+    }
+
+    /** Difference with another frame of the same size, from 0 to 100 */
+    int difference(const FrameSignature &other) const
+    {
+        const int pixels = luma.size();
+        if (pixels == 0 || other.luma.size() != pixels) {
+            return 100;
+        }
+        int histogramDiff = 0;
+        for (int bin = 0; bin < histogramBins; ++bin) {
+            histogramDiff += qAbs(histogram[bin] - other.histogram[bin]);
+        }
+        const double lumaDiff = (double) sumAbsDiff(reinterpret_cast<const uchar *>(luma.constData()), reinterpret_cast<const uchar *>(other.luma.constData()), pixels) / pixels;
+        const double edgeDiff = (double) sumAbsDiff(reinterpret_cast<const uchar *>(edges.constData()), reinterpret_cast<const uchar *>(other.edges.constData()), pixels) / pixels;
+        // Histograms catch content changes, luma and edges catch cuts between similar looking shots
+        return qRound(50.0 * histogramDiff / (2 * pixels) + 25.0 * qMin(lumaDiff / 64, 1.0) + 25.0 * qMin(edgeDiff / 64, 1.0));
+    }
+};
+}
+
+SceneSplitJob::SceneSplitJob(ClipType cType, const QString &id, const QString &url, int in, int out, const stringMap &extraParams)
+    : AbstractClipJob(MLTJOB, cType, id),
+      m_url(url),
+      m_in(in),
+      m_out(out),
+      m_extra(extraParams)
+{
+    m_jobStatus = JobWaiting;
+    description = i18n("Auto split");
+}
+
+SceneSplitJob::~SceneSplitJob()
+{
+}
+
+void SceneSplitJob::startJob()
+{
+    if (m_url.isEmpty()) {
+        m_errorMessage.append(i18n("No producer for this clip."));
+        setStatus(JobCrashed);
+        return;
+    }
+    if (m_out != -1 && m_out <= m_in) {
+        m_errorMessage.append(i18n("Clip zone undefined (%1 - %2).", m_in, m_out));
+        setStatus(JobCrashed);
+        return;
+    }
+    int length = 0;
+    {
+        Mlt::Profile profile(KdenliveSettings::current_profile().toUtf8().constData());
+        Mlt::Producer producer(profile, m_url.toUtf8().constData());
+        if (!producer.is_valid()) {
+            setStatus(JobCrashed);
+            return;
+        }
+        int out = m_out == -1 ? producer.get_length() - 1 : qMin(m_out, producer.get_length() - 1);
+        length = out - m_in + 1;
+    }
+    if (length < 2) {
+        m_errorMessage.append(i18n("Clip zone undefined (%1 - %2).", m_in, m_out));
+        setStatus(JobCrashed);
+        return;
+    }
+    if (m_in > 0) {
+        m_extra.insert(QStringLiteral("offset"), QString::number(m_in));
+    }
+
+    // Split the clip in independent segments, each one analysed by its own decoder
+    const int segmentCount = qBound(1, length / minSegmentLength, QThread::idealThreadCount());
+    QVector<Segment> segments(segmentCount);
+    for (int i = 0; i < segmentCount; ++i) {
+        segments[i].start = (qint64) length * i / segmentCount;
+        segments[i].end = (qint64) length * (i + 1) / segmentCount - 1;
+        segments[i].scores.fill(0, segments[i].end - segments[i].start + 1);
+    }
+    m_processed = 0;
+    QThreadPool pool;
+    pool.setMaxThreadCount(segmentCount);
+    for (int i = 0; i < segmentCount; ++i) {
+        QtConcurrent::run(&pool, this, &SceneSplitJob::analyseSegment, &segments[i]);
+    }
+    while (!pool.waitForDone(250)) {
+        if (m_jobStatus == JobWorking) {
+            emit jobProgress(m_clipId, qMin(99, (int) (100 * (qint64) m_processed.load() / length)), jobType);
+        }
+    }
+    if (m_jobStatus != JobWorking) {
+        return;
+    }
+
+    // Stitch segment results, each segment already compared its first frame with the previous segment's last
+    QVector<int> scores;
+    scores.reserve(length);
+    for (const Segment &segment : segments) {
+        scores += segment.scores;
+    }
+    QMap<QString, QString> jobResults;
+    jobResults.insert(m_extra.value(QStringLiteral("key")), detectCuts(scores).join(QLatin1Char(';')));
+    emit gotFilterJobResults(m_clipId, -1, -1, jobResults, m_extra);
+    m_jobStatus = JobDone;
+}
+
+void SceneSplitJob::analyseSegment(Segment *segment)
+{
+    Mlt::Profile profile(KdenliveSettings::current_profile().toUtf8().constData());
+    const int height = analysisHeight;
+    const int width = qRound(analysisHeight * profile.dar() / 2) * 2;
+    profile.set_height(height);
+    profile.set_width(width);
+    Mlt::Producer producer(profile, m_url.toUtf8().constData());
+    if (!producer.is_valid()) {
+        return;
+    }
+    producer.set("audio_index", -1);
+    // Start one frame early so that the first frame of the segment has a reference
+    int pos = qMax(0, segment->start - 1);
+    producer.seek(m_in + pos);
+    FrameSignature signatures[2];
+    int current = 0;
+    bool hasPrevious = false;
+    for (; pos <= segment->end && m_jobStatus == JobWorking; ++pos) {
+        Mlt::Frame *frame = producer.get_frame();
+        if (frame == nullptr || !frame->is_valid()) {
+            delete frame;
+            break;
+        }
+        // We just want to find scene changes, use the fastest methods
+        frame->set("consumer_deinterlace", 1);
+        frame->set("deinterlace_method", "onefield");
+        frame->set("rescale.interp", "nearest");
+        mlt_image_format format = mlt_image_yuv420p;
+        int frameWidth = width;
+        int frameHeight = height;
+        const uchar *image = frame->get_image(format, frameWidth, frameHeight);
+        if (image != nullptr && format == mlt_image_yuv420p) {
+            signatures[current].compute(image, frameWidth, frameHeight);
+            if (hasPrevious && pos >= segment->start) {
+                segment->scores[pos - segment->start] = signatures[current].difference(signatures[1 - current]);
+            }
+            hasPrevious = true;
+            current = 1 - current;
+        }
+        delete frame;
+        if (pos >= segment->start) {
+            m_processed.ref();
+        }
+    }
+}
+
+//static
+QStringList SceneSplitJob::detectCuts(const QVector<int> &scores)
+{
+    QStringList cuts;
+    const int threshold = KdenliveSettings::scenecut_threshold();
+    for (int i = 1; i < scores.count(); ++i) {
+        if (scores.at(i) < threshold) {
+            continue;
+        }
+        // Fast motion gives high scores on many frames, a cut stands out from the frames before it
+        int sum = 0;
+        int count = 0;
+        for (int j = qMax(1, i - motionWindow); j < i; ++j) {
+            sum += scores.at(j);
+            count++;
+        }
+        if (count > 0 && scores.at(i) < 2 * sum / count) {
+            continue;
+        }
+        cuts << QStringLiteral("%1=%2").arg(i).arg(scores.at(i));
+    }
+    return cuts;
+}
+
+const QString SceneSplitJob::statusMessage()
+{
+    QString statusInfo;
+    switch (m_jobStatus) {
+    case JobWorking:
+        statusInfo = description;
+        break;
+    case JobWaiting:
+        statusInfo = i18n("Waiting to process clip");
+        break;
+    default:
+        break;
+    }
+    return statusInfo;
+}
@@ -0,0 +1,79 @@
+/*
+Copyright (C) 2018  Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SCENESPLITJOB
+#define SCENESPLITJOB
+
+#include "abstractclipjob.h"
+
+#include <QAtomicInt>
+#include <QVector>
+
+/**
+ * @class SceneSplitJob
+ * @brief Detects shot changes in a clip, used by the automatic scene split.
+ *
+ * The clip is decoded at a reduced resolution and consecutive frames are compared using their luma
+ * histogram, luma difference and edge map difference. Independent segments of the clip are analysed
+ * in parallel, each segment also decodes the last frame of the previous one so that no transition is
+ * missed at segment boundaries. The result uses the same "position=score;" format as MLT's
+ * motion_est shot_change_list and is handled by the same markers / cuts code.
+ */
+
+class SceneSplitJob : public AbstractClipJob
+{
+    Q_OBJECT
+
+public:
+    /** @brief Creates the job.
+     *  @param url the clip's source file
+     *  @param in first frame to analyse
+     *  @param out last frame to analyse, -1 to analyse until the end of the clip
+     *  @param extraParams the options telling what to do with the result (addmarkers, cutscenes, storedata, ...) */
+    SceneSplitJob(ClipType cType, const QString &id, const QString &url, int in, int out, const stringMap &extraParams);
+    virtual ~ SceneSplitJob();
+    /** @brief Start processing the job. */
+    void startJob() Q_DECL_OVERRIDE;
+    /** @brief Returns a text string describing the job's current activity. */
+    const QString statusMessage() Q_DECL_OVERRIDE;
+
+private:
+    struct Segment {
+        int start;
+        int end;
+        /** @brief Difference of each frame with the previous one, 0 to 100 */
+        QVector<int> scores;
+    };
+    QString m_url;
+    int m_in;
+    int m_out;
+    QMap<QString, QString> m_extra;
+    /** @brief Number of frames analysed by all segments, used for progress */
+    QAtomicInt m_processed;
+    void analyseSegment(Segment *segment);
+    /** @brief Returns the shot changes found in @param scores, as a "position=score" list. */
+    static QStringList detectCuts(const QVector<int> &scores);
+
+signals:
+    void gotFilterJobResults(const QString &id, int startPos, int track, const stringMap &result, const stringMap &extra);
+};
+
+#endif
@@ -11,12 +11,14 @@ the Free Software Foundation, either version 3 of the License, or
 #include "projectmanager.h"
 #include "core.h"
 #include "bin/bin.h"
+#include "bin/analysisstore.h"
 #include "mltcontroller/bincontroller.h"
 #include "mltcontroller/producerqueue.h"
 #include "mainwindow.h"
 #include "kdenlivesettings.h"
 #include "monitor/monitormanager.h"
 #include "doc/kdenlivedoc.h"
+#include "doc/documentvalidator.h"
 #include "timeline/timeline.h"
 #include "project/dialogs/projectsettings.h"
 #include "timeline/customtrackview.h"
@@ -35,6 +37,8 @@ the Free Software Foundation, either version 3 of the License, or
 
 #include <QProgressDialog>
 #include <QCryptographicHash>
+#include <QFutureWatcher>
+#include <QtConcurrent>
 #include <QFileDialog>
 #include <QAction>
 #include "kdenlive_debug.h"
@@ -48,6 +52,10 @@ ProjectManager::ProjectManager(QObject *parent) :
     QObject(parent),
     m_project(nullptr),
     m_trackView(nullptr),
+    m_loading(false),
+    m_loadStale(nullptr),
+    m_loadDoc(nullptr),
+    m_loadOpenBackup(false),
     m_progressDialog(nullptr)
 {
     m_fileRevert = KStandardAction::revert(this, SLOT(slotRevert()), pCore->window()->actionCollection());
@@ -94,7 +102,13 @@ void ProjectManager::slotLoadOnOpen()
     } else {
         newFile(false);
     }
+    if (!m_loading) {
+        loadClipsOnOpen();
+    }
+}
 
+void ProjectManager::loadClipsOnOpen()
+{
     if (!m_loadClipsOnOpen.isEmpty() && m_project) {
         const QStringList list = m_loadClipsOnOpen.split(QLatin1Char(','));
         QList<QUrl> urls;
@@ -233,6 +247,9 @@ void ProjectManager::newFile(bool showProjectSettings, bool force)
 
 bool ProjectManager::closeCurrentDocument(bool saveChanges, bool quit)
 {
+    if (m_loading) {
+        return false;
+    }
     if (m_project && m_project->isModified() && saveChanges) {
         QString message;
         if (m_project->url().fileName().isEmpty()) {
@@ -294,6 +311,8 @@ bool ProjectManager::saveFileAs(const QString &outputFileName)
     QUrl url = QUrl::fromLocalFile(outputFileName);
     // Save timeline thumbnails
     m_trackView->projectView()->saveThumbnails();
+    // Clip analysis side-car files live next to the project file
+    AnalysisStore::copyFiles(pCore->bin()->getAnalysisReferences(), QDir(saveFolder + QLatin1Char('/') + AnalysisStore::folderName()));
     m_project->setUrl(url);
     // setting up autosave file in ~/.kde/data/stalefiles/kdenlive/
     // saved under file name
@@ -512,7 +531,7 @@ void ProjectManager::openFile(const QUrl &url)
 void ProjectManager::doOpenFile(const QUrl &url, KAutoSaveFile *stale)
 {
     Q_ASSERT(m_project == nullptr);
-    if (!pCore->window()->m_timelineArea->isEnabled()) {
+    if (!pCore->window()->m_timelineArea->isEnabled() || m_loading) {
         return;
     }
     m_fileRevert->setEnabled(true);
@@ -526,13 +545,62 @@ void ProjectManager::doOpenFile(const QUrl &url, KAutoSaveFile *stale)
     pCore->monitorManager()->resetDisplay();
     m_progressDialog = new QProgressDialog(pCore->window());
     m_progressDialog->setWindowTitle(i18n("Loading project"));
+    m_progressDialog->setWindowModality(Qt::ApplicationModal);
     m_progressDialog->setCancelButton(nullptr);
     m_progressDialog->setLabelText(i18n("Loading project"));
     m_progressDialog->setMaximum(0);
     m_progressDialog->show();
+
+    // Read the project file in a worker thread so that the window keeps repainting,
+    // loading continues in slotProjectFileRead
+    m_loading = true;
+    m_loadUrl = url;
+    m_loadStale = stale;
+    const QString path = stale ? stale->fileName() : url.toLocalFile();
+    QFutureWatcher<KdenliveDoc::ProjectFile> *watcher = new QFutureWatcher<KdenliveDoc::ProjectFile>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, &ProjectManager::slotProjectFileRead);
+    watcher->setFuture(QtConcurrent::run(&KdenliveDoc::readProjectFile, path, KdenliveSettings::cacheupgradedprojects()));
+}
+
+bool ProjectManager::isLoading() const
+{
+    return m_loading;
+}
+
+void ProjectManager::slotProjectFileRead()
+{
+    QFutureWatcher<KdenliveDoc::ProjectFile> *watcher = static_cast<QFutureWatcher<KdenliveDoc::ProjectFile> *>(sender());
+    const KdenliveDoc::ProjectFile projectFile = watcher->result();
+    watcher->deleteLater();
+    const QUrl url = m_loadUrl;
+    KAutoSaveFile *stale = m_loadStale;
+    const QUrl docUrl = stale ? QUrl::fromLocalFile(stale->fileName()) : url;
+
+    if (projectFile.parsed && !projectFile.validated) {
+        // Ask the upgrade questions here, then upgrade the document in a worker thread
+        DocumentValidator *validator = new DocumentValidator(projectFile.document, docUrl);
+        if (validator->isProject() && validator->prepare(DOCUMENTVERSION)) {
+            m_progressDialog->setLabelText(i18n("Validating"));
+            QFutureWatcher<KdenliveDoc::ProjectFile> *upgradeWatcher = new QFutureWatcher<KdenliveDoc::ProjectFile>(this);
+            connect(upgradeWatcher, &QFutureWatcherBase::finished, this, &ProjectManager::slotProjectFileRead);
+            upgradeWatcher->setFuture(QtConcurrent::run([validator, projectFile]() {
+                KdenliveDoc::ProjectFile upgraded = projectFile;
+                upgraded.valid = validator->upgradeDocument(true);
+                upgraded.validated = true;
+                upgraded.upgradeModified = validator->isModified();
+                upgraded.messages = validator->messages();
+                delete validator;
+                return upgraded;
+            }));
+            return;
+        }
+        // Not a project, the document reports it
+        delete validator;
+    }
+
     bool openBackup;
     m_notesPlugin->clear();
-    KdenliveDoc *doc = new KdenliveDoc(stale ? QUrl::fromLocalFile(stale->fileName()) : url, QString(), pCore->window()->m_commandStack, KdenliveSettings::default_profile().isEmpty() ? KdenliveSettings::current_profile() : KdenliveSettings::default_profile(), QMap<QString, QString> (), QMap<QString, QString> (), QPoint(KdenliveSettings::videotracks(), KdenliveSettings::audiotracks()), pCore->monitorManager()->projectMonitor()->render, m_notesPlugin, &openBackup, pCore->window());
+    KdenliveDoc *doc = new KdenliveDoc(docUrl, QString(), pCore->window()->m_commandStack, KdenliveSettings::default_profile().isEmpty() ? KdenliveSettings::current_profile() : KdenliveSettings::default_profile(), QMap<QString, QString> (), QMap<QString, QString> (), QPoint(KdenliveSettings::videotracks(), KdenliveSettings::audiotracks()), pCore->monitorManager()->projectMonitor()->render, m_notesPlugin, &openBackup, pCore->window(), &projectFile);
     if (stale == nullptr) {
         const QString projectId = QCryptographicHash::hash(url.fileName().toUtf8(), QCryptographicHash::Md5).toHex();
         QUrl autosaveUrl = QUrl::fromLocalFile(QFileInfo(url.path()).absoluteDir().absoluteFilePath(projectId + QStringLiteral(".kdenlive")));
@@ -553,6 +621,24 @@ void ProjectManager::doOpenFile(const QUrl &url, KAutoSaveFile *stale)
     m_progressDialog->setLabelText(i18n("Loading clips"));
     pCore->bin()->setDocument(doc);
 
+    // Build the MLT scene in a worker thread, the timeline picks it up in KdenliveDoc::setSceneList
+    m_loadDoc = doc;
+    m_loadOpenBackup = openBackup;
+    QFutureWatcher<void> *sceneWatcher = new QFutureWatcher<void>(this);
+    connect(sceneWatcher, &QFutureWatcherBase::finished, this, &ProjectManager::slotSceneListPrepared);
+    sceneWatcher->setFuture(QtConcurrent::run(doc->renderer(), &Render::prepareSceneList, doc->toXml().toString()));
+}
+
+void ProjectManager::slotSceneListPrepared()
+{
+    sender()->deleteLater();
+    KdenliveDoc *doc = m_loadDoc;
+    const bool openBackup = m_loadOpenBackup;
+    const QUrl url = m_loadUrl;
+    m_loadDoc = nullptr;
+    m_loadUrl.clear();
+    m_loadStale = nullptr;
+
     QList<QAction *> rulerActions;
     rulerActions << pCore->window()->actionCollection()->action(QStringLiteral("set_render_timeline_zone"));
     rulerActions << pCore->window()->actionCollection()->action(QStringLiteral("unset_render_timeline_zone"));
@@ -587,19 +673,34 @@ void ProjectManager::doOpenFile(const QUrl &url, KAutoSaveFile *stale)
         pCore->window()->m_timelineArea->setEnabled(false);
         KMessageBox::sorry(pCore->window(), i18n("Cannot open file %1.\nProject is corrupted.", url.toLocalFile()));
         pCore->window()->slotGotProgressInfo(QString(), 100);
+        // The dialog is application modal, it would block the new project
+        delete m_progressDialog;
+        m_progressDialog = nullptr;
+        m_loading = false;
+        m_backupTarget.clear();
         newFile(false, true);
+        loadClipsOnOpen();
         return;
     }
     m_trackView->setDuration(m_trackView->duration());
 
     pCore->window()->slotGotProgressInfo(QString(), 100);
     pCore->monitorManager()->projectMonitor()->adjustRulerSize(m_trackView->duration() - 1);
-    if (openBackup) {
-        slotOpenBackup(url);
-    }
     m_lastSave.start();
     delete m_progressDialog;
     m_progressDialog = nullptr;
+    m_loading = false;
+    if (!m_backupTarget.isEmpty()) {
+        // The project was restored from a backup of m_backupTarget
+        m_project->setUrl(m_backupTarget);
+        m_project->setModified(true);
+        pCore->window()->setWindowTitle(m_project->description());
+        m_backupTarget.clear();
+    }
+    loadClipsOnOpen();
+    if (openBackup) {
+        slotOpenBackup(url);
+    }
 }
 
 void ProjectManager::slotRevert()
@@ -647,12 +748,8 @@ void ProjectManager::slotOpenBackup(const QUrl &url)
         QString requestedBackup = dia->selectedFile();
         m_project->backupLastSavedVersion(projectFile.toLocalFile());
         closeCurrentDocument(false);
+        m_backupTarget = projectFile;
         doOpenFile(QUrl::fromLocalFile(requestedBackup), nullptr);
-        if (m_project) {
-            m_project->setUrl(projectFile);
-            m_project->setModified(true);
-            pCore->window()->setWindowTitle(m_project->description());
-        }
     }
     delete dia;
 }
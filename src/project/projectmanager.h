@@ -51,7 +51,10 @@ public:
     /** @brief Store command line args for later opening. */
     void init(const QUrl &projectUrl, const QString &clipList);
 
+    /** @brief Start opening @param url, the project is read in a worker thread and set up when it is done. */
     void doOpenFile(const QUrl &url, KAutoSaveFile *stale);
+    /** @brief Returns true while a project is being opened, there is no current project then. */
+    bool isLoading() const;
     KRecentFilesAction *recentFilesAction();
     void prepareSave();
     /** @brief Disable all bin effects in current project */
@@ -126,6 +129,10 @@ private slots:
     /** @brief Report progress of folder move operation. */
     void slotMoveProgress(KJob *, unsigned long progress);
     void slotMoveFinished(KJob *job);
+    /** @brief Create the document and timeline once the project file was read by doOpenFile. */
+    void slotProjectFileRead();
+    /** @brief Create the timeline once the MLT scene of the opened project was built. */
+    void slotSceneListPrepared();
 
 signals:
     void docOpened(KdenliveDoc *document);
@@ -138,6 +145,8 @@ private:
     QString getMimeType(bool open = true);
     /** @brief checks if autoback files exists, recovers from it if user says yes, returns true if files were recovered. */
     bool checkForBackupFile(const QUrl &url, bool newFile = false);
+    /** @brief Add the clips passed on the command line to the current project. */
+    void loadClipsOnOpen();
 
     KdenliveDoc *m_project;
     Timeline *m_trackView;
@@ -145,6 +154,15 @@ private:
     QTimer m_autoSaveTimer;
     QUrl m_startUrl;
     QString m_loadClipsOnOpen;
+    /** @brief True from doOpenFile until the project is set up. */
+    bool m_loading;
+    QUrl m_loadUrl;
+    KAutoSaveFile *m_loadStale;
+    /** @brief The document being opened, until its timeline is created. */
+    KdenliveDoc *m_loadDoc;
+    bool m_loadOpenBackup;
+    /** @brief The url to give to the project being restored from a backup. */
+    QUrl m_backupTarget;
     QMap<QString, QString> m_replacementPattern;
 
     QAction *m_fileRevert;
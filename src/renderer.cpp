@@ -32,9 +32,11 @@
 #include "bin/projectclip.h"
 #include "timeline/clip.h"
 #include "monitor/glwidget.h"
+#include "monitor/framecache.h"
 #include "mltcontroller/clipcontroller.h"
 #include "timeline/transitionhandler.h"
 #include "core.h"
+#include "utils/tracer.h"
 #include <mlt++/Mlt.h>
 
 #include "kdenlive_debug.h"
@@ -69,7 +71,13 @@ Render::Render(Kdenlive::MonitorId rendererName, BinController *binController, G
     m_isLoopMode(false),
     m_blackClip(nullptr),
     m_isActive(false),
-    m_isRefreshing(false)
+    m_isRefreshing(false),
+    m_frameCache(nullptr),
+    m_lastSeekPosition(0),
+    m_cachePlaySpeed(0),
+    m_cachePlayPosition(0),
+    m_cachePlayWait(0),
+    m_preparedProducer(nullptr)
 {
     qRegisterMetaType<stringMap> ("stringMap");
     analyseAudio = KdenliveSettings::monitor_audio();
@@ -89,6 +97,12 @@ Render::Render(Kdenlive::MonitorId rendererName, BinController *binController, G
     m_refreshTimer.setSingleShot(true);
     m_refreshTimer.setInterval(50);
     connect(&m_refreshTimer, &QTimer::timeout, this, &Render::refresh);
+    if (m_qmlView && KdenliveSettings::monitor_framecache()) {
+        m_frameCache = new FrameCache(this);
+        connect(m_frameCache, &FrameCache::previewReady, this, &Render::slotScrubPreview);
+    }
+    m_cachePlayTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_cachePlayTimer, &QTimer::timeout, this, &Render::slotCachePlayback);
     connect(this, &Render::checkSeeking, this, &Render::slotCheckSeeking);
     if (m_name == Kdenlive::ProjectMonitor) {
         connect(m_binController, &BinController::prepareTimelineReplacement, this, &Render::prepareTimelineReplacement, Qt::DirectConnection);
@@ -100,6 +114,9 @@ Render::Render(Kdenlive::MonitorId rendererName, BinController *binController, G
 
 Render::~Render()
 {
+    if (m_frameCache) {
+        m_frameCache->abort();
+    }
     closeMlt();
 }
 
@@ -110,6 +127,7 @@ void Render::closeMlt()
     delete m_mltConsumer;
     delete m_mltProducer;
     delete m_blackClip;
+    delete m_preparedProducer;
 }
 
 void Render::slotSwitchFullscreen()
@@ -122,6 +140,11 @@ void Render::slotSwitchFullscreen()
 void Render::prepareProfileReset(double fps)
 {
     m_refreshTimer.stop();
+    stopCachePlayback();
+    if (m_frameCache) {
+        m_frameCache->abort();
+        m_frameCache->invalidate();
+    }
     m_fps = fps;
 }
 
@@ -158,7 +181,13 @@ void Render::seek(int time)
 {
     resetZoneMode();
     time = qBound(0, time, m_mltProducer->get_length() - 1);
+    if (m_cachePlaySpeed != 0) {
+        m_cachePlayPosition = time;
+    }
     if (requestedSeekPosition == SEEK_INACTIVE) {
+        if (m_mltProducer->get_speed() == 0 && showCachedFrame(time)) {
+            return;
+        }
         requestedSeekPosition = time;
         if (m_mltProducer->get_speed() != 0) {
             m_mltConsumer->purge();
@@ -173,6 +202,123 @@ void Render::seek(int time)
         }
     } else {
         requestedSeekPosition = time;
+        // Seeks arrive faster than frames are rendered, decode the surrounding frames in the background
+        if (frameCacheAvailable(true)) {
+            m_frameCache->prefetch(time, time < m_lastSeekPosition ? -1 : 1);
+            showScrubPreview(time);
+        }
+    }
+    m_lastSeekPosition = time;
+}
+
+void Render::showScrubPreview(int position)
+{
+    if (!KdenliveSettings::monitor_scrubpreview() || m_mltProducer->get_speed() != 0) {
+        return;
+    }
+    SharedFrame frame;
+    if (m_frameCache->nearestFrame(position, KdenliveSettings::monitor_scrubdistance(), frame)) {
+        m_qmlView->showCachedFrame(frame, true);
+    } else {
+        m_frameCache->requestPreview(position);
+    }
+}
+
+void Render::slotScrubPreview(const SharedFrame &frame)
+{
+    // Only useful while the consumer is still busy with a seek
+    if (requestedSeekPosition == SEEK_INACTIVE || !m_mltProducer || m_mltProducer->get_speed() != 0) {
+        return;
+    }
+    m_qmlView->showCachedFrame(frame, true);
+}
+
+bool Render::frameCacheAvailable(bool createSource)
+{
+    if (!m_frameCache || externalConsumer || !m_qmlView->canCacheFrames()) {
+        return false;
+    }
+    if (createSource && !m_frameCache->hasSource()) {
+        m_frameCache->setSource(m_qmlView->profile(), sceneList(QString(), false), m_mltProducer->get_length());
+    }
+    return true;
+}
+
+bool Render::showCachedFrame(int position)
+{
+    if (!frameCacheAvailable()) {
+        return false;
+    }
+    m_frameCache->prefetch(position, (m_cachePlaySpeed < 0 || position < m_lastSeekPosition) ? -1 : 1);
+    m_lastSeekPosition = position;
+    SharedFrame frame;
+    if (!m_frameCache->frame(position, frame) || !m_qmlView->showCachedFrame(frame)) {
+        return false;
+    }
+    m_mltProducer->seek(position);
+    return true;
+}
+
+void Render::cacheFrame(const SharedFrame &frame)
+{
+    if (frameCacheAvailable()) {
+        m_frameCache->insert(frame);
+    }
+}
+
+bool Render::startCachePlayback(double speed)
+{
+    if (!frameCacheAvailable(true)) {
+        return false;
+    }
+    int position = seekFramePosition();
+    if (m_mltProducer->get_speed() != 0) {
+        m_mltProducer->set_speed(0);
+        m_mltConsumer->purge();
+    }
+    m_mltProducer->seek(position);
+    m_cachePlaySpeed = speed;
+    m_cachePlayPosition = position;
+    m_cachePlayWait = 0;
+    m_frameCache->prefetch(position, -1);
+    m_cachePlayTimer.start(m_fps > 0 ? qMax(1, qRound(1000.0 / m_fps)) : 40);
+    return true;
+}
+
+void Render::stopCachePlayback()
+{
+    m_cachePlayTimer.stop();
+    m_cachePlaySpeed = 0;
+}
+
+void Render::slotCachePlayback()
+{
+    if (m_cachePlaySpeed == 0 || !m_mltProducer || m_cachePlayPosition <= 0) {
+        stopCachePlayback();
+        return;
+    }
+    // The cache may have been invalidated by a timeline change
+    frameCacheAvailable(true);
+    int position = qMax(0, m_cachePlayPosition - qMax(1, (int) - m_cachePlaySpeed));
+    if (showCachedFrame(position)) {
+        m_cachePlayPosition = position;
+        m_cachePlayWait = 0;
+        return;
+    }
+    // Give the prefetch thread some time to decode the frame before asking MLT for it
+    if (++m_cachePlayWait < 10) {
+        return;
+    }
+    m_cachePlayWait = 0;
+    m_cachePlayPosition = position;
+    if (requestedSeekPosition == SEEK_INACTIVE) {
+        requestedSeekPosition = position;
+        m_mltProducer->seek(position);
+        m_isRefreshing = true;
+        if (m_mltConsumer->is_stopped()) {
+            m_mltConsumer->start();
+        }
+        m_mltConsumer->set("refresh", 1);
     }
 }
 
@@ -329,6 +475,10 @@ void Render::loadUrl(const QString &url)
 
 bool Render::updateProducer(Mlt::Producer *producer)
 {
+    stopCachePlayback();
+    if (m_frameCache) {
+        m_frameCache->invalidate();
+    }
     if (m_mltProducer) {
         if (strcmp(m_mltProducer->get("resource"), "<tractor>") == 0) {
             // We need to make some cleanup
@@ -360,6 +510,7 @@ bool Render::updateProducer(Mlt::Producer *producer)
 bool Render::setProducer(Mlt::Producer *producer, int position, bool isActive)
 {
     m_refreshTimer.stop();
+    stopCachePlayback();
     requestedSeekPosition = SEEK_INACTIVE;
     QMutexLocker locker(&m_mutex);
     QString currentId;
@@ -368,6 +519,9 @@ bool Render::setProducer(Mlt::Producer *producer, int position, bool isActive)
         // Black clip already displayed no need to refresh
         return true;
     }
+    if (m_frameCache) {
+        m_frameCache->invalidate();
+    }
     if (m_mltProducer) {
         currentId = m_mltProducer->get("id");
         m_mltProducer->set_speed(0);
@@ -454,6 +608,16 @@ int Render::setSceneList(QString playlist, int position)
     QMutexLocker locker(&m_mutex);
     //if (m_winid == -1) return -1;
     int error = 0;
+    Mlt::Producer *prepared = nullptr;
+    m_preparedMutex.lock();
+    if (m_preparedProducer && m_preparedPlaylist == playlist) {
+        prepared = m_preparedProducer;
+    } else {
+        delete m_preparedProducer;
+    }
+    m_preparedProducer = nullptr;
+    m_preparedPlaylist.clear();
+    m_preparedMutex.unlock();
 
     //qCDebug(KDENLIVE_LOG) << "//////  RENDER, SET SCENE LIST:\n" << playlist <<"\n..........:::.";
 
@@ -486,10 +650,14 @@ int Render::setSceneList(QString playlist, int position)
     blockSignals(true);
     m_locale = QLocale();
     m_locale.setNumberOptions(QLocale::OmitGroupSeparator);
-    m_mltProducer = new Mlt::Producer(*m_qmlView->profile(), "xml-string", playlist.toUtf8().constData());
+    {
+        KDENLIVE_TRACE("load", "build producers");
+        m_mltProducer = prepared ? prepared : new Mlt::Producer(*m_qmlView->profile(), "xml-string", playlist.toUtf8().constData());
+    }
     //m_mltProducer = new Mlt::Producer(*m_qmlView->profile(), "xml-nogl-string", playlist.toUtf8().constData());
     if (!m_mltProducer || !m_mltProducer->is_valid()) {
         qCDebug(KDENLIVE_LOG) << " WARNING - - - - -INVALID PLAYLIST: " << playlist.toUtf8().constData();
+        delete m_mltProducer;
         m_mltProducer = m_blackClip->cut(0, 1);
         error = -1;
     }
@@ -558,6 +726,24 @@ int Render::setSceneList(QString playlist, int position)
     return error;
 }
 
+void Render::prepareSceneList(const QString &playlist)
+{
+    // Remove profile info, as in setSceneList
+    QDomDocument doc;
+    doc.setContent(playlist);
+    QDomElement profile = doc.documentElement().firstChildElement(QStringLiteral("profile"));
+    doc.documentElement().removeChild(profile);
+    Mlt::Producer *producer;
+    {
+        KDENLIVE_TRACE("load", "prepare producers");
+        producer = new Mlt::Producer(*m_qmlView->profile(), "xml-string", doc.toString().toUtf8().constData());
+    }
+    QMutexLocker locker(&m_preparedMutex);
+    delete m_preparedProducer;
+    m_preparedProducer = producer;
+    m_preparedPlaylist = playlist;
+}
+
 void Render::checkMaxThreads()
 {
     // Make sure we don't use too much threads, MLT avformat does not cope with too much threads
@@ -579,7 +765,7 @@ void Render::checkMaxThreads()
     }
 }
 
-const QString Render::sceneList(const QString &root)
+const QString Render::sceneList(const QString &root, bool optimise)
 {
     QString playlist;
     qCDebug(KDENLIVE_LOG) << " * * *Setting document xml root: " << root;
@@ -591,7 +777,9 @@ const QString Render::sceneList(const QString &root)
     if (!xmlConsumer.is_valid()) {
         return QString();
     }
-    m_mltProducer->optimise();
+    if (optimise) {
+        m_mltProducer->optimise();
+    }
     xmlConsumer.set("terminate_on_pause", 1);
     xmlConsumer.set("store", "kdenlive");
     // Disabling meta creates cleaner files, but then we don't have access to metadata on the fly (meta channels, etc)
@@ -685,6 +873,7 @@ void Render::stop()
 {
     requestedSeekPosition = SEEK_INACTIVE;
     m_refreshTimer.stop();
+    stopCachePlayback();
     QMutexLocker locker(&m_mutex);
     m_isActive = false;
     if (m_mltProducer) {
@@ -706,6 +895,7 @@ void Render::stop(const GenTime &startTime)
 {
     requestedSeekPosition = SEEK_INACTIVE;
     m_refreshTimer.stop();
+    stopCachePlayback();
     QMutexLocker locker(&m_mutex);
     m_isActive = false;
     if (m_mltProducer) {
@@ -748,7 +938,17 @@ void Render::switchPlay(bool play, double speed)
     if (m_isZoneMode) {
         resetZoneMode();
     }
+    if (m_cachePlaySpeed != 0) {
+        // Reverse playback from the frame cache, the producer is already paused on the displayed frame
+        stopCachePlayback();
+        if (!play) {
+            return;
+        }
+    }
     if (play) {
+        if (speed < 0 && startCachePlayback(speed)) {
+            return;
+        }
         double currentSpeed = m_mltProducer->get_speed();
         if (m_name == Kdenlive::ClipMonitor && m_mltConsumer->position() == m_mltProducer->get_out() && speed > 0) {
             m_mltProducer->seek(0);
@@ -787,6 +987,12 @@ void Render::play(double speed)
     if (!m_mltProducer || !m_isActive) {
         return;
     }
+    if (m_cachePlaySpeed != 0) {
+        if (m_cachePlaySpeed == speed) {
+            return;
+        }
+        stopCachePlayback();
+    }
     double current_speed = m_mltProducer->get_speed();
     if (current_speed == speed) {
         return;
@@ -794,6 +1000,9 @@ void Render::play(double speed)
     if (m_isZoneMode) {
         resetZoneMode();
     }
+    if (speed < 0 && startCachePlayback(speed)) {
+        return;
+    }
     if (speed != 0 && m_mltConsumer->get_int("real_time") != m_qmlView->realTime()) {
         m_mltConsumer->set("real_time", m_qmlView->realTime());
         m_mltConsumer->set("buffer", 25);
@@ -814,6 +1023,7 @@ void Render::play(double speed)
 void Render::play(const GenTime &startTime)
 {
     requestedSeekPosition = SEEK_INACTIVE;
+    stopCachePlayback();
     if (!m_mltProducer || !m_mltConsumer || !m_isActive) {
         return;
     }
@@ -838,6 +1048,7 @@ void Render::loopZone(const GenTime &startTime, const GenTime &stopTime)
 bool Render::playZone(const GenTime &startTime, const GenTime &stopTime)
 {
     requestedSeekPosition = SEEK_INACTIVE;
+    stopCachePlayback();
     if (!m_mltProducer || !m_mltConsumer || !m_isActive) {
         return false;
     }
@@ -892,6 +1103,9 @@ void Render::seekToFrameDiff(int diff)
 
 void Render::doRefresh()
 {
+    if (m_frameCache) {
+        m_frameCache->invalidate();
+    }
     if (m_mltProducer && (playSpeed() == 0) && m_isActive) {
         if (m_isRefreshing) {
             m_refreshTimer.start();
@@ -904,6 +1118,9 @@ void Render::doRefresh()
 void Render::refresh()
 {
     m_refreshTimer.stop();
+    if (m_frameCache) {
+        m_frameCache->invalidate();
+    }
     if (!m_mltProducer || !m_isActive) {
         return;
     }
@@ -958,6 +1175,9 @@ bool Render::isPlaying() const
 
 double Render::playSpeed() const
 {
+    if (m_cachePlaySpeed != 0) {
+        return m_cachePlaySpeed;
+    }
     if (m_mltProducer) {
         return m_mltProducer->get_speed();
     }
@@ -973,6 +1193,16 @@ GenTime Render::seekPosition() const
     }
 }
 
+int Render::frameCacheHitRate() const
+{
+    if (!m_frameCache) {
+        return -1;
+    }
+    int hits = m_frameCache->hits();
+    int requests = hits + m_frameCache->misses();
+    return requests > 0 ? hits * 100 / requests : -1;
+}
+
 int Render::seekFramePosition() const
 {
     if (m_mltProducer && m_mltProducer->get_speed() == 0) {
@@ -1017,6 +1247,10 @@ bool Render::checkFrameNumber(int pos)
     }
     const double speed = m_mltProducer->get_speed();
     if (requestedSeekPosition != SEEK_INACTIVE) {
+        if (speed == 0 && showCachedFrame(requestedSeekPosition)) {
+            requestedSeekPosition = SEEK_INACTIVE;
+            return true;
+        }
         m_mltProducer->set_speed(0);
         m_mltProducer->seek(requestedSeekPosition);
         if (speed == 0) {
@@ -1024,9 +1258,10 @@ bool Render::checkFrameNumber(int pos)
         } else {
             m_mltProducer->set_speed(speed);
         }
-    } else if (speed < 0){
+    } else if (speed < 0 || m_cachePlaySpeed < 0) {
         m_isRefreshing = false;
         if (pos <= 0) {
+            stopCachePlayback();
             m_mltProducer->set_speed(0);
             return false;
         }
@@ -55,6 +55,8 @@ class KComboBox;
 class BinController;
 class ClipController;
 class GLWidget;
+class FrameCache;
+class SharedFrame;
 
 namespace Mlt
 {
@@ -124,12 +126,16 @@ Q_OBJECT public:
      *
      * Creates the producer from the text playlist. */
     int setSceneList(QString playlist, int position = 0);
+    /** @brief Build the producer of @param playlist ahead of a setSceneList call with the same playlist.
+     *
+     * It does not touch the current scene, so it can run in a worker thread while a project is opened. */
+    void prepareSceneList(const QString &playlist);
     bool updateProducer(Mlt::Producer *producer);
     bool setProducer(Mlt::Producer *producer, int position, bool isActive);
 
     /** @brief Get the current MLT producer playlist.
      * @return A string describing the playlist */
-    const QString sceneList(const QString &root);
+    const QString sceneList(const QString &root, bool optimise = true);
 
     /** @brief Tells the renderer to play the scene at the specified speed,
      * @param speed speed to play the scene to
@@ -154,6 +160,8 @@ Q_OBJECT public:
 
     /** @brief Return true if we are currently playing */
     bool isPlaying() const;
+    /** @brief Returns the percentage of monitor frames served from the frame cache, -1 if the cache was not used. */
+    int frameCacheHitRate() const;
 
     /** @brief Returns the speed at which the renderer is currently playing.
      *
@@ -251,6 +259,8 @@ Q_OBJECT public:
     void updateSlowMotionProducers(const QString &id, const QMap<QString, QString> &passProperties);
     void preparePreviewRendering(const QString &sceneListFile);
     void silentSeek(int time);
+    /** @brief Store a frame displayed by the monitor for fast scrubbing and reverse playback. */
+    void cacheFrame(const SharedFrame &frame);
 
 private:
 
@@ -286,6 +296,21 @@ private:
     bool m_isActive;
     /** @brief True if the consumer is currently refreshing itself. */
     bool m_isRefreshing;
+    /** @brief Decoded frames around the playhead, nullptr if disabled. */
+    FrameCache *m_frameCache;
+    /** @brief Last position displayed from the frame cache or requested to MLT, used to find the scrub direction. */
+    int m_lastSeekPosition;
+    /** @brief Reverse playback is served from the frame cache, driven by this timer. */
+    QTimer m_cachePlayTimer;
+    /** @brief Speed of the reverse playback served from the frame cache, 0 if inactive. */
+    double m_cachePlaySpeed;
+    int m_cachePlayPosition;
+    /** @brief Number of consecutive timer ticks waiting for a frame to be decoded. */
+    int m_cachePlayWait;
+    /** @brief Producer built by prepareSceneList for m_preparedPlaylist, taken by setSceneList. */
+    Mlt::Producer *m_preparedProducer;
+    QString m_preparedPlaylist;
+    QMutex m_preparedMutex;
     void closeMlt();
     QMap<QString, Mlt::Producer *> m_slowmotionProducers;
 
@@ -301,12 +326,26 @@ private:
     void cloneProperties(Mlt::Properties &dest, Mlt::Properties &source);
     /** @brief Get a track producer from a clip's id */
     Mlt::Producer *getProducerForTrack(Mlt::Playlist &trackPlaylist, const QString &clipId);
+    /** @brief Returns true if the monitor frames can be cached.
+     *  @param createSource if true, make sure the cache can decode frames in the background */
+    bool frameCacheAvailable(bool createSource = false);
+    /** @brief Display the frame at @param position from the frame cache, returns false if it is not cached. */
+    bool showCachedFrame(int position);
+    /** @brief Show an approximate frame while the consumer has not caught up with the seek to @param position. */
+    void showScrubPreview(int position);
+    /** @brief Play backwards from the frame cache instead of letting MLT decode backwards. */
+    bool startCachePlayback(double speed);
+    void stopCachePlayback();
 
 private slots:
 
     /** @brief Refreshes the monitor display. */
     void refresh();
     void slotCheckSeeking();
+    /** @brief Display the next frame of a reverse playback served from the frame cache. */
+    void slotCachePlayback();
+    /** @brief Display a placeholder frame decoded by the frame cache. */
+    void slotScrubPreview(const SharedFrame &frame);
 
 signals:
     /** @brief The renderer stopped, either playing or rendering. */
@@ -11,7 +11,10 @@
 #include "abstractaudioscopewidget.h"
 
 #include "renderer.h"
+#include "core.h"
 #include "monitor/monitor.h"
+#include "monitor/monitormanager.h"
+#include "utils/tracer.h"
 
 // Uncomment for debugging
 //#define DEBUG_AASW
@@ -25,20 +28,18 @@ AbstractAudioScopeWidget::AbstractAudioScopeWidget(bool trackMouse, QWidget *par
     m_freq(0),
     m_nChannels(0),
     m_nSamples(0),
-    m_audioFrame(),
     m_newData(0)
 {
 }
 
-void AbstractAudioScopeWidget::slotReceiveAudio(const audioShortVector &sampleData, int freq, int num_channels, int num_samples)
+void AbstractAudioScopeWidget::slotReceiveAudio(const AudioAnalysisResult &analysis)
 {
 #ifdef DEBUG_AASW
     qCDebug(KDENLIVE_LOG) << "Received audio for " << widgetName() << '.';
 #endif
-    m_audioFrame = sampleData;
-    m_freq = freq;
-    m_nChannels = num_channels;
-    m_nSamples = num_samples;
+    m_analysisMutex.lock();
+    m_lastAnalysis = analysis;
+    m_analysisMutex.unlock();
 
     m_newData.fetchAndAddAcquire(1);
 
@@ -51,9 +52,30 @@ AbstractAudioScopeWidget::~AbstractAudioScopeWidget()
 
 QImage AbstractAudioScopeWidget::renderScope(uint accelerationFactor)
 {
+    KDENLIVE_TRACE("scopes", "Render audio scope");
     const int newData = m_newData.fetchAndStoreAcquire(0);
 
-    return renderAudioScope(accelerationFactor, m_audioFrame, m_freq, m_nChannels, m_nSamples, newData);
+    m_analysisMutex.lock();
+    m_analysis = m_lastAnalysis;
+    m_analysisMutex.unlock();
+    if (!m_analysis) {
+        m_analysis = AudioAnalysisResult(new AudioAnalysisData);
+    }
+    m_freq = m_analysis->frequency;
+    m_nChannels = m_analysis->channels;
+    m_nSamples = m_analysis->samples;
+
+    return renderAudioScope(accelerationFactor, m_analysis->audio, m_freq, m_nChannels, m_nSamples, newData);
+}
+
+QVector<float> AbstractAudioScopeWidget::analysedSpectrum(int windowSize, FFTTools::WindowType windowType) const
+{
+    return m_analysis ? m_analysis->spectrum(windowSize, windowType) : QVector<float>();
+}
+
+void AbstractAudioScopeWidget::requestSpectrum(int windowSize, FFTTools::WindowType windowType)
+{
+    pCore->monitorManager()->audioAnalysis()->requestSpectrum(this, windowSize, windowType);
 }
 
 #ifdef DEBUG_AASW
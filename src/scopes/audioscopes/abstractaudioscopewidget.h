@@ -17,6 +17,9 @@
 
 #include "../../definitions.h"
 #include "../abstractscopewidget.h"
+#include "monitor/scopes/audioanalysis.h"
+
+#include <QMutex>
 
 class Render;
 
@@ -31,7 +34,8 @@ public:
     virtual ~AbstractAudioScopeWidget();
 
 public slots:
-    void slotReceiveAudio(const audioShortVector &sampleData, int freq, int num_channels, int num_samples);
+    /** @brief Receive the results of the shared audio analysis for a new block of samples. */
+    void slotReceiveAudio(const AudioAnalysisResult &analysis);
 
 protected:
     /** @brief This is just a wrapper function, subclasses can use renderAudioScope. */
@@ -45,12 +49,21 @@ protected:
                                     const audioShortVector &audioFrame, const int freq, const int num_channels, const int num_samples,
                                     const int newData) = 0;
 
+    /** @brief Spectrum of the block being rendered as computed by the shared analysis,
+     *  empty if it was not requested early enough. Only valid in renderAudioScope(). */
+    QVector<float> analysedSpectrum(int windowSize, FFTTools::WindowType windowType) const;
+    /** @brief Ask the shared analysis to compute this spectrum for the next blocks. */
+    void requestSpectrum(int windowSize, FFTTools::WindowType windowType);
+    /** @brief The analysis of the block being rendered. Only valid in renderAudioScope(). */
+    AudioAnalysisResult m_analysis;
+
     int m_freq;
     int m_nChannels;
     int m_nSamples;
 
 private:
-    audioShortVector m_audioFrame;
+    AudioAnalysisResult m_lastAnalysis;
+    QMutex m_analysisMutex;
     QAtomicInt m_newData;
 
 };
@@ -38,20 +38,15 @@ AudioSignal::~AudioSignal()
 {
 }
 
-QImage AudioSignal::renderAudioScope(uint, const audioShortVector &audioFrame,
-                                     const int, const int num_channels, const int samples, const int)
+QImage AudioSignal::renderAudioScope(uint, const audioShortVector &,
+                                     const int, const int num_channels, const int, const int)
 {
     QTime start = QTime::currentTime();
 
-    int num_samples = samples > 200 ? 200 : samples;
-
+    // Channel levels come from the shared audio analysis, scaled like |sample| / 128
     QByteArray chanAvg;
-    for (int i = 0; i < num_channels; ++i) {
-        long val = 0;
-        for (int s = 0; s < num_samples; s ++) {
-            val += abs(audioFrame[i + s * num_channels] / 128);
-        }
-        chanAvg.append(val / num_samples);
+    for (int i = 0; i < num_channels && i < m_analysis->rms.size(); ++i) {
+        chanAvg.append((char) qBound(0, (int)(m_analysis->rms.at(i) * 256), 255));
     }
 
     if (peeks.count() != chanAvg.count()) {
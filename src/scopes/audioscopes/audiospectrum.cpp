@@ -211,17 +211,22 @@ QImage AudioSpectrum::renderAudioScope(uint, const audioShortVector &audioFrame,
         ui->labelFFTSizeNumber->setText(QVariant(fftWindow).toString());
 
         // Get the spectral power distribution of the input samples,
-        // using the given window size and function
-        float freqSpectrum[fftWindow / 2];
+        // using the given window size and function. The shared audio analysis
+        // computes it once for all scopes, fall back to our own FFT until it
+        // delivers the requested window.
         FFTTools::WindowType windowType = (FFTTools::WindowType) ui->windowFunction->itemData(ui->windowFunction->currentIndex()).toInt();
-        m_fftTools.fftNormalized(audioFrame, 0, num_channels, freqSpectrum, windowType, fftWindow, 0);
+        requestSpectrum(fftWindow, windowType);
+        QVector<float> freqSpectrum = analysedSpectrum(fftWindow, windowType);
+        if (freqSpectrum.size() != fftWindow / 2) {
+            freqSpectrum = QVector<float>(fftWindow / 2);
+            m_fftTools.fftNormalized(audioFrame, 0, num_channels, freqSpectrum.data(), windowType, fftWindow, 0);
+        }
 
         // Store the current FFT window (for the HUD) and run the interpolation
         // for easy pixel-based dB value access
         QVector<float> dbMap;
         m_lastFFTLock.acquire();
-        m_lastFFT = QVector<float>(fftWindow / 2);
-        memcpy(m_lastFFT.data(), &(freqSpectrum[0]), fftWindow / 2 * sizeof(float));
+        m_lastFFT = freqSpectrum;
 
         uint right = ((float) m_freqMax) / (m_freq / 2) * (m_lastFFT.size() - 1);
         dbMap = FFTTools::interpolatePeakPreserving(m_lastFFT, m_innerScopeRect.width(), 0, right, -180);
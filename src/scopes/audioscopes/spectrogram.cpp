@@ -22,6 +22,8 @@
 // highest vertical screen resolution available for complete reconstruction.
 // Can be less as a pre-rendered image is kept in space.
 #define SPECTROGRAM_HISTORY_SIZE 1000
+// Largest FFT window offered in the UI, defines the row size of the FFT history
+#define SPECTROGRAM_MAX_WINDOW 2048
 
 // Uncomment for debugging
 //#define DEBUG_SPECTROGRAM
@@ -38,7 +40,15 @@ Spectrogram::Spectrogram(QWidget *parent) :
     AbstractAudioScopeWidget(true, parent)
     , m_fftTools()
     , m_fftHistory()
+    , m_fftHistoryLength()
+    , m_mappedHistory()
     , m_fftHistoryImg()
+    , m_historyStride(SPECTROGRAM_MAX_WINDOW / 2)
+    , m_historyHead(-1)
+    , m_historyCount(0)
+    , m_mappedWidth(0)
+    , m_mappedFreqMax(0)
+    , m_mappedFreq(0)
     , m_dBmin(-70)
     , m_dBmax(0)
     , m_freqMax(0)
@@ -336,20 +346,43 @@ QImage Spectrogram::renderAudioScope(uint, const audioShortVector &audioFrame, c
         // Show the window size used, for information
         ui->labelFFTSizeNumber->setText(QVariant(fftWindow).toString());
 
-        if (newDataAvailable) {
+        if (m_fftHistory.isEmpty()) {
+            m_fftHistory.resize(SPECTROGRAM_HISTORY_SIZE * m_historyStride);
+            m_fftHistoryLength.resize(SPECTROGRAM_HISTORY_SIZE);
+        }
+
+        // The interpolated history is only valid for the current width and frequency range
+        const int width = m_innerScopeRect.width();
+        bool remapped = false;
+        if (width != m_mappedWidth || m_freqMax != m_mappedFreqMax || m_freq != m_mappedFreq) {
+            m_mappedWidth = width;
+            m_mappedFreqMax = m_freqMax;
+            m_mappedFreq = m_freq;
+            remapHistory();
+            remapped = true;
+        }
 
-            float freqSpectrum[fftWindow / 2];
+        if (newDataAvailable) {
+            // This method might be called also when a simple refresh is required.
+            // In this case there is no data to append to the history. Only append new data,
+            // overwriting the oldest row once the history is full.
+            m_historyHead = (m_historyHead + 1) % SPECTROGRAM_HISTORY_SIZE;
+            m_historyCount = qMin(m_historyCount + 1, SPECTROGRAM_HISTORY_SIZE);
 
             // Get the spectral power distribution of the input samples,
-            // using the given window size and function
+            // using the given window size and function. Use the spectrum of the
+            // shared audio analysis if it already computes the requested window.
             FFTTools::WindowType windowType = (FFTTools::WindowType) ui->windowFunction->itemData(ui->windowFunction->currentIndex()).toInt();
-            m_fftTools.fftNormalized(audioFrame, 0, num_channels, freqSpectrum, windowType, fftWindow, 0);
-
-            // This methid might be called also when a simple refresh is required.
-            // In this case there is no data to append to the history. Only append new data.
-            QVector<float> spectrumVector(fftWindow / 2);
-            memcpy(spectrumVector.data(), &freqSpectrum[0], fftWindow / 2 * sizeof(float));
-            m_fftHistory.prepend(spectrumVector);
+            float *row = m_fftHistory.data() + m_historyHead * m_historyStride;
+            requestSpectrum(fftWindow, windowType);
+            const QVector<float> analysed = analysedSpectrum(fftWindow, windowType);
+            if (analysed.size() == fftWindow / 2) {
+                memcpy(row, analysed.constData(), analysed.size() * sizeof(float));
+            } else {
+                m_fftTools.fftNormalized(audioFrame, 0, num_channels, row, windowType, fftWindow, 0);
+            }
+            m_fftHistoryLength[m_historyHead] = fftWindow / 2;
+            mapHistoryRow(m_historyHead);
         }
 #ifdef DEBUG_SPECTROGRAM
         else {
@@ -357,99 +390,87 @@ QImage Spectrogram::renderAudioScope(uint, const audioShortVector &audioFrame, c
         }
 #endif
 
-        // Limit the maximum history size to avoid wasting space
-        while (m_fftHistory.size() > SPECTROGRAM_HISTORY_SIZE) {
-            m_fftHistory.removeLast();
-        }
-
         // Draw the spectrum
-        QImage spectrum(m_scopeRect.size(), QImage::Format_ARGB32);
-        spectrum.fill(qRgba(0, 0, 0, 0));
-        QPainter davinci(&spectrum);
-        const uint h = m_innerScopeRect.height();
-        const uint leftDist = m_innerScopeRect.left() - m_scopeRect.left();
-        const uint topDist = m_innerScopeRect.top() - m_scopeRect.top();
-        uint windowSize;
-        uint y;
-        bool completeRedraw = true;
-
-        if (m_fftHistoryImg.size() == m_scopeRect.size() && !m_parameterChanged) {
-            // The size of the widget and the parameters (like min/max dB) have not changed since last time,
-            // so we can re-use it, shift it by one pixel, and render the single remaining line. Usually about
-            // 10 times faster for a widget height of around 400 px.
-            if (newDataAvailable) {
-                davinci.drawImage(0, -1, m_fftHistoryImg);
-            } else {
-                // spectrum = m_fftHistoryImg does NOT work, leads to segfaults (anyone knows why, please tell me)
-                davinci.drawImage(0, 0, m_fftHistoryImg);
-            }
-            completeRedraw = false;
-        }
+        const int h = m_innerScopeRect.height();
+        const int leftDist = m_innerScopeRect.left() - m_scopeRect.left();
+        const int topDist = m_innerScopeRect.top() - m_scopeRect.top();
+        int y = 0;
+        bool completeRedraw = remapped || m_parameterChanged || m_fftHistoryImg.size() != m_scopeRect.size();
 
-        y = 0;
-        if (newData || m_parameterChanged) {
+        if (completeRedraw) {
             m_parameterChanged = false;
-            bool peak = false;
-
-            QVector<float> dbMap;
-            uint right;
-            ////////////////FIXME
-            for (QList<QVector<float> >::iterator it = m_fftHistory.begin(); it != m_fftHistory.end(); ++it) {
-
-                windowSize = (*it).size();
-
-                // Interpolate the frequency data to match the pixel coordinates
-                right = ((float) m_freqMax) / (m_freq / 2) * (windowSize - 1);
-                dbMap = FFTTools::interpolatePeakPreserving((*it), m_innerScopeRect.width(), 0, right, -180);
-
-                for (int i = 0; i < dbMap.size(); ++i) {
-                    float val;
-                    val = dbMap[i];
-                    peak = val > m_dBmax;
-
-                    // Normalize dB value to [0 1], 1 corresponding to dbMax dB and 0 to dbMin dB
-                    val = (val - m_dBmax) / (m_dBmax - m_dBmin) + 1;
-                    if (val < 0) {
-                        val = 0;
-                    } else if (val > 1) {
-                        val = 1;
-                    }
-                    if (!peak || !m_aHighlightPeaks->isChecked()) {
-                        spectrum.setPixel(leftDist + i, topDist + h - 1 - y, m_colorMap[(int)(val * 255)]);
-                    } else {
-                        spectrum.setPixel(leftDist + i, topDist + h - 1 - y, AbstractScopeWidget::colHighlightDark.rgba());
-                    }
-                }
-
-                y++;
-                if (y >= topDist + m_innerScopeRect.height()) {
-                    break;
-                }
-                if (!completeRedraw) {
-                    break;
-                }
+            m_fftHistoryImg = QImage(m_scopeRect.size(), QImage::Format_ARGB32);
+            m_fftHistoryImg.fill(qRgba(0, 0, 0, 0));
+            for (; y < m_historyCount && y < h; ++y) {
+                drawHistoryRow(historyIndex(y), reinterpret_cast<QRgb *>(m_fftHistoryImg.scanLine(topDist + h - 1 - y)) + leftDist);
+            }
+        } else if (newDataAvailable) {
+            // The size of the widget and the parameters (like min/max dB) have not changed since last time,
+            // so we can re-use the image, scroll it up by one line, and render the single new line.
+            if (h > 1) {
+                uchar *top = m_fftHistoryImg.scanLine(topDist);
+                memmove(top, top + m_fftHistoryImg.bytesPerLine(), (h - 1) * m_fftHistoryImg.bytesPerLine());
             }
+            drawHistoryRow(m_historyHead, reinterpret_cast<QRgb *>(m_fftHistoryImg.scanLine(topDist + h - 1)) + leftDist);
+            y = 1;
         }
 
 #ifdef DEBUG_SPECTROGRAM
-        qCDebug(KDENLIVE_LOG) << "Rendered " << y - topDist << "lines from " << m_fftHistory.size() << " available samples in " << start.elapsed() << " ms"
+        qCDebug(KDENLIVE_LOG) << "Rendered " << y << "lines from " << m_historyCount << " available samples in " << start.elapsed() << " ms"
                               << (completeRedraw ? "" : " (re-used old image)");
-        uint storedBytes = 0;
-        for (QList< QVector<float> >::iterator it = m_fftHistory.begin(); it != m_fftHistory.end(); ++it) {
-            storedBytes += (*it).size() * sizeof((*it)[0]);
-        }
-        qCDebug(KDENLIVE_LOG) << QString("Total storage used: %1 kB").arg((double)storedBytes / 1000, 0, 'f', 2);
+        qCDebug(KDENLIVE_LOG) << QString("Total storage used: %1 kB").arg((double)(m_fftHistory.size() + m_mappedHistory.size()) * sizeof(float) / 1000, 0, 'f', 2);
+#else
+        Q_UNUSED(y)
 #endif
 
-        m_fftHistoryImg = spectrum;
-
         emit signalScopeRenderingFinished(start.elapsed(), 1);
-        return spectrum;
+        return m_fftHistoryImg;
     } else {
         emit signalScopeRenderingFinished(0, 1);
         return QImage();
     }
 }
+
+int Spectrogram::historyIndex(int age) const
+{
+    return (m_historyHead - age + SPECTROGRAM_HISTORY_SIZE) % SPECTROGRAM_HISTORY_SIZE;
+}
+
+void Spectrogram::mapHistoryRow(int index)
+{
+    const int windowSize = m_fftHistoryLength.at(index);
+    // Interpolate the frequency data to match the pixel coordinates
+    const uint right = ((float) m_freqMax) / (m_freq / 2) * (windowSize - 1);
+    FFTTools::interpolatePeakPreserving(m_fftHistory.constData() + index * m_historyStride, windowSize,
+                                        m_mappedHistory.data() + index * m_mappedWidth, m_mappedWidth, 0, right, -180);
+}
+
+void Spectrogram::remapHistory()
+{
+    m_mappedHistory.resize(SPECTROGRAM_HISTORY_SIZE * m_mappedWidth);
+    for (int age = 0; age < m_historyCount; ++age) {
+        mapHistoryRow(historyIndex(age));
+    }
+}
+
+void Spectrogram::drawHistoryRow(int index, QRgb *line) const
+{
+    const float *dbMap = m_mappedHistory.constData() + index * m_mappedWidth;
+    // Normalize dB values to [0 1], 1 corresponding to dbMax dB and 0 to dbMin dB.
+    // Kept branch free so that the compiler can vectorize it; peaks get the extra palette entry.
+    const float scale = 1.0f / (m_dBmax - m_dBmin);
+    const float dBmax = m_dBmax;
+    const int peakIndex = m_aHighlightPeaks->isChecked() ? 256 : 255;
+    QRgb palette[257];
+    memcpy(palette, m_colorMap, sizeof(m_colorMap));
+    palette[256] = AbstractScopeWidget::colHighlightDark.rgba();
+    for (int i = 0; i < m_mappedWidth; ++i) {
+        const float val = (dbMap[i] - dBmax) * scale + 1;
+        const int colorIndex = val > 1 ? peakIndex : (int)(qBound(0.0f, val, 1.0f) * 255);
+        line[i] = palette[colorIndex];
+    }
+}
+
 QImage Spectrogram::renderBackground(uint)
 {
     return QImage();
@@ -550,6 +571,7 @@ void Spectrogram::resizeEvent(QResizeEvent *event)
 }
 
 #undef SPECTROGRAM_HISTORY_SIZE
+#undef SPECTROGRAM_MAX_WINDOW
 #ifdef DEBUG_SPECTROGRAM
 #undef DEBUG_SPECTROGRAM
 #endif
@@ -11,15 +11,19 @@
 /** This Spectrogram shows the spectral power distribution of incoming audio samples
     over time. See http://en.wikipedia.org/wiki/Spectrogram.
 
-    The Spectrogram makes use of two caches:
-    * A cached image where only the most recent line needs to be appended instead of
-      having to recalculate the whole image. A typical speedup factor is 10x.
+    The Spectrogram makes use of three caches:
+    * A cached image which is scrolled by one line, so only the most recent scanline needs
+      to be written instead of having to recalculate the whole image.
     * A FFT cache storing a history of previous spectral power distributions (i.e.
       the Fourier-transformed audio signals). This is used if the user adjusts parameters
-      like the maximum frequency to display or minimum/maximum signal strength in dB.
+      like the maximum frequency to display or resizes the widget.
       All required information is preserved in the FFT history, which would not be the
       case for an image (consider re-sizing the widget to 100x100 px and then back to
       800x400 px -- lost is lost).
+    * The same history already mapped to dB values per pixel column, so changing the
+      minimum/maximum signal strength only needs a colour lookup for each row.
+    Both histories are ring buffers in contiguous memory, the newest row is written in place
+    and the oldest one is overwritten once the history is full.
 */
 
 #ifndef SPECTROGRAM_H
@@ -62,8 +66,21 @@ private:
     QAction *m_aTrackMouse;
     QAction *m_aHighlightPeaks;
 
-    QList<QVector<float> > m_fftHistory;
+    /** Raw spectra, SPECTROGRAM_HISTORY_SIZE rows of m_historyStride values */
+    QVector<float> m_fftHistory;
+    /** Number of valid values in each row of m_fftHistory (depends on the window size used) */
+    QVector<int> m_fftHistoryLength;
+    /** m_fftHistory interpolated to m_mappedWidth pixel columns, in dB */
+    QVector<float> m_mappedHistory;
     QImage m_fftHistoryImg;
+    int m_historyStride;
+    /** Ring index of the most recent row */
+    int m_historyHead;
+    int m_historyCount;
+    /** Parameters m_mappedHistory was computed with */
+    int m_mappedWidth;
+    int m_mappedFreqMax;
+    int m_mappedFreq;
 
     int m_dBmin;
     int m_dBmax;
@@ -76,6 +93,15 @@ private:
     QRect m_innerScopeRect;
     QRgb m_colorMap[256];
 
+    /** Ring buffer index of the row @p age rows before the most recent one */
+    int historyIndex(int age) const;
+    /** Interpolate a raw spectrum row to pixel columns */
+    void mapHistoryRow(int index);
+    /** Re-interpolate the whole history, e.g. after the scope was resized */
+    void remapHistory();
+    /** Write the colours for a mapped history row into an image scanline */
+    void drawHistoryRow(int index, QRgb *line) const;
+
 private slots:
     void slotResetMaxFreq();
 
@@ -11,6 +11,7 @@
 #include "abstractgfxscopewidget.h"
 #include "renderer.h"
 #include "monitor/monitormanager.h"
+#include "utils/tracer.h"
 
 #include <QMouseEvent>
 
@@ -29,6 +30,7 @@ AbstractGfxScopeWidget::~AbstractGfxScopeWidget() { }
 
 QImage AbstractGfxScopeWidget::renderScope(uint accelerationFactor)
 {
+    KDENLIVE_TRACE("scopes", "Render color scope");
     QMutexLocker lock(&m_mutex);
     return renderGfxScope(accelerationFactor, m_scopeImage);
 }
@@ -39,6 +39,7 @@ ScopeManager::ScopeManager(QObject *parent) :
     connect(pCore->monitorManager(), &MonitorManager::checkColorScopes, this, &ScopeManager::slotUpdateActiveRenderer);
     connect(pCore->monitorManager(), &MonitorManager::clearScopes, this, &ScopeManager::slotClearColorScopes);
     connect(pCore->monitorManager(), &MonitorManager::checkScopes, this, &ScopeManager::slotCheckActiveScopes);
+    connect(pCore->monitorManager()->audioAnalysis(), &AudioAnalysis::analysisReady, this, &ScopeManager::slotDistributeAnalysis);
     connect(m_signalMapper, SIGNAL(mapped(QString)), SLOT(slotRequestFrame(QString)));
 
     slotUpdateActiveRenderer();
@@ -114,6 +115,11 @@ bool ScopeManager::addScope(AbstractGfxScopeWidget *colorScope, QDockWidget *col
 }
 
 void ScopeManager::slotDistributeAudio(const audioShortVector &sampleData, int freq, int num_channels, int num_samples)
+{
+    pCore->monitorManager()->audioAnalysis()->addSamples(sampleData, freq, num_channels, num_samples);
+}
+
+void ScopeManager::slotDistributeAnalysis(const AudioAnalysisResult &analysis)
 {
 #ifdef DEBUG_SM
     qCDebug(KDENLIVE_LOG) << "ScopeManager: Starting to distribute audio.";
@@ -122,7 +128,7 @@ void ScopeManager::slotDistributeAudio(const audioShortVector &sampleData, int f
         // Distribute audio to all scopes that are visible and want to be refreshed
         if (!m_audioScopes[i].scope->visibleRegion().isEmpty()) {
             if (m_audioScopes[i].scope->autoRefreshEnabled()) {
-                m_audioScopes[i].scope->slotReceiveAudio(sampleData, freq, num_channels, num_samples);
+                m_audioScopes[i].scope->slotReceiveAudio(analysis);
 #ifdef DEBUG_SM
                 qCDebug(KDENLIVE_LOG) << "ScopeManager: Distributed audio to " << m_audioScopes[i].scope->widgetName();
 #endif
@@ -273,6 +279,19 @@ void ScopeManager::checkActiveAudioScopes()
 {
     bool audioStillRequested = audioAcceptedByScopes();
 
+    // Hidden scopes should not keep their spectra computed
+    AudioAnalysis *analysis = pCore->monitorManager()->audioAnalysis();
+    for (int i = 0; i < m_audioScopes.size(); ++i) {
+        if (!m_audioScopes.at(i).scope->isVisible() || !m_audioScopes.at(i).scope->autoRefreshEnabled()) {
+            analysis->unsubscribe(m_audioScopes.at(i).scope);
+        }
+    }
+    if (audioStillRequested) {
+        analysis->subscribe(this);
+    } else {
+        analysis->unsubscribe(this);
+    }
+
 #ifdef DEBUG_SM
     qCDebug(KDENLIVE_LOG) << "ScopeManager: New audio data still requested? " << audioStillRequested;
 #endif
@@ -126,7 +126,10 @@ private slots:
     void checkActiveColourScopes();
 
     void slotDistributeFrame(const QImage &image);
+    /** @brief Feeds samples of renderers not providing SharedFrames (capture) to the shared audio analysis. */
     void slotDistributeAudio(const audioShortVector &sampleData, int freq, int num_channels, int num_samples);
+    /** @brief Sends the shared audio analysis results to the visible audio scopes. */
+    void slotDistributeAnalysis(const AudioAnalysisResult &analysis);
     /**
       Allows a scope to explicitly request a new frame, even if the scope's autoRefresh is disabled.
       */
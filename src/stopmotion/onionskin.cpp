@@ -0,0 +1,115 @@
+/*
+Copyright (C) 2018  Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "onionskin.h"
+
+#include <QPainter>
+
+OnionSkin::OnionSkin(int depth) :
+    m_head(0)
+    , m_count(0)
+    , m_dirty(false)
+{
+    setDepth(depth);
+}
+
+void OnionSkin::setDepth(int depth)
+{
+    depth = qMax(1, depth);
+    if (depth == m_frames.count()) {
+        return;
+    }
+    // Keep the most recent frames, oldest first
+    QVector<QImage> frames;
+    frames.reserve(depth);
+    for (int i = qMax(0, m_count - depth); i < m_count; ++i) {
+        frames.append(m_frames.at((m_head - m_count + i + m_frames.count()) % m_frames.count()));
+    }
+    m_count = frames.count();
+    frames.resize(depth);
+    m_frames = frames;
+    m_head = m_count % depth;
+    m_dirty = true;
+}
+
+int OnionSkin::depth() const
+{
+    return m_frames.count();
+}
+
+void OnionSkin::addFrame(const QImage &frame)
+{
+    if (frame.isNull()) {
+        return;
+    }
+    if (!m_buffer.isNull() && frame.size() != m_buffer.size()) {
+        // Capture size changed, previous frames cannot be blended anymore
+        clear();
+    }
+    QImage &slot = m_frames[m_head];
+    if (slot.size() != frame.size() || slot.format() != QImage::Format_ARGB32_Premultiplied) {
+        slot = QImage(frame.size(), QImage::Format_ARGB32_Premultiplied);
+    }
+    // Draw into the existing buffer instead of keeping a reference on the caller's image
+    QPainter p(&slot);
+    p.setCompositionMode(QPainter::CompositionMode_Source);
+    p.drawImage(0, 0, frame);
+    p.end();
+    m_head = (m_head + 1) % m_frames.count();
+    m_count = qMin(m_count + 1, m_frames.count());
+    if (m_buffer.isNull()) {
+        m_buffer = QImage(frame.size(), QImage::Format_ARGB32_Premultiplied);
+    }
+    m_dirty = true;
+}
+
+void OnionSkin::clear()
+{
+    m_head = 0;
+    m_count = 0;
+    m_buffer = QImage();
+    m_dirty = false;
+}
+
+bool OnionSkin::isEmpty() const
+{
+    return m_count == 0;
+}
+
+const QImage &OnionSkin::composite()
+{
+    if (!m_dirty || m_count == 0) {
+        return m_buffer;
+    }
+    m_buffer.fill(Qt::transparent);
+    QPainter p(&m_buffer);
+    int depth = m_frames.count();
+    for (int i = 0; i < m_count; ++i) {
+        // Oldest frame first. Frames are opaque, so blend them as a weighted average
+        // where the weight of a frame grows linearly with its recency: w(i) = i + 1
+        const QImage &frame = m_frames.at((m_head - m_count + i + depth) % depth);
+        p.setOpacity(2.0 / (i + 2));
+        p.drawImage(0, 0, frame);
+    }
+    p.end();
+    m_dirty = false;
+    return m_buffer;
+}
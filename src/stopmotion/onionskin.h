@@ -0,0 +1,59 @@
+/*
+Copyright (C) 2018  Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ONIONSKIN_H
+#define ONIONSKIN_H
+
+#include <QImage>
+#include <QVector>
+
+/**
+ * @class OnionSkin
+ * @brief Keeps the last captured frames of a stop motion sequence and blends them into one overlay image.
+ *
+ * Frames are copied into a fixed ring of buffers and the composite is drawn into a single reused image,
+ * so adding a capture never requires decoding the previous frames again.
+ */
+class OnionSkin
+{
+public:
+    explicit OnionSkin(int depth = 1);
+    /** @brief Sets the number of previous frames blended in the overlay. */
+    void setDepth(int depth);
+    int depth() const;
+    /** @brief Adds the latest captured frame, dropping the oldest one if the ring is full. */
+    void addFrame(const QImage &frame);
+    /** @brief Removes all frames. */
+    void clear();
+    bool isEmpty() const;
+    /** @brief Returns the blended overlay, most recent frame on top and older frames fading out. */
+    const QImage &composite();
+
+private:
+    QVector<QImage> m_frames;
+    /** @brief Index of the slot that receives the next frame. */
+    int m_head;
+    int m_count;
+    QImage m_buffer;
+    bool m_dirty;
+};
+
+#endif
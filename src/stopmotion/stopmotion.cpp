@@ -42,6 +42,10 @@
 #include <QMenu>
 #include <QtConcurrent>
 #include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QImageReader>
 
 MyLabel::MyLabel(QWidget *parent) :
     QLabel(parent)
@@ -154,6 +158,9 @@ StopmotionWidget::StopmotionWidget(MonitorManager *manager, const QUrl &projectF
     , m_captureDevice(nullptr)
     , m_sequenceFrame(0)
     , m_animatedIndex(-1)
+    , m_thumbWorkerActive(false)
+    , m_onionSkin(KdenliveSettings::sm_onionframes())
+    , m_onionFrame(-1)
     , m_animate(false)
     , m_manager(manager)
     , m_monitor(new StopmotionMonitor(manager, this))
@@ -318,6 +325,7 @@ StopmotionWidget::StopmotionWidget(MonitorManager *manager, const QUrl &projectF
     m_captureDevice->sendFrameForAnalysis = KdenliveSettings::analyse_stopmotion();
     m_monitor->setRender(m_captureDevice);
     connect(m_captureDevice, SIGNAL(frameSaved(QString)), this, SLOT(slotNewThumb(QString)));
+    connect(m_captureDevice, SIGNAL(frameCaptured(QString,QImage)), this, SLOT(slotNewFrame(QString,QImage)));
     */
 
     live_button->setChecked(false);
@@ -341,6 +349,10 @@ StopmotionWidget::StopmotionWidget(MonitorManager *manager, const QUrl &projectF
 
 StopmotionWidget::~StopmotionWidget()
 {
+    m_filesMutex.lock();
+    m_filesList.clear();
+    m_filesMutex.unlock();
+    m_future.waitForFinished();
     m_manager->removeMonitor(m_monitor);
     if (m_captureDevice) {
         m_captureDevice->stop();
@@ -380,6 +392,7 @@ void StopmotionWidget::slotConfigure()
     ui.sm_prenotify->setChecked(KdenliveSettings::sm_prenotify());
     ui.sm_loop->setChecked(KdenliveSettings::sm_loop());
     ui.sm_framesplayback->setValue(KdenliveSettings::sm_framesplayback());
+    ui.sm_onionframes->setValue(KdenliveSettings::sm_onionframes());
 
     if (d.exec() == QDialog::Accepted) {
         KdenliveSettings::setSm_loop(ui.sm_loop->isChecked());
@@ -387,6 +400,15 @@ void StopmotionWidget::slotConfigure()
         KdenliveSettings::setSm_framesplayback(ui.sm_framesplayback->value());
         KdenliveSettings::setSm_notifytime(ui.sm_notifytime->value());
         KdenliveSettings::setSm_prenotify(ui.sm_prenotify->isChecked());
+        if (ui.sm_onionframes->value() != KdenliveSettings::sm_onionframes()) {
+            KdenliveSettings::setSm_onionframes(ui.sm_onionframes->value());
+            m_onionSkin.setDepth(KdenliveSettings::sm_onionframes());
+            m_onionSkin.clear();
+            m_onionFrame = -1;
+            if (m_showOverlay->isChecked()) {
+                reloadOverlay();
+            }
+        }
         m_intervalTimer.setInterval(KdenliveSettings::captureinterval() * 1000);
     }
 }
@@ -398,7 +420,10 @@ void StopmotionWidget::slotShowThumbs(bool show)
         frame_list->clear();
         sequenceNameChanged(sequence_name->currentText());
     } else {
+        m_filesMutex.lock();
         m_filesList.clear();
+        m_filesMutex.unlock();
+        m_thumbFrames.clear();
         frame_list->clear();
     }
     frame_list->setHidden(!show);
@@ -492,6 +517,7 @@ void StopmotionWidget::slotLive(bool isOn)
             m_captureDevice->sendFrameForAnalysis = KdenliveSettings::analyse_stopmotion();
             m_monitor->setRender(m_captureDevice);
             connect(m_captureDevice, SIGNAL(frameSaved(QString)), this, SLOT(slotNewThumb(QString)));
+            connect(m_captureDevice, SIGNAL(frameCaptured(QString,QImage)), this, SLOT(slotNewFrame(QString,QImage)));
             }
 
             m_manager->activateMonitor(Kdenlive::StopMotionMonitor);
@@ -556,14 +582,35 @@ void StopmotionWidget::slotShowOverlay(bool isOn)
 
 void StopmotionWidget::reloadOverlay()
 {
-    const QString path = getPathForFrame(m_sequenceFrame - 1);
-    if (!QFile::exists(path)) {
+    const int last = m_sequenceFrame - 1;
+    if (m_onionFrame != last) {
+        // Frames were not received from the capture device, read the missing ones
+        if (m_onionFrame > last || m_onionFrame < last - m_onionSkin.depth()) {
+            m_onionSkin.clear();
+            m_onionFrame = last - m_onionSkin.depth();
+        }
+        for (int i = qMax(0, m_onionFrame + 1); i <= last; ++i) {
+            m_onionSkin.addFrame(QImage(getPathForFrame(i)));
+        }
+        m_onionFrame = last;
+    }
+    if (m_onionSkin.isEmpty()) {
         log_box->insertItem(-1, i18n("No previous frame found"));
         log_box->setCurrentIndex(0);
         return;
     }
     if (m_captureDevice) {
-        m_captureDevice->setOverlay(path);
+        if (m_onionSkin.depth() == 1) {
+            m_captureDevice->setOverlay(getPathForFrame(last));
+            return;
+        }
+        // The overlay producer needs a file, write the blended frames once
+        QDir cacheDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+        cacheDir.mkpath(QStringLiteral("stopmotion"));
+        const QString overlayPath = cacheDir.absoluteFilePath(QStringLiteral("stopmotion/onionskin.png"));
+        if (m_onionSkin.composite().save(overlayPath, "PNG", 100)) {
+            m_captureDevice->setOverlay(overlayPath);
+        }
     }
 }
 
@@ -605,24 +652,30 @@ void StopmotionWidget::slotUpdateOverlay()
 
 void StopmotionWidget::sequenceNameChanged(const QString &name)
 {
-    // Get rid of frames from previous sequence
-    disconnect(this, &StopmotionWidget::doCreateThumbs, this, &StopmotionWidget::slotCreateThumbs);
+    // Get rid of frames from previous sequence, thumbnails still in flight are discarded in slotCreateThumbs
+    m_filesMutex.lock();
     m_filesList.clear();
+    m_filesMutex.unlock();
     m_future.waitForFinished();
     frame_list->clear();
+    m_thumbFrames.clear();
+    m_onionSkin.clear();
+    m_onionFrame = -1;
     if (name.isEmpty()) {
         button_addsequence->setEnabled(false);
     } else {
         // Check if we are editing an existing sequence
-        m_sequenceFrame = m_filesList.isEmpty() ? 0 : SlideshowClip::getFrameNumberFromPath(QUrl::fromLocalFile(m_filesList.last())) + 1;
-        if (!m_filesList.isEmpty()) {
-            m_sequenceName = sequence_name->currentText();
-            connect(this, &StopmotionWidget::doCreateThumbs, this, &StopmotionWidget::slotCreateThumbs);
-            m_future = QtConcurrent::run(this, &StopmotionWidget::slotPrepareThumbs);
+        QStringList files;
+        SlideshowClip::selectedPath(QUrl::fromLocalFile(getPathForFrame(0, name)), false, QString(), &files);
+        m_sequenceFrame = files.isEmpty() ? 0 : SlideshowClip::getFrameNumberFromPath(QUrl::fromLocalFile(files.last())) + 1;
+        if (!files.isEmpty()) {
+            m_sequenceName = name;
+            if (KdenliveSettings::showstopmotionthumbs()) {
+                queueThumbs(files);
+            }
             button_addsequence->setEnabled(true);
         } else {
             // new sequence
-            connect(this, &StopmotionWidget::doCreateThumbs, this, &StopmotionWidget::slotCreateThumbs);
             button_addsequence->setEnabled(false);
         }
         capture_button->setEnabled(live_button->isChecked());
@@ -678,39 +731,93 @@ void StopmotionWidget::slotPreNotify()
 
 void StopmotionWidget::slotNewThumb(const QString &path)
 {
+    if (m_showOverlay->isChecked()) {
+        reloadOverlay();
+    }
     if (!KdenliveSettings::showstopmotionthumbs()) {
         return;
     }
-    m_filesList.append(path);
-    if (m_showOverlay->isChecked()) {
-        reloadOverlay();
+    queueThumbs(QStringList() << path);
+}
+
+void StopmotionWidget::slotNewFrame(const QString &path, const QImage &img)
+{
+    int ix = SlideshowClip::getFrameNumberFromPath(QUrl::fromLocalFile(path));
+    if (QFileInfo(path).fileName() != QFileInfo(getPathForFrame(ix)).fileName()) {
+        return;
     }
-    if (!m_future.isRunning()) {
-        m_future = QtConcurrent::run(this, &StopmotionWidget::slotPrepareThumbs);
+    if (ix != m_onionFrame + 1) {
+        // Not following the frames we have, reload from disk when needed
+        m_onionSkin.clear();
+        m_onionFrame = -1;
+        return;
     }
+    m_onionSkin.addFrame(img);
+    m_onionFrame = ix;
+}
 
+void StopmotionWidget::queueThumbs(const QStringList &files)
+{
+    QMutexLocker lock(&m_filesMutex);
+    m_filesList << files;
+    if (!m_thumbWorkerActive) {
+        m_thumbWorkerActive = true;
+        m_future = QtConcurrent::run(this, &StopmotionWidget::slotPrepareThumbs);
+    }
 }
 
 void StopmotionWidget::slotPrepareThumbs()
 {
-    if (m_filesList.isEmpty()) {
-        return;
+    QDir cacheDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+    cacheDir.mkpath(QStringLiteral("stopmotion/thumbs"));
+    cacheDir.cd(QStringLiteral("stopmotion/thumbs"));
+    forever {
+        m_filesMutex.lock();
+        if (m_filesList.isEmpty()) {
+            m_thumbWorkerActive = false;
+            m_filesMutex.unlock();
+            return;
+        }
+        const QString path = m_filesList.takeFirst();
+        m_filesMutex.unlock();
+
+        // Thumbnails are cached on disk, keyed by file path and modification time
+        QFileInfo info(path);
+        const QString key = QString::fromLatin1(QCryptographicHash::hash(path.toUtf8(), QCryptographicHash::Md5).toHex()) + QLatin1Char('_') + QString::number(info.lastModified().toMSecsSinceEpoch()) + QStringLiteral(".png");
+        QImage img;
+        if (cacheDir.exists(key)) {
+            img.load(cacheDir.absoluteFilePath(key));
+        }
+        if (img.isNull()) {
+            QImageReader reader(path);
+            QSize size = reader.size();
+            if (size.isValid() && size.height() > 0) {
+                reader.setScaledSize(QSize(90 * size.width() / size.height(), 90));
+            }
+            img = reader.read();
+            if (!img.isNull() && img.height() != 90) {
+                img = img.scaledToHeight(90, Qt::SmoothTransformation);
+            }
+            if (!img.isNull()) {
+                img.save(cacheDir.absoluteFilePath(key));
+            }
+        }
+        emit doCreateThumbs(img, path);
     }
-    QString path = m_filesList.takeFirst();
-    emit doCreateThumbs(QImage(path), SlideshowClip::getFrameNumberFromPath(QUrl::fromLocalFile(path)));
-
 }
 
-void StopmotionWidget::slotCreateThumbs(const QImage &img, int ix)
+void StopmotionWidget::slotCreateThumbs(const QImage &img, const QString &path)
 {
-    if (img.isNull()) {
-        m_future = QtConcurrent::run(this, &StopmotionWidget::slotPrepareThumbs);
+    int ix = SlideshowClip::getFrameNumberFromPath(QUrl::fromLocalFile(path));
+    if (img.isNull() || m_thumbFrames.contains(ix) || QFileInfo(path).fileName() != QFileInfo(getPathForFrame(ix, sequence_name->currentText())).fileName()) {
+        // Broken file, already listed or left over from a previous sequence
         return;
     }
-    int height = 90;
-    int width = height * img.width() / img.height();
+    m_thumbFrames.insert(ix);
+    int height = img.height();
+    int width = img.width();
     frame_list->setIconSize(QSize(width, height));
-    QPixmap pix = QPixmap::fromImage(img).scaled(width, height);
+    QPixmap pix = QPixmap::fromImage(img);
     QString nb = QString::number(ix);
     QPainter p(&pix);
     QFontInfo finfo(font());
@@ -725,7 +832,6 @@ void StopmotionWidget::slotCreateThumbs(const QImage &img, int ix)
     frame_list->blockSignals(true);
     frame_list->setCurrentItem(item);
     frame_list->blockSignals(false);
-    m_future = QtConcurrent::run(this, &StopmotionWidget::slotPrepareThumbs);
 }
 
 QString StopmotionWidget::getPathForFrame(int ix, QString seqName)
@@ -856,6 +962,9 @@ void StopmotionWidget::slotRemoveFrame()
     if (f.remove()) {
         QListWidgetItem *item = frame_list->takeItem(frame_list->currentRow());
         int ix = item->data(Qt::UserRole).toInt();
+        m_thumbFrames.remove(ix);
+        m_onionSkin.clear();
+        m_onionFrame = -1;
         if (ix == m_sequenceFrame - 1) {
             // We are removing the last frame, update counter
             QListWidgetItem *item2 = frame_list->item(frame_list->count() - 1);
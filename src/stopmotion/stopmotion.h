@@ -20,10 +20,13 @@
 
 #include "ui_stopmotion_ui.h"
 #include "definitions.h"
+#include "onionskin.h"
 
 #include <QUrl>
 #include <QLabel>
 #include <QFuture>
+#include <QMutex>
+#include <QSet>
 #include <QTimer>
 #include "monitor/abstractmonitor.h"
 
@@ -121,12 +124,25 @@ private:
     /** @brief This widget will hold the frame preview. */
     MyLabel *m_frame_preview;
 
-    /** @brief The list of files in the sequence to create thumbnails. */
+    /** @brief The list of files in the sequence waiting for a thumbnail, protected by m_filesMutex. */
     QStringList m_filesList;
+    QMutex m_filesMutex;
+
+    /** @brief True while the thumbnail thread is processing m_filesList, protected by m_filesMutex. */
+    bool m_thumbWorkerActive;
+
+    /** @brief Frame numbers already listed in the thumbnail view. */
+    QSet<int> m_thumbFrames;
 
     /** @brief Holds the state of the threaded thumbnail generation. */
     QFuture<void> m_future;
 
+    /** @brief The last captured frames, blended for the overlay. */
+    OnionSkin m_onionSkin;
+
+    /** @brief Number of the most recent frame stored in m_onionSkin, -1 if none. */
+    int m_onionFrame;
+
     /** @brief The action triggering display of last frame over current live video feed. */
     QAction *m_showOverlay;
 
@@ -150,6 +166,9 @@ private:
     /** @brief A new frame arrived, reload overlay. */
     void reloadOverlay();
 
+    /** @brief Add files to the thumbnail queue, starting the thumbnail thread if needed. */
+    void queueThumbs(const QStringList &files);
+
     /** @brief Holds the index of the effect to be applied to the video feed. */
     int m_effectIndex;
 
@@ -201,10 +220,10 @@ private slots:
     /** @brief Display warning / error message from capture backend. */
     void slotGotHDMIMessage(const QString &message);
 
-    /** @brief Create thumbnails for existing sequence frames. */
-    void slotCreateThumbs(const QImage &img, int ix);
+    /** @brief Add a thumbnail for a sequence frame to the frame list. */
+    void slotCreateThumbs(const QImage &img, const QString &path);
 
-    /** @brief Prepare thumbnails creation. */
+    /** @brief Create thumbnails for the queued frames, reusing the disk cache when possible. Runs in a separate thread. */
     void slotPrepareThumbs();
 
     /** @brief Called when user switches the video capture backend. */
@@ -219,6 +238,9 @@ private slots:
     /** @brief Prepare to crete thumb for newly captured frame. */
     void slotNewThumb(const QString &path);
 
+    /** @brief A frame was captured, add it to the onion skin without reading it back from disk. */
+    void slotNewFrame(const QString &path, const QImage &img);
+
     /** @brief Set the effect to be applied to overlay frame. */
     void slotUpdateOverlayEffect(QAction *act);
 
@@ -241,7 +263,7 @@ signals:
     /** @brief Ask to add sequence to current project. */
     void addOrUpdateSequence(const QString &);
 
-    void doCreateThumbs(const QImage &, int);
+    void doCreateThumbs(const QImage &, const QString &);
     void gotFrame(const QImage &);
 };
 
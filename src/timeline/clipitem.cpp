@@ -30,6 +30,7 @@
 #include "mltcontroller/effectscontroller.h"
 #include "onmonitoritems/rotoscoping/rotowidget.h"
 #include "utils/KoIconUtils.h"
+#include "utils/tracer.h"
 
 #include <klocalizedstring.h>
 #include "kdenlive_debug.h"
@@ -40,6 +41,20 @@
 #include <QMimeData>
 
 static int FRAME_SIZE;
+// Width in pixels of the cached audio thumbnail tiles
+static const int AUDIO_TILE_WIDTH = 256;
+// Maximum number of audio tiles cached per clip
+static const int AUDIO_TILE_MAX = 32;
+
+static QPixmap scaledThumb(const QPixmap &pix, int height, qreal ratio)
+{
+    if (pix.isNull() || height <= 0) {
+        return QPixmap();
+    }
+    QPixmap result = pix.scaledToHeight(qRound(height * ratio), Qt::SmoothTransformation);
+    result.setDevicePixelRatio(ratio);
+    return result;
+}
 
 ClipItem::ClipItem(ProjectClip *clip, const ItemInfo &info, double fps, double speed, int strobe, int frame_width, bool generateThumbs) :
     AbstractClipItem(info, QRectF(), fps),
@@ -502,6 +517,7 @@ QPixmap ClipItem::endThumb() const
 void ClipItem::slotGotAudioData()
 {
     m_audioThumbReady = true;
+    m_audioThumbCachePic.clear();
     if (m_clipType == AV && m_clipState != PlaylistState::AudioOnly) {
         QRectF r = boundingRect();
         r.setTop(r.top() + r.height() / 2 - 1);
@@ -511,6 +527,224 @@ void ClipItem::slotGotAudioData()
     }
 }
 
+void ClipItem::drawAudioTiles(QPainter *painter, const QRectF &mappedRect, const QRectF &mappedExposed, double scale)
+{
+    // Tiles are positioned relative to the clip start so that they remain valid when scrolling
+    const qreal ratio = painter->device()->devicePixelRatioF();
+    const QString key = QStringLiteral("%1:%2:%3:%4:%5").arg(scale).arg(qRound(mappedRect.height())).arg(m_info.cropStart.frames(m_fps)).arg(KdenliveSettings::displayallchannels()).arg(ratio);
+    if (key != m_audioTileKey) {
+        m_audioThumbCachePic.clear();
+        m_audioTileKey = key;
+    }
+    const int origin = qRound(mappedRect.left());
+    const int height = qRound(mappedRect.height());
+    const int firstTile = qMax(0, (int) (mappedExposed.left() - origin) / AUDIO_TILE_WIDTH);
+    const int lastTile = qMax(0, (int) (mappedExposed.right() - origin) / AUDIO_TILE_WIDTH);
+    for (int tile = firstTile; tile <= lastTile; ++tile) {
+        if (!m_audioThumbCachePic.contains(tile)) {
+            QPixmap pix(QSize(AUDIO_TILE_WIDTH, height) * ratio);
+            pix.setDevicePixelRatio(ratio);
+            pix.fill(Qt::transparent);
+            QPainter tilePainter(&pix);
+            tilePainter.translate(-tile * AUDIO_TILE_WIDTH, 0);
+            const int startpixel = (int) (tile * AUDIO_TILE_WIDTH / scale);
+            const int endpixel = (int) ((tile + 1) * AUDIO_TILE_WIDTH / scale + 0.5) + 1;
+            drawAudioThumb(&tilePainter, QRectF(0, 0, mappedRect.width(), height), scale, startpixel, endpixel);
+            tilePainter.end();
+            while (m_audioThumbCachePic.count() >= AUDIO_TILE_MAX) {
+                // Drop the tile farthest from the exposed area
+                const int first = m_audioThumbCachePic.firstKey();
+                const int last = m_audioThumbCachePic.lastKey();
+                m_audioThumbCachePic.remove(tile - first > last - tile ? first : last);
+            }
+            m_audioThumbCachePic.insert(tile, pix);
+        }
+        painter->drawPixmap(origin + tile * AUDIO_TILE_WIDTH, qRound(mappedRect.top()), m_audioThumbCachePic.value(tile));
+    }
+}
+
+void ClipItem::updateThumbStrip(int height, qreal ratio)
+{
+    const QString key = QStringLiteral("%1:%2:%3:%4").arg(m_startPix.cacheKey()).arg(m_endPix.cacheKey()).arg(height).arg(ratio);
+    if (key == m_thumbStripKey) {
+        return;
+    }
+    m_thumbStripKey = key;
+    m_startStrip = scaledThumb(m_startPix, height, ratio);
+    m_endStrip = scaledThumb(m_endPix, height, ratio);
+}
+
+const QPixmap &ClipItem::nameLabel(const QFont &font, qreal ratio, int maxWidth, const QColor &textColor, const QColor &bgColor, const QPalette &palette)
+{
+    const QString name = clipName();
+    const QFontMetrics metrics(font);
+    const int stateWidth = m_clipState != PlaylistState::Original ? metrics.lineSpacing() : 0;
+    const int width = qMax(1, qMin(metrics.width(name) + stateWidth + 3, maxWidth));
+    const QString key = QStringLiteral("%1:%2:%3:%4:%5:%6:%7:%8:%9").arg(name).arg((int) m_clipState).arg(m_isMainSelectedClip).arg(textColor.rgba()).arg(bgColor.rgba()).arg(palette.window().color().rgba()).arg(font.key()).arg(width).arg(ratio);
+    if (key == m_nameLabelKey) {
+        return m_nameLabel;
+    }
+    m_nameLabelKey = key;
+    const int height = metrics.height();
+    m_nameLabel = QPixmap(QSize(width, height) * ratio);
+    m_nameLabel.setDevicePixelRatio(ratio);
+    m_nameLabel.fill(m_isMainSelectedClip ? QColor(Qt::red) : bgColor);
+    QPainter painter(&m_nameLabel);
+    painter.setFont(font);
+    // Draw clip state
+    if (stateWidth > 0) {
+        if (m_isMainSelectedClip) {
+            painter.fillRect(1, 0, stateWidth, stateWidth, palette.window().color());
+        }
+        QString icon;
+        switch (m_clipState) {
+        case PlaylistState::VideoOnly:
+            icon = QStringLiteral("kdenlive-show-video");
+            break;
+        case PlaylistState::AudioOnly:
+            icon = QStringLiteral("kdenlive-show-audio");
+            break;
+        case PlaylistState::Disabled:
+            icon = QStringLiteral("remove");
+            break;
+        default:
+            break;
+        }
+        if (!icon.isEmpty()) {
+            painter.drawPixmap(QPointF(1, 0), KoIconUtils::themedIcon(icon).pixmap(QSize(stateWidth, stateWidth)));
+        }
+    }
+    painter.setPen(textColor);
+    painter.drawText(QRectF(1 + stateWidth, 0, width, height), Qt::AlignLeft, name);
+    painter.end();
+    return m_nameLabel;
+}
+
+const QPixmap &ClipItem::effectsLabel(const QFont &font, qreal ratio, const QPalette &palette)
+{
+    QColor bColor = palette.window().color();
+    QColor tColor = palette.text().color();
+    tColor.setAlpha(220);
+    const QString key = QStringLiteral("%1:%2:%3:%4:%5").arg(m_effectNames).arg(bColor.rgba()).arg(tColor.rgba()).arg(font.key()).arg(ratio);
+    if (key == m_effectsLabelKey) {
+        return m_effectsLabel;
+    }
+    m_effectsLabelKey = key;
+    const QFontMetrics metrics(font);
+    const int width = metrics.width(m_effectNames);
+    const int height = metrics.height();
+    // Same margins as the rounded rect drawn around the animated label
+    m_effectsLabel = QPixmap(QSize(width + 5, height + 1) * ratio);
+    m_effectsLabel.setDevicePixelRatio(ratio);
+    m_effectsLabel.fill(Qt::transparent);
+    QPainter painter(&m_effectsLabel);
+    painter.setFont(font);
+    painter.setBrush(bColor);
+    painter.setPen(Qt::NoPen);
+    painter.drawRoundedRect(QRectF(0, 0, width + 5, height + 1), 3, 3);
+    painter.setPen(tColor);
+    painter.drawText(QRectF(3, 2, width - 1, height - 1), Qt::AlignCenter, m_effectNames);
+    painter.end();
+    return m_effectsLabel;
+}
+
+void ClipItem::drawAudioThumb(QPainter *painter, const QRectF &mappedRect, double scale, int startpixel, int endpixel)
+{
+    int channels = m_binClip->audioChannels();
+    int cropLeft = m_info.cropStart.frames(m_fps);
+    double startx = mappedRect.left() + startpixel * scale;
+    double endx = mappedRect.left() + endpixel * scale;
+    int offset = 1;
+    if (scale < 1) {
+        offset = (int)(1.0 / scale);
+    }
+    int audioLevelCount = m_binClip->audioFrameCache.count() - 1;
+    if (!KdenliveSettings::displayallchannels()) {
+        // simplified audio
+        int channelHeight = mappedRect.height();
+        int startOffset = startpixel + cropLeft;
+        int i = startOffset;
+        if (offset * scale > 1.0) {
+            // Pixels are smaller than a frame, draw using painterpath
+            QPainterPath positiveChannelPath;
+            positiveChannelPath.moveTo(startx, mappedRect.bottom());
+            for (; i < endpixel + cropLeft + offset; i += offset) {
+                double value = m_binClip->audioFrameCache.at(qMin(i * channels, audioLevelCount)).toDouble() / 256;
+                for (int channel = 1; channel < channels; channel ++) {
+                    value = qMax(value, m_binClip->audioFrameCache.at(qMin(i * channels + channel, audioLevelCount)).toDouble() / 256);
+                }
+                positiveChannelPath.lineTo(startx + (i - startOffset) * scale, mappedRect.bottom() - (value * channelHeight));
+            }
+            positiveChannelPath.lineTo(startx + (i - startOffset) * scale, mappedRect.bottom());
+            painter->setPen(Qt::NoPen);
+            painter->setBrush(QBrush(QColor(80, 80, 150, 200)));
+            painter->drawPath(positiveChannelPath);
+        } else {
+            // Pixels are larger than frames, draw simple lines
+            painter->setPen(QColor(80, 80, 150, 200));
+            i = startx;
+            for (; i < endx; i++) {
+                int framePos = startOffset + ((i - startx) / scale);
+                double value = m_binClip->audioFrameCache.at(qMin(framePos * channels, audioLevelCount)).toDouble() / 256;
+                for (int channel = 1; channel < channels; channel ++) {
+                    value = qMax(value, m_binClip->audioFrameCache.at(qMin(framePos * channels + channel, audioLevelCount)).toDouble() / 256);
+                }
+                painter->drawLine(i, mappedRect.bottom() - (value * channelHeight), i, mappedRect.bottom());
+            }
+        }
+    } else if (channels >= 0) {
+        int channelHeight = (int)(mappedRect.height() + 0.5) / channels;
+        int startOffset = startpixel + cropLeft;
+        double value = 0;
+        if (offset * scale > 1.0) {
+            // Pixels are smaller than a frame, draw using painterpath
+            QMap<int, QPainterPath > positiveChannelPaths;
+            QMap<int, QPainterPath > negativeChannelPaths;
+            int i;
+            painter->setPen(QColor(80, 80, 150));
+            for (int channel = 0; channel < channels; channel ++) {
+                int y = channelHeight * channel + channelHeight / 2;
+                positiveChannelPaths[channel].moveTo(startx, mappedRect.bottom() - y);
+                negativeChannelPaths[channel].moveTo(startx, mappedRect.bottom() - y);
+                // Draw channel median line
+                i = startOffset;
+                painter->drawLine(startx, mappedRect.bottom() - y, endx, mappedRect.bottom() - y);
+                for (; i < endpixel + cropLeft + offset; i += offset) {
+                    value = m_binClip->audioFrameCache.at(qMin(i * channels + channel, audioLevelCount)).toDouble() / 256 * channelHeight / 2;
+                    positiveChannelPaths[channel].lineTo(startx + (i - startOffset) * scale, mappedRect.bottom() - y - value);
+                    negativeChannelPaths[channel].lineTo(startx + (i - startOffset) * scale, mappedRect.bottom() - y + value);
+                }
+            }
+            painter->setPen(Qt::NoPen);
+            painter->setBrush(QBrush(QColor(80, 80, 150, 200)));
+            for (int channel = 0; channel < channels; channel ++) {
+                int y = channelHeight * channel + channelHeight / 2;
+                positiveChannelPaths[channel].lineTo(startx + (i - startOffset) * scale, mappedRect.bottom() - y);
+                negativeChannelPaths[channel].lineTo(startx + (i - startOffset) * scale, mappedRect.bottom() - y);
+                painter->drawPath(positiveChannelPaths.value(channel));
+                painter->drawPath(negativeChannelPaths.value(channel));
+            }
+        } else {
+            // Pixels are larger than frames, draw simple lines
+            painter->setPen(QColor(80, 80, 150));
+            for (int channel = 0; channel < channels; channel ++) {
+                // Draw channel median line
+                painter->drawLine(startx, mappedRect.bottom() - (channelHeight * channel + channelHeight / 2), endx, mappedRect.bottom() - (channelHeight * channel + channelHeight / 2));
+            }
+            int i = startx;
+            painter->setPen(QColor(80, 80, 150, 200));
+            for (; i < endx; i++) {
+                int framePos = startOffset + ((i - startx) / scale);
+                for (int channel = 0; channel < channels; channel ++) {
+                    int y = channelHeight * channel + channelHeight / 2;
+                    value = m_binClip->audioFrameCache.at(qMin(framePos * channels + channel, audioLevelCount)).toDouble() / 256 * channelHeight / 2;
+                    painter->drawLine(i, mappedRect.bottom() - value - y, i, mappedRect.bottom() - y + value);
+                }
+            }
+        }
+    }
+}
+
 int ClipItem::type() const
 {
     return AVWidget;
@@ -577,6 +811,7 @@ void ClipItem::paint(QPainter *painter,
                      const QStyleOptionGraphicsItem *option,
                      QWidget *)
 {
+    KDENLIVE_TRACE("timeline", "Paint clip");
     QPalette palette = scene()->palette();
     QColor paintColor = m_paintColor;
     QColor textColor;
@@ -614,28 +849,30 @@ void ClipItem::paint(QPainter *painter,
     if (m_clipState == PlaylistState::Disabled) {
         painter->setOpacity(0.3);
     }
+    const qreal ratio = painter->device()->devicePixelRatioF();
     // draw thumbnails
     if (KdenliveSettings::videothumbnails() && m_clipState != PlaylistState::AudioOnly && m_originalClipState != PlaylistState::AudioOnly) {
+        updateThumbStrip(qRound(mapped.height()), ratio);
         QRectF thumbRect;
         if ((m_clipType == Image || m_clipType == Text || m_clipType == QText || m_clipType == TextTemplate) && !m_startPix.isNull()) {
             if (thumbRect.isNull()) {
                 thumbRect = QRectF(0, 0, mapped.height() / m_startPix.height() * m_startPix.width(), mapped.height());
             }
             thumbRect.moveTopRight(mapped.topRight());
-            painter->drawPixmap(thumbRect, m_startPix, m_startPix.rect());
+            painter->drawPixmap(thumbRect.topLeft(), m_startStrip);
         } else if (!m_endPix.isNull()) {
             if (thumbRect.isNull()) {
                 thumbRect = QRectF(0, 0, mapped.height() / m_endPix.height() * m_endPix.width(), mapped.height());
             }
             thumbRect.moveTopRight(mapped.topRight());
-            painter->drawPixmap(thumbRect, m_endPix, m_endPix.rect());
+            painter->drawPixmap(thumbRect.topLeft(), m_endStrip);
         }
         if (!m_startPix.isNull()) {
             if (thumbRect.isNull()) {
                 thumbRect = QRectF(0, 0, mapped.height() / m_startPix.height() * m_startPix.width(), mapped.height());
             }
             thumbRect.moveTopLeft(mapped.topLeft());
-            painter->drawPixmap(thumbRect, m_startPix, m_startPix.rect());
+            painter->drawPixmap(thumbRect.topLeft(), m_startStrip);
         }
 
         // if we are in full zoom, paint thumbnail for every frame
@@ -673,108 +910,11 @@ void ClipItem::paint(QPainter *painter,
     }
     // draw audio thumbnails
     if (KdenliveSettings::audiothumbnails() && m_speed == 1.0 && m_clipState != PlaylistState::VideoOnly && m_originalClipState != PlaylistState::VideoOnly && (((m_clipType == AV || m_clipType == Playlist) && (exposed.bottom() > (rect().height() / 2) || m_originalClipState == PlaylistState::AudioOnly || m_clipState == PlaylistState::AudioOnly)) || m_clipType == Audio) && m_audioThumbReady && !m_binClip->audioFrameCache.isEmpty()) {
-        int startpixel = qMax(0, (int) exposed.left());
-        int endpixel = qMax(0, (int)(exposed.right() + 0.5) + 1);
         QRectF mappedRect = mapped;
         if (m_clipType != Audio && m_clipState != PlaylistState::AudioOnly && m_originalClipState != PlaylistState::AudioOnly && KdenliveSettings::videothumbnails()) {
             mappedRect.setTop(mappedRect.bottom() - mapped.height() / 2);
         }
-
-        double scale = transformation.m11();
-        int channels = m_binClip->audioChannels();
-        int cropLeft = m_info.cropStart.frames(m_fps);
-        double startx = transformation.map(QPoint(startpixel, 0)).x();
-        double endx = transformation.map(QPoint(endpixel, 0)).x();
-        int offset = 1;
-        if (scale < 1) {
-            offset = (int)(1.0 / scale);
-        }
-        int audioLevelCount = m_binClip->audioFrameCache.count() - 1;
-        if (!KdenliveSettings::displayallchannels()) {
-            // simplified audio
-            int channelHeight = mappedRect.height();
-            int startOffset = startpixel + cropLeft;
-            int i = startOffset;
-            if (offset * scale > 1.0) {
-                // Pixels are smaller than a frame, draw using painterpath
-                QPainterPath positiveChannelPath;
-                positiveChannelPath.moveTo(startx, mappedRect.bottom());
-                for (; i < endpixel + cropLeft + offset; i += offset) {
-                    double value = m_binClip->audioFrameCache.at(qMin(i * channels, audioLevelCount)).toDouble() / 256;
-                    for (int channel = 1; channel < channels; channel ++) {
-                        value = qMax(value, m_binClip->audioFrameCache.at(qMin(i * channels + channel, audioLevelCount)).toDouble() / 256);
-                    }
-                    positiveChannelPath.lineTo(startx + (i - startOffset) * scale, mappedRect.bottom() - (value * channelHeight));
-                }
-                positiveChannelPath.lineTo(startx + (i - startOffset) * scale, mappedRect.bottom());
-                painter->setPen(Qt::NoPen);
-                painter->setBrush(QBrush(QColor(80, 80, 150, 200)));
-                painter->drawPath(positiveChannelPath);
-            } else {
-                // Pixels are larger than frames, draw simple lines
-                painter->setPen(QColor(80, 80, 150, 200));
-                i = startx;
-                for (; i < endx; i++) {
-                    int framePos = startOffset + ((i - startx) / scale);
-                    double value = m_binClip->audioFrameCache.at(qMin(framePos * channels, audioLevelCount)).toDouble() / 256;
-                    for (int channel = 1; channel < channels; channel ++) {
-                        value = qMax(value, m_binClip->audioFrameCache.at(qMin(framePos * channels + channel, audioLevelCount)).toDouble() / 256);
-                    }
-                    painter->drawLine(i, mappedRect.bottom() - (value * channelHeight), i, mappedRect.bottom());
-                }
-            }
-        } else if (channels >= 0) {
-            int channelHeight = (int)(mappedRect.height() + 0.5) / channels;
-            int startOffset = startpixel + cropLeft;
-            double value = 0;
-            if (offset * scale > 1.0) {
-                // Pixels are smaller than a frame, draw using painterpath
-                QMap<int, QPainterPath > positiveChannelPaths;
-                QMap<int, QPainterPath > negativeChannelPaths;
-                int i;
-                painter->setPen(QColor(80, 80, 150));
-                for (int channel = 0; channel < channels; channel ++) {
-                    int y = channelHeight * channel + channelHeight / 2;
-                    positiveChannelPaths[channel].moveTo(startx, mappedRect.bottom() - y);
-                    negativeChannelPaths[channel].moveTo(startx, mappedRect.bottom() - y);
-                    // Draw channel median line
-                    i = startOffset;
-                    painter->drawLine(startx, mappedRect.bottom() - y, endx, mappedRect.bottom() - y);
-                    for (; i < endpixel + cropLeft + offset; i += offset) {
-                        value = m_binClip->audioFrameCache.at(qMin(i * channels + channel, audioLevelCount)).toDouble() / 256 * channelHeight / 2;
-                        positiveChannelPaths[channel].lineTo(startx + (i - startOffset) * scale, mappedRect.bottom() - y - value);
-                        negativeChannelPaths[channel].lineTo(startx + (i - startOffset) * scale, mappedRect.bottom() - y + value);
-                    }
-                }
-                painter->setPen(Qt::NoPen);
-                painter->setBrush(QBrush(QColor(80, 80, 150, 200)));
-                for (int channel = 0; channel < channels; channel ++) {
-                    int y = channelHeight * channel + channelHeight / 2;
-                    positiveChannelPaths[channel].lineTo(startx + (i - startOffset) * scale, mappedRect.bottom() - y);
-                    negativeChannelPaths[channel].lineTo(startx + (i - startOffset) * scale, mappedRect.bottom() - y);
-                    painter->drawPath(positiveChannelPaths.value(channel));
-                    painter->drawPath(negativeChannelPaths.value(channel));
-                }
-            } else {
-                // Pixels are larger than frames, draw simple lines
-                painter->setPen(QColor(80, 80, 150));
-                for (int channel = 0; channel < channels; channel ++) {
-                    // Draw channel median line
-                    painter->drawLine(startx, mappedRect.bottom() - (channelHeight * channel + channelHeight / 2), endx, mappedRect.bottom() - (channelHeight * channel + channelHeight / 2));
-                }
-                int i = startx;
-                painter->setPen(QColor(80, 80, 150, 200));
-                for (; i < endx; i++) {
-                    int framePos = startOffset + ((i - startx) / scale);
-                    for (int channel = 0; channel < channels; channel ++) {
-                        int y = channelHeight * channel + channelHeight / 2;
-                        value = m_binClip->audioFrameCache.at(qMin(framePos * channels + channel, audioLevelCount)).toDouble() / 256 * channelHeight / 2;
-                        painter->drawLine(i, mappedRect.bottom() - value - y, i, mappedRect.bottom() - y + value);
-                    }
-                }
-            }
-        }
-        painter->setPen(QPen());
+        drawAudioTiles(painter, mappedRect, mappedExposed, transformation.m11());
     }
     if (m_clipState == PlaylistState::Disabled) {
         painter->setOpacity(1);
@@ -810,60 +950,29 @@ void ClipItem::paint(QPainter *painter,
 
         // Draw effects names
         if (!m_effectNames.isEmpty() && mapped.width() > (5 * fontUnit)) {
-            QRectF txtBounding = painter->boundingRect(mapped, Qt::AlignLeft | Qt::AlignTop, m_effectNames);
-            QColor bColor = palette.window().color();
-            QColor tColor = palette.text().color();
-            tColor.setAlpha(220);
             if (m_timeLine && m_timeLine->state() == QTimeLine::Running) {
+                QRectF txtBounding = painter->boundingRect(mapped, Qt::AlignLeft | Qt::AlignTop, m_effectNames);
+                QColor bColor = palette.window().color();
+                QColor tColor = palette.text().color();
+                tColor.setAlpha(220);
                 qreal value = m_timeLine->currentValue();
                 txtBounding.setWidth(txtBounding.width() * value);
                 bColor.setAlpha(100 + 50 * value);
-            };
-
-            painter->setBrush(bColor);
-            painter->setPen(Qt::NoPen);
-            painter->drawRoundedRect(txtBounding.adjusted(-1 + effectOffset, -2, 4 + effectOffset, -1), 3, 3);
-            painter->setPen(tColor);
-            painter->drawText(txtBounding.adjusted(2 + effectOffset, 0, 1 + effectOffset, -1), Qt::AlignCenter, m_effectNames);
+                painter->setBrush(bColor);
+                painter->setPen(Qt::NoPen);
+                painter->drawRoundedRect(txtBounding.adjusted(-1 + effectOffset, -2, 4 + effectOffset, -1), 3, 3);
+                painter->setPen(tColor);
+                painter->drawText(txtBounding.adjusted(2 + effectOffset, 0, 1 + effectOffset, -1), Qt::AlignCenter, m_effectNames);
+            } else {
+                painter->drawPixmap(QPointF(mapped.left() - 1 + effectOffset, mapped.top() - 2), effectsLabel(painter->font(), ratio, palette));
+            }
         }
 
-        // Draw clip name
-        QString name = clipName();
-        QRectF txtBounding2 = painter->boundingRect(mapped, Qt::AlignRight | Qt::AlignTop, name);
-        painter->setPen(Qt::NoPen);
-        if (m_clipState != PlaylistState::Original) {
-            txtBounding2.adjust(-fontUnit, 0, fontUnit, 0);
-        } else {
-            fontUnit = 0;
-        }
-        if (txtBounding2.left() < mapped.left()) {
-            txtBounding2.setLeft(mapped.left());
-        }
-        painter->fillRect(txtBounding2.adjusted(-3, 0, 0, 0), m_isMainSelectedClip ? Qt::red : textBgColor);
-        txtBounding2.adjust(-2, 0, 0, 0);
+        // Draw clip name and state
+        const QPixmap &label = nameLabel(painter->font(), ratio, qRound(mapped.width()), textColor, textBgColor, palette);
+        painter->drawPixmap(QPointF(mapped.right() - label.width() / ratio, mapped.top()), label);
         painter->setBrush(QBrush(Qt::NoBrush));
         painter->setPen(textColor);
-        painter->drawText(txtBounding2.adjusted(fontUnit, 0, 0, 0), Qt::AlignLeft, name);
-
-        // Draw clip state
-        if (m_clipState != PlaylistState::Original) {
-            if (m_isMainSelectedClip) {
-                painter->fillRect(txtBounding2.left(), txtBounding2.top(), fontUnit, fontUnit, palette.window().color());
-            }
-            switch (m_clipState) {
-            case PlaylistState::VideoOnly:
-                painter->drawPixmap(txtBounding2.topLeft(), KoIconUtils::themedIcon(QStringLiteral("kdenlive-show-video")).pixmap(QSize(fontUnit, fontUnit)));
-                break;
-            case PlaylistState::AudioOnly:
-                painter->drawPixmap(txtBounding2.topLeft(), KoIconUtils::themedIcon(QStringLiteral("kdenlive-show-audio")).pixmap(QSize(fontUnit, fontUnit)));
-                break;
-            case PlaylistState::Disabled:
-                painter->drawPixmap(txtBounding2.topLeft(), KoIconUtils::themedIcon(QStringLiteral("remove")).pixmap(QSize(fontUnit, fontUnit)));
-                break;
-            default:
-                break;
-            }
-        }
 
         // draw markers
         //TODO:
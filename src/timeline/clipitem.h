@@ -233,10 +233,33 @@ private:
 
     EffectsList m_effectList;
     QList<Transition *> m_transitionsList;
+    /** @brief Rendered audio thumbnail tiles, indexed by their position from the clip start. */
     QMap<int, QPixmap> m_audioThumbCachePic;
+    /** @brief Zoom, height, crop start and device pixel ratio the audio tiles were rendered for. */
+    QString m_audioTileKey;
+    /** @brief Start and end thumbnails scaled to the clip height. */
+    QPixmap m_startStrip;
+    QPixmap m_endStrip;
+    QString m_thumbStripKey;
+    /** @brief Rendered clip name and effect names labels, with the state and colors they were rendered for. */
+    QPixmap m_nameLabel;
+    QString m_nameLabelKey;
+    QPixmap m_effectsLabel;
+    QString m_effectsLabelKey;
     bool m_audioThumbReady;
     double m_framePixelWidth;
 
+    /** @brief Draw the audio thumbnail in @param mappedRect from cached tiles, rendering the missing ones. */
+    void drawAudioTiles(QPainter *painter, const QRectF &mappedRect, const QRectF &mappedExposed, double scale);
+    /** @brief Scale the start and end thumbnails to @param height if they changed. */
+    void updateThumbStrip(int height, qreal ratio);
+    /** @brief Returns the clip name label, at most @param maxWidth wide. */
+    const QPixmap &nameLabel(const QFont &font, qreal ratio, int maxWidth, const QColor &textColor, const QColor &bgColor, const QPalette &palette);
+    /** @brief Returns the effect names label. */
+    const QPixmap &effectsLabel(const QFont &font, qreal ratio, const QPalette &palette);
+    /** @brief Draw the audio levels between item positions @param startpixel and @param endpixel. */
+    void drawAudioThumb(QPainter *painter, const QRectF &mappedRect, double scale, int startpixel, int endpixel);
+
 private slots:
     void slotGetStartThumb();
     void slotGetEndThumb();
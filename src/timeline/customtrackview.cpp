@@ -53,6 +53,7 @@
 #include "managers/resizemanager.h"
 #include "lib/audio/audioEnvelope.h"
 #include "lib/audio/audioCorrelation.h"
+#include "utils/tracer.h"
 
 #include "kdenlive_debug.h"
 #include <klocalizedstring.h>
@@ -152,6 +153,11 @@ CustomTrackView::CustomTrackView(KdenliveDoc *doc, Timeline *timeline, CustomTra
     verticalScrollBar()->setTracking(true);
     // repaint guides when using vertical scroll
     connect(verticalScrollBar(), &QAbstractSlider::valueChanged, this, &CustomTrackView::slotRefreshGuides);
+    m_visibleClipsTimer.setSingleShot(true);
+    m_visibleClipsTimer.setInterval(200);
+    connect(&m_visibleClipsTimer, &QTimer::timeout, this, &CustomTrackView::slotPrioritizeVisibleClips);
+    connect(verticalScrollBar(), &QAbstractSlider::valueChanged, &m_visibleClipsTimer, static_cast<void (QTimer::*)()>(&QTimer::start));
+    connect(horizontalScrollBar(), &QAbstractSlider::valueChanged, &m_visibleClipsTimer, static_cast<void (QTimer::*)()>(&QTimer::start));
 
     m_cursorLine = projectscene->addLine(0, 0, 0, m_tracksHeight);
     m_cursorLine->setZValue(1000);
@@ -2017,13 +2023,13 @@ void CustomTrackView::slotRefreshEffects(ClipItem *clip)
 {
     int track = clip->track();
     GenTime pos = clip->startPos();
-    if (!m_timeline->track(track)->removeEffect(pos.seconds(), -1, false)) {
+    if (!m_timeline->track(track)->removeEffect(pos, -1, false)) {
         emit displayMessage(i18n("Problem deleting effect"), ErrorMessage);
         return;
     }
     bool success = true;
     for (int i = 0; i < clip->effectsCount(); ++i) {
-        if (!m_timeline->track(track)->addEffect(pos.seconds(), EffectsController::getEffectArgs(m_document->getProfileInfo(), clip->effect(i)))) {
+        if (!m_timeline->track(track)->addEffect(pos, EffectsController::getEffectArgs(m_document->getProfileInfo(), clip->effect(i)))) {
             success = false;
         }
     }
@@ -2072,7 +2078,7 @@ void CustomTrackView::addEffect(int track, GenTime pos, const QDomElement &effec
             return;
         }
         EffectsParameterList params = clip->addEffect(m_document->getProfileInfo(), effect);
-        if (!m_timeline->track(track)->addEffect(pos.seconds(), params)) {
+        if (!m_timeline->track(track)->addEffect(pos, params)) {
             emit displayMessage(i18n("Problem adding effect to clip"), ErrorMessage);
             clip->deleteEffect(params.paramValue(QStringLiteral("kdenlive_ix")).toInt());
         } else {
@@ -2115,7 +2121,7 @@ void CustomTrackView::deleteEffect(int track, const GenTime &pos, const QDomElem
             return;
         }
     }
-    if (!m_timeline->track(track)->removeEffect(pos.seconds(), index, true)) {
+    if (!m_timeline->track(track)->removeEffect(pos, index, true)) {
         //qCDebug(KDENLIVE_LOG) << "// ERROR REMOV EFFECT: " << index << ", DISABLE: " << effect.attribute("disable");
         emit displayMessage(i18n("Problem deleting effect"), ErrorMessage);
         return;
@@ -2471,7 +2477,19 @@ void CustomTrackView::slotDeleteEffect(ClipItem *clip, int track, const QDomElem
     }
 }
 
-void CustomTrackView::updateEffect(int track, GenTime pos, const QDomElement &insertedEffect, bool updateEffectStack, bool replaceEffect, bool refreshMonitor, bool updateClip)
+QDomElement CustomTrackView::currentEffect(int track, const GenTime &pos, int ix)
+{
+    if (pos < GenTime()) {
+        return m_timeline->getTrackEffects(track).itemFromIndex(ix).cloneNode().toElement();
+    }
+    ClipItem *clip = getClipItemAtStart(pos, track);
+    if (!clip) {
+        return QDomElement();
+    }
+    return clip->effectAtIndex(ix);
+}
+
+void CustomTrackView::updateEffect(int track, GenTime pos, const QDomElement &insertedEffect, bool updateEffectStack, bool replaceEffect, bool refreshMonitor, bool updateClip, const QDomElement &previousEffect)
 {
     if (insertedEffect.isNull()) {
         //qCDebug(KDENLIVE_LOG)<<"// Trying to add null effect";
@@ -2481,6 +2499,10 @@ void CustomTrackView::updateEffect(int track, GenTime pos, const QDomElement &in
     int ix = insertedEffect.attribute(QStringLiteral("kdenlive_ix")).toInt();
     QDomElement effect = insertedEffect.cloneNode().toElement();
     //qCDebug(KDENLIVE_LOG) << "// update effect ix: " << effect.attribute("kdenlive_ix")<<", TAG: "<< insertedEffect.attribute("tag");
+    EffectsParameterList previousParams;
+    if (!previousEffect.isNull() && !replaceEffect) {
+        previousParams = EffectsController::getEffectArgs(m_document->getProfileInfo(), previousEffect);
+    }
     if (pos < GenTime()) {
         // editing a track effect
         EffectsParameterList effectParams = EffectsController::getEffectArgs(m_document->getProfileInfo(), effect);
@@ -2489,7 +2511,7 @@ void CustomTrackView::updateEffect(int track, GenTime pos, const QDomElement &in
             clip->initEffect(m_document->getProfileInfo() , effect);
             effectParams = EffectsController::getEffectArgs(effect);
         }*/
-        if (!m_timeline->track(track)->editTrackEffect(effectParams, replaceEffect)) {
+        if (!m_timeline->track(track)->editTrackEffect(effectParams, replaceEffect, previousParams)) {
             emit displayMessage(i18n("Problem editing effect"), ErrorMessage);
         }
         m_timeline->setTrackEffect(track, ix, effect, updateClip);
@@ -2543,7 +2565,7 @@ void CustomTrackView::updateEffect(int track, GenTime pos, const QDomElement &in
             clip->setSelectedEffect(clip->selectedEffectIndex());
         }
 
-        bool success = m_timeline->track(clip->track())->editEffect(clip->startPos().seconds(), effectParams, replaceEffect);
+        bool success = m_timeline->track(clip->track())->editEffect(clip->startPos(), effectParams, replaceEffect, updateClip, previousParams);
         if (success) {
             clip->updateEffect(effect);
             if (updateClip && refreshMonitor && clip->hasVisibleVideo() && effect.attribute(QStringLiteral("type")) != QLatin1String("audio")) {
@@ -2582,7 +2604,7 @@ void CustomTrackView::updateEffectState(int track, GenTime pos, const QList<int>
     // editing a clip effect
     ClipItem *clip = getClipItemAtStart(pos, track);
     if (clip) {
-        bool success = m_timeline->track(clip->track())->enableEffects(clip->startPos().seconds(), effectIndexes, disable);
+        bool success = m_timeline->track(clip->track())->enableEffects(clip->startPos(), effectIndexes, disable);
         if (success) {
             if (clip->enableEffects(effectIndexes, disable) && clip->hasVisibleVideo()) {
                 monitorRefresh(clip->info(), true);
@@ -2660,7 +2682,7 @@ void CustomTrackView::moveEffect(int track, const GenTime &pos, const QList<int>
                 new_position--;
             }
             // special case: speed effect, which is a pseudo-effect, not appearing in MLT's effects
-            m_timeline->track(track)->moveEffect(pos.seconds(), old_position, new_position);
+            m_timeline->track(track)->moveEffect(pos, old_position, new_position);
             if (clip->hasVisibleVideo() && before.attribute(QStringLiteral("type")) != QLatin1String("audio")) {
                 monitorRefresh(clip->info(), true);
             }
@@ -2725,8 +2747,8 @@ void CustomTrackView::slotUpdateClipEffect(ClipItem *clip, int track, const QDom
 
 void CustomTrackView::slotUpdateClipRegion(ClipItem *clip, int ix, const QString &region)
 {
-    QDomElement effect = clip->getEffectAtIndex(ix);
-    QDomElement oldeffect = effect.cloneNode().toElement();
+    QDomElement oldeffect = clip->effectAtIndex(ix);
+    QDomElement effect = oldeffect.cloneNode().toElement();
     effect.setAttribute(QStringLiteral("region"), region);
     EditEffectCommand *command = new EditEffectCommand(this, clip->track(), clip->startPos(), oldeffect, effect, ix, true, true, true, true);
     m_commandStack->push(command);
@@ -2751,7 +2773,7 @@ void CustomTrackView::cutClip(const ItemInfo &info, const GenTime &cutTime, bool
             return;
         }
         if (execute) {
-            if (!m_timeline->track(info.track)->cut(cutTime.seconds())) {
+            if (!m_timeline->track(info.track)->cut(cutTime)) {
                 // Error cuting clip in playlist
                 qCDebug(KDENLIVE_LOG) << "/// ERROR CUTTING CLIP PLAYLIST!!";
                 return;
@@ -2835,12 +2857,12 @@ void CustomTrackView::cutClip(const ItemInfo &info, const GenTime &cutTime, bool
             emit displayMessage(i18n("Cannot find clip to uncut"), ErrorMessage);
             return;
         }
-        if (!m_timeline->track(info.track)->del(cutTime.seconds())) {
+        if (!m_timeline->track(info.track)->del(cutTime)) {
             emit displayMessage(i18n("Error removing clip at %1 on track %2", m_document->timecode().getTimecodeFromFrames(cutTime.frames(m_document->fps())), m_timeline->getTrackInfo(info.track).trackName), ErrorMessage);
             return;
         }
         dup->binClip()->removeRef();
-        m_timeline->track(info.track)->resize(info.startPos.seconds(), (info.endPos - cutTime).seconds(), true);
+        m_timeline->track(info.track)->resize(info.startPos, info.endPos - cutTime, true);
         m_timeline->reloadTrack(info.track, info.startPos.frames(m_document->fps()), info.endPos.frames(m_document->fps()));
         item = getClipItemAtStart(info.startPos, info.track);
         // Restore original effects
@@ -4436,7 +4458,7 @@ void CustomTrackView::deleteClip(const ItemInfo &info, bool refresh)
         return;
     }
     //m_document->renderer()->saveSceneList(QString("/tmp/error%1.mlt").arg(m_ct), QDomElement());
-    if (!m_timeline->track(info.track)->del(info.startPos.seconds())) {
+    if (!m_timeline->track(info.track)->del(info.startPos)) {
         qCDebug(KDENLIVE_LOG) << " / / /CANNOT DELETE CLIP AT: " << info.startPos.frames(25);
         emit displayMessage(i18n("Error removing clip at %1 on track %2", m_document->timecode().getTimecodeFromFrames(info.startPos.frames(m_document->fps())), m_timeline->getTrackInfo(info.track).trackName), ErrorMessage);
         return;
@@ -4928,10 +4950,10 @@ void CustomTrackView::addClip(const QString &clipId, const  ItemInfo &info, cons
         prod = m_document->renderer()->getBinProducer(clipId);
     }
     binClip->addRef();
-    m_timeline->track(info.track)->add(info.startPos.seconds(), prod, info.cropStart.seconds(), (info.cropStart + info.cropDuration).seconds(), state, duplicate, TimelineMode::NormalEdit); // m_scene->editMode());
+    m_timeline->track(info.track)->add(info.startPos, prod, info.cropStart, info.cropStart + info.cropDuration, state, duplicate, TimelineMode::NormalEdit); // m_scene->editMode());
 
     for (int i = 0; i < item->effectsCount(); ++i) {
-        m_timeline->track(info.track)->addEffect(info.startPos.seconds(), EffectsController::getEffectArgs(m_document->getProfileInfo(), item->effect(i)));
+        m_timeline->track(info.track)->addEffect(info.startPos, EffectsController::getEffectArgs(m_document->getProfileInfo(), item->effect(i)));
     }
     if (refresh && item->hasVisibleVideo()) {
         monitorRefresh(info, true);
@@ -5155,7 +5177,7 @@ bool CustomTrackView::moveClip(const ItemInfo &start, const ItemInfo &end, bool
     qCDebug(KDENLIVE_LOG) << start;
     qCDebug(KDENLIVE_LOG) << end;
 #endif
-    bool success = m_timeline->moveClip(start.track, start.startPos.seconds(), end.track, end.startPos.seconds(), item->clipState(), m_scene->editMode(), item->needsDuplicate());
+    bool success = m_timeline->moveClip(start.track, start.startPos, end.track, end.startPos, item->clipState(), m_scene->editMode(), item->needsDuplicate());
     QList<ItemInfo> range;
     if (item->hasVisibleVideo()) {
         range << start << end;
@@ -5249,7 +5271,7 @@ void CustomTrackView::moveGroup(QList<ItemInfo> startClip, QList<ItemInfo> start
                     clip->setEnabled(false);
                 }
             }
-            m_timeline->track(startClip.at(i).track)->del(startClip.at(i).startPos.seconds(), false);
+            m_timeline->track(startClip.at(i).track)->del(startClip.at(i).startPos, false);
         } else {
             qCDebug(KDENLIVE_LOG) << "//MISSING CLIP AT: " << startClip.at(i).startPos.frames(25) << " / track: " << startClip.at(i).track << " / OFFSET: " << trackOffset;
         }
@@ -5343,10 +5365,10 @@ void CustomTrackView::moveGroup(QList<ItemInfo> startClip, QList<ItemInfo> start
                 } else {
                     prod = m_document->renderer()->getBinProducer(clip->getBinId());
                 }
-                m_timeline->track(info.track)->add(info.startPos.seconds(), prod, info.cropStart.seconds(), (info.cropStart + info.cropDuration).seconds(), clip->clipState(), true, m_scene->editMode());
+                m_timeline->track(info.track)->add(info.startPos, prod, info.cropStart, info.cropStart + info.cropDuration, clip->clipState(), true, m_scene->editMode());
 
                 for (int j = 0; j < clip->effectsCount(); ++j) {
-                    m_timeline->track(info.track)->addEffect(info.startPos.seconds(), EffectsController::getEffectArgs(m_document->getProfileInfo(), clip->effect(j)));
+                    m_timeline->track(info.track)->addEffect(info.startPos, EffectsController::getEffectArgs(m_document->getProfileInfo(), clip->effect(j)));
                 }
             } else if (item->type() == TransitionWidget) {
                 Transition *tr = static_cast <Transition *>(item);
@@ -5452,13 +5474,13 @@ void CustomTrackView::resizeClip(const ItemInfo &start, const ItemInfo &end, boo
     KdenliveSettings::setSnaptopoints(false);
 
     if (resizeClipStart) {
-        if (m_timeline->track(start.track)->resize(start.startPos.seconds(), (end.startPos - start.startPos).seconds(), false)) {
+        if (m_timeline->track(start.track)->resize(start.startPos, end.startPos - start.startPos, false)) {
             item->resizeStart((int) end.startPos.frames(m_document->fps()));
         } else {
             emit displayMessage(i18n("Resizing clip start failed!!"), ErrorMessage);
         }
     } else {
-        if (m_timeline->track(start.track)->resize(start.startPos.seconds(), (end.endPos - start.endPos).seconds(), true)) {
+        if (m_timeline->track(start.track)->resize(start.startPos, end.endPos - start.endPos, true)) {
             item->resizeEnd((int) end.endPos.frames(m_document->fps()));
         } else {
             emit displayMessage(i18n("Resizing clip end failed!!"), ErrorMessage);
@@ -5535,7 +5557,7 @@ void CustomTrackView::prepareResizeClipStart(AbstractClipItem *item, const ItemI
     }
     ItemInfo info = item->info();
     if (item->type() == AVWidget) {
-        bool success = m_timeline->track(oldInfo.track)->resize(oldInfo.startPos.seconds(), (item->startPos() - oldInfo.startPos).seconds(), false);
+        bool success = m_timeline->track(oldInfo.track)->resize(oldInfo.startPos, item->startPos() - oldInfo.startPos, false);
         if (success) {
             // Check if there is an automatic transition on that clip (lower track)
             Transition *transition = getTransitionItemAtStart(oldInfo.startPos, oldInfo.track);
@@ -5652,7 +5674,7 @@ void CustomTrackView::prepareResizeClipEnd(AbstractClipItem *item, const ItemInf
         if (!hasParentCommand) {
             command->setText(i18n("Resize clip end"));
         }
-        bool success = m_timeline->track(info.track)->resize(oldInfo.startPos.seconds(), (info.endPos - oldInfo.endPos).seconds(), true);
+        bool success = m_timeline->track(info.track)->resize(oldInfo.startPos, info.endPos - oldInfo.endPos, true);
         if (success) {
             // Check if there is an automatic transition on that clip (lower track)
             Transition *tr = getTransitionItemAtEnd(oldInfo.endPos, oldInfo.track);
@@ -5757,7 +5779,7 @@ void CustomTrackView::updatePositionEffects(ClipItem *item, const ItemInfo &info
         duration += start;
         EffectsList::setParameter(effect, QStringLiteral("in"), QString::number(start));
         EffectsList::setParameter(effect, QStringLiteral("out"), QString::number(duration));
-        if (!m_timeline->track(item->track())->editEffect(item->startPos().seconds(), EffectsController::getEffectArgs(m_document->getProfileInfo(), effect), false)) {
+        if (!m_timeline->track(item->track())->editEffect(item->startPos(), EffectsController::getEffectArgs(m_document->getProfileInfo(), effect), false)) {
             emit displayMessage(i18n("Problem editing effect"), ErrorMessage);
         }
         // if fade effect is displayed, update the effect edit widget with new clip duration
@@ -5778,7 +5800,7 @@ void CustomTrackView::updatePositionEffects(ClipItem *item, const ItemInfo &info
         duration += start;
         EffectsList::setParameter(effect, QStringLiteral("in"), QString::number(start));
         EffectsList::setParameter(effect, QStringLiteral("out"), QString::number(duration));
-        if (!m_timeline->track(item->track())->editEffect(item->startPos().seconds(), EffectsController::getEffectArgs(m_document->getProfileInfo(), effect), false)) {
+        if (!m_timeline->track(item->track())->editEffect(item->startPos(), EffectsController::getEffectArgs(m_document->getProfileInfo(), effect), false)) {
             emit displayMessage(i18n("Problem editing effect"), ErrorMessage);
         }
         // if fade effect is displayed, update the effect edit widget with new clip duration
@@ -5801,7 +5823,7 @@ void CustomTrackView::updatePositionEffects(ClipItem *item, const ItemInfo &info
         int start = end - duration;
         EffectsList::setParameter(effect, QStringLiteral("in"), QString::number(start));
         EffectsList::setParameter(effect, QStringLiteral("out"), QString::number(end));
-        if (!m_timeline->track(item->track())->editEffect(item->startPos().seconds(), EffectsController::getEffectArgs(m_document->getProfileInfo(), effect), false)) {
+        if (!m_timeline->track(item->track())->editEffect(item->startPos(), EffectsController::getEffectArgs(m_document->getProfileInfo(), effect), false)) {
             emit displayMessage(i18n("Problem editing effect"), ErrorMessage);
         }
         // if fade effect is displayed, update the effect edit widget with new clip duration
@@ -5823,7 +5845,7 @@ void CustomTrackView::updatePositionEffects(ClipItem *item, const ItemInfo &info
         int start = end - duration;
         EffectsList::setParameter(effect, QStringLiteral("in"), QString::number(start));
         EffectsList::setParameter(effect, QStringLiteral("out"), QString::number(end));
-        if (!m_timeline->track(item->track())->editEffect(item->startPos().seconds(), EffectsController::getEffectArgs(m_document->getProfileInfo(), effect), false)) {
+        if (!m_timeline->track(item->track())->editEffect(item->startPos(), EffectsController::getEffectArgs(m_document->getProfileInfo(), effect), false)) {
             emit displayMessage(i18n("Problem editing effect"), ErrorMessage);
         }
         // if fade effect is displayed, update the effect edit widget with new clip duration
@@ -6323,6 +6345,7 @@ void CustomTrackView::slotRefreshGuides()
 
 void CustomTrackView::drawBackground(QPainter *painter, const QRectF &rect)
 {
+    KDENLIVE_TRACE("timeline", "Paint background");
     //TODO: optimize, we currently redraw bg on every cursor move
     painter->setClipRect(rect);
     QPen pen1 = painter->pen();
@@ -6990,6 +7013,24 @@ void CustomTrackView::slotUpdateAllThumbs()
         }
     }
     viewport()->update();
+    m_visibleClipsTimer.start();
+}
+
+void CustomTrackView::slotPrioritizeVisibleClips()
+{
+    QStringList ids;
+    const QList<QGraphicsItem *> items = scene()->items(mapToScene(viewport()->rect()).boundingRect());
+    for (QGraphicsItem *item : items) {
+        if (item->type() == AVWidget) {
+            const QString &id = static_cast<ClipItem *>(item)->getBinId();
+            if (!ids.contains(id)) {
+                ids << id;
+            }
+        }
+    }
+    if (!ids.isEmpty()) {
+        m_document->prioritizeClips(ids);
+    }
 }
 
 void CustomTrackView::saveThumbnails()
@@ -7511,7 +7552,7 @@ bool CustomTrackView::doSplitAudio(const GenTime &pos, int track, int destTrack,
             clip->setSelected(true);
             ClipItem *audioClip = getClipItemAtStart(pos, info.track);
             if (audioClip) {
-                if (m_timeline->track(track)->replace(pos.seconds(), m_document->renderer()->getBinVideoProducer(clip->getBinId()))) {
+                if (m_timeline->track(track)->replace(pos, m_document->renderer()->getBinVideoProducer(clip->getBinId()))) {
                     clip->setState(PlaylistState::VideoOnly);
                 } else {
                     emit displayMessage(i18n("Cannot update clip (time: %1, track: %2)", pos.frames(m_document->fps()), destTrack), ErrorMessage);
@@ -7550,7 +7591,7 @@ bool CustomTrackView::doSplitAudio(const GenTime &pos, int track, int destTrack,
                 ClipItem *clp = static_cast <ClipItem *>(children.at(i));
                 ItemInfo info = clip->info();
                 deleteClip(clp->info());
-                if (!m_timeline->track(info.track)->replace(info.startPos.seconds(), m_document->renderer()->getBinProducer(clip->getBinId()))) {
+                if (!m_timeline->track(info.track)->replace(info.startPos, m_document->renderer()->getBinProducer(clip->getBinId()))) {
                     emit displayMessage(i18n("Cannot update clip (time: %1, track: %2)", info.startPos.frames(m_document->fps()), info.track), ErrorMessage);
                     return false;
                 } else {
@@ -7735,7 +7776,7 @@ void CustomTrackView::doChangeClipType(const ItemInfo &info, PlaylistState::Clip
         }
         prod = copy;
     }
-    if (prod && prod->is_valid() && m_timeline->track(info.track)->replace(info.startPos.seconds(), prod, state, previousState)) {
+    if (prod && prod->is_valid() && m_timeline->track(info.track)->replace(info.startPos, prod, state, previousState)) {
         clip->setState(state);
         clip->update();
         if (clip->clipType() != Audio && state != PlaylistState::Disabled && previousState != PlaylistState::Disabled && (previousState == PlaylistState::AudioOnly || state == PlaylistState::AudioOnly)) {
@@ -8539,7 +8580,7 @@ void CustomTrackView::exportTimelineSelection(QString path)
         if (item->type() == AVWidget) {
             ClipItem *clip = static_cast<ClipItem *>(item);
             int track = clip->track() - firstTrack;
-            m_timeline->duplicateClipOnPlaylist(clip->track(), clip->startPos().seconds(), startOffest, newTractor->track(track));
+            m_timeline->duplicateClipOnPlaylist(clip->track(), clip->startPos(), startOffest, newTractor->track(track));
         } else if (item->type() == TransitionWidget) {
             Transition *tr = static_cast<Transition *>(item);
             int a_track = qBound(0, tr->transitionEndTrack() - firstTrack, lastTrack - firstTrack + 1);
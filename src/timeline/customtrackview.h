@@ -25,6 +25,7 @@
 #include <QGraphicsView>
 #include <QGraphicsItemAnimation>
 #include <QTimeLine>
+#include <QTimer>
 #include <QMenu>
 #include <QMutex>
 #include <QWaitCondition>
@@ -90,7 +91,11 @@ public:
     void slotAddGroupEffect(const QDomElement &effect, AbstractGroupItem *group, AbstractClipItem *dropTarget = nullptr);
     void addEffect(int track, GenTime pos, const QDomElement &effect);
     void deleteEffect(int track, const GenTime &pos, const QDomElement &effect);
-    void updateEffect(int track, GenTime pos, const QDomElement &insertedEffect, bool refreshEffectStack = false, bool replaceEffect = false, bool refreshMonitor = true, bool updateClip = true);
+    /** @brief Update an effect of a clip or track.
+     *  @param previousEffect the effect as currently applied, if known only the changed MLT properties are updated */
+    void updateEffect(int track, GenTime pos, const QDomElement &insertedEffect, bool refreshEffectStack = false, bool replaceEffect = false, bool refreshMonitor = true, bool updateClip = true, const QDomElement &previousEffect = QDomElement());
+    /** @brief Returns a copy of the effect with index @param ix (kdenlive_ix) as currently applied on a clip or track. */
+    QDomElement currentEffect(int track, const GenTime &pos, int ix);
     /** @brief Enable / disable a list of effects */
     void updateEffectState(int track, GenTime pos, const QList<int> &effectIndexes, bool disable, bool updateEffectStack);
     void moveEffect(int track, const GenTime &pos, const QList<int> &oldPos, const QList<int> &newPos);
@@ -455,6 +460,8 @@ private:
     QGraphicsItem *m_visualTip;
     QGraphicsItemAnimation *m_keyProperties;
     QTimeLine *m_keyPropertiesTimer;
+    /** @brief Delays the loading priority update of visible clips while scrolling. */
+    QTimer m_visibleClipsTimer;
     QColor m_tipColor;
     QPen m_tipPen;
     QPoint m_clickEvent;
@@ -560,6 +567,8 @@ private:
 
 private slots:
     void slotRefreshGuides();
+    /** @brief Load the producers, thumbnails and audio thumbnails of the clips in view first. */
+    void slotPrioritizeVisibleClips();
     void slotEditTimeLineGuide();
     void slotDeleteTimeLineGuide();
     void checkTrackSequence(int track);
@@ -263,7 +263,7 @@ bool EffectManager::doAddFilter(EffectsParameterList params, int duration)
     return true;
 }
 
-bool EffectManager::editEffect(const EffectsParameterList &params, int duration, bool replaceEffect)
+bool EffectManager::editEffect(const EffectsParameterList &params, int duration, bool replaceEffect, const EffectsParameterList &previous)
 {
     int index = params.paramValue(QStringLiteral("kdenlive_ix")).toInt();
     QString tag =  params.paramValue(QStringLiteral("tag"));
@@ -332,8 +332,9 @@ bool EffectManager::editEffect(const EffectsParameterList &params, int duration,
         }
     }
 
-    for (int j = 0; j < params.count(); ++j) {
-        filter->set(params.at(j).name().toUtf8().constData(), params.at(j).value().toUtf8().constData());
+    const EffectsParameterList changed = previous.isEmpty() ? params : params.changedParams(previous);
+    for (int j = 0; j < changed.count(); ++j) {
+        filter->set(changed.at(j).name().toUtf8().constData(), changed.at(j).value().toUtf8().constData());
     }
 
     for (int j = 0; j < filtersList.count(); ++j) {
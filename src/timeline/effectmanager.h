@@ -44,7 +44,8 @@ public:
     void setProducer(Mlt::Service &producer);
     bool addEffect(const EffectsParameterList &params, int duration);
     bool doAddFilter(EffectsParameterList params, int duration);
-    bool editEffect(const EffectsParameterList &params, int duration, bool replaceEffect);
+    /** @brief Updates an effect's filter. If @param previous contains the effect's current parameters, only the changed properties are set. */
+    bool editEffect(const EffectsParameterList &params, int duration, bool replaceEffect, const EffectsParameterList &previous = EffectsParameterList());
     bool removeEffect(int effectIndex, bool updateIndex);
     bool enableEffects(const QList<int> &effectIndexes, bool disable, bool rememberState = false);
     bool moveEffect(int oldPos, int newPos);
@@ -147,74 +147,18 @@ void KeyframeView::drawKeyFrames(const QRectF &br, int length, bool active, QPai
             // this is probably an animated rect
             continue;
         }
-        Mlt::Animation drawAnim = m_keyProperties.get_animation(paramName.toUtf8().constData());
-        if (!drawAnim.is_valid()) {
+        const CurveGeometry &curve = curveGeometry(paramName, info, br, transformation);
+        if (curve.path.isEmpty()) {
             continue;
         }
-        QPainterPath path;
-        // Find first key before our clip start, get frame for rect left first
-        int firstKF = qMax(0, drawAnim.previous_key(-m_offset));
-        int lastKF = drawAnim.next_key(duration - m_offset);
-        if (lastKF < duration - m_offset) {
-            lastKF = duration - m_offset;
-        }
-        int frame = firstKF;
-        double value = m_keyProperties.anim_get_double(paramName.toUtf8().constData(), frame, duration - m_offset);
-        QPointF start = keyframePoint(br, frame + m_offset, value, info.factor, info.min, info.max);
-        path.moveTo(br.x(), br.bottom());
-        path.lineTo(br.x(), start.y());
-        path.lineTo(start);
         painter->setPen(paramName == m_inTimeline ? QColor(Qt::white) : Qt::NoPen);
-        for (int i = 0; i < drawAnim.key_count(); ++i) {
-            int currentFrame = drawAnim.key_get_frame(i);
-            if (currentFrame < firstKF) {
-                continue;
-            }
-            if (currentFrame > lastKF) {
-                break;
-            }
-            if (active && paramName == m_inTimeline) {
-                painter->setBrush((drawAnim.key_get_frame(i) == activeKeyframe) ? QColor(Qt::red) : QColor(Qt::blue));
-                painter->drawEllipse(QRectF(transformation.map(start) - h / 2, transformation.map(start) + h / 2));
-            }
-            if (i + 1 < drawAnim.key_count()) {
-                frame = drawAnim.key_get_frame(i + 1);
-                value = m_keyProperties.anim_get_double(paramName.toUtf8().constData(), frame, duration - m_offset);
-                QPointF end = keyframePoint(br, frame + m_offset, value, info.factor, info.min, info.max);
-                //QPointF end = keyframePoint(br, i + 1);
-                switch (drawAnim.key_get_type(i)) {
-                case mlt_keyframe_discrete:
-                    path.lineTo(end.x(), start.y());
-                    path.lineTo(end);
-                    break;
-                case mlt_keyframe_linear:
-                    path.lineTo(end);
-                    break;
-                case mlt_keyframe_smooth:
-                    frame = drawAnim.key_get_frame(qMax(i - 1, 0));
-                    value = m_keyProperties.anim_get_double(paramName.toUtf8().constData(), frame, duration - m_offset);
-                    QPointF pre = keyframePoint(br, frame + m_offset, value, info.factor, info.min, info.max);
-                    frame = drawAnim.key_get_frame(qMin(i + 2, drawAnim.key_count() - 1));
-                    value = m_keyProperties.anim_get_double(paramName.toUtf8().constData(), frame, duration - m_offset);
-                    QPointF post = keyframePoint(br, frame + m_offset, value, info.factor, info.min, info.max);
-                    QPointF c1 = (end - pre) / 6.0; // + start
-                    QPointF c2 = (start - post) / 6.0; // + end
-                    double mid = (end.x() - start.x()) / 2;
-                    if (c1.x() >  mid) {
-                        c1 = c1 * mid / c1.x();    // scale down tangent vector to not go beyond middle
-                    }
-                    if (c2.x() < -mid) {
-                        c2 = c2 * -mid / c2.x();
-                    }
-                    path.cubicTo(start + c1, end + c2, end);
-                    break;
-                }
-                start = end;
-            } else {
-                path.lineTo(br.right(), start.y());
+        if (active && paramName == m_inTimeline) {
+            for (int i = 0; i < curve.handles.count(); ++i) {
+                const QPair<int, QPointF> &handle = curve.handles.at(i);
+                painter->setBrush(handle.first == activeKeyframe ? QColor(Qt::red) : QColor(Qt::blue));
+                painter->drawEllipse(QRectF(handle.second - h / 2, handle.second + h / 2));
             }
         }
-        path.lineTo(br.right(), br.bottom());
         if (paramName == m_inTimeline) {
             QColor col(Qt::white);
             col.setAlpha(active ? 120 : 80);
@@ -244,11 +188,97 @@ void KeyframeView::drawKeyFrames(const QRectF &br, int length, bool active, QPai
             col.setAlpha(80);
             painter->setBrush(col);
         }
-        painter->drawPath(transformation.map(path));
+        painter->drawPath(curve.path);
     }
     painter->restore();
 }
 
+const KeyframeView::CurveGeometry &KeyframeView::curveGeometry(const QString &paramName, const ParameterInfo &info, const QRectF &br, const QTransform &transformation)
+{
+    QMap<QString, CurveGeometry>::iterator cached = m_curveCache.find(paramName);
+    if (cached != m_curveCache.end() && cached->duration == duration && cached->offset == m_offset && cached->rect == br && cached->transform == transformation) {
+        return cached.value();
+    }
+    CurveGeometry curve;
+    curve.duration = duration;
+    curve.offset = m_offset;
+    curve.rect = br;
+    curve.transform = transformation;
+    const QByteArray name = paramName.toUtf8();
+    Mlt::Animation drawAnim = m_keyProperties.get_animation(name.constData());
+    if (!drawAnim.is_valid()) {
+        return m_curveCache.insert(paramName, curve).value();
+    }
+    // Sample every keyframe value once, smooth segments need the neighbours of each key
+    const int keyCount = drawAnim.key_count();
+    QVector<int> frames(keyCount);
+    QVector<QPointF> points(keyCount);
+    for (int i = 0; i < keyCount; ++i) {
+        frames[i] = drawAnim.key_get_frame(i);
+        double value = m_keyProperties.anim_get_double(name.constData(), frames.at(i), duration - m_offset);
+        points[i] = keyframePoint(br, frames.at(i) + m_offset, value, info.factor, info.min, info.max);
+    }
+    QPainterPath path;
+    // Find first key before our clip start, get frame for rect left first
+    int firstKF = qMax(0, drawAnim.previous_key(-m_offset));
+    int lastKF = drawAnim.next_key(duration - m_offset);
+    if (lastKF < duration - m_offset) {
+        lastKF = duration - m_offset;
+    }
+    double value = m_keyProperties.anim_get_double(name.constData(), firstKF, duration - m_offset);
+    QPointF start = keyframePoint(br, firstKF + m_offset, value, info.factor, info.min, info.max);
+    path.moveTo(br.x(), br.bottom());
+    path.lineTo(br.x(), start.y());
+    path.lineTo(start);
+    for (int i = 0; i < keyCount; ++i) {
+        int currentFrame = frames.at(i);
+        if (currentFrame < firstKF) {
+            continue;
+        }
+        if (currentFrame > lastKF) {
+            break;
+        }
+        curve.handles << qMakePair(currentFrame, transformation.map(start));
+        if (i + 1 < keyCount) {
+            const QPointF &end = points.at(i + 1);
+            switch (drawAnim.key_get_type(i)) {
+            case mlt_keyframe_discrete:
+                path.lineTo(end.x(), start.y());
+                path.lineTo(end);
+                break;
+            case mlt_keyframe_linear:
+                path.lineTo(end);
+                break;
+            case mlt_keyframe_smooth:
+                const QPointF &pre = points.at(qMax(i - 1, 0));
+                const QPointF &post = points.at(qMin(i + 2, keyCount - 1));
+                QPointF c1 = (end - pre) / 6.0; // + start
+                QPointF c2 = (start - post) / 6.0; // + end
+                double mid = (end.x() - start.x()) / 2;
+                if (c1.x() >  mid) {
+                    c1 = c1 * mid / c1.x();    // scale down tangent vector to not go beyond middle
+                }
+                if (c2.x() < -mid) {
+                    c2 = c2 * -mid / c2.x();
+                }
+                path.cubicTo(start + c1, end + c2, end);
+                break;
+            }
+            start = end;
+        } else {
+            path.lineTo(br.right(), start.y());
+        }
+    }
+    path.lineTo(br.right(), br.bottom());
+    curve.path = transformation.map(path);
+    return m_curveCache.insert(paramName, curve).value();
+}
+
+void KeyframeView::invalidateCurves()
+{
+    m_curveCache.clear();
+}
+
 void KeyframeView::drawKeyFrameChannels(const QRectF &br, int in, int out, QPainter *painter, const QList<QPoint> &maximas, int limitKeyframes, const QColor &textColor)
 {
     double frameFactor = (double)(out - in) / br.width();
@@ -518,12 +548,13 @@ int KeyframeView::mouseOverKeyFrames(const QRectF &br, QPointF pos, double scale
     }
     pos.setX((pos.x() - m_offset) * scale);
     int previousEdit = activeKeyframe;
+    const QByteArray name = m_inTimeline.toUtf8();
     for (int i = 0; i < m_keyAnim.key_count(); ++i) {
         int key = m_keyAnim.key_get_frame(i);
         if (key < 0) {
             key += duration;
         }
-        double value = m_keyProperties.anim_get_double(m_inTimeline.toUtf8().constData(), key, duration - m_offset);
+        double value = m_keyProperties.anim_get_double(name.constData(), key, duration - m_offset);
         QPointF p = keyframeMap(br, key, value);
         p.setX(p.x() * scale);
         if (m_keyframeType == GeometryKeyframe) {
@@ -561,6 +592,7 @@ void KeyframeView::updateKeyFramePos(const QRectF &br, int frame, const double y
     if (!m_keyAnim.is_key(activeKeyframe)) {
         return;
     }
+    invalidateCurves();
     int prev = m_keyAnim.key_count() <= 1 || m_keyAnim.key_get_frame(0) == activeKeyframe ? 0 : m_keyAnim.previous_key(activeKeyframe - 1) + 1;
     prev = qMax(prev, -m_offset);
     int next = m_keyAnim.key_count() <= 1 || m_keyAnim.key_get_frame(m_keyAnim.key_count() - 1) == activeKeyframe ? duration - m_offset - 1 :  m_keyAnim.next_key(activeKeyframe + 1) - 1;
@@ -637,6 +669,7 @@ mlt_keyframe_type KeyframeView::type(int frame)
 
 void KeyframeView::addKeyframe(int frame, double value, mlt_keyframe_type type)
 {
+    invalidateCurves();
     m_keyProperties.anim_set(m_inTimeline.toUtf8().constData(), value, frame - m_offset, duration - m_offset, type);
     // Last keyframe should stick to end
     if (frame == duration - 1) {
@@ -665,6 +698,7 @@ void KeyframeView::addKeyframe(int frame, double value, mlt_keyframe_type type)
 
 void KeyframeView::addDefaultKeyframe(ProfileInfo profile, int frame, mlt_keyframe_type type)
 {
+    invalidateCurves();
     double value = m_keyframeDefault;
     if (m_keyAnim.key_count() == 1 && frame != m_keyAnim.key_get_frame(0)) {
         value = m_keyProperties.anim_get_double(m_inTimeline.toUtf8().constData(), m_keyAnim.key_get_frame(0), duration - m_offset);
@@ -707,6 +741,7 @@ void KeyframeView::addDefaultKeyframe(ProfileInfo profile, int frame, mlt_keyfra
 
 void KeyframeView::removeKeyframe(int frame)
 {
+    invalidateCurves();
     m_keyAnim.remove(frame);
     if (frame == duration - 1 && frame == attachToEnd) {
         attachToEnd = -2;
@@ -761,6 +796,7 @@ void KeyframeView::editKeyframeType(int type)
 {
     if (m_keyAnim.is_key(activeKeyframe)) {
         // This is a keyframe
+        invalidateCurves();
         double val = m_keyProperties.anim_get_double(m_inTimeline.toUtf8().constData(), activeKeyframe, duration - m_offset);
         m_keyProperties.anim_set(m_inTimeline.toUtf8().constData(), val, activeKeyframe, duration - m_offset, (mlt_keyframe_type) type);
     }
@@ -816,6 +852,7 @@ const QString KeyframeView::serialize(const QString &name, bool rectAnimation)
 
 QList<QPoint> KeyframeView::loadKeyframes(const QString &data)
 {
+    invalidateCurves();
     QList<QPoint> result;
     m_keyframeType = NoKeyframe;
     m_inTimeline = QStringLiteral("imported");
@@ -875,6 +912,7 @@ QList<QPoint> KeyframeView::loadKeyframes(const QString &data)
 
 bool KeyframeView::loadKeyframes(const QLocale &locale, const QDomElement &effect, int cropStart, int length)
 {
+    invalidateCurves();
     m_keyframeType = NoKeyframe;
     duration = length;
     m_inTimeline.clear();
@@ -966,6 +1004,7 @@ void KeyframeView::setOffset(int frames)
     if (duration == 0 || !m_keyAnim.is_valid()) {
         return;
     }
+    invalidateCurves();
     if (m_keyAnim.is_key(-m_offset)) {
         mlt_keyframe_type type = m_keyAnim.keyframe_type(-m_offset);
         double value = m_keyProperties.anim_get_double(m_inTimeline.toUtf8().constData(), -m_offset, duration - m_offset);
@@ -1011,6 +1050,7 @@ void KeyframeView::reset()
         // nothing to do
         return;
     }
+    invalidateCurves();
     m_keyframeType = NoKeyframe;
     duration = 0;
     attachToEnd = -2;
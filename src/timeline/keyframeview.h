@@ -29,6 +29,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "mlt++/MltProperties.h"
 #include "mlt++/MltAnimation.h"
 
+#include <QPainterPath>
+#include <QTransform>
+
 class QAction;
 
 /**
@@ -133,6 +136,20 @@ private:
         QString defaultValue;
     };
     QMap<QString, ParameterInfo> m_paramInfos;
+    /** @brief Curve of one parameter as drawn in timeline, reused until the animation, clip rect or zoom changes */
+    struct CurveGeometry {
+        int duration;
+        int offset;
+        QRectF rect;
+        QTransform transform;
+        QPainterPath path;
+        /** @brief Keyframe frame and its (transformed) handle position */
+        QVector<QPair<int, QPointF> > handles;
+    };
+    QMap<QString, CurveGeometry> m_curveCache;
+    /** @brief Drop cached curves, must be called whenever m_keyProperties is modified */
+    void invalidateCurves();
+    const CurveGeometry &curveGeometry(const QString &paramName, const ParameterInfo &info, const QRectF &br, const QTransform &transformation);
 
 signals:
     void updateKeyframes(const QRectF &r = QRectF());
@@ -21,11 +21,13 @@
 #include "../customruler.h"
 #include "kdenlivesettings.h"
 #include "doc/kdenlivedoc.h"
+#include "utils/tracer.h"
 
 #include <KLocalizedString>
 #include <QtConcurrent>
 #include <QStandardPaths>
 #include <QProcess>
+#include <QDomDocument>
 
 PreviewManager::PreviewManager(KdenliveDoc *doc, CustomRuler *ruler, Mlt::Tractor *tractor) : QObject()
     , m_doc(doc)
@@ -139,6 +141,68 @@ void PreviewManager::loadChunks(const QStringList &previewChunks, QStringList di
     }
 }
 
+int PreviewManager::addChunksToScene(QDomDocument &doc) const
+{
+    QDomElement tractor = doc.documentElement().firstChildElement(QStringLiteral("tractor"));
+    if (tractor.isNull()) {
+        return 0;
+    }
+    QList<int> chunks = m_ruler->getProcessedChunks();
+    const QList<int> dirtyChunks = m_ruler->getDirtyChunks();
+    qSort(chunks);
+    int chunkSize = KdenliveSettings::timelinechunks();
+    QDomElement playlist = doc.createElement(QStringLiteral("playlist"));
+    playlist.setAttribute(QStringLiteral("id"), QStringLiteral("timeline_preview"));
+    int position = 0;
+    int count = 0;
+    for (int frame : chunks) {
+        if (frame < position || dirtyChunks.contains(frame)) {
+            continue;
+        }
+        const QString fileName = m_cacheDir.absoluteFilePath(QStringLiteral("%1.%2").arg(frame).arg(m_extension));
+        if (!QFile::exists(fileName)) {
+            continue;
+        }
+        if (frame > position) {
+            QDomElement blank = doc.createElement(QStringLiteral("blank"));
+            blank.setAttribute(QStringLiteral("length"), frame - position);
+            playlist.appendChild(blank);
+        }
+        const QString producerId = QStringLiteral("timeline_preview_%1").arg(frame);
+        QDomElement producer = doc.createElement(QStringLiteral("producer"));
+        producer.setAttribute(QStringLiteral("id"), producerId);
+        QDomElement prop = doc.createElement(QStringLiteral("property"));
+        prop.setAttribute(QStringLiteral("name"), QStringLiteral("resource"));
+        prop.appendChild(doc.createTextNode(fileName));
+        producer.appendChild(prop);
+        prop = doc.createElement(QStringLiteral("property"));
+        prop.setAttribute(QStringLiteral("name"), QStringLiteral("mlt_service"));
+        prop.appendChild(doc.createTextNode(QStringLiteral("avformat-novalidate")));
+        producer.appendChild(prop);
+        doc.documentElement().insertBefore(producer, tractor);
+        QDomElement entry = doc.createElement(QStringLiteral("entry"));
+        entry.setAttribute(QStringLiteral("producer"), producerId);
+        playlist.appendChild(entry);
+        position = frame + chunkSize;
+        count++;
+    }
+    if (count == 0) {
+        return 0;
+    }
+    doc.documentElement().insertBefore(playlist, tractor);
+    // Like our timeline preview track, only replace the video of the tracks below
+    QDomElement track = doc.createElement(QStringLiteral("track"));
+    track.setAttribute(QStringLiteral("producer"), QStringLiteral("timeline_preview"));
+    track.setAttribute(QStringLiteral("hide"), QStringLiteral("audio"));
+    QDomElement lastTrack = tractor.lastChildElement(QStringLiteral("track"));
+    if (lastTrack.isNull()) {
+        tractor.appendChild(track);
+    } else {
+        tractor.insertAfter(track, lastTrack);
+    }
+    return count;
+}
+
 void PreviewManager::deletePreviewTrack()
 {
     m_tractor->lock();
@@ -438,6 +502,7 @@ void PreviewManager::doPreviewRender(const QString &scene)
         args << QStringLiteral("out=") + QString::number(i + chunkSize - 1);
         args << QStringLiteral("-consumer") << QStringLiteral("avformat:") + m_cacheDir.absoluteFilePath(fileName);
         args << m_consumerParams;
+        KDENLIVE_TRACE("preview", "Render chunk");
         QProcess previewProcess;
         connect(this, &PreviewManager::abortPreview, &previewProcess, &QProcess::kill, Qt::DirectConnection);
         previewProcess.start(KdenliveSettings::rendererpath(), args);
@@ -29,6 +29,7 @@
 
 class KdenliveDoc;
 class CustomRuler;
+class QDomDocument;
 
 namespace Mlt
 {
@@ -79,6 +80,8 @@ public:
     const QDir getCacheDir() const;
     /** @brief: Load existing ruler chunks. */
     void loadChunks(const QStringList &previewChunks, QStringList dirtyChunks, const QDateTime &documentDate);
+    /** @brief: Add a video only track playing the rendered chunks on top of a render scene, so that their effects are not processed again. Returns the number of chunks used. */
+    int addChunksToScene(QDomDocument &doc) const;
 
 private:
     KdenliveDoc *m_doc;
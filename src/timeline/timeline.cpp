@@ -690,7 +690,7 @@ bool Timeline::isLastClip(const ItemInfo &info)
     if (tk == nullptr) {
         return true;
     }
-    return tk->isLastClip(info.endPos.seconds());
+    return tk->isLastClip(info.endPos);
 }
 
 void Timeline::setTrackInfo(int ix, const TrackInfo &info)
@@ -1403,7 +1403,7 @@ void Timeline::checkTrackHeight(bool force)
     }
 }
 
-bool Timeline::moveClip(int startTrack, qreal startPos, int endTrack, qreal endPos, PlaylistState::ClipState state, TimelineMode::EditMode mode, bool duplicate)
+bool Timeline::moveClip(int startTrack, const GenTime &startPos, int endTrack, const GenTime &endPos, PlaylistState::ClipState state, TimelineMode::EditMode mode, bool duplicate)
 {
     if (startTrack == endTrack) {
         return track(startTrack)->move(startPos, endPos, mode);
@@ -1415,13 +1415,13 @@ bool Timeline::moveClip(int startTrack, qreal startPos, int endTrack, qreal endP
     Mlt::Producer *clipProducer = sourceTrack->playlist().replace_with_blank(clipIndex);
     sourceTrack->playlist().consolidate_blanks();
     if (!clipProducer || clipProducer->is_blank()) {
-        qCDebug(KDENLIVE_LOG) << "// Cannot get clip at index: " << clipIndex << " / " << startPos;
+        qCDebug(KDENLIVE_LOG) << "// Cannot get clip at index: " << clipIndex << " / " << pos;
         sourceTrack->playlist().unlock();
         return false;
     }
     sourceTrack->playlist().unlock();
     Track *destTrack = track(endTrack);
-    bool success = destTrack->add(endPos, clipProducer, GenTime(clipProducer->get_in(), destTrack->fps()).seconds(), GenTime(clipProducer->get_out() + 1, destTrack->fps()).seconds(), state, duplicate, mode);
+    bool success = destTrack->add(endPos, clipProducer, GenTime(clipProducer->get_in(), destTrack->fps()), GenTime(clipProducer->get_out() + 1, destTrack->fps()), state, duplicate, mode);
     delete clipProducer;
     return success;
 }
@@ -1657,7 +1657,7 @@ int Timeline::changeClipSpeed(const ItemInfo &info, const ItemInfo &speedIndepen
     return track(info.track)->changeClipSpeed(info, speedIndependantInfo, state, speed, strobe, prod, id, passProperties);
 }
 
-void Timeline::duplicateClipOnPlaylist(int tk, qreal startPos, int offset, Mlt::Producer *prod)
+void Timeline::duplicateClipOnPlaylist(int tk, const GenTime &startPos, int offset, Mlt::Producer *prod)
 {
     Track *sourceTrack = track(tk);
     int pos = sourceTrack->frame(startPos);
@@ -1971,6 +1971,14 @@ void Timeline::invalidateRange(const ItemInfo &info)
     }
 }
 
+int Timeline::addPreviewChunks(QDomDocument &doc) const
+{
+    if (!m_timelinePreview || !m_usePreview) {
+        return 0;
+    }
+    return m_timelinePreview->addChunksToScene(doc);
+}
+
 void Timeline::loadPreviewRender()
 {
     QString chunks = m_doc->getDocumentProperty(QStringLiteral("previewchunks"));
@@ -82,6 +82,8 @@ public:
     void refresh();
     int outPoint() const;
     int inPoint() const;
+    /** @brief Add the up to date timeline preview chunks as top track of a render scene, returns the number of chunks used. */
+    int addPreviewChunks(QDomDocument &doc) const;
     int fitZoom() const;
     /** @brief This object handles all transition operation. */
     TransitionHandler *transitionHandler;
@@ -111,7 +113,7 @@ public:
     /** @brief Returns a kdenlive effect xml description from an effect tag / id */
     static QDomElement getEffectByTag(const QString &effecttag, const QString &effectid);
     /** @brief Move a clip between tracks */
-    bool moveClip(int startTrack, qreal startPos, int endTrack, qreal endPos, PlaylistState::ClipState state, TimelineMode::EditMode mode, bool duplicate);
+    bool moveClip(int startTrack, const GenTime &startPos, int endTrack, const GenTime &endPos, PlaylistState::ClipState state, TimelineMode::EditMode mode, bool duplicate);
     void renameTrack(int ix, const QString &name);
     void updateTrackState(int ix, int state);
     /** @brief Returns info about a track.
@@ -141,7 +143,7 @@ public:
     int getTracks();
     void getTransitions();
     void refreshTractor();
-    void duplicateClipOnPlaylist(int tk, qreal startPos, int offset, Mlt::Producer *prod);
+    void duplicateClipOnPlaylist(int tk, const GenTime &startPos, int offset, Mlt::Producer *prod);
     int getSpaceLength(const GenTime &pos, int tk, bool fromBlankStart);
     void blockTrackSignals(bool block);
     /** @brief Load document */
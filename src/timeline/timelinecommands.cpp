@@ -291,9 +291,9 @@ EditEffectCommand::EditEffectCommand(CustomTrackView *view, const int track, con
     QUndoCommand(parent),
     m_view(view),
     m_track(track),
-    m_oldeffect(oldeffect),
-    m_effect(effect),
+    m_delta(oldeffect, effect),
     m_pos(pos),
+    m_ix(effect.attribute(QStringLiteral("kdenlive_ix")).toInt()),
     m_stackPos(stackPos),
     m_doIt(doIt),
     m_refreshEffectStack(refreshEffectStack),
@@ -309,7 +309,7 @@ EditEffectCommand::EditEffectCommand(CustomTrackView *view, const int track, con
         effectName = i18n("effect");
     }
     setText(i18n("Edit effect %1", effectName));
-    if (m_effect.attribute(QStringLiteral("id")) == QLatin1String("pan_zoom")) {
+    if (effect.attribute(QStringLiteral("id")) == QLatin1String("pan_zoom")) {
         QString bg = EffectsList::parameter(effect, QStringLiteral("background"));
         QString oldBg = EffectsList::parameter(oldeffect, QStringLiteral("background"));
         if (bg != oldBg) {
@@ -338,19 +338,22 @@ bool EditEffectCommand::mergeWith(const QUndoCommand *other)
     if (m_pos != static_cast<const EditEffectCommand *>(other)->m_pos) {
         return false;
     }
-    m_effect = static_cast<const EditEffectCommand *>(other)->m_effect.cloneNode().toElement();
+    m_delta.merge(static_cast<const EditEffectCommand *>(other)->m_delta);
+    m_replaceEffect |= static_cast<const EditEffectCommand *>(other)->m_replaceEffect;
     return true;
 }
 // virtual
 void EditEffectCommand::undo()
 {
-    m_view->updateEffect(m_track, m_pos, m_oldeffect, true, m_replaceEffect, m_refreshMonitor, m_updateClip);
+    const QDomElement current = m_view->currentEffect(m_track, m_pos, m_ix);
+    m_view->updateEffect(m_track, m_pos, m_delta.oldEffect(current), true, m_replaceEffect, m_refreshMonitor, m_updateClip, current);
 }
 // virtual
 void EditEffectCommand::redo()
 {
     if (m_doIt) {
-        m_view->updateEffect(m_track, m_pos, m_effect, m_refreshEffectStack, m_replaceEffect, m_refreshMonitor, m_updateClip);
+        const QDomElement current = m_view->currentEffect(m_track, m_pos, m_ix);
+        m_view->updateEffect(m_track, m_pos, m_delta.newEffect(current), m_refreshEffectStack, m_replaceEffect, m_refreshMonitor, m_updateClip, current);
     }
     m_doIt = true;
     m_refreshEffectStack = true;
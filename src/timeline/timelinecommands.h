@@ -27,6 +27,7 @@
 #include <QDomElement>
 #include "definitions.h"
 #include "effectslist/effectslist.h"
+#include "effectslist/effectdelta.h"
 class GenTime;
 class CustomTrackView;
 class Timeline;
@@ -175,9 +176,11 @@ public:
 private:
     CustomTrackView *m_view;
     const int m_track;
-    QDomElement m_oldeffect;
-    QDomElement m_effect;
+    /** @brief Only the changed attributes are kept, successive edits of the effect are merged in it */
+    EffectDelta m_delta;
     const GenTime m_pos;
+    /** @brief The effect's kdenlive_ix, used to fetch the current effect on undo / redo */
+    int m_ix;
     int m_stackPos;
     bool m_doIt;
     bool m_refreshEffectStack;
@@ -60,9 +60,9 @@ qreal Track::fps()
     return m_playlist.get_fps();
 }
 
-int Track::frame(qreal t)
+int Track::frame(const GenTime &t)
 {
-    return round(t * fps());
+    return (int) t.frames(fps());
 }
 
 qreal Track::length() {
@@ -70,7 +70,7 @@ qreal Track::length() {
 }
 
 // basic clip operations
-bool Track::add(qreal t, Mlt::Producer *parent, qreal tcut, qreal dtcut, PlaylistState::ClipState state, bool duplicate, TimelineMode::EditMode mode)
+bool Track::add(const GenTime &t, Mlt::Producer *parent, const GenTime &tcut, const GenTime &dtcut, PlaylistState::ClipState state, bool duplicate, TimelineMode::EditMode mode)
 {
     Mlt::Producer *cut = nullptr;
     if (parent == nullptr || !parent->is_valid()) {
@@ -99,7 +99,7 @@ bool Track::add(qreal t, Mlt::Producer *parent, qreal tcut, qreal dtcut, Playlis
     return result;
 }
 
-bool Track::doAdd(qreal t, Mlt::Producer *cut, TimelineMode::EditMode mode)
+bool Track::doAdd(const GenTime &t, Mlt::Producer *cut, TimelineMode::EditMode mode)
 {
     int pos = frame(t);
     if (pos < m_playlist.get_playtime() && mode == TimelineMode::InsertEdit) {
@@ -112,7 +112,7 @@ bool Track::doAdd(qreal t, Mlt::Producer *cut, TimelineMode::EditMode mode)
     return true;
 }
 
-bool Track::move(qreal start, qreal end, TimelineMode::EditMode mode)
+bool Track::move(const GenTime &start, const GenTime &end, TimelineMode::EditMode mode)
 {
     int pos = frame(start);
     m_playlist.lock();
@@ -123,12 +123,12 @@ bool Track::move(qreal start, qreal end, TimelineMode::EditMode mode)
     }
     QScopedPointer <Mlt::Producer> clipProducer(m_playlist.replace_with_blank(clipIndex));
     if (!clipProducer || clipProducer->is_blank()) {
-        qCDebug(KDENLIVE_LOG) << "// Cannot get clip at index: "<<clipIndex<<" / "<< start;
+        qCDebug(KDENLIVE_LOG) << "// Cannot get clip at index: "<<clipIndex<<" / "<< pos;
         m_playlist.unlock();
         return false;
     }
     m_playlist.consolidate_blanks();
-    if (end >= m_playlist.get_playtime()) {
+    if (frame(end) >= m_playlist.get_playtime()) {
 	// Clip is inserted at the end of track, duration change event handled in doAdd()
 	durationChanged = false;
     }
@@ -140,7 +140,7 @@ bool Track::move(qreal start, qreal end, TimelineMode::EditMode mode)
     return result;
 }
 
-bool Track::isLastClip(qreal t)
+bool Track::isLastClip(const GenTime &t)
 {
     int clipIndex = m_playlist.get_clip_index_at(frame(t));
     if (clipIndex >= m_playlist.count() - 1) {
@@ -149,7 +149,7 @@ bool Track::isLastClip(qreal t)
     return false;
 }
 
-bool Track::del(qreal t, bool checkDuration)
+bool Track::del(const GenTime &t, bool checkDuration)
 {
     m_playlist.lock();
     bool durationChanged = false;
@@ -174,7 +174,7 @@ bool Track::del(qreal t, bool checkDuration)
     return true;
 }
 
-bool Track::del(qreal t, qreal dt)
+bool Track::del(const GenTime &t, const GenTime &dt)
 {
     m_playlist.lock();
     m_playlist.insert_blank(m_playlist.remove_region(frame(t), frame(dt) + 1), frame(dt));
@@ -183,7 +183,7 @@ bool Track::del(qreal t, qreal dt)
     return true;
 }
 
-bool Track::resize(qreal t, qreal dt, bool end)
+bool Track::resize(const GenTime &t, const GenTime &dt, bool end)
 {
     m_playlist.lock();
     int startFrame = frame(t);
@@ -191,7 +191,7 @@ bool Track::resize(qreal t, qreal dt, bool end)
     int length = frame(dt);
     QScopedPointer<Mlt::Producer> clip(m_playlist.get_clip(index));
     if (clip == nullptr || clip->is_blank()) {
-        qWarning("Can't resize clip at %f", t);
+        qWarning("Can't resize clip at %d", startFrame);
 	m_playlist.unlock();
         return false;
     }
@@ -256,7 +256,7 @@ bool Track::resize(qreal t, qreal dt, bool end)
     return true;
 }
 
-bool Track::cut(qreal t)
+bool Track::cut(const GenTime &t)
 {
     int pos = frame(t);
     m_playlist.lock();
@@ -445,7 +445,7 @@ QList<ItemInfo> Track::replaceAll(const QString &id, Mlt::Producer *original, Ml
 }
 
 //TODO: cut: checkSlowMotionProducer
-bool Track::replace(qreal t, Mlt::Producer *prod, PlaylistState::ClipState state, PlaylistState::ClipState originalState) {
+bool Track::replace(const GenTime &t, Mlt::Producer *prod, PlaylistState::ClipState state, PlaylistState::ClipState originalState) {
     m_playlist.lock();
     int index = m_playlist.get_clip_index_at(frame(t));
     Mlt::Producer *cut;
@@ -899,7 +899,7 @@ void Track::disableEffects(bool disable)
     }
 }
 
-bool Track::addEffect(double start, const EffectsParameterList &params)
+bool Track::addEffect(const GenTime &start, const EffectsParameterList &params)
 {
     int pos = frame(start);
     int clipIndex = m_playlist.get_clip_index_at(pos);
@@ -921,7 +921,7 @@ bool Track::addTrackEffect(const EffectsParameterList &params)
     return effect.addEffect(params, duration);
 }
 
-bool Track::editEffect(double start, const EffectsParameterList &params, bool replace, bool updateClip)
+bool Track::editEffect(const GenTime &start, const EffectsParameterList &params, bool replace, bool updateClip, const EffectsParameterList &previous)
 {
     int pos = frame(start);
     int clipIndex = m_playlist.get_clip_index_at(pos);
@@ -931,18 +931,18 @@ bool Track::editEffect(double start, const EffectsParameterList &params, bool re
         return false;
     }
     EffectManager effect(*clip.data());
-    bool result = effect.editEffect(params, duration, replace);
+    bool result = effect.editEffect(params, duration, replace, previous);
     return result;
 }
 
-bool Track::editTrackEffect(const EffectsParameterList &params, bool replace)
+bool Track::editTrackEffect(const EffectsParameterList &params, bool replace, const EffectsParameterList &previous)
 {
     EffectManager effect(m_playlist);
     int duration = m_playlist.get_playtime() - 1;
-    return effect.editEffect(params, duration, replace);
+    return effect.editEffect(params, duration, replace, previous);
 }
 
-bool Track::removeEffect(double start, int effectIndex, bool updateIndex)
+bool Track::removeEffect(const GenTime &start, int effectIndex, bool updateIndex)
 {
     int pos = frame(start);
     int clipIndex = m_playlist.get_clip_index_at(pos);
@@ -961,7 +961,7 @@ bool Track::removeTrackEffect(int effectIndex, bool updateIndex)
     return effect.removeEffect(effectIndex, updateIndex);
 }
 
-bool Track::enableEffects(double start, const QList<int> &effectIndexes, bool disable)
+bool Track::enableEffects(const GenTime &start, const QList<int> &effectIndexes, bool disable)
 {
     int pos = frame(start);
     int clipIndex = m_playlist.get_clip_index_at(pos);
@@ -980,7 +980,7 @@ bool Track::enableTrackEffects(const QList<int> &effectIndexes, bool disable, bo
     return effect.enableEffects(effectIndexes, disable, remember);
 }
 
-bool Track::moveEffect(double start, int oldPos, int newPos)
+bool Track::moveEffect(const GenTime &start, int oldPos, int newPos)
 {
     int pos = frame(start);
     int clipIndex = m_playlist.get_clip_index_at(pos);
@@ -88,9 +88,9 @@ public:
     HeaderTrack *trackHeader;
 
     /** @brief convertion utility function
-     * @param time (in seconds)
+     * @param t timeline position
      * @return frame number */
-    int frame(qreal t);
+    int frame(const GenTime &t);
     /** @brief get the playlist duration
      * @return play time in seconds */
     qreal length();
@@ -99,40 +99,40 @@ public:
     int index() const;
 
     /** @brief add a clip
-     * @param t is the time position to start the cut (in seconds)
+     * @param t is the time position to start the cut
      * @param cut is a MLT Producer cut (resource + in/out timecodes)
      * @param duplicate when true, we will create a copy of the clip if necessary
      * @param mode allow insert in non-blanks by replacing (mode=1) or pushing (mode=2) content
      * The playlist must be locked / unlocked before and after calling doAdd
      * @return true if success */
-    bool doAdd(qreal t, Mlt::Producer *cut, TimelineMode::EditMode mode);
-    bool add(qreal t, Mlt::Producer *parent, qreal tcut, qreal dtcut, PlaylistState::ClipState state, bool duplicate, TimelineMode::EditMode mode);
+    bool doAdd(const GenTime &t, Mlt::Producer *cut, TimelineMode::EditMode mode);
+    bool add(const GenTime &t, Mlt::Producer *parent, const GenTime &tcut, const GenTime &dtcut, PlaylistState::ClipState state, bool duplicate, TimelineMode::EditMode mode);
     /** @brief Move a clip in the track
-     * @param start where clip is present (in seconds);
+     * @param start where clip is present;
      * @param end wher the clip should be moved
      * @param mode allow insert in non-blanks by replacing (mode=1) or pushing (mode=2) content
      * @return true if success */
-    bool move(qreal start, qreal end, TimelineMode::EditMode mode = TimelineMode::NormalEdit);
+    bool move(const GenTime &start, const GenTime &end, TimelineMode::EditMode mode = TimelineMode::NormalEdit);
     /** @brief delete a clip
-     * @param time where clip is present (in seconds);
+     * @param t where clip is present;
      * @return true if success */
-    bool del(qreal t, bool checkDuration = true);
+    bool del(const GenTime &t, bool checkDuration = true);
     /** delete a region
      * @param t is the start,
-     * @param dt is the duration (in seconds)
+     * @param dt is the duration
      * @return true if success */
-    bool del(qreal t, qreal dt);
+    bool del(const GenTime &t, const GenTime &dt);
     /** @brief change the clip length from start or end
      * @param told is the current edge position,
-     * @param tnew is the target edge position (in seconds)
+     * @param tnew is the target edge position
      * @param end precises if we move the end of the left clip (\em true)
      *  or the start of the right clip (\em false)
      * @return true if success */
-    bool resize(qreal told, qreal tnew, bool end);
+    bool resize(const GenTime &told, const GenTime &tnew, bool end);
     /** @brief split the clip at given position
      * @param t is the cut time in playlist
      * @return true if success */
-    bool cut(qreal t);
+    bool cut(const GenTime &t);
     /** @brief prepends a dash to the clip's id to prepare for replacement */
     void replaceId(const QString &id);
     /** @brief replace all occurrences of a clip in the track with another resource
@@ -147,7 +147,7 @@ public:
      * @param t is the clip time in playlist
      * @param prod is the replacement clip
      * @return true if success */
-    bool replace(qreal t, Mlt::Producer *prod, PlaylistState::ClipState state = PlaylistState::Original, PlaylistState::ClipState originalState = PlaylistState::Original);
+    bool replace(const GenTime &t, Mlt::Producer *prod, PlaylistState::ClipState state = PlaylistState::Original, PlaylistState::ClipState originalState = PlaylistState::Original);
     /** @brief look for a clip having a given property value
      * @param name is the property name
      * @param value is the searched value
@@ -196,16 +196,16 @@ public:
     /** @brief Dis/enable all effects on this track. */
     void disableEffects(bool disable);
     /** @brief Returns true if position is on last clip or beyond track length. */
-    bool isLastClip(qreal t);
-    bool addEffect(double start, const EffectsParameterList &params);
+    bool isLastClip(const GenTime &t);
+    bool addEffect(const GenTime &start, const EffectsParameterList &params);
     bool addTrackEffect(const EffectsParameterList &params);
-    bool editEffect(double start, const EffectsParameterList &params, bool replace, bool updateClip = true);
-    bool editTrackEffect(const EffectsParameterList &params, bool replace);
-    bool removeEffect(double start, int effectIndex, bool updateIndex);
+    bool editEffect(const GenTime &start, const EffectsParameterList &params, bool replace, bool updateClip = true, const EffectsParameterList &previous = EffectsParameterList());
+    bool editTrackEffect(const EffectsParameterList &params, bool replace, const EffectsParameterList &previous = EffectsParameterList());
+    bool removeEffect(const GenTime &start, int effectIndex, bool updateIndex);
     bool removeTrackEffect(int effectIndex, bool updateIndex);
-    bool enableEffects(double start, const QList<int> &effectIndexes, bool disable);
+    bool enableEffects(const GenTime &start, const QList<int> &effectIndexes, bool disable);
     bool enableTrackEffects(const QList<int> &effectIndexes, bool disable, bool remember = false);
-    bool moveEffect(double start, int oldPos, int newPos);
+    bool moveEffect(const GenTime &start, int oldPos, int newPos);
     bool moveTrackEffect(int oldPos, int newPos);
     QList<QPoint> visibleClips();
     bool resize_in_out(int pos, int in, int out);
@@ -22,6 +22,7 @@
 
 #include "kdenlivesettings.h"
 #include "mainwindow.h"
+#include "utils/tracer.h"
 
 #include "kdenlive_debug.h"
 
@@ -187,6 +188,7 @@ void Transition::paint(QPainter *painter,
                        const QStyleOptionGraphicsItem *option,
                        QWidget */*widget*/)
 {
+    KDENLIVE_TRACE("timeline", "Paint transition");
     const QRectF exposed = painter->worldTransform().mapRect(option->exposedRect);
     const QRectF br = rect();
     QPen framePen;
@@ -52,6 +52,8 @@ public:
     int frameHeight() const;
     /** \brief Extract embedded images in project titles folder. */
     static const QString extractBase64Image(const QString &titlePath, const QString &data);
+    /** \brief Parse a "x,y,width,height" rect as stored in title xml. */
+    static QRectF stringToRect(const QString &);
 
     enum ItemOrigin {OriginXLeft = 0, OriginYTop = 1};
     enum AxisPosition {AxisDefault = 0, AxisInverted = 1};
@@ -63,7 +65,6 @@ private:
     int m_height;
     QString colorToString(const QColor &);
     QString rectFToString(const QRectF &);
-    QRectF stringToRect(const QString &);
     QColor stringToColor(const QString &);
     QTransform stringToTransform(const QString &);
     QList<QVariant> stringToList(const QString &);
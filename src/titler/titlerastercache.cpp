@@ -0,0 +1,248 @@
+/*
+Copyright (C) 2018  Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "titlerastercache.h"
+#include "titledocument.h"
+
+#include "kdenlive_debug.h"
+#include <QApplication>
+#include <QCache>
+#include <QCryptographicHash>
+#include <QDomDocument>
+#include <QFile>
+#include <QGraphicsRectItem>
+#include <QGraphicsScene>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPainter>
+#include <QThread>
+
+#include <cmath>
+
+namespace {
+// Rasters kept in memory, cost is in kB
+QCache<QString, QImage> rasterCache(64 * 1024);
+// Title scenes are not reentrant, render one at a time
+QMutex rasterMutex;
+// Largest full scene raster used for animated titles, in kB. Kept well below the memory cache cost
+// so that a scene raster does not evict all others, and is not refused by the cache.
+const int maxSceneRaster = 16 * 1024;
+
+QString rasterKey(const QString &xmlData, const QSize &size)
+{
+    return TitleRasterCache::contentHash(xmlData) + QLatin1Char('_') + QString::number(size.width()) + QLatin1Char('x') + QString::number(size.height());
+}
+
+QImage cachedRaster(const QDir &folder, const QString &key)
+{
+    QImage *img = rasterCache.object(key);
+    if (img) {
+        return *img;
+    }
+    if (folder.exists(key + QStringLiteral(".png"))) {
+        QImage stored(folder.absoluteFilePath(key + QStringLiteral(".png")));
+        if (!stored.isNull()) {
+            stored = stored.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+            rasterCache.insert(key, new QImage(stored), stored.byteCount() / 1024);
+            return stored;
+        }
+    }
+    return QImage();
+}
+
+void storeRaster(const QDir &folder, const QString &key, const QImage &img)
+{
+    rasterCache.insert(key, new QImage(img), img.byteCount() / 1024);
+    if (folder.exists() && !img.save(folder.absoluteFilePath(key + QStringLiteral(".png")))) {
+        qCDebug(KDENLIVE_LOG) << "Cannot write title raster to" << folder.absolutePath();
+    }
+}
+
+QRectF viewport(const QDomElement &title, const QString &name, const QRectF &defaultRect)
+{
+    QDomElement port = title.firstChildElement(name);
+    if (port.isNull()) {
+        return defaultRect;
+    }
+    QRectF r = TitleDocument::stringToRect(port.attribute(QStringLiteral("rect")));
+    return r.isEmpty() ? defaultRect : r;
+}
+}
+
+//static
+QString TitleRasterCache::contentHash(const QString &xmlData)
+{
+    return QString::fromLatin1(QCryptographicHash::hash(xmlData.toUtf8(), QCryptographicHash::Md5).toHex());
+}
+
+//static
+bool TitleRasterCache::isCacheable(const QDomDocument &doc)
+{
+    QDomElement title = doc.documentElement();
+    if (title.tagName() != QLatin1String("kdenlivetitle") || !title.hasAttribute(QStringLiteral("width")) || !title.hasAttribute(QStringLiteral("height"))) {
+        return false;
+    }
+    // Pixmaps can only be loaded in the GUI thread
+    bool guiThread = QThread::currentThread() == qApp->thread();
+    QDomNodeList items = title.elementsByTagName(QStringLiteral("item"));
+    for (int i = 0; i < items.count(); ++i) {
+        QDomElement item = items.item(i).toElement();
+        QDomElement content = item.firstChildElement(QStringLiteral("content"));
+        if (item.attribute(QStringLiteral("type")) == QLatin1String("QGraphicsTextItem")) {
+            // Typewriter effect changes the text on every frame, template text is replaced by the producer
+            if (content.hasAttribute(QStringLiteral("typewriter")) || content.text() == QLatin1String("%s")) {
+                return false;
+            }
+            // Old titles using point sizes need a conversion requiring user interaction
+            if (!content.hasAttribute(QStringLiteral("font-pixel-size"))) {
+                return false;
+            }
+        } else if (!guiThread && item.attribute(QStringLiteral("type")) == QLatin1String("QGraphicsPixmapItem")) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//static
+QImage TitleRasterCache::render(const QDomDocument &doc, const QRectF &source, const QSize &size)
+{
+    QDomElement title = doc.documentElement();
+    int width = title.attribute(QStringLiteral("width")).toInt();
+    int height = title.attribute(QStringLiteral("height")).toInt();
+    QGraphicsScene scene(0, 0, width, height);
+    // TitleDocument applies the background color to the frame item
+    QGraphicsRectItem *background = scene.addRect(0, 0, width, height, Qt::NoPen, Qt::NoBrush);
+    background->setZValue(-1100);
+    TitleDocument titleDoc;
+    titleDoc.setScene(&scene, width, height);
+    int duration;
+    titleDoc.loadFromXml(doc, nullptr, nullptr, &duration);
+    QImage img(size, QImage::Format_ARGB32_Premultiplied);
+    img.fill(Qt::transparent);
+    QPainter painter(&img);
+    painter.setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing | QPainter::SmoothPixmapTransform | QPainter::HighQualityAntialiasing);
+    scene.render(&painter, QRectF(0, 0, size.width(), size.height()), source, Qt::IgnoreAspectRatio);
+    painter.end();
+    return img;
+}
+
+//static
+QImage TitleRasterCache::image(const QDir &cacheFolder, const QString &xmlData, const QSize &size, int position, int duration)
+{
+    if (xmlData.isEmpty() || size.isEmpty()) {
+        return QImage();
+    }
+    const QString key = rasterKey(xmlData, size);
+    QMutexLocker lock(&rasterMutex);
+    QImage img = cachedRaster(cacheFolder, key);
+    if (!img.isNull()) {
+        return img;
+    }
+    QDomDocument doc;
+    if (!doc.setContent(xmlData) || !isCacheable(doc)) {
+        return QImage();
+    }
+    QDomElement title = doc.documentElement();
+    const QRectF frame(0, 0, title.attribute(QStringLiteral("width")).toInt(), title.attribute(QStringLiteral("height")).toInt());
+    const QRectF start = viewport(title, QStringLiteral("startviewport"), frame);
+    const QRectF end = viewport(title, QStringLiteral("endviewport"), start);
+    if (start == end) {
+        // Static title, rasterize once
+        img = render(doc, start, size);
+        storeRaster(cacheFolder, key, img);
+        return img;
+    }
+
+    // Only the viewport moves: rasterize the whole travelled area once and crop each frame from it
+    double percent = duration > 1 ? qBound(0.0, (double) position / (duration - 1), 1.0) : 0.0;
+    const QRectF current(start.x() + (end.x() - start.x()) * percent, start.y() + (end.y() - start.y()) * percent,
+                         start.width() + (end.width() - start.width()) * percent, start.height() + (end.height() - start.height()) * percent);
+    const double xScale = qMax(size.width() / start.width(), size.width() / end.width());
+    const double yScale = qMax(size.height() / start.height(), size.height() / end.height());
+    const QRectF area = start.united(end);
+    const QSize sceneSize(std::ceil(area.width() * xScale), std::ceil(area.height() * yScale));
+    if ((qint64) sceneSize.width() * sceneSize.height() * 4 / 1024 > maxSceneRaster) {
+        return render(doc, current, size);
+    }
+    const QString sceneKey = key + QStringLiteral("_scene");
+    QImage sceneImage = cachedRaster(cacheFolder, sceneKey);
+    if (sceneImage.isNull()) {
+        sceneImage = render(doc, area, sceneSize);
+        storeRaster(cacheFolder, sceneKey, sceneImage);
+    }
+    img = QImage(size, QImage::Format_ARGB32_Premultiplied);
+    img.fill(Qt::transparent);
+    QPainter painter(&img);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    const QRectF source((current.x() - area.x()) * xScale, (current.y() - area.y()) * yScale, current.width() * xScale, current.height() * yScale);
+    painter.drawImage(QRectF(0, 0, size.width(), size.height()), sceneImage, source);
+    painter.end();
+    return img;
+}
+
+
+//static
+QString TitleRasterCache::rasterFile(const QDir &cacheFolder, const QString &xmlData, const QSize &size)
+{
+    if (xmlData.isEmpty() || size.isEmpty() || !cacheFolder.exists()) {
+        return QString();
+    }
+    const QString key = rasterKey(xmlData, size);
+    const QString path = cacheFolder.absoluteFilePath(key + QStringLiteral(".png"));
+    QMutexLocker lock(&rasterMutex);
+    QDomDocument doc;
+    if (!doc.setContent(xmlData) || !isCacheable(doc)) {
+        return QString();
+    }
+    QDomElement title = doc.documentElement();
+    const QRectF frame(0, 0, title.attribute(QStringLiteral("width")).toInt(), title.attribute(QStringLiteral("height")).toInt());
+    const QRectF start = viewport(title, QStringLiteral("startviewport"), frame);
+    if (start != viewport(title, QStringLiteral("endviewport"), start)) {
+        // Animated titles need the producer
+        return QString();
+    }
+    if (!QFile::exists(path)) {
+        storeRaster(cacheFolder, key, render(doc, start, size));
+    }
+    return QFile::exists(path) ? path : QString();
+}
+
+//static
+void TitleRasterCache::prune(const QDir &cacheFolder, const QStringList &usedXmlData)
+{
+    if (!cacheFolder.exists()) {
+        return;
+    }
+    QStringList used;
+    for (const QString &xmlData : usedXmlData) {
+        used << contentHash(xmlData);
+    }
+    QMutexLocker lock(&rasterMutex);
+    // Rasters are named after the content hash, drop those of edited or deleted titles
+    const QStringList files = cacheFolder.entryList(QStringList() << QStringLiteral("*.png"), QDir::Files);
+    for (const QString &file : files) {
+        if (!used.contains(file.section(QLatin1Char('_'), 0, 0))) {
+            rasterCache.remove(file.section(QLatin1Char('.'), 0, 0));
+            cacheFolder.remove(file);
+        }
+    }
+}
@@ -0,0 +1,60 @@
+/*
+Copyright (C) 2018  Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TITLERASTERCACHE_H
+#define TITLERASTERCACHE_H
+
+#include <QImage>
+#include <QDir>
+#include <QRectF>
+
+class QDomDocument;
+
+/**
+ * @class TitleRasterCache
+ * @brief Persistent cache of rasterized title clips, keyed by title content hash and frame size.
+ *
+ * Static titles are rendered once per (content, size) and stored as png in the project's title cache folder.
+ * Titles whose only animation is a moving viewport keep a single raster of the whole scene, each frame
+ * is then cropped from it. Titles with a typewriter effect cannot be cached and return a null image.
+ */
+class TitleRasterCache
+{
+public:
+    /** @brief Returns the Md5 hash identifying a title's content. */
+    static QString contentHash(const QString &xmlData);
+    /** @brief Returns true if the title can be served from the cache (no typewriter effect, no legacy point sized fonts). */
+    static bool isCacheable(const QDomDocument &doc);
+    /** @brief Returns the title frame at @param position rendered at @param size, or a null image if it cannot be cached.
+     *  @param cacheFolder the folder where rasters are stored, if it does not exist rasters are only kept in memory
+     *  @param duration the title duration, used to interpolate the viewport of animated titles */
+    static QImage image(const QDir &cacheFolder, const QString &xmlData, const QSize &size, int position = 0, int duration = 0);
+    /** @brief Returns the png file holding a static title rendered at @param size, or an empty string if the title is animated or cannot be cached. */
+    static QString rasterFile(const QDir &cacheFolder, const QString &xmlData, const QSize &size);
+    /** @brief Delete the rasters of titles that are not in @param usedXmlData anymore. */
+    static void prune(const QDir &cacheFolder, const QStringList &usedXmlData);
+
+private:
+    /** @brief Renders the title scene area @param source into an image of size @param size. */
+    static QImage render(const QDomDocument &doc, const QRectF &source, const QSize &size);
+};
+
+#endif
@@ -17,6 +17,7 @@
 
 #include "titlewidget.h"
 #include "gradientwidget.h"
+#include "titlerastercache.h"
 #include "kdenlivesettings.h"
 #include "doc/kthumb.h"
 #include "renderer.h"
@@ -41,7 +42,6 @@
 #include <QSignalMapper>
 #include <QTextBlockFormat>
 #include <QTextCursor>
-#include <QCryptographicHash>
 #include <QKeyEvent>
 #include <QImageReader>
 
@@ -537,7 +537,7 @@ TitleWidget::TitleWidget(const QUrl &url, const Timecode &tc, const QString &pro
     foreach (const TitleTemplate &t, titletemplates) {
         templateBox->addItem(t.icon, t.name, t.file);
     }
-    lastDocumentHash = QCryptographicHash::hash(xml().toString().toLatin1(), QCryptographicHash::Md5).toHex();
+    lastDocumentHash = TitleRasterCache::contentHash(xml().toString());
 }
 
 TitleWidget::~TitleWidget()
@@ -640,7 +640,7 @@ void TitleWidget::templateIndexChanged(int index)
 {
     QString item = templateBox->itemData(index).toString();
     if (!item.isEmpty()) {
-        if (lastDocumentHash != QCryptographicHash::hash(xml().toString().toLatin1(), QCryptographicHash::Md5).toHex()) {
+        if (lastDocumentHash != TitleRasterCache::contentHash(xml().toString())) {
             if (KMessageBox::questionYesNo(this, i18n("Do you really want to load a new template? Changes in this title will be lost!")) == KMessageBox::No) {
                 return;
             }
@@ -658,7 +658,7 @@ void TitleWidget::templateIndexChanged(int index)
             }
 
         }
-        lastDocumentHash = QCryptographicHash::hash(xml().toString().toLatin1(), QCryptographicHash::Md5).toHex();
+        lastDocumentHash = TitleRasterCache::contentHash(xml().toString());
     }
 }
 //virtual
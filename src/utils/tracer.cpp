@@ -0,0 +1,220 @@
+/*
+Copyright (C) 2018  Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "tracer.h"
+#include "kdenlive_debug.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QVector>
+
+namespace {
+// Events kept per thread, older ones are overwritten
+const int bufferCapacity = 32768;
+// Buffers of finished threads kept until the next export, older ones are freed
+const int maxFinishedBuffers = 16;
+
+struct TraceEvent
+{
+    const char *category;
+    const char *name;
+    qint64 start;
+    qint64 duration;
+};
+
+struct TraceBuffer
+{
+    // Only contended while a trace is exported
+    QMutex mutex;
+    QVector<TraceEvent> events;
+    int next = 0;
+    bool wrapped = false;
+    int tid = 0;
+    QString threadName;
+    // The thread exited, the buffer is only kept for export
+    bool finished = false;
+};
+
+const QElapsedTimer &traceClock()
+{
+    static const QElapsedTimer timer = []() {
+        QElapsedTimer t;
+        t.start();
+        return t;
+    }();
+    return timer;
+}
+
+// Buffers of finished threads are kept so that their events can still be exported, they are
+// freed once exported, when tracing restarts or when too many threads finished (thread pool
+// threads expire after being idle)
+QMutex buffersMutex;
+QList<TraceBuffer *> buffers;
+int lastTid = 0;
+
+// Free the buffers of finished threads, except the @param keep most recent ones. Call with buffersMutex locked.
+void releaseFinishedBuffers(int keep)
+{
+    for (int i = buffers.count() - 1; i >= 0; --i) {
+        if (buffers.at(i)->finished) {
+            if (keep > 0) {
+                --keep;
+            } else {
+                delete buffers.takeAt(i);
+            }
+        }
+    }
+}
+
+struct BufferOwner
+{
+    TraceBuffer *buffer = nullptr;
+    ~BufferOwner()
+    {
+        if (!buffer) {
+            return;
+        }
+        QMutexLocker lock(&buffersMutex);
+        if (buffer->next == 0 && !buffer->wrapped) {
+            // Nothing to export
+            buffers.removeOne(buffer);
+            delete buffer;
+            return;
+        }
+        buffer->finished = true;
+        releaseFinishedBuffers(maxFinishedBuffers);
+    }
+};
+thread_local BufferOwner threadBuffer;
+
+TraceBuffer *currentBuffer()
+{
+    if (!threadBuffer.buffer) {
+        TraceBuffer *buffer = new TraceBuffer;
+        buffer->events.resize(bufferCapacity);
+        QThread *thread = QThread::currentThread();
+        if (qApp && thread == qApp->thread()) {
+            buffer->threadName = QStringLiteral("Main thread");
+        } else if (thread && !thread->objectName().isEmpty()) {
+            buffer->threadName = thread->objectName();
+        }
+        QMutexLocker lock(&buffersMutex);
+        buffers << buffer;
+        buffer->tid = ++lastTid;
+        if (buffer->threadName.isEmpty()) {
+            buffer->threadName = QStringLiteral("Thread %1").arg(buffer->tid);
+        }
+        threadBuffer.buffer = buffer;
+    }
+    return threadBuffer.buffer;
+}
+}
+
+QAtomicInt Tracer::s_enabled(0);
+
+void Tracer::setEnabled(bool enabled)
+{
+    if (enabled) {
+        traceClock();
+        QMutexLocker lock(&buffersMutex);
+        releaseFinishedBuffers(0);
+        for (TraceBuffer *buffer : buffers) {
+            QMutexLocker bufferLock(&buffer->mutex);
+            buffer->next = 0;
+            buffer->wrapped = false;
+        }
+    }
+    s_enabled.store(enabled ? 1 : 0);
+}
+
+qint64 Tracer::now()
+{
+    return traceClock().nsecsElapsed();
+}
+
+void Tracer::record(const char *category, const char *name, qint64 start, qint64 duration)
+{
+    TraceBuffer *buffer = currentBuffer();
+    QMutexLocker lock(&buffer->mutex);
+    TraceEvent &event = buffer->events[buffer->next];
+    event.category = category;
+    event.name = name;
+    event.start = start;
+    event.duration = duration;
+    if (++buffer->next == bufferCapacity) {
+        buffer->next = 0;
+        buffer->wrapped = true;
+    }
+}
+
+bool Tracer::exportTrace(const QString &path)
+{
+    QJsonArray events;
+    const qint64 pid = QCoreApplication::applicationPid();
+    QMutexLocker lock(&buffersMutex);
+    for (TraceBuffer *buffer : buffers) {
+        QJsonObject meta;
+        meta.insert(QStringLiteral("ph"), QStringLiteral("M"));
+        meta.insert(QStringLiteral("name"), QStringLiteral("thread_name"));
+        meta.insert(QStringLiteral("pid"), pid);
+        meta.insert(QStringLiteral("tid"), buffer->tid);
+        QJsonObject args;
+        args.insert(QStringLiteral("name"), buffer->threadName);
+        meta.insert(QStringLiteral("args"), args);
+        events.append(meta);
+        QMutexLocker bufferLock(&buffer->mutex);
+        const int count = buffer->wrapped ? bufferCapacity : buffer->next;
+        const int first = buffer->wrapped ? buffer->next : 0;
+        for (int i = 0; i < count; ++i) {
+            const TraceEvent &event = buffer->events.at((first + i) % bufferCapacity);
+            QJsonObject item;
+            item.insert(QStringLiteral("ph"), QStringLiteral("X"));
+            item.insert(QStringLiteral("cat"), QString::fromLatin1(event.category));
+            item.insert(QStringLiteral("name"), QString::fromLatin1(event.name));
+            item.insert(QStringLiteral("pid"), pid);
+            item.insert(QStringLiteral("tid"), buffer->tid);
+            // Chrome expects microseconds
+            item.insert(QStringLiteral("ts"), event.start / 1000.);
+            item.insert(QStringLiteral("dur"), event.duration / 1000.);
+            events.append(item);
+        }
+    }
+    // The events of finished threads are saved now
+    releaseFinishedBuffers(0);
+    lock.unlock();
+    QJsonObject root;
+    root.insert(QStringLiteral("traceEvents"), events);
+    root.insert(QStringLiteral("displayTimeUnit"), QStringLiteral("ms"));
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCDebug(KDENLIVE_LOG) << "Cannot write trace file" << path;
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return true;
+}
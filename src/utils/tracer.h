@@ -0,0 +1,89 @@
+/*
+Copyright (C) 2018  Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QAtomicInt>
+#include <QString>
+
+/**
+ * @class Tracer
+ * @brief Records timed trace points into per-thread ring buffers, exported in the Chrome trace format.
+ *
+ * Scopes are marked with KDENLIVE_TRACE("category", "name"); when tracing is disabled this only costs
+ * an atomic load. Names must be string literals, they are stored as pointers. Each thread keeps its
+ * last events, so a trace saved after a freeze shows what happened just before it. The saved json
+ * file can be opened in chrome://tracing or ui.perfetto.dev.
+ */
+class Tracer
+{
+public:
+    static bool isEnabled()
+    {
+        return s_enabled.load() != 0;
+    }
+    /** @brief Start or stop recording, starting discards the previous events. */
+    static void setEnabled(bool enabled);
+    /** @brief Monotonic time in nanoseconds since the tracer was initialized. */
+    static qint64 now();
+    /** @brief Store a complete event in the calling thread's buffer. */
+    static void record(const char *category, const char *name, qint64 start, qint64 duration);
+    /** @brief Write the recorded events to @param path as a Chrome trace json file. */
+    static bool exportTrace(const QString &path);
+
+private:
+    static QAtomicInt s_enabled;
+};
+
+/**
+ * @class TraceScope
+ * @brief Records the lifetime of the object as a trace event.
+ */
+class TraceScope
+{
+public:
+    TraceScope(const char *category, const char *name)
+        : m_category(category)
+        , m_name(Tracer::isEnabled() ? name : nullptr)
+        , m_start(m_name ? Tracer::now() : 0)
+    {
+    }
+    ~TraceScope()
+    {
+        if (m_name) {
+            Tracer::record(m_category, m_name, m_start, Tracer::now() - m_start);
+        }
+    }
+
+private:
+    const char *m_category;
+    const char *m_name;
+    qint64 m_start;
+    Q_DISABLE_COPY(TraceScope)
+};
+
+#define KDENLIVE_TRACE_CONCAT_(a, b) a##b
+#define KDENLIVE_TRACE_CONCAT(a, b) KDENLIVE_TRACE_CONCAT_(a, b)
+/** @brief Trace the enclosing scope. */
+#define KDENLIVE_TRACE(category, name) TraceScope KDENLIVE_TRACE_CONCAT(traceScope, __LINE__)(category, name)
+
+#endif
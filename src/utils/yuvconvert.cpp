@@ -0,0 +1,162 @@
+/*
+Copyright (C) 2018  Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "yuvconvert.h"
+
+#include <QtGlobal>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// BT.601 limited range coefficients in Q13 fixed point, the largest (2.017) still fits a signed 16 bit lane
+static const int CoeffY = 9539;   // 1.164383
+static const int CoeffRV = 13075; // 1.596027
+static const int CoeffGU = 3209;  // 0.391762
+static const int CoeffGV = 6660;  // 0.812968
+static const int CoeffBU = 16525; // 2.017232
+// Samples are scaled by 2^7 before the multiplication, keeping the high 16 bits of the product
+// (like _mm_mulhi_epi16) leaves 4 fractional bits in the result
+static const int SampleShift = 7;
+static const int ResultShift = 4;
+
+static inline int mulHigh(int sample, int coeff)
+{
+    return ((sample << SampleShift) * coeff) >> 16;
+}
+
+static inline QRgb yuvToRgb(int y, int u, int v)
+{
+    const int c = mulHigh(y - 16, CoeffY) + (1 << (ResultShift - 1));
+    const int r = qBound(0, (c + mulHigh(v, CoeffRV)) >> ResultShift, 255);
+    const int g = qBound(0, (c - mulHigh(u, CoeffGU) - mulHigh(v, CoeffGV)) >> ResultShift, 255);
+    const int b = qBound(0, (c + mulHigh(u, CoeffBU)) >> ResultShift, 255);
+    return qRgb(r, g, b);
+}
+
+static void convertLineScalar(const uchar *src, QRgb *dst, int width, int yOffset, int uOffset, int vOffset)
+{
+    for (int x = 0; x + 1 < width; x += 2, src += 4) {
+        const int u = src[uOffset] - 128;
+        const int v = src[vOffset] - 128;
+        dst[x] = yuvToRgb(src[yOffset], u, v);
+        dst[x + 1] = yuvToRgb(src[yOffset + 2], u, v);
+    }
+    if (width & 1) {
+        dst[width - 1] = yuvToRgb(src[yOffset], src[uOffset] - 128, src[vOffset] - 128);
+    }
+}
+
+#ifdef __SSE2__
+// Converts the largest multiple of 8 pixels of a line, returns the number of converted pixels
+static int convertLineSse2(const uchar *src, uchar *dst, int width, bool uyvy)
+{
+    const __m128i lowBytes = _mm_set1_epi16(0x00ff);
+    const __m128i lowWords = _mm_set1_epi32(0x0000ffff);
+    const __m128i offset16 = _mm_set1_epi16(16);
+    const __m128i offset128 = _mm_set1_epi16(128);
+    const __m128i rounding = _mm_set1_epi16(1 << (ResultShift - 1));
+    const __m128i cy = _mm_set1_epi16(CoeffY);
+    const __m128i crv = _mm_set1_epi16(CoeffRV);
+    const __m128i cgu = _mm_set1_epi16(CoeffGU);
+    const __m128i cgv = _mm_set1_epi16(CoeffGV);
+    const __m128i cbu = _mm_set1_epi16(CoeffBU);
+    const __m128i alpha = _mm_set1_epi8((char) 0xff);
+    const int count = width & ~7;
+    for (int x = 0; x < count; x += 8, src += 16, dst += 32) {
+        const __m128i in = _mm_loadu_si128((const __m128i *) src);
+        __m128i y, uv;
+        if (uyvy) {
+            y = _mm_srli_epi16(in, 8);
+            uv = _mm_and_si128(in, lowBytes);
+        } else {
+            y = _mm_and_si128(in, lowBytes);
+            uv = _mm_srli_epi16(in, 8);
+        }
+        // Spread each chroma sample over the two pixels sharing it
+        __m128i u = _mm_and_si128(uv, lowWords);
+        __m128i v = _mm_srli_epi32(uv, 16);
+        u = _mm_slli_epi16(_mm_sub_epi16(_mm_or_si128(u, _mm_slli_epi32(u, 16)), offset128), SampleShift);
+        v = _mm_slli_epi16(_mm_sub_epi16(_mm_or_si128(v, _mm_slli_epi32(v, 16)), offset128), SampleShift);
+        y = _mm_slli_epi16(_mm_sub_epi16(y, offset16), SampleShift);
+        const __m128i c = _mm_adds_epi16(_mm_mulhi_epi16(y, cy), rounding);
+        // Saturating adds keep overflowing sums at the 16 bit limits, packus then clamps to 0..255
+        const __m128i r = _mm_srai_epi16(_mm_adds_epi16(c, _mm_mulhi_epi16(v, crv)), ResultShift);
+        const __m128i g = _mm_srai_epi16(_mm_subs_epi16(_mm_subs_epi16(c, _mm_mulhi_epi16(u, cgu)), _mm_mulhi_epi16(v, cgv)), ResultShift);
+        const __m128i b = _mm_srai_epi16(_mm_adds_epi16(c, _mm_mulhi_epi16(u, cbu)), ResultShift);
+        const __m128i b8 = _mm_packus_epi16(b, b);
+        const __m128i g8 = _mm_packus_epi16(g, g);
+        const __m128i r8 = _mm_packus_epi16(r, r);
+        // Interleave to the B, G, R, A byte order of little endian Format_RGB32
+        const __m128i bg = _mm_unpacklo_epi8(b8, g8);
+        const __m128i ra = _mm_unpacklo_epi8(r8, alpha);
+        _mm_storeu_si128((__m128i *) dst, _mm_unpacklo_epi16(bg, ra));
+        _mm_storeu_si128((__m128i *)(dst + 16), _mm_unpackhi_epi16(bg, ra));
+    }
+    return count;
+}
+#endif
+
+void YuvConvert::toRgb32(const uchar *src, int srcStride, uchar *dst, int dstStride, int width, int height, Layout layout)
+{
+    if (!src || !dst || width <= 0 || height <= 0) {
+        return;
+    }
+    const int yOffset = layout == UYVY ? 1 : 0;
+    const int uOffset = layout == UYVY ? 0 : 1;
+    const int vOffset = layout == UYVY ? 2 : 3;
+    for (int line = 0; line < height; ++line) {
+        const uchar *srcLine = src + line * srcStride;
+        uchar *dstLine = dst + line * dstStride;
+        int done = 0;
+#ifdef __SSE2__
+        done = convertLineSse2(srcLine, dstLine, width, layout == UYVY);
+#endif
+        if (done < width) {
+            convertLineScalar(srcLine + done * 2, reinterpret_cast<QRgb *>(dstLine) + done, width - done, yOffset, uOffset, vOffset);
+        }
+    }
+}
+
+ImagePool::ImagePool(int size) :
+    m_size(qMax(1, size)),
+    m_next(0)
+{
+    m_images.resize(m_size);
+}
+
+QImage *ImagePool::acquire(int width, int height, QImage::Format format)
+{
+    // Round robin, so that the buffer last shown by a receiver is not immediately overwritten
+    for (int i = 0; i < m_size; ++i) {
+        QImage &image = m_images[(m_next + i) % m_size];
+        if (!image.isNull() && !image.isDetached()) {
+            // Still referenced by a consumer
+            continue;
+        }
+        if (image.width() != width || image.height() != height || image.format() != format) {
+            image = QImage(width, height, format);
+        }
+        m_next = (m_next + i + 1) % m_size;
+        return &image;
+    }
+    return nullptr;
+}
@@ -0,0 +1,70 @@
+/*
+Copyright (C) 2018  Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef YUVCONVERT_H
+#define YUVCONVERT_H
+
+#include <QImage>
+#include <QVector>
+
+/**
+ * @namespace YuvConvert
+ * @brief Conversion of packed 4:2:2 capture buffers (BT.601, limited range) to QImage::Format_RGB32.
+ *
+ * On x86 builds with SSE2 eight pixels are converted per iteration, other platforms use a scalar
+ * fallback producing the same results.
+ */
+namespace YuvConvert
+{
+/** @brief Byte order of the packed 4:2:2 source. MLT's mlt_image_yuv422 is YUYV, capture cards usually deliver UYVY. */
+enum Layout { YUYV = 0, UYVY };
+
+/** @brief Convert a packed 4:2:2 buffer into a 32 bit RGB buffer.
+ *  @param src source buffer
+ *  @param srcStride bytes per source line (usually width * 2)
+ *  @param dst destination buffer, laid out like QImage::Format_RGB32
+ *  @param dstStride bytes per destination line (usually width * 4) */
+void toRgb32(const uchar *src, int srcStride, uchar *dst, int dstStride, int width, int height, Layout layout);
+}
+
+/**
+ * @class ImagePool
+ * @brief A small set of preallocated images that are reused from frame to frame.
+ *
+ * acquire() returns a buffer that may be written in place; once filled, copies of it can be
+ * emitted as usual. A buffer stays busy as long as such a copy is alive (in a queued signal or
+ * a receiver), so the pool also tells when consumers fall behind: acquire() then returns
+ * nullptr and the caller should drop the frame.
+ */
+class ImagePool
+{
+public:
+    explicit ImagePool(int size = 3);
+    /** @brief Returns an unshared image of the requested geometry, or nullptr if all buffers are still in use. */
+    QImage *acquire(int width, int height, QImage::Format format = QImage::Format_RGB32);
+
+private:
+    QVector<QImage> m_images;
+    int m_size;
+    int m_next;
+};
+
+#endif
@@ -0,0 +1,187 @@
+/*
+Copyright (C) 2018  Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "benchmarkharness.h"
+
+#include <QElapsedTimer>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+static std::atomic<qint64> allocations(0);
+
+void *operator new(std::size_t size)
+{
+    ++allocations;
+    void *ptr = std::malloc(size ? size : 1);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+qint64 allocationCount()
+{
+    return allocations;
+}
+
+qint64 heapUsage()
+{
+#ifdef __GLIBC__
+    return mallinfo().uordblks;
+#else
+    return 0;
+#endif
+}
+
+Stats::Stats(const QString &name)
+    : m_name(name)
+    , m_allocations(0)
+    , m_heap(0)
+{
+}
+
+void Stats::measure(const std::function<void()> &operation)
+{
+    qint64 allocationsBefore = allocationCount();
+    qint64 heap = heapUsage();
+    QElapsedTimer timer;
+    timer.start();
+    operation();
+    m_samples << timer.nsecsElapsed();
+    m_allocations += allocationCount() - allocationsBefore;
+    m_heap += heapUsage() - heap;
+}
+
+void Stats::print()
+{
+    if (m_samples.isEmpty()) {
+        return;
+    }
+    std::sort(m_samples.begin(), m_samples.end());
+    std::cout << std::left << std::setw(20) << m_name.toStdString() << std::right
+              << std::setw(8) << m_samples.count()
+              << std::setw(12) << percentile(50)
+              << std::setw(12) << percentile(90)
+              << std::setw(12) << percentile(99)
+              << std::setw(12) << m_samples.last() / 1000.
+              << std::setw(12) << m_allocations / m_samples.count()
+              << std::setw(14) << m_heap / m_samples.count() << std::endl;
+}
+
+//static
+void Stats::printHeader()
+{
+    std::cout << std::left << std::setw(20) << "operation" << std::right
+              << std::setw(8) << "count"
+              << std::setw(12) << "p50 (us)"
+              << std::setw(12) << "p90 (us)"
+              << std::setw(12) << "p99 (us)"
+              << std::setw(12) << "max (us)"
+              << std::setw(12) << "allocs/op"
+              << std::setw(14) << "heap B/op" << std::endl;
+}
+
+double Stats::percentile(int percent) const
+{
+    int ix = qMin(m_samples.count() - 1, m_samples.count() * percent / 100);
+    return m_samples.at(ix) / 1000.;
+}
+
+BenchmarkOptions::BenchmarkOptions(const QString &description)
+    : m_description(description)
+{
+}
+
+void BenchmarkOptions::addInt(const QString &name, int *value, const QString &help, int minimum)
+{
+    m_options << Option{name, help, QString::number(*value), [value, minimum](const QString &arg) {
+        *value = qMax(minimum, arg.toInt());
+    }};
+}
+
+void BenchmarkOptions::addIntList(const QString &name, QVector<int> *values, const QString &help, int minimum)
+{
+    QStringList defaults;
+    for (int value : *values) {
+        defaults << QString::number(value);
+    }
+    m_options << Option{name, help, defaults.join(QLatin1Char(',')), [values, minimum](const QString &arg) {
+        values->clear();
+        for (const QString &value : arg.split(QLatin1Char(','), QString::SkipEmptyParts)) {
+            *values << qMax(minimum, value.toInt());
+        }
+    }};
+}
+
+void BenchmarkOptions::addString(const QString &name, QString *value, const QString &help)
+{
+    m_options << Option{name, help, *value, [value](const QString &arg) {
+        *value = arg;
+    }};
+}
+
+bool BenchmarkOptions::parse(const QStringList &arguments, int *exitCode)
+{
+    *exitCode = 0;
+    for (int i = 1; i < arguments.count(); ++i) {
+        const QString &arg = arguments.at(i);
+        if (arg == QLatin1String("-h") || arg == QLatin1String("--help")) {
+            printUsage(arguments.first());
+            return false;
+        }
+        auto option = std::find_if(m_options.constBegin(), m_options.constEnd(), [&arg](const Option &o) {
+            return arg.startsWith(QStringLiteral("--") + o.name + QLatin1Char('='));
+        });
+        if (option == m_options.constEnd()) {
+            std::cout << "Unknown argument: " << arg.toStdString() << std::endl;
+            printUsage(arguments.first());
+            *exitCode = 1;
+            return false;
+        }
+        option->set(arg.section(QLatin1Char('='), 1));
+    }
+    return true;
+}
+
+void BenchmarkOptions::printUsage(const QString &path) const
+{
+    std::cout << m_description.toStdString() << std::endl << std::endl
+              << path.toStdString() << " [options]" << std::endl;
+    for (const Option &option : m_options) {
+        std::cout << "\t--" << option.name.toStdString() << "=<value>\n\t\t" << option.help.toStdString();
+        if (!option.defaultValue.isEmpty()) {
+            std::cout << " (default " << option.defaultValue.toStdString() << ")";
+        }
+        std::cout << std::endl;
+    }
+}
@@ -0,0 +1,89 @@
+/*
+Copyright (C) 2018  Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BENCHMARKHARNESS_H
+#define BENCHMARKHARNESS_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <climits>
+#include <functional>
+
+/*
+ * Shared parts of the benchmarks: command line options, latency statistics and allocation counts.
+ * The C++ allocations done by Qt and by the benchmark are counted by the operator new defined in
+ * benchmarkharness.cpp, MLT allocations are only visible in the heap usage reported by glibc.
+ */
+
+/** @brief Number of C++ allocations done since the program started. */
+qint64 allocationCount();
+/** @brief Heap in use as reported by glibc, 0 on other platforms. */
+qint64 heapUsage();
+
+/** @brief Latency samples and allocations of one operation. */
+class Stats
+{
+public:
+    explicit Stats(const QString &name);
+    /** @brief Run @param operation once and record its duration and allocations. */
+    void measure(const std::function<void()> &operation);
+    /** @brief Print the percentiles of the samples as one line of the table started by printHeader. */
+    void print();
+    static void printHeader();
+
+private:
+    QString m_name;
+    QVector<qint64> m_samples;
+    qint64 m_allocations;
+    qint64 m_heap;
+    double percentile(int percent) const;
+};
+
+/** @brief Command line options of a benchmark, given as --name=value. */
+class BenchmarkOptions
+{
+public:
+    /** @param description The text printed before the options in the usage. */
+    explicit BenchmarkOptions(const QString &description);
+    /** @brief Declare the option @param name setting @param value, whose current value is the default. */
+    void addInt(const QString &name, int *value, const QString &help, int minimum = INT_MIN);
+    /** @brief Declare the option @param name setting @param values from a comma separated list. */
+    void addIntList(const QString &name, QVector<int> *values, const QString &help, int minimum = INT_MIN);
+    void addString(const QString &name, QString *value, const QString &help);
+    /** @brief Set the options from @param arguments, the program arguments.
+     *  @return false if the program should stop with @param exitCode, after --help or an unknown argument. */
+    bool parse(const QStringList &arguments, int *exitCode);
+
+private:
+    struct Option
+    {
+        QString name;
+        QString help;
+        QString defaultValue;
+        std::function<void(const QString &)> set;
+    };
+    QString m_description;
+    QVector<Option> m_options;
+    void printUsage(const QString &path) const;
+};
+
+#endif
@@ -0,0 +1,220 @@
+/*
+Copyright (C) 2018  Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Benchmark of the document upgrade on large generated legacy (0.88) projects.
+ *
+ * Each generated project is parsed and upgraded by DocumentValidator as when it is opened in
+ * Kdenlive, then the upgraded document is saved and parsed again, which is what opening the
+ * project costs once its upgraded copy is cached.
+ * With --output, the generated projects are also written so that the whole opening can be
+ * timed in Kdenlive with the "load" trace points.
+ * It is built when Kdenlive is configured with -DBUILD_BENCHMARKS=ON.
+ */
+
+#include "benchmarkharness.h"
+#include "definitions.h"
+#include "doc/documentvalidator.h"
+
+#include <QApplication>
+#include <QDir>
+#include <QDomDocument>
+#include <QFile>
+#include <QLocale>
+#include <QStringList>
+#include <QUrl>
+#include <QVector>
+#include <mlt++/Mlt.h>
+#include <iostream>
+
+struct Options
+{
+    QVector<int> clips = {500, 2000, 8000};
+    int tracks = 4;
+    int effects = 2;
+    int iterations = 5;
+    QString output;
+};
+
+static QDomElement property(QDomDocument &doc, const QString &name, const QString &value)
+{
+    QDomElement prop = doc.createElement(QStringLiteral("property"));
+    prop.setAttribute(QStringLiteral("name"), name);
+    prop.appendChild(doc.createTextNode(value));
+    return prop;
+}
+
+/** @brief Build a project in the 0.88 document format with @param clips bin clips spread over the tracks. */
+static QString generateProject(int clips, const Options &options)
+{
+    QDomDocument doc;
+    QDomElement mlt = doc.createElement(QStringLiteral("mlt"));
+    mlt.setAttribute(QStringLiteral("LC_NUMERIC"), QStringLiteral("C"));
+    mlt.setAttribute(QStringLiteral("root"), QDir::tempPath());
+    doc.appendChild(mlt);
+    QDomElement black = doc.createElement(QStringLiteral("producer"));
+    black.setAttribute(QStringLiteral("id"), QStringLiteral("black"));
+    black.appendChild(property(doc, QStringLiteral("mlt_service"), QStringLiteral("colour")));
+    mlt.appendChild(black);
+
+    QDomElement info = doc.createElement(QStringLiteral("kdenlivedoc"));
+    info.setAttribute(QStringLiteral("version"), QStringLiteral("0.88"));
+    info.setAttribute(QStringLiteral("projectfolder"), QDir::tempPath());
+    QDomElement profile = doc.createElement(QStringLiteral("profileinfo"));
+    profile.setAttribute(QStringLiteral("width"), 1920);
+    profile.setAttribute(QStringLiteral("height"), 1080);
+    info.appendChild(profile);
+    QDomElement tracksInfo = doc.createElement(QStringLiteral("tracksinfo"));
+    info.appendChild(tracksInfo);
+
+    QVector<QDomElement> playlists;
+    QDomElement tractor = doc.createElement(QStringLiteral("tractor"));
+    tractor.setAttribute(QStringLiteral("id"), QStringLiteral("maintractor"));
+    QDomElement blackTrack = doc.createElement(QStringLiteral("track"));
+    blackTrack.setAttribute(QStringLiteral("producer"), QStringLiteral("black_track"));
+    tractor.appendChild(blackTrack);
+    for (int t = 1; t <= options.tracks; ++t) {
+        QDomElement playlist = doc.createElement(QStringLiteral("playlist"));
+        playlist.setAttribute(QStringLiteral("id"), QStringLiteral("playlist%1").arg(t));
+        playlists << playlist;
+        QDomElement track = doc.createElement(QStringLiteral("track"));
+        track.setAttribute(QStringLiteral("producer"), playlist.attribute(QStringLiteral("id")));
+        tractor.appendChild(track);
+        QDomElement trackInfo = doc.createElement(QStringLiteral("trackinfo"));
+        trackInfo.setAttribute(QStringLiteral("trackname"), QStringLiteral("Track %1").arg(t));
+        tracksInfo.appendChild(trackInfo);
+    }
+
+    for (int i = 1; i <= clips; ++i) {
+        const bool title = i % 10 == 0;
+        const QString id = QString::number(i);
+        const int track = i % options.tracks + 1;
+        // Legacy clip description, in the kdenlivedoc element
+        QDomElement kproducer = doc.createElement(QStringLiteral("kdenlive_producer"));
+        kproducer.setAttribute(QStringLiteral("id"), id);
+        kproducer.setAttribute(QStringLiteral("type"), title ? 6 : 3);
+        kproducer.setAttribute(QStringLiteral("duration"), 250);
+        kproducer.setAttribute(QStringLiteral("groupid"), i % 20);
+        kproducer.setAttribute(QStringLiteral("resource"), title ? QString() : QStringLiteral("/media/clip%1.mp4").arg(i));
+        if (title) {
+            kproducer.setAttribute(QStringLiteral("xmldata"), QStringLiteral("<kdenlivetitle><item type=\"QGraphicsTextItem\"><content font-pixel-size=\"40\">Title %1</content></item></kdenlivetitle>").arg(i));
+        }
+        info.appendChild(kproducer);
+        QDomElement marker = doc.createElement(QStringLiteral("marker"));
+        marker.setAttribute(QStringLiteral("id"), id);
+        marker.setAttribute(QStringLiteral("time"), 1.5);
+        marker.setAttribute(QStringLiteral("comment"), QStringLiteral("Marker %1").arg(i));
+        info.appendChild(marker);
+
+        // Track aware MLT producer used in the timeline
+        QDomElement prod = doc.createElement(QStringLiteral("producer"));
+        prod.setAttribute(QStringLiteral("id"), title ? id : QStringLiteral("%1_%2").arg(id).arg(track));
+        prod.appendChild(property(doc, QStringLiteral("mlt_service"), title ? QStringLiteral("kdenlivetitle") : QStringLiteral("avformat")));
+        prod.appendChild(property(doc, QStringLiteral("resource"), kproducer.attribute(QStringLiteral("resource"))));
+        mlt.appendChild(prod);
+
+        QDomElement entry = doc.createElement(QStringLiteral("entry"));
+        entry.setAttribute(QStringLiteral("producer"), prod.attribute(QStringLiteral("id")));
+        entry.setAttribute(QStringLiteral("in"), 0);
+        entry.setAttribute(QStringLiteral("out"), 249);
+        for (int e = 0; e < options.effects; ++e) {
+            QDomElement filter = doc.createElement(QStringLiteral("filter"));
+            filter.appendChild(property(doc, QStringLiteral("mlt_service"), e % 2 ? QStringLiteral("ladspa") : QStringLiteral("brightness")));
+            filter.appendChild(property(doc, QStringLiteral("kdenlive_id"), e % 2 ? QStringLiteral("pitch_shift") : QStringLiteral("brightness")));
+            entry.appendChild(filter);
+        }
+        playlists[track - 1].appendChild(entry);
+        if (i % 4 == 0) {
+            QDomElement transition = doc.createElement(QStringLiteral("transition"));
+            transition.setAttribute(QStringLiteral("in"), i * 250);
+            transition.setAttribute(QStringLiteral("out"), i * 250 + 25);
+            transition.appendChild(property(doc, QStringLiteral("mlt_service"), QStringLiteral("luma")));
+            transition.appendChild(property(doc, QStringLiteral("kdenlive_id"), QStringLiteral("luma")));
+            tractor.appendChild(transition);
+        }
+    }
+    for (const QDomElement &playlist : playlists) {
+        mlt.appendChild(playlist);
+    }
+    mlt.appendChild(tractor);
+    mlt.appendChild(info);
+    return doc.toString();
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+    Options options;
+    BenchmarkOptions arguments(QStringLiteral("Generate large legacy projects and measure their upgrade.\n"
+                                              "The upgrade may ask questions in message boxes, use -platform offscreen to run without a display."));
+    arguments.addIntList(QStringLiteral("clips"), &options.clips, QStringLiteral("Number of bin clips of each generated project"), 1);
+    arguments.addInt(QStringLiteral("tracks"), &options.tracks, QStringLiteral("Number of tracks"), 1);
+    arguments.addInt(QStringLiteral("effects"), &options.effects, QStringLiteral("Number of effects on each clip"), 0);
+    arguments.addInt(QStringLiteral("iterations"), &options.iterations, QStringLiteral("Number of times each step is run"), 1);
+    arguments.addString(QStringLiteral("output"), &options.output, QStringLiteral("Also write the generated projects in this folder"));
+    int exitCode;
+    if (!arguments.parse(app.arguments(), &exitCode)) {
+        return exitCode;
+    }
+
+    // The generated projects use the C locale, matching it keeps the validator from reloading the effects
+    QLocale::setDefault(QLocale::c());
+    Mlt::Factory::init(nullptr);
+    Stats::printHeader();
+    for (int clips : options.clips) {
+        const QString xml = generateProject(clips, options);
+        const QUrl url = QUrl::fromLocalFile(QDir(options.output.isEmpty() ? QDir::tempPath() : options.output).absoluteFilePath(QStringLiteral("legacy_%1.kdenlive").arg(clips)));
+        if (!options.output.isEmpty()) {
+            QFile file(url.toLocalFile());
+            if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+                file.write(xml.toUtf8());
+            } else {
+                std::cout << "Cannot write " << file.fileName().toStdString() << std::endl;
+            }
+        }
+        Stats parse(QStringLiteral("parse %1").arg(clips));
+        Stats upgrade(QStringLiteral("upgrade %1").arg(clips));
+        Stats cached(QStringLiteral("cached load %1").arg(clips));
+        for (int i = 0; i < options.iterations; ++i) {
+            QDomDocument doc;
+            parse.measure([&]() { doc.setContent(xml); });
+            bool valid = false;
+            upgrade.measure([&]() {
+                DocumentValidator validator(doc, url);
+                valid = validator.isProject() && validator.validate(DOCUMENTVERSION);
+            });
+            if (!valid) {
+                std::cout << "The generated project with " << clips << " clips could not be upgraded" << std::endl;
+                return 1;
+            }
+            const QString upgraded = doc.toString();
+            cached.measure([&]() {
+                QDomDocument copy;
+                copy.setContent(upgraded);
+            });
+        }
+        parse.print();
+        upgrade.print();
+        cached.print();
+    }
+    Mlt::Factory::close();
+    return 0;
+}
@@ -0,0 +1,400 @@
+/*
+Copyright (C) 2018  Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Benchmark of the timeline editing operations.
+ *
+ * A synthetic project (color clips, effects, transitions and markers) is built in MLT and each
+ * playlist is wrapped in the timeline's Track class. Moves, inserts, resizes, group moves and razor
+ * cuts are pushed on an undo stack as commands calling the same Track methods as the timeline, then
+ * undone and redone, followed by saving and loading the project xml. Latency percentiles and
+ * allocation counts are reported for each operation.
+ * It is built when Kdenlive is configured with -DBUILD_BENCHMARKS=ON.
+ */
+
+#include "benchmarkharness.h"
+#include "timeline/track.h"
+
+#include <QApplication>
+#include <QScopedPointer>
+#include <QStringList>
+#include <QUndoCommand>
+#include <QUndoStack>
+#include <QVector>
+#include <QWidget>
+#include <mlt++/Mlt.h>
+#include <functional>
+#include <iostream>
+
+struct Options
+{
+    int tracks = 4;
+    int clips = 200;
+    int effects = 2;
+    int transitions = 50;
+    int markers = 10;
+    int iterations = 200;
+    int seed = 1;
+    QString profile = QStringLiteral("atsc_1080p_25");
+};
+
+/** @brief Move a clip on a track, the Track call done by MoveClipCommand through Timeline::moveClip. */
+class MoveCommand : public QUndoCommand
+{
+public:
+    MoveCommand(Track *track, int start, int end, QUndoCommand *parent = nullptr)
+        : QUndoCommand(parent)
+        , m_track(track)
+        , m_start(start, track->fps())
+        , m_end(end, track->fps())
+        , m_done(false)
+    {
+    }
+    void undo() Q_DECL_OVERRIDE
+    {
+        if (m_done) {
+            m_track->move(m_end, m_start);
+        }
+    }
+    void redo() Q_DECL_OVERRIDE
+    {
+        m_done = m_track->move(m_start, m_end);
+    }
+    bool done() const
+    {
+        return m_done;
+    }
+
+private:
+    Track *m_track;
+    GenTime m_start;
+    GenTime m_end;
+    bool m_done;
+};
+
+/** @brief Add a clip in a blank area, the Track calls done by AddTimelineClipCommand. */
+class AddCommand : public QUndoCommand
+{
+public:
+    AddCommand(Track *track, Mlt::Producer *parent, int position, int duration)
+        : m_track(track)
+        , m_parent(parent)
+        , m_position(position, track->fps())
+        , m_duration(duration, track->fps())
+    {
+    }
+    void undo() Q_DECL_OVERRIDE
+    {
+        m_track->del(m_position);
+    }
+    void redo() Q_DECL_OVERRIDE
+    {
+        m_track->add(m_position, m_parent, GenTime(), m_duration, PlaylistState::Original, false, TimelineMode::NormalEdit);
+    }
+
+private:
+    Track *m_track;
+    Mlt::Producer *m_parent;
+    GenTime m_position;
+    GenTime m_duration;
+};
+
+/** @brief Change the end of a clip, the Track call done by ResizeClipCommand. */
+class ResizeCommand : public QUndoCommand
+{
+public:
+    ResizeCommand(Track *track, int start, int offset)
+        : m_track(track)
+        , m_start(start, track->fps())
+        , m_offset(offset, track->fps())
+    {
+    }
+    void undo() Q_DECL_OVERRIDE
+    {
+        m_track->resize(m_start, GenTime() - m_offset, true);
+    }
+    void redo() Q_DECL_OVERRIDE
+    {
+        m_track->resize(m_start, m_offset, true);
+    }
+
+private:
+    Track *m_track;
+    GenTime m_start;
+    GenTime m_offset;
+};
+
+/** @brief Cut a clip, the Track calls done by RazorClipCommand through CustomTrackView::cutClip. */
+class RazorCommand : public QUndoCommand
+{
+public:
+    RazorCommand(Track *track, int start, int end, int position)
+        : m_track(track)
+        , m_start(start, track->fps())
+        , m_end(end, track->fps())
+        , m_position(position, track->fps())
+        , m_done(false)
+    {
+    }
+    void undo() Q_DECL_OVERRIDE
+    {
+        if (m_done && m_track->del(m_position)) {
+            m_track->resize(m_start, m_end - m_position, true);
+        }
+    }
+    void redo() Q_DECL_OVERRIDE
+    {
+        m_done = m_track->cut(m_position);
+    }
+    bool done() const
+    {
+        return m_done;
+    }
+
+private:
+    Track *m_track;
+    GenTime m_start;
+    GenTime m_end;
+    GenTime m_position;
+    bool m_done;
+};
+
+/** @brief Synthetic project, each tractor playlist is handled by a timeline Track. */
+class Project
+{
+public:
+    Project(Mlt::Profile &profile, const Options &options)
+        : m_profile(profile)
+        , m_tractor(profile)
+    {
+        // Bin clips shared by the timeline cuts, like in a real project
+        for (int i = 0; i < 20; ++i) {
+            Mlt::Producer *prod = new Mlt::Producer(profile, "color", QStringLiteral("0x%1ff").arg(i * 0x0a0b0c, 6, 16, QLatin1Char('0')).toUtf8().constData());
+            prod->set("length", 100000);
+            prod->set("out", 99999);
+            prod->set("id", QString::number(i).toUtf8().constData());
+            for (int j = 0; j < options.markers; ++j) {
+                const QString name = QStringLiteral("kdenlive:marker.%1:%2").arg(i).arg(j * 2.5);
+                prod->set(name.toUtf8().constData(), QStringLiteral("0:Marker %1").arg(j).toUtf8().constData());
+            }
+            m_binClips << prod;
+        }
+        for (int t = 0; t < options.tracks; ++t) {
+            Mlt::Playlist playlist(profile);
+            playlist.set("id", QStringLiteral("playlist%1").arg(t).toUtf8().constData());
+            m_tractor.set_track(playlist, t);
+            m_tracks << new Track(t, QList<QAction *>(), playlist, VideoTrack, 50, &m_headers);
+        }
+        for (int c = 0; c < options.clips; ++c) {
+            Track *track = m_tracks.at(c % options.tracks);
+            Mlt::Producer *parent = m_binClips.at(qrand() % m_binClips.count());
+            int in = qrand() % 1000;
+            QScopedPointer<Mlt::Producer> cut(parent->cut(in, in + 50 + qrand() % 200));
+            for (int e = 0; e < options.effects; ++e) {
+                Mlt::Filter filter(profile, "brightness");
+                filter.set("kdenlive_id", "brightness");
+                filter.set("kdenlive_ix", e + 1);
+                filter.set("level", 0.8);
+                cut->attach(filter);
+            }
+            int position = track->playlist().get_playtime() + qrand() % 50;
+            track->playlist().insert_at(position, cut.data(), 1);
+        }
+        Mlt::Field *field = m_tractor.field();
+        int length = m_tractor.get_playtime();
+        for (int i = 0; i < options.transitions && options.tracks > 1; ++i) {
+            Mlt::Transition transition(profile, "composite");
+            int start = qrand() % qMax(1, length - 100);
+            transition.set_in_and_out(start, start + 25);
+            transition.set("kdenlive_id", "composite");
+            int bTrack = 1 + qrand() % (options.tracks - 1);
+            field->plant_transition(transition, qrand() % bTrack, bTrack);
+        }
+        delete field;
+    }
+
+    ~Project()
+    {
+        m_undoStack.clear();
+        qDeleteAll(m_tracks);
+        qDeleteAll(m_binClips);
+    }
+
+    Track *track(int ix)
+    {
+        return m_tracks.at(ix);
+    }
+
+    int trackCount() const
+    {
+        return m_tracks.count();
+    }
+
+    Mlt::Producer *binClip()
+    {
+        return m_binClips.at(qrand() % m_binClips.count());
+    }
+
+    QUndoStack &undoStack()
+    {
+        return m_undoStack;
+    }
+
+    /** @brief Returns the index of a random clip on @param track, or -1 if the track is empty. */
+    int randomClip(Track *track)
+    {
+        Mlt::Playlist &playlist = track->playlist();
+        if (playlist.count() == 0) {
+            return -1;
+        }
+        for (int tries = 0; tries < 10; ++tries) {
+            int ix = qrand() % playlist.count();
+            if (!playlist.is_blank(ix)) {
+                return ix;
+            }
+        }
+        return -1;
+    }
+
+    /** @brief Serialize the project like Render::sceneList. */
+    QString save()
+    {
+        Mlt::Consumer xmlConsumer(m_profile, "xml:kdenlive_playlist");
+        xmlConsumer.set("terminate_on_pause", 1);
+        xmlConsumer.set("store", "kdenlive");
+        xmlConsumer.connect(m_tractor);
+        xmlConsumer.run();
+        return QString::fromUtf8(xmlConsumer.get("kdenlive_playlist"));
+    }
+
+private:
+    Mlt::Profile &m_profile;
+    Mlt::Tractor m_tractor;
+    /** @brief Parent of the track headers created by Track. */
+    QWidget m_headers;
+    QUndoStack m_undoStack;
+    QList<Mlt::Producer *> m_binClips;
+    QList<Track *> m_tracks;
+};
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+    Options options;
+    BenchmarkOptions arguments(QStringLiteral("Build a synthetic timeline and measure the editing operations.\n"
+                                              "Track headers are widgets, use -platform offscreen to run without a display."));
+    arguments.addInt(QStringLiteral("tracks"), &options.tracks, QStringLiteral("Number of tracks"), 1);
+    arguments.addInt(QStringLiteral("clips"), &options.clips, QStringLiteral("Number of clips, spread over the tracks"), 1);
+    arguments.addInt(QStringLiteral("effects"), &options.effects, QStringLiteral("Number of effects on each clip"), 0);
+    arguments.addInt(QStringLiteral("transitions"), &options.transitions, QStringLiteral("Number of transitions"), 0);
+    arguments.addInt(QStringLiteral("markers"), &options.markers, QStringLiteral("Number of markers on each bin clip"), 0);
+    arguments.addInt(QStringLiteral("iterations"), &options.iterations, QStringLiteral("Number of times each operation is run"), 1);
+    arguments.addInt(QStringLiteral("seed"), &options.seed, QStringLiteral("Seed of the random clip positions"));
+    arguments.addString(QStringLiteral("profile"), &options.profile, QStringLiteral("MLT profile of the project"));
+    int exitCode;
+    if (!arguments.parse(app.arguments(), &exitCode)) {
+        return exitCode;
+    }
+
+    Mlt::Factory::init(nullptr);
+    Mlt::Profile profile(options.profile.toUtf8().constData());
+    qsrand(options.seed);
+
+    Stats build("build");
+    Stats move("move"), moveUndo("move undo"), moveRedo("move redo");
+    Stats add("add"), addUndo("add undo"), addRedo("add redo");
+    Stats resize("resize"), resizeUndo("resize undo"), resizeRedo("resize redo");
+    Stats group("group move"), groupUndo("group undo"), groupRedo("group redo");
+    Stats razor("razor"), razorUndo("razor undo"), razorRedo("razor redo");
+    Stats save("save"), load("load");
+
+    QScopedPointer<Project> project;
+    build.measure([&]() {
+        project.reset(new Project(profile, options));
+    });
+    QUndoStack &stack = project->undoStack();
+    // Push a command, then undo and redo it. It is finally undone so that the next operations start from the same project
+    auto measureCommand = [&](QUndoCommand *command, const std::function<bool()> &done, Stats &doStats, Stats &undoStats, Stats &redoStats) {
+        doStats.measure([&]() { stack.push(command); });
+        if (done()) {
+            undoStats.measure([&]() { stack.undo(); });
+            redoStats.measure([&]() { stack.redo(); });
+        }
+        stack.undo();
+    };
+
+    for (int i = 0; i < options.iterations; ++i) {
+        Track *track = project->track(qrand() % project->trackCount());
+        Mlt::Playlist &playlist = track->playlist();
+        const int ix = project->randomClip(track);
+        if (ix >= 0) {
+            const int start = playlist.clip_start(ix);
+            const int length = playlist.clip_length(ix);
+            // Move the clip to the end of the track so that it never overlaps another clip
+            MoveCommand *moveCommand = new MoveCommand(track, start, playlist.get_playtime() + 10 + qrand() % 100);
+            measureCommand(moveCommand, [moveCommand]() { return moveCommand->done(); }, move, moveUndo, moveRedo);
+
+            // Shorten the clip, so that it does not need to extend over the next one
+            const int offset = qMin(length - 1, 1 + qrand() % 20);
+            measureCommand(new ResizeCommand(track, start, -offset), []() { return true; }, resize, resizeUndo, resizeRedo);
+
+            if (length > 3) {
+                const int position = start + 1 + qrand() % (length - 2);
+                RazorCommand *razorCommand = new RazorCommand(track, start, start + length, position);
+                measureCommand(razorCommand, [razorCommand]() { return razorCommand->done(); }, razor, razorUndo, razorRedo);
+            }
+        }
+
+        const int duration = 25 + qrand() % 50;
+        measureCommand(new AddCommand(track, project->binClip(), playlist.get_playtime() + 10, duration), []() { return true; }, add, addUndo, addRedo);
+
+        // Group move: the last clip of each track is moved further right
+        QUndoCommand *groupCommand = new QUndoCommand();
+        QList<MoveCommand *> groupMoves;
+        for (int t = 0; t < project->trackCount(); ++t) {
+            Mlt::Playlist &pl = project->track(t)->playlist();
+            int last = pl.count() - 1;
+            if (last >= 0 && !pl.is_blank(last)) {
+                groupMoves << new MoveCommand(project->track(t), pl.clip_start(last), pl.get_playtime() + 50, groupCommand);
+            }
+        }
+        measureCommand(groupCommand, [&groupMoves]() { return !groupMoves.isEmpty(); }, group, groupUndo, groupRedo);
+    }
+
+    for (int i = 0; i < qMax(1, options.iterations / 20); ++i) {
+        QString xml;
+        save.measure([&]() { xml = project->save(); });
+        load.measure([&]() {
+            Mlt::Producer producer(profile, "xml-string", xml.toUtf8().constData());
+        });
+    }
+
+    std::cout << options.tracks << " tracks, " << options.clips << " clips, " << options.effects << " effects per clip, "
+              << options.transitions << " transitions, " << options.markers << " markers per bin clip" << std::endl << std::endl;
+    Stats::printHeader();
+    for (Stats *stats : {&build, &move, &moveUndo, &moveRedo, &add, &addUndo, &addRedo, &resize, &resizeUndo, &resizeRedo,
+                         &group, &groupUndo, &groupRedo, &razor, &razorUndo, &razorRedo, &save, &load}) {
+        stats->print();
+    }
+    project.reset();
+    Mlt::Factory::close();
+    return 0;
+}